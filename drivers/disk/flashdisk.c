@@ -13,250 +13,659 @@
 #include <init.h>
 #include <device.h>
 #include <drivers/flash.h>
+#include <kernel.h>
+#include <logging/log.h>
+
+LOG_MODULE_REGISTER(flashdisk, CONFIG_FLASHDISK_LOG_LEVEL);
 
 #define SECTOR_SIZE CONFIG_DISK_FLASH_SECTOR_SIZE
+#define BLOCK_SIZE CONFIG_DISK_ERASE_BLOCK_SIZE
+#define SECTORS_PER_BLOCK (BLOCK_SIZE / SECTOR_SIZE)
+#define VOLUME_BLOCKS (CONFIG_DISK_VOLUME_SIZE / BLOCK_SIZE)
+
+BUILD_ASSERT((BLOCK_SIZE % SECTOR_SIZE) == 0,
+	     "Erase block size must be a multiple of the sector size");
+BUILD_ASSERT((CONFIG_DISK_FLASH_START % CONFIG_DISK_FLASH_ERASE_ALIGNMENT) == 0,
+	     "Flash disk must start at an erase-aligned address");
+
+#ifdef CONFIG_DISK_FLASH_WRITE_BACK
+#define CACHE_BLOCKS CONFIG_DISK_FLASH_CACHE_BLOCKS
+#else
+#define CACHE_BLOCKS 1
+#endif
 
 static const struct device *flash_dev;
 
-/* flash read-copy-erase-write operation */
-static uint8_t __aligned(4) read_copy_buf[CONFIG_DISK_ERASE_BLOCK_SIZE];
-static uint8_t *fs_buff = read_copy_buf;
+/* Erase blocks are always modified in RAM and then erased and written back
+ * as a whole. Without the write-back cache, the single entry is written back
+ * before each write request returns.
+ */
+struct flashdisk_cache_entry {
+	uint8_t __aligned(4) data[BLOCK_SIZE];
+	uint32_t block;
+	uint32_t last_use;
+	bool valid;
+	bool dirty;
+};
 
-/* calculate number of blocks required for a given size */
-#define GET_NUM_BLOCK(total_size, block_size) \
-	((total_size + block_size - 1) / block_size)
+static struct flashdisk_cache_entry cache[CACHE_BLOCKS];
+static uint32_t cache_clock;
 
-#define GET_SIZE_TO_BOUNDARY(start, block_size) \
-	(block_size - (start & (block_size - 1)))
+/* serializes disk accesses against the delayed flush */
+static K_MUTEX_DEFINE(flashdisk_lock);
 
-static off_t lba_to_address(uint32_t sector_num)
+static off_t block_address(uint32_t pblock)
 {
-	off_t flash_addr;
+	return CONFIG_DISK_FLASH_START + (off_t)pblock * BLOCK_SIZE;
+}
 
-	flash_addr = CONFIG_DISK_FLASH_START + sector_num * SECTOR_SIZE;
+static int flash_read_chunks(off_t fl_addr, void *buff, size_t size)
+{
+	uint8_t *dst = buff;
 
-	__ASSERT(flash_addr < (CONFIG_DISK_FLASH_START +
-		CONFIG_DISK_VOLUME_SIZE), "FS bound error");
+	while (size) {
+		size_t len = MIN(size, CONFIG_DISK_FLASH_MAX_RW_SIZE);
 
-	return flash_addr;
+		if (flash_read(flash_dev, fl_addr, dst, len) != 0) {
+			return -EIO;
+		}
+
+		fl_addr += len;
+		dst += len;
+		size -= len;
+	}
+
+	return 0;
 }
 
-static int disk_flash_access_status(struct disk_info *disk)
+static int flash_write_chunks(off_t fl_addr, const void *buff, size_t size)
 {
-	if (!flash_dev) {
-		return DISK_STATUS_NOMEDIA;
+	const uint8_t *src = buff;
+
+	while (size) {
+		size_t len = MIN(size, CONFIG_DISK_FLASH_MAX_RW_SIZE);
+
+		if (flash_write(flash_dev, fl_addr, src, len) != 0) {
+			return -EIO;
+		}
+
+		fl_addr += len;
+		src += len;
+		size -= len;
 	}
 
-	return DISK_STATUS_OK;
+	return 0;
 }
 
-static int disk_flash_access_init(struct disk_info *disk)
+/* erase one physical block and write new contents to it */
+static int program_flash_block(uint32_t pblock, const uint8_t *data)
 {
-	if (flash_dev) {
-		return 0;
+	off_t fl_addr = block_address(pblock);
+
+	if (flash_erase(flash_dev, fl_addr, BLOCK_SIZE) != 0) {
+		return -EIO;
 	}
 
-	flash_dev = device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
-	if (!flash_dev) {
-		return -ENODEV;
+	return flash_write_chunks(fl_addr, data, BLOCK_SIZE);
+}
+
+#ifdef CONFIG_DISK_FLASH_FTL
+
+/*
+ * Logical erase blocks are remapped to physical ones. A modified block is
+ * written to the next free physical block, found by walking the volume in a
+ * round-robin fashion, so that repeated writes to the same sectors do not
+ * keep erasing the same block. The previous location only becomes free once
+ * the new mapping has been recorded, so an interrupted write leaves the old
+ * contents in place.
+ *
+ * The mapping is kept in one of the two last blocks of the volume: a header,
+ * a snapshot of the whole map and a log of changes appended to it. When the
+ * log is full, a new snapshot is written to the other journal block with a
+ * newer generation.
+ */
+#define FTL_JOURNAL_BLOCKS 2
+#define FTL_DATA_BLOCKS (VOLUME_BLOCKS - FTL_JOURNAL_BLOCKS)
+#define FTL_LOGICAL_BLOCKS (FTL_DATA_BLOCKS - CONFIG_DISK_FLASH_FTL_SPARE_BLOCKS)
+
+#define FTL_MAGIC 0x4c54467aU
+#define FTL_RECORD_SIZE 8
+#define FTL_SNAPSHOT_OFFSET FTL_RECORD_SIZE
+#define FTL_SNAPSHOT_SIZE \
+	ROUND_UP(FTL_LOGICAL_BLOCKS * sizeof(uint16_t), FTL_RECORD_SIZE)
+#define FTL_RECORDS_OFFSET (FTL_SNAPSHOT_OFFSET + FTL_SNAPSHOT_SIZE)
+#define FTL_RECORDS ((BLOCK_SIZE - FTL_RECORDS_OFFSET) / FTL_RECORD_SIZE)
+
+BUILD_ASSERT(FTL_DATA_BLOCKS <= UINT16_MAX, "Too many erase blocks for FTL");
+BUILD_ASSERT(FTL_LOGICAL_BLOCKS > 0, "Volume too small for FTL");
+BUILD_ASSERT(FTL_RECORDS_OFFSET < BLOCK_SIZE,
+	     "FTL map does not fit in an erase block");
+
+struct ftl_header {
+	uint32_t magic;
+	uint16_t blocks;
+	uint16_t generation;
+};
+
+struct ftl_record {
+	uint16_t lblock;
+	uint16_t pblock;
+	uint16_t lblock_inv;
+	uint16_t pblock_inv;
+};
+
+BUILD_ASSERT(sizeof(struct ftl_header) == FTL_RECORD_SIZE);
+BUILD_ASSERT(sizeof(struct ftl_record) == FTL_RECORD_SIZE);
+
+/* padded to the snapshot size so that it can be written as is */
+static uint16_t ftl_map[FTL_SNAPSHOT_SIZE / sizeof(uint16_t)];
+static ATOMIC_DEFINE(ftl_used, FTL_DATA_BLOCKS);
+static uint32_t ftl_cursor;
+static uint32_t ftl_next_record;
+static uint16_t ftl_generation;
+static uint8_t ftl_journal;
+
+static inline uint32_t block_map(uint32_t lblock)
+{
+	return ftl_map[lblock];
+}
+
+static off_t ftl_journal_address(uint8_t journal)
+{
+	return block_address(FTL_DATA_BLOCKS + journal);
+}
+
+static int ftl_journal_write(uint8_t journal, uint16_t generation)
+{
+	struct ftl_header hdr = {
+		.magic = FTL_MAGIC,
+		.blocks = FTL_LOGICAL_BLOCKS,
+		.generation = generation,
+	};
+	off_t fl_addr = ftl_journal_address(journal);
+	int rc;
+
+	if (flash_erase(flash_dev, fl_addr, BLOCK_SIZE) != 0) {
+		return -EIO;
+	}
+
+	rc = flash_write_chunks(fl_addr + FTL_SNAPSHOT_OFFSET, ftl_map,
+				FTL_SNAPSHOT_SIZE);
+	if (rc != 0) {
+		return rc;
 	}
 
+	/* the header goes last, it marks the snapshot as complete */
+	rc = flash_write_chunks(fl_addr, &hdr, sizeof(hdr));
+	if (rc != 0) {
+		return rc;
+	}
+
+	ftl_journal = journal;
+	ftl_generation = generation;
+	ftl_next_record = 0;
+
 	return 0;
 }
 
-static int disk_flash_access_read(struct disk_info *disk, uint8_t *buff,
-				uint32_t start_sector, uint32_t sector_count)
+static int ftl_journal_append(uint32_t lblock, uint32_t pblock)
 {
+	struct ftl_record rec = {
+		.lblock = lblock,
+		.pblock = pblock,
+		.lblock_inv = ~lblock,
+		.pblock_inv = ~pblock,
+	};
 	off_t fl_addr;
-	uint32_t remaining;
-	uint32_t len;
-	uint32_t num_read;
+	int rc;
+
+	if (ftl_next_record >= FTL_RECORDS) {
+		return ftl_journal_write(!ftl_journal, ftl_generation + 1);
+	}
 
-	fl_addr = lba_to_address(start_sector);
-	remaining = (sector_count * SECTOR_SIZE);
-	len = CONFIG_DISK_FLASH_MAX_RW_SIZE;
+	fl_addr = ftl_journal_address(ftl_journal) + FTL_RECORDS_OFFSET +
+		  ftl_next_record * FTL_RECORD_SIZE;
 
-	num_read = GET_NUM_BLOCK(remaining, CONFIG_DISK_FLASH_MAX_RW_SIZE);
+	rc = flash_write_chunks(fl_addr, &rec, sizeof(rec));
+	if (rc != 0) {
+		/* the slot may be partially written, start a new snapshot */
+		ftl_next_record = FTL_RECORDS;
+		return rc;
+	}
+
+	ftl_next_record++;
 
-	for (uint32_t i = 0; i < num_read; i++) {
-		if (remaining < CONFIG_DISK_FLASH_MAX_RW_SIZE) {
-			len = remaining;
+	return 0;
+}
+
+static bool ftl_record_valid(const struct ftl_record *rec)
+{
+	return (uint16_t)(rec->lblock ^ rec->lblock_inv) == UINT16_MAX &&
+	       (uint16_t)(rec->pblock ^ rec->pblock_inv) == UINT16_MAX &&
+	       rec->lblock < FTL_LOGICAL_BLOCKS &&
+	       rec->pblock < FTL_DATA_BLOCKS;
+}
+
+static bool ftl_record_erased(const struct ftl_record *rec, uint8_t erase_value)
+{
+	const uint8_t *raw = (const uint8_t *)rec;
+
+	for (size_t i = 0; i < sizeof(*rec); i++) {
+		if (raw[i] != erase_value) {
+			return false;
 		}
+	}
 
-		if (flash_read(flash_dev, fl_addr, buff, len) != 0) {
+	return true;
+}
+
+static int ftl_init(void)
+{
+	const struct flash_parameters *params;
+	struct ftl_header hdr[FTL_JOURNAL_BLOCKS];
+	struct ftl_record rec;
+	int journal = -1;
+	int rc;
+
+	params = flash_get_parameters(flash_dev);
+	if (FTL_RECORD_SIZE % params->write_block_size) {
+		LOG_ERR("Unsupported write block size %zu",
+			params->write_block_size);
+		return -ENOTSUP;
+	}
+
+	for (int i = 0; i < FTL_JOURNAL_BLOCKS; i++) {
+		rc = flash_read_chunks(ftl_journal_address(i), &hdr[i],
+				       sizeof(hdr[i]));
+		if (rc != 0) {
+			return rc;
+		}
+
+		if (hdr[i].magic != FTL_MAGIC) {
+			continue;
+		}
+
+		if (hdr[i].blocks != FTL_LOGICAL_BLOCKS) {
+			LOG_ERR("FTL map of %u blocks, expected %u",
+				hdr[i].blocks, FTL_LOGICAL_BLOCKS);
+			return -EINVAL;
+		}
+
+		if (journal < 0 ||
+		    (int16_t)(hdr[i].generation - hdr[journal].generation) > 0) {
+			journal = i;
+		}
+	}
+
+	(void)memset(ftl_used, 0, sizeof(ftl_used));
+	ftl_cursor = 0;
+
+	if (journal < 0) {
+		/* fresh volume, start with an identity mapping */
+		LOG_INF("Creating FTL map");
+		for (uint32_t i = 0; i < FTL_LOGICAL_BLOCKS; i++) {
+			ftl_map[i] = i;
+			atomic_set_bit(ftl_used, i);
+		}
+
+		return ftl_journal_write(0, 1);
+	}
+
+	rc = flash_read_chunks(ftl_journal_address(journal) +
+			       FTL_SNAPSHOT_OFFSET, ftl_map, FTL_SNAPSHOT_SIZE);
+	if (rc != 0) {
+		return rc;
+	}
+
+	ftl_journal = journal;
+	ftl_generation = hdr[journal].generation;
+
+	for (ftl_next_record = 0; ftl_next_record < FTL_RECORDS;
+	     ftl_next_record++) {
+		rc = flash_read_chunks(ftl_journal_address(journal) +
+				       FTL_RECORDS_OFFSET +
+				       ftl_next_record * FTL_RECORD_SIZE,
+				       &rec, sizeof(rec));
+		if (rc != 0) {
+			return rc;
+		}
+
+		if (!ftl_record_valid(&rec)) {
+			if (!ftl_record_erased(&rec, params->erase_value)) {
+				/* interrupted append, compact on next write */
+				ftl_next_record = FTL_RECORDS;
+			}
+			break;
+		}
+
+		ftl_map[rec.lblock] = rec.pblock;
+	}
+
+	for (uint32_t i = 0; i < FTL_LOGICAL_BLOCKS; i++) {
+		if (ftl_map[i] >= FTL_DATA_BLOCKS ||
+		    atomic_test_and_set_bit(ftl_used, ftl_map[i])) {
+			LOG_ERR("Corrupted FTL map");
 			return -EIO;
 		}
+	}
 
-		fl_addr += len;
-		buff += len;
-		remaining -= len;
+	return 0;
+}
+
+static uint32_t ftl_free_block(void)
+{
+	uint32_t pblock;
+
+	do {
+		pblock = ftl_cursor;
+		ftl_cursor = (ftl_cursor + 1) % FTL_DATA_BLOCKS;
+	} while (atomic_test_bit(ftl_used, pblock));
+
+	return pblock;
+}
+
+static int write_flash_block(uint32_t lblock, const uint8_t *data)
+{
+	uint32_t old = ftl_map[lblock];
+	uint32_t pblock = ftl_free_block();
+	int rc;
+
+	rc = program_flash_block(pblock, data);
+	if (rc != 0) {
+		return rc;
+	}
+
+	ftl_map[lblock] = pblock;
+	rc = ftl_journal_append(lblock, pblock);
+	if (rc != 0) {
+		ftl_map[lblock] = old;
+		return rc;
 	}
 
+	atomic_set_bit(ftl_used, pblock);
+	atomic_clear_bit(ftl_used, old);
+
 	return 0;
 }
 
-/* This performs read-copy into an output buffer */
-static int read_copy_flash_block(off_t start_addr, uint32_t size,
-				 const void *src_buff,
-				 uint8_t *dest_buff)
+#define DISK_SECTOR_COUNT (FTL_LOGICAL_BLOCKS * SECTORS_PER_BLOCK)
+
+#else
+
+static inline uint32_t block_map(uint32_t lblock)
 {
-	off_t fl_addr;
-	uint32_t num_read;
-	uint32_t offset = 0U;
+	return lblock;
+}
+
+static int write_flash_block(uint32_t lblock, const uint8_t *data)
+{
+	return program_flash_block(lblock, data);
+}
 
-	/* adjust offset if starting address is not erase-aligned address */
-	if (start_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1)) {
-		offset = start_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1);
+#define DISK_SECTOR_COUNT (CONFIG_DISK_VOLUME_SIZE / SECTOR_SIZE)
+
+#endif /* CONFIG_DISK_FLASH_FTL */
+
+static struct flashdisk_cache_entry *cache_find(uint32_t block)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].valid && cache[i].block == block) {
+			cache[i].last_use = ++cache_clock;
+			return &cache[i];
+		}
 	}
 
-	/* align starting address to an aligned address for flash erase-write */
-	fl_addr = ROUND_DOWN(start_addr, CONFIG_DISK_FLASH_ERASE_ALIGNMENT);
+	return NULL;
+}
 
-	num_read = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
-				 CONFIG_DISK_FLASH_MAX_RW_SIZE);
+static int cache_flush(struct flashdisk_cache_entry *entry)
+{
+	int rc;
 
-	/* read one block from flash */
-	for (uint32_t i = 0; i < num_read; i++) {
-		int rc;
+	if (!entry->dirty) {
+		return 0;
+	}
+
+	rc = write_flash_block(entry->block, entry->data);
+	if (rc == 0) {
+		entry->dirty = false;
+	}
+
+	return rc;
+}
+
+static int cache_flush_all(void)
+{
+	int ret = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cache); i++) {
+		int rc = cache_flush(&cache[i]);
 
-		rc = flash_read(flash_dev,
-				fl_addr + (CONFIG_DISK_FLASH_MAX_RW_SIZE * i),
-				dest_buff + (CONFIG_DISK_FLASH_MAX_RW_SIZE * i),
-				CONFIG_DISK_FLASH_MAX_RW_SIZE);
 		if (rc != 0) {
-			return -EIO;
+			ret = rc;
 		}
 	}
 
-	/* overwrite with user data */
-	memcpy(dest_buff + offset, src_buff, size);
-
-	return 0;
+	return ret;
 }
 
-/* input size is either less or equal to a block size,
- * CONFIG_DISK_ERASE_BLOCK_SIZE.
+/* Get a cache entry for a block, evicting the least recently used one if
+ * needed. The block is only read from flash if it is not going to be
+ * overwritten entirely.
  */
-static int update_flash_block(off_t start_addr, uint32_t size, const void *buff)
+static int cache_get(uint32_t block, bool load,
+		     struct flashdisk_cache_entry **entry)
 {
-	off_t fl_addr;
-	uint8_t *src = (uint8_t *)buff;
-	uint32_t num_write;
+	struct flashdisk_cache_entry *e = cache_find(block);
+	int rc;
 
-	/* if size is a partial block, perform read-copy with user data */
-	if (size < CONFIG_DISK_ERASE_BLOCK_SIZE) {
-		int rc;
+	if (e) {
+		*entry = e;
+		return 0;
+	}
+
+	e = &cache[0];
+	for (size_t i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (!cache[i].valid) {
+			e = &cache[i];
+			break;
+		}
 
-		rc = read_copy_flash_block(start_addr, size, buff, fs_buff);
+		if (cache[i].last_use < e->last_use) {
+			e = &cache[i];
+		}
+	}
+
+	if (e->valid) {
+		rc = cache_flush(e);
 		if (rc != 0) {
-			return -EIO;
+			return rc;
 		}
 
-		/* now use the local buffer as the source */
-		src = (uint8_t *)fs_buff;
+		e->valid = false;
+	}
+
+	if (load) {
+		rc = flash_read_chunks(block_address(block_map(block)),
+				       e->data, BLOCK_SIZE);
+		if (rc != 0) {
+			return rc;
+		}
 	}
 
-	/* always align starting address for flash write operation */
-	fl_addr = ROUND_DOWN(start_addr, CONFIG_DISK_FLASH_ERASE_ALIGNMENT);
+	e->block = block;
+	e->valid = true;
+	e->last_use = ++cache_clock;
+	*entry = e;
 
-	if (flash_erase(flash_dev, fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE)
-			!= 0) {
-		return -EIO;
+	return 0;
+}
+
+#if defined(CONFIG_DISK_FLASH_WRITE_BACK) && \
+	(CONFIG_DISK_FLASH_FLUSH_TIMEOUT > 0)
+static void flush_work_handler(struct k_work *work)
+{
+	int rc;
+
+	k_mutex_lock(&flashdisk_lock, K_FOREVER);
+	rc = cache_flush_all();
+	k_mutex_unlock(&flashdisk_lock);
+
+	if (rc != 0) {
+		LOG_ERR("Failed to write back cached blocks (%d)", rc);
 	}
+}
 
-	/* write data to flash */
-	num_write = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
-				  CONFIG_DISK_FLASH_MAX_RW_SIZE);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
 
-	for (uint32_t i = 0; i < num_write; i++) {
-		if (flash_write(flash_dev, fl_addr, src,
-				CONFIG_DISK_FLASH_MAX_RW_SIZE) != 0) {
-			return -EIO;
-		}
+static void schedule_flush(void)
+{
+	/* not rescheduled by later writes, so that dirty blocks are written
+	 * back at most one timeout after they were first modified
+	 */
+	(void)k_work_schedule(&flush_work,
+			      K_MSEC(CONFIG_DISK_FLASH_FLUSH_TIMEOUT));
+}
+#else
+static inline void schedule_flush(void)
+{
+}
+#endif
 
-		fl_addr += CONFIG_DISK_FLASH_MAX_RW_SIZE;
-		src += CONFIG_DISK_FLASH_MAX_RW_SIZE;
+static int disk_flash_access_status(struct disk_info *disk)
+{
+	if (!flash_dev) {
+		return DISK_STATUS_NOMEDIA;
 	}
 
-	return 0;
+	return DISK_STATUS_OK;
 }
 
-static int disk_flash_access_write(struct disk_info *disk, const uint8_t *buff,
-				 uint32_t start_sector, uint32_t sector_count)
+static int disk_flash_access_init(struct disk_info *disk)
 {
-	off_t fl_addr;
-	uint32_t remaining;
-	uint32_t size;
-
-	fl_addr = lba_to_address(start_sector);
-	remaining = (sector_count * SECTOR_SIZE);
-
-	/* check if start address is erased-aligned address  */
-	if (fl_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1)) {
-		off_t block_bnd;
-
-		/* not aligned */
-		/* check if the size goes over flash block boundary */
-		block_bnd = fl_addr + CONFIG_DISK_ERASE_BLOCK_SIZE;
-		block_bnd = block_bnd & ~(CONFIG_DISK_ERASE_BLOCK_SIZE - 1);
-		if ((fl_addr + remaining) < block_bnd) {
-			/* not over block boundary (a partial block also) */
-			if (update_flash_block(fl_addr, remaining, buff) != 0) {
-				return -EIO;
-			}
-			return 0;
-		}
+	const struct device *dev;
+	int rc = 0;
 
-		/* write goes over block boundary */
-		size = GET_SIZE_TO_BOUNDARY(fl_addr,
-						CONFIG_DISK_ERASE_BLOCK_SIZE);
+	if (flash_dev) {
+		return 0;
+	}
 
-		/* write first partial block */
-		if (update_flash_block(fl_addr, size, buff) != 0) {
-			return -EIO;
+	dev = device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
+	if (!dev) {
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&flashdisk_lock, K_FOREVER);
+
+	flash_dev = dev;
+
+#ifdef CONFIG_DISK_FLASH_FTL
+	rc = ftl_init();
+	if (rc != 0) {
+		flash_dev = NULL;
+	}
+#endif
+
+	k_mutex_unlock(&flashdisk_lock);
+
+	return rc;
+}
+
+static int disk_flash_access_read(struct disk_info *disk, uint8_t *buff,
+				uint32_t start_sector, uint32_t sector_count)
+{
+	int rc = 0;
+
+	__ASSERT(start_sector + sector_count <= DISK_SECTOR_COUNT,
+		 "FS bound error");
+
+	k_mutex_lock(&flashdisk_lock, K_FOREVER);
+
+	while (sector_count) {
+		uint32_t block = start_sector / SECTORS_PER_BLOCK;
+		uint32_t first = start_sector % SECTORS_PER_BLOCK;
+		uint32_t count = MIN(sector_count, SECTORS_PER_BLOCK - first);
+		struct flashdisk_cache_entry *entry = cache_find(block);
+		size_t size = count * SECTOR_SIZE;
+
+		if (entry) {
+			memcpy(buff, entry->data + first * SECTOR_SIZE, size);
+		} else {
+			rc = flash_read_chunks(block_address(block_map(block)) +
+					       first * SECTOR_SIZE, buff, size);
+			if (rc != 0) {
+				break;
+			}
 		}
 
-		fl_addr += size;
-		remaining -= size;
 		buff += size;
+		start_sector += count;
+		sector_count -= count;
 	}
 
-	/* start is an erase-aligned address */
-	while (remaining) {
-		int rc;
+	k_mutex_unlock(&flashdisk_lock);
 
-		if (remaining < CONFIG_DISK_ERASE_BLOCK_SIZE) {
-			break;
-		}
+	return rc;
+}
+
+static int disk_flash_access_write(struct disk_info *disk, const uint8_t *buff,
+				 uint32_t start_sector, uint32_t sector_count)
+{
+	int rc = 0;
+
+	__ASSERT(start_sector + sector_count <= DISK_SECTOR_COUNT,
+		 "FS bound error");
 
-		rc = update_flash_block(fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE,
-					 buff);
+	k_mutex_lock(&flashdisk_lock, K_FOREVER);
+
+	/* merge the sectors into the cached erase blocks */
+	while (sector_count) {
+		uint32_t block = start_sector / SECTORS_PER_BLOCK;
+		uint32_t first = start_sector % SECTORS_PER_BLOCK;
+		uint32_t count = MIN(sector_count, SECTORS_PER_BLOCK - first);
+		struct flashdisk_cache_entry *entry;
+		size_t size = count * SECTOR_SIZE;
+
+		rc = cache_get(block, count < SECTORS_PER_BLOCK, &entry);
 		if (rc != 0) {
-			return -EIO;
+			break;
 		}
 
-		fl_addr += CONFIG_DISK_ERASE_BLOCK_SIZE;
-		remaining -= CONFIG_DISK_ERASE_BLOCK_SIZE;
-		buff += CONFIG_DISK_ERASE_BLOCK_SIZE;
+		memcpy(entry->data + first * SECTOR_SIZE, buff, size);
+		entry->dirty = true;
+
+		buff += size;
+		start_sector += count;
+		sector_count -= count;
 	}
 
-	/* remaining partial block */
-	if (remaining) {
-		if (update_flash_block(fl_addr, remaining, buff) != 0) {
-			return -EIO;
+	if (rc == 0) {
+		if (IS_ENABLED(CONFIG_DISK_FLASH_WRITE_BACK)) {
+			schedule_flush();
+		} else {
+			rc = cache_flush_all();
 		}
 	}
 
-	return 0;
+	k_mutex_unlock(&flashdisk_lock);
+
+	return rc;
 }
 
 static int disk_flash_access_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
 {
 	switch (cmd) {
-	case DISK_IOCTL_CTRL_SYNC:
-		return 0;
+	case DISK_IOCTL_CTRL_SYNC: {
+		int rc;
+
+		k_mutex_lock(&flashdisk_lock, K_FOREVER);
+		rc = cache_flush_all();
+		k_mutex_unlock(&flashdisk_lock);
+
+		return rc;
+	}
 	case DISK_IOCTL_GET_SECTOR_COUNT:
-		*(uint32_t *)buff = CONFIG_DISK_VOLUME_SIZE / SECTOR_SIZE;
+		*(uint32_t *)buff = DISK_SECTOR_COUNT;
 		return 0;
 	case DISK_IOCTL_GET_SECTOR_SIZE:
 		*(uint32_t *) buff = SECTOR_SIZE;
@@ -8,6 +8,7 @@
 
 #include <device.h>
 #include <drivers/flash.h>
+#include <drivers/flash/flash_simulator.h>
 #include <init.h>
 #include <kernel.h>
 #include <sys/util.h>
@@ -53,6 +54,21 @@
 
 #define MOCK_FLASH(addr) (mock_flash + (addr) - FLASH_SIMULATOR_BASE_OFFSET)
 
+/* timing model derived from DT, parts not given take no time */
+#define FLASH_SIMULATOR_PROG_PAGE_SIZE \
+		DT_INST_PROP_OR(0, program_page_size, FLASH_SIMULATOR_PROG_UNIT)
+#define FLASH_SIMULATOR_PAGE_PROG_TIME_US \
+		DT_INST_PROP_OR(0, page_program_time_us, 0)
+#define FLASH_SIMULATOR_SECTOR_ERASE_TIME_US \
+		DT_INST_PROP_OR(0, sector_erase_time_us, 0)
+#define FLASH_SIMULATOR_READ_BANDWIDTH \
+		DT_INST_PROP_OR(0, read_bandwidth, 0)
+
+#if (FLASH_SIMULATOR_PROG_PAGE_SIZE % FLASH_SIMULATOR_PROG_UNIT) || \
+	(FLASH_SIMULATOR_ERASE_UNIT % FLASH_SIMULATOR_PROG_PAGE_SIZE)
+#error "Program page must be a multiple of program unit and a factor of erase unit"
+#endif
+
 /* maximum number of pages that can be tracked by the stats module */
 #define STATS_PAGE_COUNT_THRESHOLD 256
 
@@ -172,6 +188,80 @@ static int flash_range_is_valid(const struct device *dev, off_t offset,
 	return 1;
 }
 
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+static uint32_t wear_erase_counts[FLASH_SIMULATOR_PAGE_COUNT];
+static uint64_t wear_read_time_us;
+static uint64_t wear_write_time_us;
+static uint64_t wear_erase_time_us;
+static uint32_t wear_read_calls;
+static uint32_t wear_write_calls;
+static uint32_t wear_erase_calls;
+static struct k_spinlock wear_lock;
+
+static void wear_add_time(uint64_t *total, uint32_t us)
+{
+	k_spinlock_key_t key = k_spin_lock(&wear_lock);
+
+	*total += us;
+	k_spin_unlock(&wear_lock, key);
+}
+
+static void wear_add_call(uint32_t *calls)
+{
+	k_spinlock_key_t key = k_spin_lock(&wear_lock);
+
+	(*calls)++;
+	k_spin_unlock(&wear_lock, key);
+}
+
+static void wear_add_erase(uint32_t unit)
+{
+	k_spinlock_key_t key = k_spin_lock(&wear_lock);
+
+	wear_erase_counts[unit]++;
+	k_spin_unlock(&wear_lock, key);
+}
+#endif /* CONFIG_FLASH_SIMULATOR_WEAR_STATS */
+
+#ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
+static uint32_t read_time_us(size_t len)
+{
+	uint64_t us = CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US;
+
+#if FLASH_SIMULATOR_READ_BANDWIDTH > 0
+	us += ceiling_fraction((uint64_t)len * USEC_PER_SEC,
+			       FLASH_SIMULATOR_READ_BANDWIDTH);
+#endif
+
+	return (uint32_t)MIN(us, UINT32_MAX);
+}
+
+static uint32_t write_time_us(off_t offset, size_t len)
+{
+	uint64_t us = CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US;
+
+	if (len > 0) {
+		off_t first = (offset - FLASH_SIMULATOR_BASE_OFFSET) /
+			      FLASH_SIMULATOR_PROG_PAGE_SIZE;
+		off_t last = (offset - FLASH_SIMULATOR_BASE_OFFSET + len - 1) /
+			     FLASH_SIMULATOR_PROG_PAGE_SIZE;
+
+		us += (uint64_t)(last - first + 1) *
+		      FLASH_SIMULATOR_PAGE_PROG_TIME_US;
+	}
+
+	return (uint32_t)MIN(us, UINT32_MAX);
+}
+
+static uint32_t erase_time_us(size_t units)
+{
+	uint64_t us = CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US +
+		      (uint64_t)units * FLASH_SIMULATOR_SECTOR_ERASE_TIME_US;
+
+	return (uint32_t)MIN(us, UINT32_MAX);
+}
+#endif /* CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING */
+
 static int flash_sim_read(const struct device *dev, const off_t offset,
 			  void *data,
 			  const size_t len)
@@ -190,14 +280,21 @@ static int flash_sim_read(const struct device *dev, const off_t offset,
 	}
 
 	FLASH_SIM_STATS_INC(flash_sim_stats, flash_read_calls);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_call(&wear_read_calls);
+#endif
 
 	memcpy(data, MOCK_FLASH(offset), len);
 	FLASH_SIM_STATS_INCN(flash_sim_stats, bytes_read, len);
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US);
-	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_read_time_us,
-		   CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US);
+	uint32_t us = read_time_us(len);
+
+	k_busy_wait(us);
+	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_read_time_us, us);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_time(&wear_read_time_us, us);
+#endif
 #endif
 
 	return 0;
@@ -219,6 +316,9 @@ static int flash_sim_write(const struct device *dev, const off_t offset,
 	}
 
 	FLASH_SIM_STATS_INC(flash_sim_stats, flash_write_calls);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_call(&wear_write_calls);
+#endif
 
 	/* check if any unit has been already programmed */
 	memset(buf, FLASH_SIMULATOR_ERASE_VALUE, sizeof(buf));
@@ -270,9 +370,13 @@ static int flash_sim_write(const struct device *dev, const off_t offset,
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
 	/* wait before returning */
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US);
-	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_write_time_us,
-		   CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US);
+	uint32_t us = write_time_us(offset, len);
+
+	k_busy_wait(us);
+	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_write_time_us, us);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_time(&wear_write_time_us, us);
+#endif
 #endif
 
 	return 0;
@@ -304,6 +408,9 @@ static int flash_sim_erase(const struct device *dev, const off_t offset,
 	}
 
 	FLASH_SIM_STATS_INC(flash_sim_stats, flash_erase_calls);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_call(&wear_erase_calls);
+#endif
 
 #ifdef CONFIG_FLASH_SIMULATOR_STATS
 	if ((flash_sim_thresholds.max_erase_calls != 0) &&
@@ -319,14 +426,21 @@ static int flash_sim_erase(const struct device *dev, const off_t offset,
 	/* erase as many units as necessary and increase their erase counter */
 	for (uint32_t i = 0; i < len / FLASH_SIMULATOR_ERASE_UNIT; i++) {
 		ERASE_CYCLES_INC(unit_start + i);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+		wear_add_erase(unit_start + i);
+#endif
 		unit_erase(unit_start + i);
 	}
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
 	/* wait before returning */
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US);
-	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_erase_time_us,
-		   CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US);
+	uint32_t us = erase_time_us(len / FLASH_SIMULATOR_ERASE_UNIT);
+
+	k_busy_wait(us);
+	FLASH_SIM_STATS_INCN(flash_sim_stats, flash_erase_time_us, us);
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	wear_add_time(&wear_erase_time_us, us);
+#endif
 #endif
 
 	return 0;
@@ -486,6 +600,79 @@ void *z_impl_flash_simulator_get_memory(const struct device *dev,
 	return mock_flash;
 }
 
+int z_impl_flash_simulator_wear_get(const struct device *dev,
+				    struct flash_simulator_wear *wear,
+				    uint32_t *erase_counts, size_t count)
+{
+	ARG_UNUSED(dev);
+
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	k_spinlock_key_t key = k_spin_lock(&wear_lock);
+	uint32_t erases;
+	int bucket;
+
+	(void)memset(wear, 0, sizeof(*wear));
+	wear->sector_count = FLASH_SIMULATOR_PAGE_COUNT;
+	wear->min_erases = UINT32_MAX;
+
+	for (uint32_t i = 0; i < FLASH_SIMULATOR_PAGE_COUNT; i++) {
+		erases = wear_erase_counts[i];
+
+		wear->min_erases = MIN(wear->min_erases, erases);
+		wear->max_erases = MAX(wear->max_erases, erases);
+		wear->total_erases += erases;
+
+		bucket = (erases == 0U) ? 0 : 32 - __builtin_clz(erases);
+		wear->histogram[MIN(bucket,
+				    FLASH_SIMULATOR_WEAR_BUCKETS - 1)]++;
+	}
+
+	wear->read_time_us = wear_read_time_us;
+	wear->write_time_us = wear_write_time_us;
+	wear->erase_time_us = wear_erase_time_us;
+	wear->read_calls = wear_read_calls;
+	wear->write_calls = wear_write_calls;
+	wear->erase_calls = wear_erase_calls;
+
+	count = MIN(count, FLASH_SIMULATOR_PAGE_COUNT);
+	if (erase_counts != NULL) {
+		memcpy(erase_counts, wear_erase_counts,
+		       count * sizeof(erase_counts[0]));
+	} else {
+		count = 0;
+	}
+
+	k_spin_unlock(&wear_lock, key);
+
+	return count;
+#else
+	ARG_UNUSED(wear);
+	ARG_UNUSED(erase_counts);
+	ARG_UNUSED(count);
+
+	return -ENOTSUP;
+#endif /* CONFIG_FLASH_SIMULATOR_WEAR_STATS */
+}
+
+void z_impl_flash_simulator_wear_reset(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+#ifdef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	k_spinlock_key_t key = k_spin_lock(&wear_lock);
+
+	(void)memset(wear_erase_counts, 0, sizeof(wear_erase_counts));
+	wear_read_time_us = 0U;
+	wear_write_time_us = 0U;
+	wear_erase_time_us = 0U;
+	wear_read_calls = 0U;
+	wear_write_calls = 0U;
+	wear_erase_calls = 0U;
+
+	k_spin_unlock(&wear_lock, key);
+#endif
+}
+
 #ifdef CONFIG_USERSPACE
 
 #include <syscall_handler.h>
@@ -500,4 +687,30 @@ void *z_vrfy_flash_simulator_get_memory(const struct device *dev,
 
 #include <syscalls/flash_simulator_get_memory_mrsh.c>
 
+int z_vrfy_flash_simulator_wear_get(const struct device *dev,
+				    struct flash_simulator_wear *wear,
+				    uint32_t *erase_counts, size_t count)
+{
+	Z_OOPS(Z_SYSCALL_SPECIFIC_DRIVER(dev, K_OBJ_DRIVER_FLASH, &flash_sim_api));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(wear, sizeof(*wear)));
+	if (erase_counts != NULL) {
+		Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(erase_counts, count,
+						    sizeof(uint32_t)));
+	}
+
+	return z_impl_flash_simulator_wear_get(dev, wear, erase_counts,
+					       count);
+}
+
+#include <syscalls/flash_simulator_wear_get_mrsh.c>
+
+void z_vrfy_flash_simulator_wear_reset(const struct device *dev)
+{
+	Z_OOPS(Z_SYSCALL_SPECIFIC_DRIVER(dev, K_OBJ_DRIVER_FLASH, &flash_sim_api));
+
+	z_impl_flash_simulator_wear_reset(dev);
+}
+
+#include <syscalls/flash_simulator_wear_reset_mrsh.c>
+
 #endif /* CONFIG_USERSPACE */
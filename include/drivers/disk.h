@@ -61,6 +61,7 @@ extern "C" {
 #define DISK_STATUS_WR_PROTECT		0x04
 
 struct disk_operations;
+struct disk_cache;
 
 /**
  * @brief Disk info
@@ -74,6 +75,10 @@ struct disk_info {
 	const struct disk_operations *ops;
 	/** Device associated to this disk */
 	const struct device *dev;
+#if defined(CONFIG_DISK_CACHE) || defined(__DOXYGEN__)
+	/** Sector cache attached to this disk, if any */
+	struct disk_cache *cache;
+#endif
 };
 
 /**
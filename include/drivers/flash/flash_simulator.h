@@ -6,6 +6,9 @@
 #ifndef __ZEPHYR_INCLUDE_DRIVERS__FLASH_SIMULATOR_H__
 #define __ZEPHYR_INCLUDE_DRIVERS__FLASH_SIMULATOR_H__
 
+#include <zephyr/types.h>
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +33,69 @@ extern "C" {
  */
 __syscall void *flash_simulator_get_memory(const struct device *dev,
 					   size_t *mock_size);
+
+/** Number of buckets of the erase count histogram */
+#define FLASH_SIMULATOR_WEAR_BUCKETS 16
+
+/**
+ * @brief Flash simulator wear, operation and busy time statistics
+ *
+ * Bucket 0 of the histogram counts erase blocks which were not erased,
+ * bucket n > 0 those erased from 2^(n-1) to 2^n - 1 times, and the last
+ * bucket also all erase blocks erased more often.
+ */
+struct flash_simulator_wear {
+	/** Number of erase blocks of the simulated flash */
+	uint32_t sector_count;
+	/** Lowest erase count of an erase block */
+	uint32_t min_erases;
+	/** Highest erase count of an erase block */
+	uint32_t max_erases;
+	/** Number of erase blocks by erase count */
+	uint32_t histogram[FLASH_SIMULATOR_WEAR_BUCKETS];
+	/** Erases of all erase blocks */
+	uint64_t total_erases;
+	/** Number of read calls */
+	uint32_t read_calls;
+	/** Number of write calls */
+	uint32_t write_calls;
+	/** Number of erase calls */
+	uint32_t erase_calls;
+	/** Simulated busy time of reads in microseconds */
+	uint64_t read_time_us;
+	/** Simulated busy time of writes in microseconds */
+	uint64_t write_time_us;
+	/** Simulated busy time of erases in microseconds */
+	uint64_t erase_time_us;
+};
+
+/**
+ * @brief Take a snapshot of the wear statistics of the simulator
+ *
+ * Requires @kconfig{CONFIG_FLASH_SIMULATOR_WEAR_STATS}.  Busy times are
+ * only counted with @kconfig{CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING}.
+ *
+ * @param[in]  dev flash simulator device pointer.
+ * @param[out] wear statistics since start up or the last reset.
+ * @param[out] erase_counts array receiving the erase count of every erase
+ *	       block, in order, or NULL.
+ * @param[in]  count number of elements of @p erase_counts.
+ *
+ * @retval >=0 number of erase counts stored in @p erase_counts;
+ * @retval -ENOTSUP when the statistics are not enabled.
+ */
+__syscall int flash_simulator_wear_get(const struct device *dev,
+				       struct flash_simulator_wear *wear,
+				       uint32_t *erase_counts, size_t count);
+
+/**
+ * @brief Clear the wear statistics of the simulator
+ *
+ * Sets all erase counts, operation counts and busy times to zero.
+ *
+ * @param[in] dev flash simulator device pointer.
+ */
+__syscall void flash_simulator_wear_reset(const struct device *dev);
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,9 @@ extern "C" {
 
 #define FCB_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /**< Max length of element */
 
+/** Number of words in a bitmap with a bit for every possible sector */
+#define FCB_SECTOR_BITMAP_WORDS	((UINT8_MAX + 1) / 32)
+
 /**
  * @brief FCB entry info structure. This data structure describes the element
  * location in the flash.
@@ -129,6 +132,14 @@ struct fcb {
 	/**< The value flash takes when it is erased. This is read from
 	 * flash parameters and initialized upon call to fcb_init.
 	 */
+
+#if defined(CONFIG_FCB_SECTOR_SUMMARY) || defined(__DOXYGEN__)
+	uint32_t f_sum_checked[FCB_SECTOR_BITMAP_WORDS];
+	/**< Sectors whose summary has been looked at, internal state */
+
+	uint32_t f_sum_valid[FCB_SECTOR_BITMAP_WORDS];
+	/**< Sectors with a summary matching their contents, internal state */
+#endif
 };
 
 /**
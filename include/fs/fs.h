@@ -13,6 +13,10 @@
 #include <sys/dlist.h>
 #include <fs/fs_interface.h>
 
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+#include <kernel.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -87,6 +91,8 @@ enum {
  * @param mountp_len Length of Mount point string
  * @param fs Pointer to File system interface of the mount point
  * @param flags Mount flags
+ * @param async_wq Work queue running asynchronous requests of the mount,
+ *	  or NULL for the common file system work queue
  */
 struct fs_mount_t {
 	sys_dnode_t node;
@@ -94,10 +100,19 @@ struct fs_mount_t {
 	const char *mnt_point;
 	void *fs_data;
 	void *storage_dev;
+#if defined(CONFIG_FILE_SYSTEM_ASYNC) || defined(__DOXYGEN__)
+	struct k_work_q *async_wq;
+#endif
 	/* fields filled by file system core */
 	size_t mountp_len;
 	const struct fs_file_system_t *fs;
 	uint8_t flags;
+#if defined(CONFIG_FILE_SYSTEM_ASYNC) || defined(__DOXYGEN__)
+	sys_slist_t async_queue;
+	struct k_spinlock async_lock;
+	struct k_work async_work;
+	bool async_closed;
+#endif
 };
 
 /**
@@ -136,6 +151,17 @@ struct fs_statvfs {
 	unsigned long f_bfree;
 };
 
+/**
+ * @brief Structure describing one buffer of a vectored read or write
+ *
+ * @param base Pointer to the buffer
+ * @param len Length of the buffer in bytes
+ */
+struct fs_iovec {
+	void *base;
+	size_t len;
+};
+
 
 /**
  * @name fs_open open and creation mode flags
@@ -368,6 +394,55 @@ ssize_t fs_read(struct fs_file_t *zfp, void *ptr, size_t size);
  */
 ssize_t fs_write(struct fs_file_t *zfp, const void *ptr, size_t size);
 
+/**
+ * @brief Read file into several buffers
+ *
+ * Reads data from the file to the buffers described by @p iov, filling each
+ * of them in turn, as one call of fs_read() would to a buffer made of all of
+ * them.  A returned value may be lower than the total length of the buffers
+ * if there were fewer bytes available than requested.
+ *
+ * File systems which do not provide a vectored read use fs_read() once
+ * for each buffer.
+ *
+ * @param zfp Pointer to the file object
+ * @param iov Array of buffer descriptors
+ * @param iovcnt Number of elements in @p iov
+ *
+ * @retval >=0 a number of bytes read, on success;
+ * @retval -EBADF when invoked on zfp that represents unopened/closed file;
+ * @retval -EINVAL when @p iovcnt is negative;
+ * @retval -ENOTSUP when not implemented by underlying file system driver;
+ * @retval <0 a negative errno code on error.
+ */
+ssize_t fs_readv(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		 int iovcnt);
+
+/**
+ * @brief Write file from several buffers
+ *
+ * Writes the data of the buffers described by @p iov to the file, in
+ * order, as one call of fs_write() would from a buffer made of all of them.
+ * Data gathered this way does not have to be copied into one buffer first.
+ * If an error occurs after some data has been written, the number of bytes
+ * written is returned.
+ *
+ * File systems which do not provide a vectored write use fs_write() once
+ * for each buffer.
+ *
+ * @param zfp Pointer to the file object
+ * @param iov Array of buffer descriptors
+ * @param iovcnt Number of elements in @p iov
+ *
+ * @retval >=0 a number of bytes written, on success;
+ * @retval -EBADF when invoked on zfp that represents unopened/closed file;
+ * @retval -EINVAL when @p iovcnt is negative;
+ * @retval -ENOTSUP when not implemented by underlying file system driver;
+ * @retval <0 an other negative errno code on error.
+ */
+ssize_t fs_writev(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		  int iovcnt);
+
 /**
  * @brief Seek file
  *
@@ -545,11 +620,18 @@ int fs_mount(struct fs_mount_t *mp);
  * calling the file system specific unmount function and removing
  * the mount point from mounted file system list.
  *
+ * With @kconfig{CONFIG_FILE_SYSTEM_ASYNC}, asynchronous requests already
+ * submitted on the mount point complete first, and new ones are rejected.
+ * Completion callbacks of asynchronous requests must therefore not unmount
+ * their own mount point.
+ *
  * @param mp Pointer to the fs_mount_t structure
  *
  * @retval 0 on success;
  * @retval -EINVAL if no system has been mounted at given mount point;
  * @retval -ENOTSUP when not supported by underlying file system driver;
+ * @retval -EDEADLK when called from a thread of the work queue running
+ *	   asynchronous requests of the mount point, including its workers;
  * @retval <0 an other negative errno code on error.
  */
 int fs_unmount(struct fs_mount_t *mp);
@@ -635,6 +717,80 @@ int fs_register(int type, const struct fs_file_system_t *fs);
  */
 int fs_unregister(int type, const struct fs_file_system_t *fs);
 
+#if defined(CONFIG_FILE_SYSTEM_ASYNC) || defined(__DOXYGEN__)
+
+/** @brief Operations of asynchronous file system requests */
+enum fs_async_op {
+	/** Read with fs_readv() */
+	FS_ASYNC_READ = 0,
+	/** Write with fs_writev() */
+	FS_ASYNC_WRITE,
+	/** Flush with fs_sync() */
+	FS_ASYNC_SYNC,
+};
+
+struct fs_async_req;
+
+/**
+ * @brief Completion callback of an asynchronous file system request
+ *
+ * Called from the work queue running requests of the mount point.
+ *
+ * @param req The completed request
+ * @param result Value returned by the operation
+ */
+typedef void (*fs_async_cb_t)(struct fs_async_req *req, ssize_t result);
+
+/**
+ * @brief Asynchronous file system request
+ *
+ * @param node Entry in the request queue of the mount point
+ * @param zfp Pointer to the file object
+ * @param op Operation to perform
+ * @param iov Buffers to read to or write from; unused for FS_ASYNC_SYNC
+ * @param iovcnt Number of elements in @p iov
+ * @param cb Callback called on completion, or NULL
+ * @param signal Poll signal raised with the result on completion, or NULL
+ * @param result Result of the operation, -EINPROGRESS until completion
+ */
+struct fs_async_req {
+	sys_snode_t node;
+	struct fs_file_t *zfp;
+	enum fs_async_op op;
+	const struct fs_iovec *iov;
+	int iovcnt;
+	fs_async_cb_t cb;
+#if defined(CONFIG_POLL) || defined(__DOXYGEN__)
+	struct k_poll_signal *signal;
+#endif
+	ssize_t result;
+};
+
+/**
+ * @brief Submit an asynchronous file system request
+ *
+ * Queues the request on the mount point of its file.  Requests of one
+ * mount point are run in order of submission by the work queue of the mount
+ * point, so that a caller does not wait for the storage device.  On
+ * completion the result is stored in the request, the callback is called
+ * and the poll signal is raised, if given; after that the request may be
+ * used again.
+ *
+ * The request, the buffers and the file object must stay valid until the
+ * request completes, and the file must not be closed before that.
+ *
+ * @param req Request to submit
+ *
+ * @retval 0 on success;
+ * @retval -EBADF when invoked on a file that is not open;
+ * @retval -EINVAL when the request is not valid;
+ * @retval -EBUSY when the mount point of the file is being unmounted;
+ * @retval <0 an other negative errno code on error.
+ */
+int fs_async_submit(struct fs_async_req *req);
+
+#endif /* CONFIG_FILE_SYSTEM_ASYNC */
+
 /**
  * @}
  */
@@ -17,6 +17,8 @@
 extern "C" {
 #endif
 
+struct littlefs_shared_cache;
+
 /** @brief Filesystem info structure for LittleFS mount */
 struct fs_littlefs {
 	/* Defaulted in driver, customizable before mount. */
@@ -33,10 +35,21 @@ struct fs_littlefs {
 	 */
 	uint32_t *lookahead_buffer[CONFIG_FS_LITTLEFS_LOOKAHEAD_SIZE / sizeof(uint32_t)];
 
+#if defined(CONFIG_FS_LITTLEFS_SHARED_CACHE) || defined(__DOXYGEN__)
+	/* Size of the shared read cache of the mount in bytes, or 0 for
+	 * @kconfig{CONFIG_FS_LITTLEFS_SHARED_CACHE_SIZE}.  Rounded down to a
+	 * multiple of cfg.cache_size.
+	 */
+	lfs_size_t shared_cache_size;
+#endif
+
 	/* These structures are filled automatically at mount. */
 	struct lfs lfs;
 	void *backend;
 	struct k_mutex mutex;
+#if defined(CONFIG_FS_LITTLEFS_SHARED_CACHE) || defined(__DOXYGEN__)
+	struct littlefs_shared_cache *shared_cache;
+#endif
 };
 
 /** @brief Define a littlefs configuration with customized size
@@ -60,6 +73,10 @@ struct fs_littlefs {
  * must also select @kconfig{CONFIG_FS_LITTLEFS_FC_HEAP_SIZE} to relax
  * the size constraints on per-file cache allocations.
  *
+ * Options without a parameter here, like ``cfg.block_cycles`` and
+ * ``cfg.metadata_max``, can be set in the defined object before it is
+ * mounted; left at zero they take the Kconfig defaults.
+ *
  * @param name the name for the structure.  The defined object has
  * file scope.
  * @param read_sz see @kconfig{CONFIG_FS_LITTLEFS_READ_SIZE}
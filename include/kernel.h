@@ -1364,6 +1364,29 @@ extern void k_timer_init(struct k_timer *timer,
 __syscall void k_timer_start(struct k_timer *timer,
 			     k_timeout_t duration, k_timeout_t period);
 
+/**
+ * @brief Start a timer with a slack.
+ *
+ * This routine behaves like k_timer_start(), but allows each expiry of
+ * the timer to be deferred by up to @a slack, so that it can be served
+ * by the same timer interrupt as other timeouts expiring in that window.
+ * Periodic timers do not drift: every period is still counted from the
+ * nominal expiry. Use this for timers which do not need to be precise,
+ * such as polling or keepalive timers, to reduce the number of wakeups
+ * from idle.
+ *
+ * Without @kconfig{CONFIG_TIMEOUT_SLACK} the slack is ignored and the
+ * timer behaves exactly as if started with k_timer_start().
+ *
+ * @param timer     Address of timer.
+ * @param duration  Initial timer duration.
+ * @param period    Timer period.
+ * @param slack     Maximum deferral of each expiry, as a relative timeout.
+ */
+__syscall void k_timer_start_slack(struct k_timer *timer,
+				   k_timeout_t duration, k_timeout_t period,
+				   k_timeout_t slack);
+
 /**
  * @brief Stop a timer.
  *
@@ -2608,6 +2631,7 @@ __syscall int k_stack_pop(struct k_stack *stack, stack_data_t *data,
 
 struct k_work;
 struct k_work_q;
+struct k_work_q_worker;
 struct k_work_queue_config;
 struct k_delayed_work;
 extern struct k_work_q k_sys_work_q;
@@ -3059,6 +3083,39 @@ int k_work_submit_to_queue(struct k_work_q *queue,
  */
 extern int k_work_submit(struct k_work *work);
 
+/** @brief Submit several work items to a queue.
+ *
+ * This is equivalent to invoking k_work_submit_to_queue() on each item in
+ * turn, but the work module lock is taken only once and the caller yields
+ * at most once, after all the items have been submitted.
+ *
+ * Submission stops at the first item that is rejected.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param queue pointer to the work queue on which the items should run.  If
+ * NULL the queue from the most recent submission of each item will be used.
+ * @param works array of pointers to the work items.
+ * @param count number of work items in @p works.
+ *
+ * @return the number of items that were submitted, or were already queued,
+ * if at least one was; otherwise the error that
+ * k_work_submit_to_queue() returned for the first item.
+ */
+int k_work_submit_to_queue_batch(struct k_work_q *queue,
+				 struct k_work *const works[], size_t count);
+
+/** @brief Submit several work items to the system queue.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param works array of pointers to the work items.
+ * @param count number of work items in @p works.
+ *
+ * @return as with k_work_submit_to_queue_batch().
+ */
+int k_work_submit_batch(struct k_work *const works[], size_t count);
+
 /** @brief Wait for last-submitted instance to complete.
  *
  * Resubmissions may occur while waiting, including chained submissions (from
@@ -3173,6 +3230,37 @@ void k_work_queue_start(struct k_work_q *queue,
 			k_thread_stack_t *stack, size_t stack_size,
 			int prio, const struct k_work_queue_config *cfg);
 
+/** @brief Add a worker thread to a work queue.
+ *
+ * Start an additional thread which processes the items submitted to
+ * @p queue, at the priority of the work queue thread, so that several
+ * items of the queue can run concurrently on SMP systems.  A work item
+ * never runs on two threads at the same time: an item resubmitted while
+ * it is running is not picked up by another worker before it completes.
+ * Items that rely on running one after the other must not be submitted to
+ * a queue with workers.
+ *
+ * Workers cannot be removed from a queue.
+ *
+ * @note Requires @kconfig{CONFIG_WORKQUEUE_WORKERS}.
+ *
+ * @param queue pointer to a started work queue.
+ * @param worker pointer to the uninitialized worker structure.
+ * @param stack pointer to the worker thread stack area.
+ * @param stack_size size of the worker thread stack area, in bytes.
+ * @param cpu CPU the worker thread is pinned to, or -1 to let it run on
+ * any CPU.  Pinning requires @kconfig{CONFIG_SCHED_CPU_MASK}.
+ *
+ * @retval 0 if the worker was started.
+ * @retval -ENODEV if @p queue has not been started.
+ * @retval -EINVAL if @p cpu is not a valid CPU.
+ * @retval -ENOTSUP if @p cpu is given but pinning is not supported.
+ */
+int k_work_queue_add_worker(struct k_work_q *queue,
+			    struct k_work_q_worker *worker,
+			    k_thread_stack_t *stack, size_t stack_size,
+			    int cpu);
+
 /** @brief Access the thread that animates a work queue.
  *
  * This is necessary to grant a work queue thread access to things the work
@@ -3184,6 +3272,19 @@ void k_work_queue_start(struct k_work_q *queue,
  */
 static inline k_tid_t k_work_queue_thread_get(struct k_work_q *queue);
 
+/** @brief Check whether the calling thread runs the items of a work queue.
+ *
+ * This is the thread of the queue or, with
+ * @kconfig{CONFIG_WORKQUEUE_WORKERS}, any worker added to it.  Such a thread
+ * must not wait for items of the queue to complete.
+ *
+ * @param queue pointer to the queue structure.
+ *
+ * @retval true if the calling thread is a thread of @p queue.
+ * @retval false otherwise.
+ */
+bool k_work_queue_is_worker(struct k_work_q *queue);
+
 /** @brief Wait until the work queue has drained, optionally plugging it.
  *
  * This blocks submission to the work queue except when coming from queue
@@ -3649,6 +3750,12 @@ struct k_work_delayable {
 struct z_work_flusher {
 	struct k_work work;
 	struct k_sem sem;
+#ifdef CONFIG_WORKQUEUE_WORKERS
+	/* The item being flushed: with several workers the flusher must
+	 * not run before it completes.
+	 */
+	struct k_work *target;
+#endif
 };
 
 /* Record used to wait for work to complete a cancellation.
@@ -3715,6 +3822,18 @@ struct k_work_queue_config {
 	bool no_yield;
 };
 
+/** @brief An additional thread processing the work of a queue.
+ *
+ * @see k_work_queue_add_worker()
+ */
+struct k_work_q_worker {
+	/* The worker thread. */
+	struct k_thread thread;
+
+	/* Link in the list of workers of the queue. */
+	sys_snode_t node;
+};
+
 /** @brief A structure used to hold work until it can be processed. */
 struct k_work_q {
 	/* The thread that animates the work. */
@@ -3735,6 +3854,14 @@ struct k_work_q {
 
 	/* Flags describing queue state. */
 	uint32_t flags;
+
+#ifdef CONFIG_WORKQUEUE_WORKERS
+	/* Additional threads processing the pending items. */
+	sys_slist_t workers;
+
+	/* Number of items being run by the queue threads. */
+	uint16_t running;
+#endif
 };
 
 /* Provide the implementation for inline functions declared above */
@@ -4251,6 +4378,10 @@ struct k_msgq {
 	char *write_ptr;
 	/** Number of used messages */
 	uint32_t used_msgs;
+	/** Number of slots reserved by k_msgq_alloc_put_batch() */
+	uint32_t reserved_msgs;
+	/** Number of messages claimed by k_msgq_peek_claim_batch() */
+	uint32_t claimed_msgs;
 
 	_POLL_EVENT;
 
@@ -4274,6 +4405,8 @@ struct k_msgq {
 	.read_ptr = q_buffer, \
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
+	.reserved_msgs = 0, \
+	.claimed_msgs = 0, \
 	_POLL_EVENT_OBJ_INIT(obj) \
 	}
 
@@ -4397,6 +4530,7 @@ int k_msgq_cleanup(struct k_msgq *msgq);
  * @retval 0 Message sent.
  * @retval -ENOMSG Returned without waiting or queue purged.
  * @retval -EAGAIN Waiting period timed out.
+ * @retval -EBUSY Slots are reserved with k_msgq_alloc_put().
  */
 __syscall int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout);
 
@@ -4419,6 +4553,7 @@ __syscall int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t time
  * @retval 0 Message received.
  * @retval -ENOMSG Returned without waiting.
  * @retval -EAGAIN Waiting period timed out.
+ * @retval -EBUSY Messages are claimed with k_msgq_peek_claim().
  */
 __syscall int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout);
 
@@ -4445,10 +4580,145 @@ __syscall int k_msgq_peek(struct k_msgq *msgq, void *data);
  * buffer. Any threads that are blocked waiting to send a message to the
  * message queue are unblocked and see an -ENOMSG error code.
  *
+ * Messages claimed with k_msgq_peek_claim() are discarded as well and must
+ * not be accessed anymore. Reserved slots are kept.
+ *
  * @param msgq Address of the message queue.
  */
 __syscall void k_msgq_purge(struct k_msgq *msgq);
 
+/**
+ * @brief Reserve ring buffer slots for messages.
+ *
+ * This routine reserves up to @a num free slots in the ring buffer of
+ * @a msgq and stores their addresses in @a slots, so that the messages can
+ * be written in place instead of being copied by k_msgq_put(). The slots
+ * are only visible to receivers once k_msgq_commit() is called, which
+ * sends all the reserved messages at once.
+ *
+ * Only one reservation can be outstanding at a time. Until it is committed,
+ * other senders get -EBUSY instead of waiting, so this is intended for
+ * queues with a single sender.
+ *
+ * @note The slots are in the message queue's ring buffer, this routine
+ * cannot be used from user mode.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ * @param slots Array where the addresses of the reserved slots are stored.
+ * @param num Maximum number of slots to reserve.
+ *
+ * @return Number of slots reserved (at least one) on success.
+ * @retval -ENOMSG The queue is full.
+ * @retval -EBUSY Slots are already reserved.
+ * @retval -EINVAL @a num is zero.
+ */
+int k_msgq_alloc_put_batch(struct k_msgq *msgq, void **slots, uint32_t num);
+
+/**
+ * @brief Reserve a ring buffer slot for a message.
+ *
+ * Same as k_msgq_alloc_put_batch() for a single message.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ * @param slot Address where the address of the reserved slot is stored.
+ *
+ * @retval 0 Slot reserved.
+ * @retval -ENOMSG The queue is full.
+ * @retval -EBUSY Slots are already reserved.
+ */
+static inline int k_msgq_alloc_put(struct k_msgq *msgq, void **slot)
+{
+	int ret = k_msgq_alloc_put_batch(msgq, slot, 1);
+
+	return ret < 0 ? ret : 0;
+}
+
+/**
+ * @brief Send the messages written to reserved slots.
+ *
+ * This routine sends all the messages reserved with k_msgq_alloc_put() or
+ * k_msgq_alloc_put_batch(), in the order of their slots. Threads waiting
+ * to receive a message are woken up.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ *
+ * @retval 0 Messages sent.
+ * @retval -EINVAL No slots are reserved.
+ */
+int k_msgq_commit(struct k_msgq *msgq);
+
+/**
+ * @brief Claim messages in place.
+ *
+ * This routine claims up to @a num of the oldest messages in @a msgq and
+ * stores their addresses in @a slots, so that they can be read in place
+ * instead of being copied by k_msgq_get(). The slots stay allocated until
+ * k_msgq_release() is called, which removes all the claimed messages from
+ * the queue at once.
+ *
+ * Only one claim can be outstanding at a time. Until the messages are
+ * released, other receivers get -EBUSY instead of waiting, so this is
+ * intended for queues with a single receiver.
+ *
+ * @note The slots are in the message queue's ring buffer, this routine
+ * cannot be used from user mode.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ * @param slots Array where the addresses of the claimed messages are stored.
+ * @param num Maximum number of messages to claim.
+ *
+ * @return Number of messages claimed (at least one) on success.
+ * @retval -ENOMSG The queue is empty.
+ * @retval -EBUSY Messages are already claimed.
+ * @retval -EINVAL @a num is zero.
+ */
+int k_msgq_peek_claim_batch(struct k_msgq *msgq, void **slots, uint32_t num);
+
+/**
+ * @brief Claim a message in place.
+ *
+ * Same as k_msgq_peek_claim_batch() for a single message.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ * @param slot Address where the address of the claimed message is stored.
+ *
+ * @retval 0 Message claimed.
+ * @retval -ENOMSG The queue is empty.
+ * @retval -EBUSY Messages are already claimed.
+ */
+static inline int k_msgq_peek_claim(struct k_msgq *msgq, void **slot)
+{
+	int ret = k_msgq_peek_claim_batch(msgq, slot, 1);
+
+	return ret < 0 ? ret : 0;
+}
+
+/**
+ * @brief Release claimed messages.
+ *
+ * This routine removes all the messages claimed with k_msgq_peek_claim()
+ * or k_msgq_peek_claim_batch() from @a msgq. Threads waiting to send a
+ * message are woken up.
+ *
+ * @funcprops \isr_ok
+ *
+ * @param msgq Address of the message queue.
+ *
+ * @retval 0 Messages released.
+ * @retval -EINVAL No messages are claimed.
+ */
+int k_msgq_release(struct k_msgq *msgq);
+
 /**
  * @brief Get the amount of free space in a message queue.
  *
@@ -4475,7 +4745,7 @@ __syscall void  k_msgq_get_attrs(struct k_msgq *msgq,
 
 static inline uint32_t z_impl_k_msgq_num_free_get(struct k_msgq *msgq)
 {
-	return msgq->max_msgs - msgq->used_msgs;
+	return msgq->max_msgs - msgq->used_msgs - msgq->reserved_msgs;
 }
 
 /**
@@ -4865,6 +5135,15 @@ __syscall void k_pipe_buffer_flush(struct k_pipe *pipe);
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+/* Free blocks kept aside for one CPU */
+struct z_mem_slab_cache {
+	struct k_spinlock lock;
+	char *free_list;
+	uint32_t count;
+};
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
 	struct k_spinlock lock;
@@ -4872,9 +5151,19 @@ struct k_mem_slab {
 	size_t block_size;
 	char *buffer;
 	char *free_list;
+	/* Blocks not on free_list, including the ones in the CPU caches */
 	uint32_t num_used;
 #ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
 	uint32_t max_used;
+#endif
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+	struct z_mem_slab_cache cache[CONFIG_MP_NUM_CPUS];
+	/* Set while threads wait for a block, frees skip the caches then */
+	bool cache_bypass;
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	atomic_t cache_num_used;
+	atomic_t cache_max_used;
+#endif
 #endif
 
 	SYS_PORT_TRACING_TRACKING_FIELD(k_mem_slab)
@@ -5028,7 +5317,17 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline uint32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+	uint32_t num_used = slab->num_used;
+
+	for (unsigned int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		num_used -= slab->cache[i].count;
+	}
+
+	return num_used;
+#else
 	return slab->num_used;
+#endif
 }
 
 /**
@@ -5043,7 +5342,10 @@ static inline uint32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline uint32_t k_mem_slab_max_used_get(struct k_mem_slab *slab)
 {
-#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+#if defined(CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION) && \
+	defined(CONFIG_MEM_SLAB_PER_CPU_CACHE)
+	return atomic_get(&slab->cache_max_used);
+#elif defined(CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION)
 	return slab->max_used;
 #else
 	ARG_UNUSED(slab);
@@ -5063,7 +5365,7 @@ static inline uint32_t k_mem_slab_max_used_get(struct k_mem_slab *slab)
  */
 static inline uint32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
 /** @} */
@@ -159,6 +159,24 @@ struct _mem_domain_info {
 	struct k_mem_domain *mem_domain;
 };
 
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+struct z_object;
+
+/* Kernel objects recently validated in system calls made by a thread */
+struct _obj_validation_cache {
+	struct {
+		/** Kernel object address passed to the system call */
+		const void *obj;
+		/** Its metadata, found to grant access to the thread */
+		struct z_object *ko;
+	} entries[CONFIG_OBJ_VALIDATION_CACHE_SIZE];
+	/** Permission generation the entries are valid for */
+	uint32_t gen;
+	/** Entry to replace next */
+	uint8_t next;
+};
+#endif /* CONFIG_OBJ_VALIDATION_CACHE */
+
 #endif /* CONFIG_USERSPACE */
 
 #ifdef CONFIG_THREAD_USERSPACE_LOCAL_DATA
@@ -278,6 +296,10 @@ struct k_thread {
 	k_thread_stack_t *stack_obj;
 	/** current syscall frame pointer */
 	void *syscall_frame;
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+	/** kernel objects recently validated in system calls */
+	struct _obj_validation_cache obj_cache;
+#endif
 #endif /* CONFIG_USERSPACE */
 
 
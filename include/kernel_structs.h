@@ -241,6 +241,10 @@ struct _timeout {
 #else
 	int32_t dticks;
 #endif
+#ifdef CONFIG_TIMEOUT_SLACK
+	/* Ticks by which the expiry may be deferred to share a wakeup */
+	uint32_t slack;
+#endif
 };
 
 #ifdef __cplusplus
@@ -168,6 +168,9 @@ enum ethernet_hw_caps {
 
 	/** TXTIME supported */
 	ETHERNET_TXTIME			= BIT(19),
+
+	/** TCP segmentation offload (TSO) supported */
+	ETHERNET_HW_TCP_SEG_OFFLOAD	= BIT(20),
 };
 
 /** @cond INTERNAL_HIDDEN */
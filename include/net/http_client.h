@@ -62,6 +62,28 @@ typedef int (*http_payload_cb_t)(int sock,
 				 struct http_request *req,
 				 void *user_data);
 
+/**
+ * @typedef http_payload_chunk_cb_t
+ * @brief Callback used to produce the request body one chunk at a time.
+ *
+ * The HTTP client sends each chunk using chunked transfer coding, so the
+ * total length of the body does not need to be known in advance. The
+ * chunk data must stay valid until the callback is called again.
+ *
+ * @param req HTTP request information
+ * @param chunk Set by the callback to point to the next chunk of data.
+ * @param user_data User specified data specified in http_client_req()
+ *
+ * @return >0 length of the chunk, in this case the callback is called again
+ *             after the chunk has been sent,
+ *         0   if there is no more data to send,
+ *         <0  if http_client_req() should return the error code to the
+ *             caller.
+ */
+typedef int (*http_payload_chunk_cb_t)(struct http_request *req,
+				       const uint8_t **chunk,
+				       void *user_data);
+
 /**
  * @typedef http_header_cb_t
  * @brief Callback can be used if application wants to construct additional
@@ -154,6 +176,11 @@ struct http_response {
 	uint8_t cl_present : 1;
 	uint8_t body_found : 1;
 	uint8_t message_complete : 1;
+
+	/** Set when the response is complete and the server allows the
+	 * connection to be used for further requests.
+	 */
+	uint8_t keep_alive : 1;
 };
 
 /** HTTP client internal data that the application should not touch
@@ -244,6 +271,13 @@ struct http_request {
 	 */
 	http_payload_cb_t payload_cb;
 
+	/** User supplied callback function to call when the next chunk of
+	 * the payload needs to be sent. If set, the request body is sent
+	 * using chunked transfer coding and the payload, payload_len and
+	 * payload_cb fields are ignored.
+	 */
+	http_payload_chunk_cb_t payload_chunk_cb;
+
 	/** Payload, may be NULL */
 	const char *payload;
 
@@ -276,7 +310,9 @@ struct http_request {
  * @brief Do a HTTP request. The callback is called when data is received
  * from the HTTP server. The caller must have created a connection to the
  * server before calling this function so connect() call must have be done
- * successfully for the socket.
+ * successfully for the socket. If the keep_alive flag of the response is set
+ * when the callback is called with HTTP_DATA_FINAL, the same connection can
+ * be used for the next request.
  *
  * @param sock Socket id of the connection.
  * @param req HTTP request information
@@ -290,6 +326,28 @@ struct http_request {
 int http_client_req(int sock, struct http_request *req,
 		    int32_t timeout, void *user_data);
 
+/**
+ * @brief Do several HTTP requests on one connection without waiting for
+ * the responses in between (HTTP/1.1 pipelining).
+ *
+ * All the requests are sent first, after which the responses are read in
+ * the same order. The response callback of each request is called like with
+ * http_client_req(). Only requests without a body using the GET, HEAD or
+ * OPTIONS methods can be pipelined. The server must support persistent
+ * connections, check the keep_alive flag of the last response before
+ * reusing the connection.
+ *
+ * @param sock Socket id of the connection.
+ * @param reqs Array of pointers to HTTP request information.
+ * @param count Number of requests in the array.
+ * @param timeout Max timeout to wait for each response, in milliseconds.
+ * @param user_data User specified data that is passed to the callbacks.
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ */
+int http_client_req_pipeline(int sock, struct http_request **reqs,
+			     size_t count, int32_t timeout, void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -444,6 +444,24 @@ struct mqtt_transport {
 #endif
 };
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/** @brief Outstanding QoS 1 or QoS 2 publish message. */
+struct mqtt_inflight_entry {
+	/** Internal. Copy of the publish parameters, used for retransmission.
+	 *  Topic and payload buffers are not copied.
+	 */
+	struct mqtt_publish_param param;
+
+	/** Internal. Wall clock value (in milliseconds) of the last
+	 *  transmission of the message.
+	 */
+	uint32_t timestamp;
+
+	/** Internal. Acknowledgment the message is waiting for. */
+	uint8_t state;
+};
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -462,6 +480,11 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	uint32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/** Internal. Publish messages awaiting acknowledgment. */
+	struct mqtt_inflight_entry inflight[CONFIG_MQTT_INFLIGHT_WINDOW];
+#endif /* CONFIG_MQTT_INFLIGHT */
 };
 
 /**
@@ -596,7 +619,14 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note With @kconfig{CONFIG_MQTT_INFLIGHT} enabled, QoS 1 and QoS 2 messages
+ *       are tracked until acknowledged by the broker. Topic and payload
+ *       buffers shall remain valid until the MQTT_EVT_PUBACK (QoS 1) or
+ *       MQTT_EVT_PUBCOMP (QoS 2) event for the message is notified.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ *         -EAGAIN if the in-flight window is full, -EBUSY if a message with
+ *         the same message id is already in flight.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
@@ -631,7 +661,9 @@ int mqtt_publish_qos2_receive(struct mqtt_client *client,
 
 /**
  * @brief API used by client to request release of QoS2 publish message.
- *        Should be called on reception of @ref MQTT_EVT_PUBREC.
+ *        Should be called on reception of @ref MQTT_EVT_PUBREC, unless
+ *        CONFIG_MQTT_INFLIGHT is enabled, in which case the library sends
+ *        PUBREL itself and this call does nothing for a tracked message.
  *
  * @param[in] client Client instance for which the procedure is requested.
  *                   Shall not be NULL.
@@ -727,6 +759,9 @@ int mqtt_abort(struct mqtt_client *client);
  *        makes it possible to respect the Keep Alive time agreed with the
  *        broker on connection. @ref mqtt_connect for details on Keep Alive
  *        time.
+ * @note  With @kconfig{CONFIG_MQTT_INFLIGHT} enabled, this function also
+ *        retransmits outstanding messages that were not acknowledged within
+ *        @kconfig{CONFIG_MQTT_INFLIGHT_RETRANSMIT_TIMEOUT}.
  *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
@@ -741,9 +776,25 @@ int mqtt_live(struct mqtt_client *client);
  * @return Time in milliseconds until next keep alive message is expected to
  *         be sent. Function will return -1 if keep alive messages are
  *         not enabled.
+ *
+ * @note With @kconfig{CONFIG_MQTT_INFLIGHT} enabled, the time until the next
+ *       retransmission of an outstanding message is taken into account.
  */
 int mqtt_keepalive_time_left(const struct mqtt_client *client);
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/**
+ * @brief Get the number of publish messages that can be sent before the
+ *        in-flight window is full.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ *
+ * @return Number of free entries in the in-flight window.
+ */
+int mqtt_inflight_window_free(const struct mqtt_client *client);
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 /**
  * @brief Receive an incoming MQTT packet. The registered callback will be
  *        called with the packet content.
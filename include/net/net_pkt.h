@@ -223,6 +223,21 @@ struct net_pkt {
 	uint16_t vlan_tci;
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	uint16_t ipv4_fragment_flags;	/* Fragment offset and MF (More Fragment) flag */
+	uint16_t ipv4_fragment_id;	/* Fragment id */
+	bool ipv4_reassembled;		/* Reassembled from fragments */
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+	/* Segment size of a TCP packet larger than the MTU. The packet
+	 * is split into segments of this size before it is given to a
+	 * driver that cannot segment it in hardware. Zero if the packet
+	 * is sent as is.
+	 */
+	uint16_t gso_size;
+#endif /* CONFIG_NET_TCP_GSO */
+
 #if defined(CONFIG_NET_IPV6)
 	/* Where is the start of the last header before payload data
 	 * in IPv6 packet. This is offset value from start of the IPv6
@@ -635,6 +650,107 @@ static inline uint16_t net_pkt_ip_opts_len(struct net_pkt *pkt)
 #endif
 }
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline uint16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	return (pkt->ipv4_fragment_flags & NET_IPV4_FRAGH_OFFSET_MASK) * 8U;
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	return (pkt->ipv4_fragment_flags & NET_IPV4_MORE_FRAG_MASK) != 0;
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_flags(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_flags;
+}
+
+static inline void net_pkt_set_ipv4_fragment_flags(struct net_pkt *pkt,
+						   uint16_t flags)
+{
+	pkt->ipv4_fragment_flags = flags;
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_id(struct net_pkt *pkt)
+{
+	return pkt->ipv4_fragment_id;
+}
+
+static inline void net_pkt_set_ipv4_fragment_id(struct net_pkt *pkt,
+						uint16_t id)
+{
+	pkt->ipv4_fragment_id = id;
+}
+
+static inline bool net_pkt_ipv4_reassembled(struct net_pkt *pkt)
+{
+	return pkt->ipv4_reassembled;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool reassembled)
+{
+	pkt->ipv4_reassembled = reassembled;
+}
+#else /* CONFIG_NET_IPV4_FRAGMENT */
+static inline uint16_t net_pkt_ipv4_fragment_offset(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline bool net_pkt_ipv4_fragment_more(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_flags(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_flags(struct net_pkt *pkt,
+						   uint16_t flags)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(flags);
+}
+
+static inline uint16_t net_pkt_ipv4_fragment_id(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_ipv4_fragment_id(struct net_pkt *pkt,
+						uint16_t id)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(id);
+}
+
+static inline bool net_pkt_ipv4_reassembled(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool reassembled)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(reassembled);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 static inline uint16_t net_pkt_ipv6_fragment_start(struct net_pkt *pkt)
 {
@@ -723,6 +839,31 @@ static inline void net_pkt_set_ipv6_fragment_id(struct net_pkt *pkt,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_TCP_GSO)
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	return pkt->gso_size;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt, uint16_t size)
+{
+	pkt->gso_size = size;
+}
+#else /* CONFIG_NET_TCP_GSO */
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt, uint16_t size)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(size);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 static inline uint8_t net_pkt_priority(struct net_pkt *pkt)
 {
 	return pkt->priority;
@@ -219,6 +219,26 @@ struct net_stats_ipv4_igmp {
 	net_stats_t drop;
 };
 
+/**
+ * @brief IPv4 fragmentation and reassembly statistics
+ */
+struct net_stats_ipv4_frag {
+	/** Number of received IPv4 fragments */
+	net_stats_t recv;
+
+	/** Number of sent IPv4 fragments */
+	net_stats_t sent;
+
+	/** Number of IPv4 packets reassembled from fragments */
+	net_stats_t reassembled;
+
+	/** Number of dropped IPv4 fragments */
+	net_stats_t drop;
+
+	/** Number of reassemblies cancelled because of a timeout */
+	net_stats_t timeout;
+};
+
 /**
  * @brief Network packet transfer times for calculating average TX time
  */
@@ -342,6 +362,11 @@ struct net_stats {
 	struct net_stats_ipv4_igmp ipv4_igmp;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	/** IPv4 fragmentation statistics */
+	struct net_stats_ipv4_frag ipv4_frag;
+#endif
+
 #if NET_TC_COUNT > 1
 	/** Traffic class statistics */
 	struct net_stats_tc tc;
@@ -151,11 +151,39 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		       enum websocket_opcode opcode, bool mask, bool final,
 		       int32_t timeout);
 
+/**
+ * @brief Send websocket msg to peer from a set of buffers.
+ *
+ * @details The function will automatically add websocket header to the
+ * message. The header and the payload buffers are sent with a single
+ * sendmsg() call, without copying the payload.
+ *
+ * @note If mask is true, the payload buffers are masked in place, so their
+ * content is modified by this call.
+ *
+ * @param ws_sock Websocket id returned by websocket_connect().
+ * @param iov Array of buffers containing the websocket data to send.
+ * @param iovcnt Number of buffers, at most
+ *        @kconfig{CONFIG_WEBSOCKET_MAX_SEND_IOVCNT}.
+ * @param opcode Operation code (text, binary, ping, pong, close)
+ * @param mask Mask the data, see RFC 6455 for details
+ * @param final Is this final message for this message send. See
+ *        websocket_send_msg() for details.
+ * @param timeout How long to try to send the message. The value is in
+ *        milliseconds. Value SYS_FOREVER_MS means to wait forever.
+ *
+ * @return <0 if error, >=0 amount of bytes sent
+ */
+int websocket_send_msgv(int ws_sock, struct iovec *iov, size_t iovcnt,
+			enum websocket_opcode opcode, bool mask, bool final,
+			int32_t timeout);
+
 /**
  * @brief Receive websocket msg from peer.
  *
  * @details The function will automatically remove websocket header from the
- * message.
+ * message. If no data is buffered from an earlier read, the payload is read
+ * directly into the given buffer and unmasked in place.
  *
  * @param ws_sock Websocket id returned by websocket_connect().
  * @param buf Buffer where websocket data is read.
@@ -41,8 +41,16 @@ struct z_spinlock_key {
  */
 struct k_spinlock {
 #ifdef CONFIG_SMP
+#ifdef CONFIG_TICKET_SPINLOCKS
+	/* Ticket currently being served, and the next ticket to be
+	 * handed out.  The lock is held whenever they differ.
+	 */
+	atomic_t owner;
+	atomic_t tail;
+#else
 	atomic_t locked;
 #endif
+#endif
 
 #ifdef CONFIG_SPIN_VALIDATE
 	/* Stores the thread that holds the lock with the locking CPU
@@ -99,6 +107,56 @@ bool z_spin_lock_mem_coherent(struct k_spinlock *l);
  */
 typedef struct z_spinlock_key k_spinlock_key_t;
 
+#ifdef CONFIG_SMP
+/* Internal functions: raw lock acquisition and release, without the
+ * interrupt masking and validation.  With CONFIG_TICKET_SPINLOCKS each
+ * CPU draws a ticket and spins until it is served, so the lock is
+ * granted in FIFO order and waiters only read the shared state.
+ */
+static ALWAYS_INLINE void z_spin_lock_acquire(struct k_spinlock *l)
+{
+#ifdef CONFIG_TICKET_SPINLOCKS
+	atomic_val_t ticket = atomic_inc(&l->tail);
+
+	while (atomic_get(&l->owner) != ticket) {
+	}
+#else
+	while (!atomic_cas(&l->locked, 0, 1)) {
+	}
+#endif
+}
+
+static ALWAYS_INLINE void z_spin_lock_release(struct k_spinlock *l)
+{
+#ifdef CONFIG_TICKET_SPINLOCKS
+	/* Only the holder ever writes the owner field, but the atomic
+	 * increment provides the barrier needed to publish the data
+	 * protected by the lock before the next CPU gets it.
+	 */
+	(void)atomic_inc(&l->owner);
+#else
+	/* Strictly we don't need atomic_clear() here (which is an
+	 * exchange operation that returns the old value).  We are always
+	 * setting a zero and (because we hold the lock) know the existing
+	 * state won't change due to a race.  But some architectures need
+	 * a memory barrier when used like this, and we don't have a
+	 * Zephyr framework for that.
+	 */
+	atomic_clear(&l->locked);
+#endif
+}
+
+/* Internal function: true if any CPU holds the lock */
+static ALWAYS_INLINE bool z_spin_is_locked(struct k_spinlock *l)
+{
+#ifdef CONFIG_TICKET_SPINLOCKS
+	return atomic_get(&l->owner) != atomic_get(&l->tail);
+#else
+	return atomic_get(&l->locked) != 0;
+#endif
+}
+#endif /* CONFIG_SMP */
+
 /**
  * @brief Lock a spinlock
  *
@@ -146,8 +204,7 @@ static ALWAYS_INLINE k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
 #endif
 
 #ifdef CONFIG_SMP
-	while (!atomic_cas(&l->locked, 0, 1)) {
-	}
+	z_spin_lock_acquire(l);
 #endif
 
 #ifdef CONFIG_SPIN_VALIDATE
@@ -186,14 +243,7 @@ static ALWAYS_INLINE void k_spin_unlock(struct k_spinlock *l,
 #endif
 
 #ifdef CONFIG_SMP
-	/* Strictly we don't need atomic_clear() here (which is an
-	 * exchange operation that returns the old value).  We are always
-	 * setting a zero and (because we hold the lock) know the existing
-	 * state won't change due to a race.  But some architectures need
-	 * a memory barrier when used like this, and we don't have a
-	 * Zephyr framework for that.
-	 */
-	atomic_clear(&l->locked);
+	z_spin_lock_release(l);
 #endif
 	arch_irq_unlock(key.key);
 }
@@ -208,7 +258,7 @@ static ALWAYS_INLINE void k_spin_release(struct k_spinlock *l)
 	__ASSERT(z_spin_unlock_valid(l), "Not my spinlock %p", l);
 #endif
 #ifdef CONFIG_SMP
-	atomic_clear(&l->locked);
+	z_spin_lock_release(l);
 #endif
 }
 
@@ -92,6 +92,137 @@ int disk_access_write(const char *pdrv, const uint8_t *data_buf,
  */
 int disk_access_ioctl(const char *pdrv, uint8_t cmd, void *buff);
 
+#if defined(CONFIG_DISK_CACHE) || defined(__DOXYGEN__)
+
+/**
+ * @brief Sector cache statistics
+ */
+struct disk_cache_stats {
+	/** Sectors read from the cache */
+	uint32_t hits;
+	/** Sectors which had to be read from the disk */
+	uint32_t misses;
+	/** Sectors read ahead of a sequential access */
+	uint32_t read_ahead;
+	/** Modified sectors written back to the disk */
+	uint32_t write_backs;
+};
+
+/**
+ * @brief Sector cache entry
+ *
+ * Internally used by the sector cache.
+ */
+struct disk_cache_entry {
+	uint32_t sector;
+	uint32_t last_use;
+	bool valid;
+	bool dirty;
+};
+
+/**
+ * @brief Sector cache
+ *
+ * Use DISK_CACHE_DEFINE() to define a sector cache. All members are
+ * internal to the sector cache.
+ */
+struct disk_cache {
+	struct disk_cache_entry *entries;
+	uint8_t *data;
+	uint8_t *ra_buf;
+	uint32_t num_sectors;
+	uint32_t sector_size;
+	uint32_t disk_sectors;
+	uint32_t clock;
+	uint32_t next_sector;
+	struct k_mutex lock;
+	struct disk_cache_stats stats;
+};
+
+/**
+ * @brief Statically define a sector cache
+ *
+ * The cache keeps @p _num_sectors sectors of @p _sector_size bytes, plus a
+ * buffer of CONFIG_DISK_CACHE_READ_AHEAD + 1 sectors for read-ahead.
+ *
+ * @param _name Name of the sector cache
+ * @param _num_sectors Number of sectors kept in the cache, at least 2
+ * @param _sector_size Sector size of the disk the cache is used with
+ */
+#define DISK_CACHE_DEFINE(_name, _num_sectors, _sector_size)		\
+	BUILD_ASSERT((_num_sectors) >= 2,				\
+		     "A sector cache needs at least two sectors");	\
+	static struct disk_cache_entry					\
+		_disk_cache_entries_##_name[_num_sectors];		\
+	static uint8_t _disk_cache_data_##_name				\
+		[(_num_sectors) * (_sector_size)] __aligned(4);		\
+	static uint8_t _disk_cache_ra_##_name				\
+		[(CONFIG_DISK_CACHE_READ_AHEAD + 1) * (_sector_size)]	\
+		__aligned(4);						\
+	static struct disk_cache _name = {				\
+		.entries = _disk_cache_entries_##_name,			\
+		.data = _disk_cache_data_##_name,			\
+		.ra_buf = _disk_cache_ra_##_name,			\
+		.num_sectors = (_num_sectors),				\
+		.sector_size = (_sector_size),				\
+		.lock = Z_MUTEX_INITIALIZER(_name.lock),		\
+	}
+
+/**
+ * @brief Attach a sector cache to a disk
+ *
+ * Once attached, the sectors read from and written to the disk through the
+ * disk access API are kept in the cache. Reads of sectors following the
+ * previously read one are extended by CONFIG_DISK_CACHE_READ_AHEAD sectors.
+ * With CONFIG_DISK_CACHE_WRITE_BACK, written sectors are only written to
+ * the disk when they are evicted from the cache or when the disk is
+ * synchronized with DISK_IOCTL_CTRL_SYNC.
+ *
+ * The disk must have been initialized with disk_access_init(), and must not
+ * be accessed other than through the disk access API while the cache is
+ * attached.
+ *
+ * @param[in] pdrv          Disk name
+ * @param[in] cache         Sector cache defined with DISK_CACHE_DEFINE()
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the disk is not registered or its sector size does
+ *         not match the one of the cache
+ * @retval -EBUSY if the disk already has a cache attached
+ * @return other negative errno code if the disk could not be queried
+ */
+int disk_access_cache_attach(const char *pdrv, struct disk_cache *cache);
+
+/**
+ * @brief Detach the sector cache of a disk
+ *
+ * Modified sectors are written to the disk before the cache is detached.
+ * Accesses to the disk in progress in other threads complete through the
+ * cache first, the following ones go directly to the disk.
+ *
+ * @param[in] pdrv          Disk name
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the disk has no cache attached
+ * @return other negative errno code if modified sectors could not be
+ *         written to the disk, in which case the cache stays attached
+ */
+int disk_access_cache_detach(const char *pdrv);
+
+/**
+ * @brief Get the statistics of the sector cache of a disk
+ *
+ * @param[in] pdrv          Disk name
+ * @param[out] stats        Statistics since the cache was attached
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the disk has no cache attached
+ */
+int disk_access_cache_stats_get(const char *pdrv,
+				struct disk_cache_stats *stats);
+
+#endif /* CONFIG_DISK_CACHE */
+
 #ifdef __cplusplus
 }
 #endif
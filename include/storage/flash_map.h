@@ -35,6 +35,15 @@
 #include <stddef.h>
 #include <sys/types.h>
 
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY)
+#include <kernel.h>
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+#include <tinycrypt/sha256.h>
+#else
+#include <mbedtls/md.h>
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -106,6 +115,176 @@ struct flash_area_check {
  */
 int flash_area_check_int_sha256(const struct flash_area *fa,
 				const struct flash_area_check *fac);
+
+/**
+ * @brief Algorithms for incremental flash area integrity checks
+ */
+enum flash_area_check_alg {
+	/** CRC-32 (IEEE), matched against its 4 byte little endian encoding */
+	FLASH_AREA_CHECK_CRC32,
+	/** SHA-256, matched against its 32 byte digest */
+	FLASH_AREA_CHECK_SHA256,
+};
+
+/**
+ * @brief Incremental flash area integrity check context
+ *
+ * All members are internal to the integrity check functions.
+ */
+struct flash_area_check_ctx {
+	const struct flash_area *fa;
+	const struct device *dev;
+	enum flash_area_check_alg alg;
+	off_t off;
+	size_t remaining;
+	uint8_t *rbuf;
+	size_t rblen;
+	union {
+		uint32_t crc;
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+		struct tc_sha256_state_struct sha;
+#else
+		mbedtls_md_context_t md;
+#endif
+	};
+};
+
+/**
+ * @brief Start an incremental integrity check of a flash area region
+ *
+ * The region is then read and hashed in parts with
+ * flash_area_check_update(), so that a large region can be checked in
+ * bounded slices, or while it is still being written, and the check is
+ * completed with flash_area_check_final().
+ *
+ * @param[out] ctx	Integrity check context
+ * @param[in] fa	Flash area
+ * @param[in] alg	Integrity check algorithm
+ * @param[in] off	Offset of the region in the flash area
+ * @param[in] len	Length of the region
+ * @param[in] rbuf	Read buffer, which stays in use until the check is
+ *			completed
+ * @param[in] rblen	Size of the read buffer, which is the amount of data
+ *			read from the flash at once
+ *
+ * @return  0 on success, -EINVAL on invalid parameters, -ENODEV if the flash
+ * device is not found, -ESRCH if the hash could not be started
+ */
+int flash_area_check_init(struct flash_area_check_ctx *ctx,
+			  const struct flash_area *fa,
+			  enum flash_area_check_alg alg, off_t off, size_t len,
+			  uint8_t *rbuf, size_t rblen);
+
+/**
+ * @brief Hash the next part of the region of an integrity check
+ *
+ * @param[in] ctx	Integrity check context
+ * @param[in] len	Number of bytes to read and hash, at most the number
+ *			of bytes remaining in the region
+ *
+ * @return  0 on success, -EINVAL if @p len exceeds the remaining bytes,
+ * -ESRCH on hash failure, other negative errno code on flash read failure.
+ * On failure, the check must be given up with flash_area_check_abort().
+ */
+int flash_area_check_update(struct flash_area_check_ctx *ctx, size_t len);
+
+/**
+ * @brief Get the number of bytes of an integrity check yet to be hashed
+ *
+ * @param[in] ctx	Integrity check context
+ *
+ * @return Number of bytes remaining in the region
+ */
+static inline size_t flash_area_check_remaining(
+	const struct flash_area_check_ctx *ctx)
+{
+	return ctx->remaining;
+}
+
+/**
+ * @brief Complete an integrity check
+ *
+ * The whole region must have been hashed. The context is released whatever
+ * the outcome.
+ *
+ * @param[in] ctx	Integrity check context
+ * @param[in] match	Expected CRC-32 or SHA-256 digest
+ *
+ * @return  0 if the region matches, -EILSEQ if it does not, -EINVAL if part
+ * of the region was not hashed, -ESRCH on hash failure
+ */
+int flash_area_check_final(struct flash_area_check_ctx *ctx,
+			   const uint8_t *match);
+
+/**
+ * @brief Give up an integrity check
+ *
+ * @param[in] ctx	Integrity check context
+ */
+void flash_area_check_abort(struct flash_area_check_ctx *ctx);
+
+struct flash_area_check_work;
+
+/**
+ * @brief Integrity check completion callback
+ *
+ * @param work	Integrity check work item
+ * @param result	Result of flash_area_check_final(), or the error which
+ *			stopped the check
+ */
+typedef void (*flash_area_check_work_cb_t)(struct flash_area_check_work *work,
+					   int result);
+
+/**
+ * @brief Integrity check run from a work queue
+ *
+ * Initialize with flash_area_check_work_init(). Only the @p ctx member may
+ * be accessed directly, to start the check with flash_area_check_init()
+ * before submitting it.
+ */
+struct flash_area_check_work {
+	/** Integrity check context */
+	struct flash_area_check_ctx ctx;
+	struct k_work work;
+	struct k_work_q *queue;
+	const uint8_t *match;
+	size_t slice;
+	flash_area_check_work_cb_t cb;
+};
+
+/**
+ * @brief Initialize an integrity check work item
+ *
+ * Must be called once before the work item is first submitted, and not
+ * while a check submitted with it is in progress.
+ *
+ * @param[in] work	Integrity check work item
+ */
+void flash_area_check_work_init(struct flash_area_check_work *work);
+
+/**
+ * @brief Run an integrity check from a work queue
+ *
+ * The check started on @p work->ctx is run in slices of at most @p slice
+ * bytes, each of them in a separate run of the work item, so that the other
+ * items of the queue are not held up for the whole check. The callback is
+ * invoked from the work queue once the check is completed.
+ *
+ * @param[in] work	Integrity check work item, initialized with
+ *			flash_area_check_work_init()
+ * @param[in] queue	Work queue, or NULL for the system work queue
+ * @param[in] slice	Maximum number of bytes hashed in one run
+ * @param[in] match	Expected CRC-32 or SHA-256 digest, which must remain
+ *			valid until the check is completed
+ * @param[in] cb	Completion callback
+ *
+ * @return  0 on success, -EINVAL on invalid parameters, -EBUSY if the work
+ * item is already in use
+ */
+int flash_area_check_work_submit(struct flash_area_check_work *work,
+				 struct k_work_q *queue, size_t slice,
+				 const uint8_t *match,
+				 flash_area_check_work_cb_t cb);
 #endif
 
 /**
@@ -105,6 +105,31 @@ struct k_mem_paging_stats_t {
 		/** Number of dirty pages selected for eviction */
 		unsigned long			dirty;
 	} eviction;
+
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	/* Only gathered system wide */
+	struct {
+		/** Number of pages paged in by readahead */
+		unsigned long			pages;
+
+		/** Number of pages read ahead which were accessed later */
+		unsigned long			hits;
+
+		/** Number of pages read ahead evicted without being accessed */
+		unsigned long			misses;
+	} readahead;
+#endif /* CONFIG_DEMAND_PAGING_READAHEAD */
+
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	/* Only gathered system wide */
+	struct {
+		/** Number of data pages written back by the page cleaner */
+		unsigned long			pages;
+
+		/** Number of batches written back by the page cleaner */
+		unsigned long			batches;
+	} cleaner;
+#endif /* CONFIG_DEMAND_PAGING_CLEANER */
 #endif /* CONFIG_DEMAND_PAGING_STATS */
 };
 
@@ -499,6 +524,18 @@ __syscall void k_mem_paging_histogram_backing_store_page_in_get(
 __syscall void k_mem_paging_histogram_backing_store_page_out_get(
 	struct k_mem_paging_histogram_t *hist);
 
+/**
+ * Get the page fault timing histogram
+ *
+ * This populates the timing histogram struct being passed in
+ * as argument. The time covers servicing the page fault as a whole,
+ * including eviction, backing store accesses and readahead.
+ *
+ * @param[in,out] hist Timing histogram struct to be filled.
+ */
+__syscall void k_mem_paging_histogram_page_fault_get(
+	struct k_mem_paging_histogram_t *hist);
+
 #include <syscalls/mem_manage.h>
 
 /** @} */
@@ -621,6 +658,42 @@ void k_mem_paging_backing_store_page_out(uintptr_t location);
  */
 void k_mem_paging_backing_store_page_in(uintptr_t location);
 
+/**
+ * Store clean copies of a batch of loaded data pages
+ *
+ * This is invoked by the page cleaner (CONFIG_DEMAND_PAGING_CLEANER) to write
+ * dirty or not yet backed data pages to the backing store ahead of their
+ * eviction. The data pages stay mapped; their contents are read directly
+ * from the virtual addresses in pf->addr. Nothing else accesses these data
+ * pages during the call, and their page frames will not be evicted.
+ *
+ * For each page frame, a storage location is obtained just like
+ * k_mem_paging_backing_store_location_get() would for a call which is not
+ * on behalf of a page fault, the data page is copied there, and the
+ * Z_PAGE_FRAME_BACKED bit is set. Subsequent calls to
+ * k_mem_paging_backing_store_location_get() must then return this location
+ * until the bit is cleared again. The kernel only makes such calls when
+ * paging the data page out to its clean copy, or before freeing the location
+ * if the data page is unmapped, and clears the bit right after. The kernel
+ * marks the stored data pages as clean in the page tables once this returns.
+ *
+ * Processing stops at the first data page which cannot be stored, for
+ * instance if the backing store is full.
+ *
+ * Calls to this, k_mem_paging_backing_store_page_in() and
+ * k_mem_paging_backing_store_page_out() will always be serialized, but
+ * interrupts may be enabled.
+ *
+ * Backing stores implementing this select
+ * CONFIG_DEMAND_PAGING_BACKING_STORE_BATCH.
+ *
+ * @param pfs Page frames holding the data pages to store
+ * @param count Number of page frames in pfs
+ * @return Number of data pages stored, counted from the start of pfs
+ */
+size_t k_mem_paging_backing_store_page_out_batch(struct z_page_frame *pfs[],
+						 size_t count);
+
 /**
  * Update internal accounting after a page-in
  *
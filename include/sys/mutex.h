@@ -11,9 +11,12 @@
  * sys_mutex behaves almost exactly like k_mutex, with the added advantage
  * that a sys_mutex instance can reside in user memory.
  *
- * Further enhancements will support locking/unlocking uncontended sys_mutexes
- * with simple atomic ops instead of syscalls, similar to Linux's
- * FUTEX_LOCK_PI and FUTEX_UNLOCK_PI
+ * With CONFIG_SYS_MUTEX_FAST_PATH, uncontended sys_mutexes are locked and
+ * unlocked with simple atomic ops instead of syscalls, similar to Linux's
+ * FUTEX_LOCK_PI and FUTEX_UNLOCK_PI. A contended mutex is handed
+ * over to a kernel mutex, which implements priority inheritance. A thread
+ * waiting for a mutex taken with atomic ops must have been granted access to
+ * the owner thread object, otherwise sys_mutex_lock() returns -EINVAL.
  */
 
 #ifdef __cplusplus
@@ -21,14 +24,14 @@ extern "C" {
 #endif
 
 #ifdef CONFIG_USERSPACE
+#include <kernel.h>
 #include <sys/atomic.h>
 #include <zephyr/types.h>
 #include <sys_clock.h>
 
 struct sys_mutex {
-	/* Currently unused, but will be used to store state for fast mutexes
-	 * that can be locked/unlocked with atomic ops if there is no
-	 * contention
+	/* Zero if unlocked, the owner's thread ID if locked with atomic ops,
+	 * otherwise the state is managed by the kernel
 	 */
 	atomic_t val;
 };
@@ -89,6 +92,10 @@ __syscall int z_sys_mutex_kernel_unlock(struct sys_mutex *mutex);
  * A thread is permitted to lock a mutex it has already locked. The operation
  * completes immediately and the lock count is increased by 1.
  *
+ * With CONFIG_SYS_MUTEX_FAST_PATH an uncontended mutex is locked without
+ * making a syscall, so the access checks below are only performed when the
+ * kernel gets involved.
+ *
  * @param mutex Address of the mutex, which may reside in user memory
  * @param timeout Waiting period to lock the mutex,
  *                or one of the special values K_NO_WAIT and K_FOREVER.
@@ -101,7 +108,12 @@ __syscall int z_sys_mutex_kernel_unlock(struct sys_mutex *mutex);
  */
 static inline int sys_mutex_lock(struct sys_mutex *mutex, k_timeout_t timeout)
 {
-	/* For now, make the syscall unconditionally */
+#ifdef CONFIG_SYS_MUTEX_FAST_PATH
+	if (atomic_cas(&mutex->val, 0, (atomic_val_t)k_current_get())) {
+		return 0;
+	}
+#endif
+
 	return z_sys_mutex_kernel_lock(mutex, timeout);
 }
 
@@ -124,7 +136,12 @@ static inline int sys_mutex_lock(struct sys_mutex *mutex, k_timeout_t timeout)
  */
 static inline int sys_mutex_unlock(struct sys_mutex *mutex)
 {
-	/* For now, make the syscall unconditionally */
+#ifdef CONFIG_SYS_MUTEX_FAST_PATH
+	if (atomic_cas(&mutex->val, (atomic_val_t)k_current_get(), 0)) {
+		return 0;
+	}
+#endif
+
 	return z_sys_mutex_kernel_unlock(mutex);
 }
 
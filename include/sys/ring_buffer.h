@@ -437,6 +437,358 @@ uint32_t ring_buf_get(struct ring_buf *buf, uint8_t *data, uint32_t size);
  */
 uint32_t ring_buf_peek(struct ring_buf *buf, uint8_t *data, uint32_t size);
 
+/* Indexes written by different CPUs are kept in separate cache lines so
+ * that the producer and the consumer do not keep stealing the line from
+ * each other. There is no point in padding on a single CPU.
+ */
+#if defined(CONFIG_SMP) && defined(CONFIG_DCACHE_LINE_SIZE) && \
+	(CONFIG_DCACHE_LINE_SIZE > 0)
+#define RING_BUF_CACHE_LINE_SIZE CONFIG_DCACHE_LINE_SIZE
+#elif defined(CONFIG_SMP)
+#define RING_BUF_CACHE_LINE_SIZE 64
+#else
+#define RING_BUF_CACHE_LINE_SIZE 4
+#endif
+
+/**
+ * @brief A lock-free single producer, single consumer byte ring buffer
+ *
+ * Indexes are free running and the size is a power of 2, so that the
+ * producer and the consumer each only ever write their own index.
+ */
+struct ring_buf_spsc {
+	uint8_t *buf;	/**< Memory region for stored bytes */
+	uint32_t size;	/**< Size of buf in bytes, a power of 2 */
+	uint32_t mask;	/**< Modulo mask */
+
+	struct {
+		uint32_t tail;	   /**< Published by the producer */
+		uint32_t tmp_tail; /**< End of the producer's claim */
+		uint32_t head;	   /**< Producer's copy of the consumer head */
+	} prod __aligned(RING_BUF_CACHE_LINE_SIZE);
+
+	struct {
+		uint32_t head;	   /**< Published by the consumer */
+		uint32_t tmp_head; /**< End of the consumer's claim */
+		uint32_t tail;	   /**< Consumer's copy of the producer tail */
+	} cons __aligned(RING_BUF_CACHE_LINE_SIZE);
+};
+
+/**
+ * @brief A lock-free bounded multiple producer, multiple consumer ring
+ *
+ * The ring holds fixed size elements. Every slot has a sequence number
+ * telling whether it is free or holds a message for the current lap, so
+ * that producers and consumers only contend on the head and tail indexes
+ * when claiming slots, and never when writing or reading them.
+ */
+struct ring_buf_mpmc {
+	uint8_t *buf;		/**< Memory region for stored elements */
+	uint32_t *seq;		/**< Per slot sequence numbers */
+	uint32_t elem_size;	/**< Size of an element in bytes */
+	uint32_t count;		/**< Number of slots, a power of 2 */
+	uint32_t mask;		/**< Modulo mask */
+
+	atomic_t tail __aligned(RING_BUF_CACHE_LINE_SIZE); /**< Next put */
+	atomic_t head __aligned(RING_BUF_CACHE_LINE_SIZE); /**< Next get */
+};
+
+/**
+ * @brief Define and initialize a single producer, single consumer ring buffer.
+ *
+ * The ring buffer can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern struct ring_buf_spsc <name>; @endcode
+ *
+ * @param name  Name of the ring buffer.
+ * @param size8 Size of ring buffer (in bytes), must be a power of 2.
+ */
+#define RING_BUF_SPSC_DECLARE(name, size8) \
+	BUILD_ASSERT(size8 < RING_BUFFER_MAX_SIZE,\
+		RING_BUFFER_SIZE_ASSERT_MSG); \
+	BUILD_ASSERT(((size8) & ((size8) - 1)) == 0, \
+		"Size must be a power of 2"); \
+	static uint8_t __noinit _ring_buffer_data_##name[size8]; \
+	struct ring_buf_spsc name = { \
+		.buf = _ring_buffer_data_##name, \
+		.size = size8, \
+		.mask = (size8) - 1 \
+	}
+
+/**
+ * @brief Initialize a single producer, single consumer ring buffer.
+ *
+ * @param buf  Address of ring buffer.
+ * @param size Ring buffer size (in bytes), must be a power of 2.
+ * @param data Ring buffer data area.
+ */
+static inline void ring_buf_spsc_init(struct ring_buf_spsc *buf,
+				      uint32_t size, uint8_t *data)
+{
+	__ASSERT(size < RING_BUFFER_MAX_SIZE, RING_BUFFER_SIZE_ASSERT_MSG);
+	__ASSERT(is_power_of_two(size), "Size must be a power of 2");
+
+	memset(buf, 0, sizeof(struct ring_buf_spsc));
+	buf->buf = data;
+	buf->size = size;
+	buf->mask = size - 1U;
+}
+
+/**
+ * @brief Determine used space in a single producer, single consumer ring
+ * buffer.
+ *
+ * The value may already be outdated when returned if the other side is
+ * running concurrently.
+ *
+ * @param buf Address of ring buffer.
+ *
+ * @return Ring buffer space used (in bytes).
+ */
+uint32_t ring_buf_spsc_size_get(struct ring_buf_spsc *buf);
+
+/**
+ * @brief Determine free space in a single producer, single consumer ring
+ * buffer.
+ *
+ * @param buf Address of ring buffer.
+ *
+ * @return Ring buffer free space (in bytes).
+ */
+static inline uint32_t ring_buf_spsc_space_get(struct ring_buf_spsc *buf)
+{
+	return buf->size - ring_buf_spsc_size_get(buf);
+}
+
+/**
+ * @brief Allocate buffer for writing data to a single producer, single
+ * consumer ring buffer.
+ *
+ * This is the lock-free counterpart of @ref ring_buf_put_claim. Only one
+ * context may be producing at a time, but it may run concurrently with the
+ * consumer, on any CPU, without further locking.
+ *
+ * @param[in]  buf  Address of ring buffer.
+ * @param[out] data Pointer to the address. It is set to a location within
+ *		    ring buffer.
+ * @param[in]  size Requested allocation size (in bytes).
+ *
+ * @return Size of allocated buffer which can be smaller than requested if
+ *	   there is not enough free space or buffer wraps.
+ */
+uint32_t ring_buf_spsc_put_claim(struct ring_buf_spsc *buf, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Make bytes written to allocated buffers visible to the consumer.
+ *
+ * Bytes claimed but not finished are returned to the ring buffer.
+ *
+ * @param buf  Address of ring buffer.
+ * @param size Number of valid bytes in the allocated buffers.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL Provided @a size exceeds the claimed space.
+ */
+int ring_buf_spsc_put_finish(struct ring_buf_spsc *buf, uint32_t size);
+
+/**
+ * @brief Write (copy) data to a single producer, single consumer ring buffer.
+ *
+ * @param buf  Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @retval Number of bytes written.
+ */
+uint32_t ring_buf_spsc_put(struct ring_buf_spsc *buf, const uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @brief Get address of a valid data in a single producer, single consumer
+ * ring buffer.
+ *
+ * This is the lock-free counterpart of @ref ring_buf_get_claim. Only one
+ * context may be consuming at a time, but it may run concurrently with the
+ * producer, on any CPU, without further locking.
+ *
+ * @param[in]  buf  Address of ring buffer.
+ * @param[out] data Pointer to the address. It is set to a location within
+ *		    ring buffer.
+ * @param[in]  size Requested size (in bytes).
+ *
+ * @return Number of valid bytes in the provided buffer which can be smaller
+ *	   than requested if there is not enough data or buffer wraps.
+ */
+uint32_t ring_buf_spsc_get_claim(struct ring_buf_spsc *buf, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Return bytes read from claimed buffers to the producer.
+ *
+ * Bytes claimed but not finished can be claimed again.
+ *
+ * @param buf  Address of ring buffer.
+ * @param size Number of bytes that can be freed.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL Provided @a size exceeds the claimed data.
+ */
+int ring_buf_spsc_get_finish(struct ring_buf_spsc *buf, uint32_t size);
+
+/**
+ * @brief Read data from a single producer, single consumer ring buffer.
+ *
+ * @param buf  Address of ring buffer.
+ * @param data Address of the output buffer. Can be NULL to discard data.
+ * @param size Data size (in bytes).
+ *
+ * @retval Number of bytes written to the output buffer.
+ */
+uint32_t ring_buf_spsc_get(struct ring_buf_spsc *buf, uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @brief Define and initialize a multiple producer, multiple consumer ring.
+ *
+ * The ring can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct ring_buf_mpmc <name>; @endcode
+ *
+ * @param name  Name of the ring.
+ * @param esize Size of an element (in bytes).
+ * @param num   Number of elements, must be a power of 2.
+ */
+#define RING_BUF_MPMC_DECLARE(name, esize, num) \
+	BUILD_ASSERT(num < RING_BUFFER_MAX_SIZE,\
+		RING_BUFFER_SIZE_ASSERT_MSG); \
+	BUILD_ASSERT(((num) & ((num) - 1)) == 0, \
+		"Number of elements must be a power of 2"); \
+	static uint8_t __noinit __aligned(4) \
+		_ring_buffer_data_##name[(esize) * (num)]; \
+	static uint32_t _ring_buffer_seq_##name[num]; \
+	struct ring_buf_mpmc name = { \
+		.buf = _ring_buffer_data_##name, \
+		.seq = _ring_buffer_seq_##name, \
+		.elem_size = esize, \
+		.count = num, \
+		.mask = (num) - 1 \
+	}
+
+/**
+ * @brief Initialize a multiple producer, multiple consumer ring.
+ *
+ * @param buf       Address of ring.
+ * @param elem_size Size of an element (in bytes).
+ * @param num       Number of elements, must be a power of 2.
+ * @param data      Ring data area (uint8_t data[elem_size * num]).
+ * @param seq       Ring sequence numbers (uint32_t seq[num]).
+ */
+static inline void ring_buf_mpmc_init(struct ring_buf_mpmc *buf,
+				      uint32_t elem_size, uint32_t num,
+				      void *data, uint32_t *seq)
+{
+	__ASSERT(num < RING_BUFFER_MAX_SIZE, RING_BUFFER_SIZE_ASSERT_MSG);
+	__ASSERT(is_power_of_two(num), "Size must be a power of 2");
+
+	memset(buf, 0, sizeof(struct ring_buf_mpmc));
+	memset(seq, 0, num * sizeof(uint32_t));
+	buf->buf = (uint8_t *)data;
+	buf->seq = seq;
+	buf->elem_size = elem_size;
+	buf->count = num;
+	buf->mask = num - 1U;
+}
+
+/**
+ * @brief Claim free slots in a multiple producer, multiple consumer ring.
+ *
+ * Any number of producers may claim slots concurrently, from any context
+ * and on any CPU. The claimed slots are contiguous in memory and must be
+ * handed over to consumers with @ref ring_buf_mpmc_put_finish. Consumers
+ * cannot get past a slot which is claimed but not finished, so slots
+ * should be finished promptly.
+ *
+ * @param[in]  buf  Address of ring.
+ * @param[out] data Set to the address of the first claimed slot.
+ * @param[in]  num  Requested number of slots.
+ *
+ * @return Number of claimed slots which can be smaller than requested if
+ *	   there are not enough free slots or the ring wraps.
+ */
+uint32_t ring_buf_mpmc_put_claim(struct ring_buf_mpmc *buf, void **data,
+				 uint32_t num);
+
+/**
+ * @brief Hand over claimed slots to consumers.
+ *
+ * @param buf  Address of ring.
+ * @param data Address of the first claimed slot.
+ * @param num  Number of claimed slots, all of them must be finished.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL @a data and @a num do not describe slots of the ring.
+ */
+int ring_buf_mpmc_put_finish(struct ring_buf_mpmc *buf, void *data,
+			     uint32_t num);
+
+/**
+ * @brief Write (copy) elements to a multiple producer, multiple consumer
+ * ring.
+ *
+ * @param buf  Address of ring.
+ * @param data Address of elements.
+ * @param num  Number of elements.
+ *
+ * @retval Number of elements written.
+ */
+uint32_t ring_buf_mpmc_put(struct ring_buf_mpmc *buf, const void *data,
+			   uint32_t num);
+
+/**
+ * @brief Claim filled slots in a multiple producer, multiple consumer ring.
+ *
+ * Any number of consumers may claim slots concurrently, from any context
+ * and on any CPU. The claimed slots are contiguous in memory and must be
+ * returned to producers with @ref ring_buf_mpmc_get_finish.
+ *
+ * @param[in]  buf  Address of ring.
+ * @param[out] data Set to the address of the first claimed slot.
+ * @param[in]  num  Requested number of slots.
+ *
+ * @return Number of claimed slots which can be smaller than requested if
+ *	   there are not enough elements or the ring wraps.
+ */
+uint32_t ring_buf_mpmc_get_claim(struct ring_buf_mpmc *buf, void **data,
+				 uint32_t num);
+
+/**
+ * @brief Return claimed slots to producers.
+ *
+ * @param buf  Address of ring.
+ * @param data Address of the first claimed slot.
+ * @param num  Number of claimed slots, all of them must be finished.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL @a data and @a num do not describe slots of the ring.
+ */
+int ring_buf_mpmc_get_finish(struct ring_buf_mpmc *buf, void *data,
+			     uint32_t num);
+
+/**
+ * @brief Read (copy) elements from a multiple producer, multiple consumer
+ * ring.
+ *
+ * @param buf  Address of ring.
+ * @param data Address of the output buffer. Can be NULL to discard elements.
+ * @param num  Number of elements.
+ *
+ * @retval Number of elements read.
+ */
+uint32_t ring_buf_mpmc_get(struct ring_buf_mpmc *buf, void *data,
+			   uint32_t num);
+
 /**
  * @}
  */
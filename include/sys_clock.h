@@ -189,6 +189,31 @@ int64_t sys_clock_tick_get(void);
 
 uint64_t sys_clock_timeout_end_calc(k_timeout_t timeout);
 
+#ifdef CONFIG_TIMEOUT_SLACK
+/**
+ * @brief Timeout coalescing statistics
+ */
+struct sys_clock_slack_stats {
+	/** Announcements of elapsed ticks which expired timeouts */
+	uint64_t wakeups;
+	/** Expiry ticks which were served by an earlier wakeup */
+	uint64_t wakeups_avoided;
+};
+
+/**
+ *
+ * @brief Get timeout coalescing statistics
+ *
+ * The number of wakeups avoided counts the timeouts which expired at a
+ * different tick than the previous timeout served by the same
+ * announcement, i.e. which would otherwise have needed a timer interrupt
+ * of their own. Divide by the uptime to get a rate.
+ *
+ * @param stats Filled with the statistics since boot
+ */
+void sys_clock_slack_stats_get(struct sys_clock_slack_stats *stats);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,6 +81,30 @@ static inline bool z_is_in_user_syscall(void)
 int z_object_validate(struct z_object *ko, enum k_objects otype,
 		      enum _obj_init_check init);
 
+/**
+ * Find and validate a system object, using the caller's validation cache
+ *
+ * Equivalent to z_object_validate() on the result of z_object_find(), but
+ * objects the calling thread was recently granted access to are found in
+ * a per-thread cache, skipping both the lookup and the permission check.
+ * Errors are dumped like z_dump_object_error() does.
+ *
+ * Only available with CONFIG_OBJ_VALIDATION_CACHE.
+ *
+ * @param obj Address of the kernel object
+ * @param otype Expected type of the kernel object, or K_OBJ_ANY if type
+ *	  doesn't matter
+ * @param init Indicate whether the object needs to already be in initialized
+ *             or uninitialized state, or that we don't care
+ * @return 0 If the object is valid
+ *         -EBADF if not a valid object of the specified type
+ *         -EPERM If the caller does not have permissions
+ *         -EINVAL Object is not initialized
+ *         -EADDRINUSE Object is already initialized
+ */
+int z_object_validate_cached(const void *obj, enum k_objects otype,
+			     enum _obj_init_check init);
+
 /**
  * Dump out error information on failed z_object_validate() call
  *
@@ -445,11 +469,18 @@ static inline int z_obj_validation_check(struct z_object *ko,
 	return ret;
 }
 
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+#define Z_SYSCALL_IS_OBJ(ptr, type, init) \
+	Z_SYSCALL_VERIFY_MSG(z_object_validate_cached(			\
+				     (const void *)ptr,			\
+				     type, init) == 0, "access denied")
+#else
 #define Z_SYSCALL_IS_OBJ(ptr, type, init) \
 	Z_SYSCALL_VERIFY_MSG(z_obj_validation_check(			\
 				     z_object_find((const void *)ptr),	\
 				     (const void *)ptr,			\
 				     type, init) == 0, "access denied")
+#endif
 
 /**
  * @brief Runtime check driver object pointer for presence of operation
@@ -30,6 +30,14 @@ static inline void z_init_timeout(struct _timeout *to)
 void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 		   k_timeout_t timeout);
 
+#ifdef CONFIG_TIMEOUT_SLACK
+/* As z_add_timeout(), but the expiry may be deferred by up to slack
+ * ticks to be served together with other timeouts
+ */
+void z_add_timeout_slack(struct _timeout *to, _timeout_func_t fn,
+			 k_timeout_t timeout, uint32_t slack);
+#endif
+
 int z_abort_timeout(struct _timeout *to);
 
 static inline bool z_is_inactive_timeout(const struct _timeout *to)
@@ -1432,6 +1432,58 @@
  */
 #define sys_port_trace_k_msgq_purge(msgq)
 
+/**
+ * @brief Trace Message Queue slot reservation attempt entry
+ * @param msgq Message Queue object
+ */
+#define sys_port_trace_k_msgq_alloc_put_batch_enter(msgq)
+
+/**
+ * @brief Trace Message Queue slot reservation attempt outcome
+ * @param msgq Message Queue object
+ * @param ret Return value
+ */
+#define sys_port_trace_k_msgq_alloc_put_batch_exit(msgq, ret)
+
+/**
+ * @brief Trace Message Queue commit of reserved slots entry
+ * @param msgq Message Queue object
+ */
+#define sys_port_trace_k_msgq_commit_enter(msgq)
+
+/**
+ * @brief Trace Message Queue commit of reserved slots outcome
+ * @param msgq Message Queue object
+ * @param ret Return value
+ */
+#define sys_port_trace_k_msgq_commit_exit(msgq, ret)
+
+/**
+ * @brief Trace Message Queue message claim attempt entry
+ * @param msgq Message Queue object
+ */
+#define sys_port_trace_k_msgq_peek_claim_batch_enter(msgq)
+
+/**
+ * @brief Trace Message Queue message claim attempt outcome
+ * @param msgq Message Queue object
+ * @param ret Return value
+ */
+#define sys_port_trace_k_msgq_peek_claim_batch_exit(msgq, ret)
+
+/**
+ * @brief Trace Message Queue release of claimed messages entry
+ * @param msgq Message Queue object
+ */
+#define sys_port_trace_k_msgq_release_enter(msgq)
+
+/**
+ * @brief Trace Message Queue release of claimed messages outcome
+ * @param msgq Message Queue object
+ * @param ret Return value
+ */
+#define sys_port_trace_k_msgq_release_exit(msgq, ret)
+
 /** @} */ /* end of subsys_tracing_apis_msgq */
 
 /**
@@ -180,6 +180,11 @@ void z_mem_domain_exit_thread(struct k_thread *thread);
  * not recommended.
  */
 extern struct k_spinlock z_mem_domain_lock;
+
+/* Lock a free mutex on behalf of another thread, used by sys_mutex when a
+ * mutex taken from user mode with atomic ops becomes contended
+ */
+int z_mutex_lock_for(struct k_mutex *mutex, struct k_thread *thread);
 #endif /* CONFIG_USERSPACE */
 
 #ifdef CONFIG_GDBSTUB
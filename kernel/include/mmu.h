@@ -90,6 +90,12 @@
  */
 #define Z_PAGE_FRAME_BACKED		BIT(4)
 
+/**
+ * This page frame was paged in by readahead and has not been seen accessed
+ * since
+ */
+#define Z_PAGE_FRAME_READAHEAD		BIT(5)
+
 /**
  * Data structure for physical page frames
  *
@@ -263,6 +269,20 @@ unsigned long z_num_pagefaults_get(void);
  */
 int z_page_frame_evict(uintptr_t phys);
 
+/**
+ * Clear the accessed state of the data page in a page frame
+ *
+ * For use by eviction algorithms instead of calling arch_page_info_get()
+ * with clear_accessed set, so that the kernel can tell whether pages read
+ * ahead were eventually used.
+ *
+ * Must be called with interrupts locked, on an evictable page frame.
+ *
+ * @param pf Page frame
+ * @return ARCH_DATA_PAGE_* bits of the data page before clearing
+ */
+uintptr_t z_page_frame_accessed_clear(struct z_page_frame *pf);
+
 /**
  * Handle a page fault for a virtual data page
  *
@@ -38,6 +38,14 @@ static int create_free_list(struct k_mem_slab *slab)
 	slab->free_list = NULL;
 	p = slab->buffer;
 
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+	for (j = 0U; j < CONFIG_MP_NUM_CPUS; j++) {
+		slab->cache[j].free_list = NULL;
+		slab->cache[j].count = 0U;
+	}
+	slab->cache_bypass = false;
+#endif
+
 	for (j = 0U; j < slab->num_blocks; j++) {
 		*(char **)p = slab->free_list;
 		slab->free_list = p;
@@ -86,6 +94,10 @@ int k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 
 #ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
 	slab->max_used = 0U;
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+	atomic_clear(&slab->cache_num_used);
+	atomic_clear(&slab->cache_max_used);
+#endif
 #endif
 
 	rc = create_free_list(slab);
@@ -101,13 +113,218 @@ out:
 	return rc;
 }
 
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+
+#define CACHE_SIZE CONFIG_MEM_SLAB_PER_CPU_CACHE_SIZE
+#define CACHE_BATCH (CACHE_SIZE / 2)
+
+/*
+ * Each CPU keeps up to CACHE_SIZE free blocks in its own cache, protected
+ * by a per-CPU spinlock that is normally only taken by that CPU. The slab
+ * lock is taken when a cache runs empty or full, and then CACHE_BATCH
+ * blocks are moved between the cache and the slab's free list. When
+ * nested, the slab lock is always taken first.
+ *
+ * Allocations only fail or block once the free list and all the caches
+ * are empty. While threads wait, cache_bypass makes frees go through the
+ * slab lock so that the blocks are handed to the waiters.
+ */
+
+static inline void cache_stats_alloc(struct k_mem_slab *slab)
+{
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	atomic_val_t used = atomic_inc(&slab->cache_num_used) + 1;
+	atomic_val_t max = atomic_get(&slab->cache_max_used);
+
+	while (used > max) {
+		if (atomic_cas(&slab->cache_max_used, max, used)) {
+			break;
+		}
+		max = atomic_get(&slab->cache_max_used);
+	}
+#endif
+}
+
+static inline void cache_stats_free(struct k_mem_slab *slab)
+{
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+	atomic_dec(&slab->cache_num_used);
+#endif
+}
+
+static bool cache_alloc(struct k_mem_slab *slab, void **mem)
+{
+	unsigned int key = arch_irq_lock();
+	struct z_mem_slab_cache *cache = &slab->cache[_current_cpu->id];
+	k_spinlock_key_t cache_key = k_spin_lock(&cache->lock);
+	bool found = cache->count > 0U;
+
+	if (found) {
+		*mem = cache->free_list;
+		cache->free_list = *(char **)(cache->free_list);
+		cache->count--;
+	}
+
+	k_spin_unlock(&cache->lock, cache_key);
+	arch_irq_unlock(key);
+
+	if (found) {
+		cache_stats_alloc(slab);
+	}
+
+	return found;
+}
+
+static bool cache_free(struct k_mem_slab *slab, void **mem)
+{
+	unsigned int key = arch_irq_lock();
+	struct z_mem_slab_cache *cache = &slab->cache[_current_cpu->id];
+	k_spinlock_key_t cache_key = k_spin_lock(&cache->lock);
+	bool cached = !slab->cache_bypass && cache->count < CACHE_SIZE;
+
+	if (cached) {
+		**(char ***) mem = cache->free_list;
+		cache->free_list = *(char **) mem;
+		cache->count++;
+	}
+
+	k_spin_unlock(&cache->lock, cache_key);
+	arch_irq_unlock(key);
+
+	if (cached) {
+		cache_stats_free(slab);
+	}
+
+	return cached;
+}
+
+/* Called with the slab lock held */
+static void cache_refill(struct k_mem_slab *slab)
+{
+	struct z_mem_slab_cache *cache = &slab->cache[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&cache->lock);
+	char *block;
+
+	while (cache->count < CACHE_BATCH && slab->free_list != NULL) {
+		block = slab->free_list;
+		slab->free_list = *(char **)block;
+		slab->num_used++;
+
+		*(char **)block = cache->free_list;
+		cache->free_list = block;
+		cache->count++;
+	}
+
+	k_spin_unlock(&cache->lock, key);
+}
+
+/* Called with the slab lock held */
+static void cache_drain(struct k_mem_slab *slab)
+{
+	struct z_mem_slab_cache *cache = &slab->cache[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&cache->lock);
+	char *block;
+
+	while (cache->count > CACHE_BATCH) {
+		block = cache->free_list;
+		cache->free_list = *(char **)block;
+		cache->count--;
+
+		*(char **)block = slab->free_list;
+		slab->free_list = block;
+		slab->num_used--;
+	}
+
+	k_spin_unlock(&cache->lock, key);
+}
+
+/* Called with the slab lock held when the free list is empty */
+static bool cache_steal(struct k_mem_slab *slab, void **mem)
+{
+	struct z_mem_slab_cache *cache;
+	k_spinlock_key_t key;
+	bool found = false;
+
+	/* Set before looking at the caches, so that a concurrent free either
+	 * leaves its block where it is found below or takes the slab lock.
+	 */
+	slab->cache_bypass = true;
+
+	for (unsigned int i = 0; i < CONFIG_MP_NUM_CPUS && !found; i++) {
+		cache = &slab->cache[i];
+		key = k_spin_lock(&cache->lock);
+
+		if (cache->count > 0U) {
+			*mem = cache->free_list;
+			cache->free_list = *(char **)(cache->free_list);
+			cache->count--;
+			found = true;
+		}
+
+		k_spin_unlock(&cache->lock, key);
+	}
+
+	if (found) {
+		if (z_waitq_head(&slab->wait_q) == NULL) {
+			slab->cache_bypass = false;
+		}
+
+		cache_stats_alloc(slab);
+	}
+
+	return found;
+}
+
+#else
+
+static inline bool cache_alloc(struct k_mem_slab *slab, void **mem)
+{
+	return false;
+}
+
+static inline bool cache_free(struct k_mem_slab *slab, void **mem)
+{
+	return false;
+}
+
+static inline void cache_refill(struct k_mem_slab *slab)
+{
+}
+
+static inline void cache_drain(struct k_mem_slab *slab)
+{
+}
+
+static inline bool cache_steal(struct k_mem_slab *slab, void **mem)
+{
+	return false;
+}
+
+static inline void cache_stats_alloc(struct k_mem_slab *slab)
+{
+}
+
+static inline void cache_stats_free(struct k_mem_slab *slab)
+{
+}
+
+#endif /* CONFIG_MEM_SLAB_PER_CPU_CACHE */
+
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, k_timeout_t timeout)
 {
-	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	k_spinlock_key_t key;
 	int result;
 
 	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_mem_slab, alloc, slab, timeout);
 
+	if (cache_alloc(slab, mem)) {
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_mem_slab, alloc, slab, timeout, 0);
+
+		return 0;
+	}
+
+	key = k_spin_lock(&slab->lock);
+
 	if (slab->free_list != NULL) {
 		/* take a free block */
 		*mem = slab->free_list;
@@ -118,6 +335,11 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, k_timeout_t timeout)
 		slab->max_used = MAX(slab->num_used, slab->max_used);
 #endif
 
+		cache_stats_alloc(slab);
+		cache_refill(slab);
+
+		result = 0;
+	} else if (cache_steal(slab, mem)) {
 		result = 0;
 	} else if (K_TIMEOUT_EQ(timeout, K_NO_WAIT) ||
 		   !IS_ENABLED(CONFIG_MULTITHREADING)) {
@@ -147,9 +369,18 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, k_timeout_t timeout)
 
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	k_spinlock_key_t key;
 
 	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_mem_slab, free, slab);
+
+	if (cache_free(slab, mem)) {
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_mem_slab, free, slab);
+
+		return;
+	}
+
+	key = k_spin_lock(&slab->lock);
+
 	if (slab->free_list == NULL && IS_ENABLED(CONFIG_MULTITHREADING)) {
 		struct k_thread *pending_thread = z_unpend_first_thread(&slab->wait_q);
 
@@ -166,6 +397,14 @@ void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 	slab->free_list = *(char **) mem;
 	slab->num_used--;
 
+#ifdef CONFIG_MEM_SLAB_PER_CPU_CACHE
+	/* Nobody is waiting any more */
+	slab->cache_bypass = false;
+#endif
+
+	cache_stats_free(slab);
+	cache_drain(slab);
+
 	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_mem_slab, free, slab);
 
 	k_spin_unlock(&slab->lock, key);
@@ -461,6 +461,7 @@ static int page_frame_prepare_locked(struct z_page_frame *pf, bool *dirty_ptr,
 
 static inline void do_backing_store_page_in(uintptr_t location);
 static inline void do_backing_store_page_out(uintptr_t location);
+static void page_frame_backing_free_locked(struct z_page_frame *pf);
 #endif /* CONFIG_DEMAND_PAGING */
 
 /* Allocate a free page frame, and map it to a specified virtual address
@@ -657,6 +658,13 @@ void k_mem_unmap(void *addr, size_t size)
 
 		arch_mem_unmap(pos, CONFIG_MMU_PAGE_SIZE);
 
+#ifdef CONFIG_DEMAND_PAGING
+		if (z_page_frame_is_backed(pf)) {
+			/* Discard the clean copy in the backing store */
+			page_frame_backing_free_locked(pf);
+		}
+#endif /* CONFIG_DEMAND_PAGING */
+
 		/* Put the page frame back into free list */
 		page_frame_free_locked(pf);
 	}
@@ -935,6 +943,12 @@ struct k_mem_paging_stats_t paging_stats;
 extern struct k_mem_paging_histogram_t z_paging_histogram_eviction;
 extern struct k_mem_paging_histogram_t z_paging_histogram_backing_store_page_in;
 extern struct k_mem_paging_histogram_t z_paging_histogram_backing_store_page_out;
+extern struct k_mem_paging_histogram_t z_paging_histogram_page_fault;
+#endif
+
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+/* Given to wake up the page cleaner before its period expires */
+static K_SEM_DEFINE(page_cleaner_sem, 0, 1);
 #endif
 
 static inline void do_backing_store_page_in(uintptr_t location)
@@ -1018,6 +1032,67 @@ static void virt_region_foreach(void *addr, size_t size,
 	}
 }
 
+uintptr_t z_page_frame_accessed_clear(struct z_page_frame *pf)
+{
+	uintptr_t flags;
+
+	flags = arch_page_info_get(pf->addr, NULL, true);
+
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	if ((pf->flags & Z_PAGE_FRAME_READAHEAD) != 0U &&
+	    (flags & ARCH_DATA_PAGE_ACCESSED) != 0U) {
+		pf->flags &= ~Z_PAGE_FRAME_READAHEAD;
+#ifdef CONFIG_DEMAND_PAGING_STATS
+		paging_stats.readahead.hits++;
+#endif
+	}
+#endif /* CONFIG_DEMAND_PAGING_READAHEAD */
+
+	return flags;
+}
+
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+/* Account for a page read ahead which is about to be evicted */
+static void readahead_evict(struct z_page_frame *pf)
+{
+	uintptr_t flags;
+
+	if ((pf->flags & Z_PAGE_FRAME_READAHEAD) == 0U) {
+		return;
+	}
+
+	pf->flags &= ~Z_PAGE_FRAME_READAHEAD;
+	flags = arch_page_info_get(pf->addr, NULL, false);
+
+#ifdef CONFIG_DEMAND_PAGING_STATS
+	if ((flags & ARCH_DATA_PAGE_ACCESSED) != 0U) {
+		paging_stats.readahead.hits++;
+	} else {
+		paging_stats.readahead.misses++;
+	}
+#else
+	ARG_UNUSED(flags);
+#endif
+}
+#endif /* CONFIG_DEMAND_PAGING_READAHEAD */
+
+/* Free the backing store location holding the clean copy of a page frame
+ * whose data page is going away
+ */
+static void page_frame_backing_free_locked(struct z_page_frame *pf)
+{
+	uintptr_t location;
+	int ret;
+
+	/* Backed page frames get their previous location back */
+	ret = k_mem_paging_backing_store_location_get(pf, &location, false);
+	__ASSERT(ret == 0, "no location for backed page frame");
+	if (ret == 0) {
+		k_mem_paging_backing_store_location_free(location);
+	}
+	pf->flags &= ~Z_PAGE_FRAME_BACKED;
+}
+
 /*
  * Perform some preparatory steps before paging out. The provided page frame
  * must be evicted to the backing store immediately after this is called
@@ -1058,6 +1133,9 @@ static int page_frame_prepare_locked(struct z_page_frame *pf, bool *dirty_ptr,
 	 */
 	if (z_page_frame_is_mapped(pf)) {
 		dirty = dirty || !z_page_frame_is_backed(pf);
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+		readahead_evict(pf);
+#endif
 	}
 
 	if (dirty || page_fault) {
@@ -1072,6 +1150,9 @@ static int page_frame_prepare_locked(struct z_page_frame *pf, bool *dirty_ptr,
 			return -ENOMEM;
 		}
 		arch_mem_page_out(pf->addr, *location_ptr);
+
+		/* The clean copy, if any, is now the paged out data page */
+		pf->flags &= ~Z_PAGE_FRAME_BACKED;
 	} else {
 		/* Shouldn't happen unless this function is mis-used */
 		__ASSERT(!dirty, "un-mapped page determined to be dirty");
@@ -1308,7 +1389,12 @@ static inline struct z_page_frame *do_eviction_select(bool *dirty)
 	return pf;
 }
 
-static bool do_page_fault(void *addr, bool pin)
+/*
+ * Page in the data page at addr. If readahead is set, this is not a real page
+ * fault but a speculative page-in: it is not counted as a fault, and false is
+ * returned if there was nothing to page in.
+ */
+static bool do_page_fault(void *addr, bool pin, bool readahead)
 {
 	struct z_page_frame *pf;
 	int key, ret;
@@ -1369,6 +1455,11 @@ static bool do_page_fault(void *addr, bool pin)
 	result = true;
 
 	if (status == ARCH_PAGE_LOCATION_PAGED_IN) {
+		if (readahead) {
+			result = false;
+			goto out;
+		}
+
 		if (pin) {
 			/* It's a physical memory address */
 			uintptr_t phys = page_in_location;
@@ -1387,7 +1478,13 @@ static bool do_page_fault(void *addr, bool pin)
 	__ASSERT(status == ARCH_PAGE_LOCATION_PAGED_OUT,
 		 "unexpected status value %d", status);
 
-	paging_stats_faults_inc(faulting_thread, key);
+	if (readahead) {
+#if defined(CONFIG_DEMAND_PAGING_READAHEAD) && defined(CONFIG_DEMAND_PAGING_STATS)
+		paging_stats.readahead.pages++;
+#endif
+	} else {
+		paging_stats_faults_inc(faulting_thread, key);
+	}
 
 	pf = free_page_frame_list_get();
 	if (pf == NULL) {
@@ -1401,6 +1498,12 @@ static bool do_page_fault(void *addr, bool pin)
 	}
 	ret = page_frame_prepare_locked(pf, &dirty, true, &page_out_location);
 	__ASSERT(ret == 0, "failed to prepare page frame");
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	if (dirty) {
+		/* The page cleaner is falling behind */
+		k_sem_give(&page_cleaner_sem);
+	}
+#endif
 
 #ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
 	irq_unlock(key);
@@ -1421,6 +1524,11 @@ static bool do_page_fault(void *addr, bool pin)
 	if (pin) {
 		pf->flags |= Z_PAGE_FRAME_PINNED;
 	}
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	if (readahead) {
+		pf->flags |= Z_PAGE_FRAME_READAHEAD;
+	}
+#endif
 	pf->flags |= Z_PAGE_FRAME_MAPPED;
 	pf->addr = UINT_TO_POINTER(POINTER_TO_UINT(addr)
 				   & ~(CONFIG_MMU_PAGE_SIZE - 1));
@@ -1440,7 +1548,7 @@ static void do_page_in(void *addr)
 {
 	bool ret;
 
-	ret = do_page_fault(addr, false);
+	ret = do_page_fault(addr, false, false);
 	__ASSERT(ret, "unmapped memory address %p", addr);
 	(void)ret;
 }
@@ -1457,7 +1565,7 @@ static void do_mem_pin(void *addr)
 {
 	bool ret;
 
-	ret = do_page_fault(addr, true);
+	ret = do_page_fault(addr, true, false);
 	__ASSERT(ret, "unmapped memory address %p", addr);
 	(void)ret;
 }
@@ -1470,9 +1578,92 @@ void k_mem_pin(void *addr, size_t size)
 	virt_region_foreach(addr, size, do_mem_pin);
 }
 
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+/* Data page expected to fault next if memory is being streamed through,
+ * protected by z_mm_lock as faults may be taken on several CPUs at once
+ */
+static uint8_t *readahead_next;
+
+static void readahead(void *addr)
+{
+	uint8_t *page = UINT_TO_POINTER(POINTER_TO_UINT(addr) &
+					~(CONFIG_MMU_PAGE_SIZE - 1));
+	k_spinlock_key_t key;
+	bool stream;
+	int i;
+
+	key = k_spin_lock(&z_mm_lock);
+	stream = (page == readahead_next);
+	/* Move the expected page past the ones about to be read ahead, so
+	 * that a fault on another CPU meanwhile doesn't read them as well.
+	 */
+	readahead_next = page + CONFIG_MMU_PAGE_SIZE *
+		(stream ? CONFIG_DEMAND_PAGING_READAHEAD_PAGES + 1 : 1);
+	k_spin_unlock(&z_mm_lock, key);
+
+	if (!stream) {
+		return;
+	}
+
+	/* Read ahead before paging in the faulting page itself, so that it
+	 * can't be evicted again before the faulting access is retried.
+	 */
+	for (i = 1; i <= CONFIG_DEMAND_PAGING_READAHEAD_PAGES; i++) {
+		page += CONFIG_MMU_PAGE_SIZE;
+
+		if (page >= (uint8_t *)Z_VIRT_RAM_END - Z_VM_RESERVED ||
+		    !do_page_fault(page, false, true)) {
+			break;
+		}
+	}
+
+	/* If the stream goes on, the next fault is right after the pages
+	 * read ahead.
+	 */
+	key = k_spin_lock(&z_mm_lock);
+	readahead_next = page + CONFIG_MMU_PAGE_SIZE;
+	k_spin_unlock(&z_mm_lock, key);
+}
+#endif /* CONFIG_DEMAND_PAGING_READAHEAD */
+
 bool z_page_fault(void *addr)
 {
-	return do_page_fault(addr, false);
+	bool ret;
+
+#ifdef CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM
+	uint32_t time_diff;
+
+#ifdef CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS
+	timing_t time_start, time_end;
+
+	time_start = timing_counter_get();
+#else
+	uint32_t time_start;
+
+	time_start = k_cycle_get_32();
+#endif /* CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS */
+#endif /* CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM */
+
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	readahead(addr);
+#endif
+	ret = do_page_fault(addr, false, false);
+
+#ifdef CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM
+#ifdef CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS
+	time_end = timing_counter_get();
+	time_diff = (uint32_t)timing_cycles_get(&time_start, &time_end);
+#else
+	time_diff = k_cycle_get_32() - time_start;
+#endif /* CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS */
+
+	if (ret) {
+		z_paging_histogram_inc(&z_paging_histogram_page_fault,
+				       time_diff);
+	}
+#endif /* CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM */
+
+	return ret;
 }
 
 static void do_mem_unpin(void *addr)
@@ -1499,4 +1690,136 @@ void k_mem_unpin(void *addr, size_t size)
 	virt_region_foreach(addr, size, do_mem_unpin);
 }
 
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+static K_KERNEL_PINNED_STACK_DEFINE(page_cleaner_stack,
+				    CONFIG_DEMAND_PAGING_CLEANER_STACK_SIZE);
+__pinned_bss
+static struct k_thread page_cleaner_thread;
+
+/* Page frames written back by the current batch */
+static struct z_page_frame *
+page_cleaner_batch[CONFIG_DEMAND_PAGING_CLEANER_BATCH];
+
+/* Index of the page frame the next scan starts from */
+static size_t page_cleaner_next;
+
+/* Page frames worth writing back: evictable, not accessed since the eviction
+ * algorithm last looked at them, and either dirty or without a clean copy.
+ * Recently accessed page frames are left alone, as they are unlikely to be
+ * evicted soon and marking them clean would lose their accessed bit.
+ */
+static bool page_frame_needs_cleaning(struct z_page_frame *pf)
+{
+	uintptr_t flags;
+
+	if (!z_page_frame_is_evictable(pf)) {
+		return false;
+	}
+
+	flags = arch_page_info_get(pf->addr, NULL, false);
+	if ((flags & ARCH_DATA_PAGE_ACCESSED) != 0U) {
+		return false;
+	}
+
+	return (flags & ARCH_DATA_PAGE_DIRTY) != 0U ||
+	       !z_page_frame_is_backed(pf);
+}
+
+static void page_cleaner_run(void)
+{
+	struct z_page_frame *pf;
+	size_t i, count, stored;
+	int key;
+
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+	/* As for page faults, no other thread may touch the page frames
+	 * while their contents are being written back.
+	 */
+	k_sched_lock();
+#endif /* CONFIG_DEMAND_PAGING_ALLOW_IRQ */
+	key = irq_lock();
+
+	count = 0;
+	for (i = 0; i < Z_NUM_PAGE_FRAMES &&
+		    count < CONFIG_DEMAND_PAGING_CLEANER_BATCH; i++) {
+		pf = &z_page_frames[page_cleaner_next];
+		page_cleaner_next = (page_cleaner_next + 1) % Z_NUM_PAGE_FRAMES;
+
+		if (page_frame_needs_cleaning(pf)) {
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+			pf->flags |= Z_PAGE_FRAME_BUSY;
+#endif
+			page_cleaner_batch[count++] = pf;
+		}
+	}
+
+	if (count == 0U) {
+		goto out;
+	}
+
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+	irq_unlock(key);
+#endif /* CONFIG_DEMAND_PAGING_ALLOW_IRQ */
+	stored = k_mem_paging_backing_store_page_out_batch(page_cleaner_batch,
+							   count);
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+	key = irq_lock();
+#endif /* CONFIG_DEMAND_PAGING_ALLOW_IRQ */
+
+	for (i = 0; i < count; i++) {
+		pf = page_cleaner_batch[i];
+		if (i < stored) {
+			/* Re-mapping the data page clears its dirty and
+			 * accessed bits, the latter being set again by the
+			 * backing store reading it.
+			 */
+			arch_mem_page_in(pf->addr, z_page_frame_to_phys(pf));
+		}
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+		pf->flags &= ~Z_PAGE_FRAME_BUSY;
+#endif
+	}
+
+#ifdef CONFIG_DEMAND_PAGING_STATS
+	if (stored > 0U) {
+		paging_stats.cleaner.pages += stored;
+		paging_stats.cleaner.batches++;
+	}
+#endif
+out:
+	irq_unlock(key);
+#ifdef CONFIG_DEMAND_PAGING_ALLOW_IRQ
+	k_sched_unlock();
+#endif /* CONFIG_DEMAND_PAGING_ALLOW_IRQ */
+}
+
+static void page_cleaner(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		(void)k_sem_take(&page_cleaner_sem,
+				 K_MSEC(CONFIG_DEMAND_PAGING_CLEANER_PERIOD));
+		page_cleaner_run();
+	}
+}
+
+static int page_cleaner_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_thread_create(&page_cleaner_thread, page_cleaner_stack,
+			K_KERNEL_STACK_SIZEOF(page_cleaner_stack),
+			page_cleaner, NULL, NULL, NULL,
+			CONFIG_DEMAND_PAGING_CLEANER_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&page_cleaner_thread, "page_cleaner");
+
+	return 0;
+}
+
+SYS_INIT(page_cleaner_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif /* CONFIG_DEMAND_PAGING_CLEANER */
+
 #endif /* CONFIG_DEMAND_PAGING */
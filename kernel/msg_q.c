@@ -42,6 +42,8 @@ void k_msgq_init(struct k_msgq *msgq, char *buffer, size_t msg_size,
 	msgq->read_ptr = buffer;
 	msgq->write_ptr = buffer;
 	msgq->used_msgs = 0;
+	msgq->reserved_msgs = 0;
+	msgq->claimed_msgs = 0;
 	msgq->flags = 0;
 	z_waitq_init(&msgq->wait_q);
 	msgq->lock = (struct k_spinlock) {};
@@ -125,7 +127,10 @@ int z_impl_k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout
 
 	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, put, msgq, timeout);
 
-	if (msgq->used_msgs < msgq->max_msgs) {
+	if (msgq->reserved_msgs > 0U) {
+		/* the reserved slots must be committed first */
+		result = -EBUSY;
+	} else if (msgq->used_msgs < msgq->max_msgs) {
 		/* message queue isn't full */
 		pending_thread = z_unpend_first_thread(&msgq->wait_q);
 		if (pending_thread != NULL) {
@@ -215,7 +220,10 @@ int z_impl_k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout)
 
 	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, get, msgq, timeout);
 
-	if (msgq->used_msgs > 0U) {
+	if (msgq->claimed_msgs > 0U) {
+		/* the claimed messages must be released first */
+		result = -EBUSY;
+	} else if (msgq->used_msgs > 0U) {
 		/* take first available message from queue */
 		(void)memcpy(data, msgq->read_ptr, msgq->msg_size);
 		msgq->read_ptr += msgq->msg_size;
@@ -315,6 +323,216 @@ static inline int z_vrfy_k_msgq_peek(struct k_msgq *msgq, void *data)
 #include <syscalls/k_msgq_peek_mrsh.c>
 #endif
 
+/*
+ * Zero-copy access. Reserved slots start at write_ptr and are not counted
+ * in used_msgs until they are committed, claimed messages start at
+ * read_ptr and stay counted in used_msgs until they are released. While
+ * slots are reserved other senders are turned away, and while messages are
+ * claimed other receivers are, so threads only ever wait for a completely
+ * full or empty ring as with the copying API.
+ */
+static inline char *next_slot(struct k_msgq *msgq, char *slot)
+{
+	slot += msgq->msg_size;
+	if (slot == msgq->buffer_end) {
+		slot = msgq->buffer_start;
+	}
+
+	return slot;
+}
+
+int k_msgq_alloc_put_batch(struct k_msgq *msgq, void **slots, uint32_t num)
+{
+	k_spinlock_key_t key;
+	char *slot;
+	uint32_t i;
+	int result;
+
+	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, alloc_put_batch, msgq);
+
+	CHECKIF(num == 0U) {
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, alloc_put_batch, msgq,
+					       -EINVAL);
+
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (msgq->reserved_msgs > 0U) {
+		result = -EBUSY;
+	} else if (msgq->used_msgs == msgq->max_msgs) {
+		result = -ENOMSG;
+	} else {
+		num = MIN(num, msgq->max_msgs - msgq->used_msgs);
+		slot = msgq->write_ptr;
+
+		for (i = 0U; i < num; i++) {
+			slots[i] = slot;
+			slot = next_slot(msgq, slot);
+		}
+
+		msgq->reserved_msgs = num;
+		result = num;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, alloc_put_batch, msgq, result);
+
+	return result;
+}
+
+int k_msgq_commit(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool resched = false;
+
+	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, commit, msgq);
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (msgq->reserved_msgs == 0U) {
+		k_spin_unlock(&msgq->lock, key);
+
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, commit, msgq, -EINVAL);
+
+		return -EINVAL;
+	}
+
+	for (; msgq->reserved_msgs > 0U; msgq->reserved_msgs--) {
+		msgq->write_ptr = next_slot(msgq, msgq->write_ptr);
+		msgq->used_msgs++;
+	}
+
+	/* give messages to waiting threads */
+	while (msgq->used_msgs > 0U) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		(void)memcpy(pending_thread->base.swap_data, msgq->read_ptr,
+			     msgq->msg_size);
+		msgq->read_ptr = next_slot(msgq, msgq->read_ptr);
+		msgq->used_msgs--;
+
+		arch_thread_return_value_set(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		resched = true;
+	}
+
+#ifdef CONFIG_POLL
+	if (msgq->used_msgs > 0U) {
+		handle_poll_events(msgq, K_POLL_STATE_MSGQ_DATA_AVAILABLE);
+	}
+#endif /* CONFIG_POLL */
+
+	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, commit, msgq, 0);
+
+	if (resched) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return 0;
+}
+
+int k_msgq_peek_claim_batch(struct k_msgq *msgq, void **slots, uint32_t num)
+{
+	k_spinlock_key_t key;
+	char *slot;
+	uint32_t i;
+	int result;
+
+	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, peek_claim_batch, msgq);
+
+	CHECKIF(num == 0U) {
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, peek_claim_batch, msgq,
+					       -EINVAL);
+
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (msgq->claimed_msgs > 0U) {
+		result = -EBUSY;
+	} else if (msgq->used_msgs == 0U) {
+		result = -ENOMSG;
+	} else {
+		num = MIN(num, msgq->used_msgs);
+		slot = msgq->read_ptr;
+
+		for (i = 0U; i < num; i++) {
+			slots[i] = slot;
+			slot = next_slot(msgq, slot);
+		}
+
+		msgq->claimed_msgs = num;
+		result = num;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, peek_claim_batch, msgq, result);
+
+	return result;
+}
+
+int k_msgq_release(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool resched = false;
+
+	SYS_PORT_TRACING_OBJ_FUNC_ENTER(k_msgq, release, msgq);
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (msgq->claimed_msgs == 0U) {
+		k_spin_unlock(&msgq->lock, key);
+
+		SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, release, msgq, -EINVAL);
+
+		return -EINVAL;
+	}
+
+	for (; msgq->claimed_msgs > 0U; msgq->claimed_msgs--) {
+		msgq->read_ptr = next_slot(msgq, msgq->read_ptr);
+		msgq->used_msgs--;
+	}
+
+	/* add messages of waiting threads to the queue */
+	while (msgq->used_msgs < msgq->max_msgs) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		(void)memcpy(msgq->write_ptr, pending_thread->base.swap_data,
+			     msgq->msg_size);
+		msgq->write_ptr = next_slot(msgq, msgq->write_ptr);
+		msgq->used_msgs++;
+
+		arch_thread_return_value_set(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		resched = true;
+	}
+
+	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_msgq, release, msgq, 0);
+
+	if (resched) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return 0;
+}
+
 void z_impl_k_msgq_purge(struct k_msgq *msgq)
 {
 	k_spinlock_key_t key;
@@ -331,6 +549,7 @@ void z_impl_k_msgq_purge(struct k_msgq *msgq)
 	}
 
 	msgq->used_msgs = 0;
+	msgq->claimed_msgs = 0;
 	msgq->read_ptr = msgq->write_ptr;
 
 	z_reschedule(&msgq->lock, key);
@@ -190,6 +190,26 @@ static inline int z_vrfy_k_mutex_lock(struct k_mutex *mutex,
 	return z_impl_k_mutex_lock(mutex, timeout);
 }
 #include <syscalls/k_mutex_lock_mrsh.c>
+
+int z_mutex_lock_for(struct k_mutex *mutex, struct k_thread *thread)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (mutex->lock_count != 0U) {
+		k_spin_unlock(&lock, key);
+		return -EBUSY;
+	}
+
+	mutex->owner_orig_prio = thread->base.prio;
+	mutex->lock_count = 1U;
+	mutex->owner = thread;
+
+	LOG_DBG("%p took mutex %p on behalf of %p", _current, mutex, thread);
+
+	k_spin_unlock(&lock, key);
+
+	return 0;
+}
 #endif
 
 int z_impl_k_mutex_unlock(struct k_mutex *mutex)
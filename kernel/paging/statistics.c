@@ -16,6 +16,7 @@ extern struct k_mem_paging_stats_t paging_stats;
 struct k_mem_paging_histogram_t z_paging_histogram_eviction;
 struct k_mem_paging_histogram_t z_paging_histogram_backing_store_page_in;
 struct k_mem_paging_histogram_t z_paging_histogram_backing_store_page_out;
+struct k_mem_paging_histogram_t z_paging_histogram_page_fault;
 
 #ifdef CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS
 
@@ -35,6 +36,10 @@ extern unsigned long
 k_mem_paging_backing_store_histogram_bounds[
 	CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM_NUM_BINS];
 
+extern unsigned long
+k_mem_paging_page_fault_histogram_bounds[
+	CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM_NUM_BINS];
+
 #else
 #define NS_TO_CYC(ns)		(CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC / 1000000U * ns)
 
@@ -73,6 +78,24 @@ k_mem_paging_backing_store_histogram_bounds[
 	NS_TO_CYC(10000),
 	ULONG_MAX
 };
+
+/*
+ * This provides the upper bounds of the bins in page fault timing histogram.
+ */
+__weak unsigned long
+k_mem_paging_page_fault_histogram_bounds[
+	CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM_NUM_BINS] = {
+	NS_TO_CYC(100),
+	NS_TO_CYC(250),
+	NS_TO_CYC(500),
+	NS_TO_CYC(1000),
+	NS_TO_CYC(2000),
+	NS_TO_CYC(5000),
+	NS_TO_CYC(10000),
+	NS_TO_CYC(20000),
+	NS_TO_CYC(50000),
+	ULONG_MAX
+};
 #endif /* CONFIG_DEMAND_PAGING_STATS_USING_TIMING_FUNCTIONS */
 #endif /* CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM */
 
@@ -160,6 +183,12 @@ void z_paging_histogram_init(void)
 	memcpy(z_paging_histogram_backing_store_page_out.bounds,
 	       k_mem_paging_backing_store_histogram_bounds,
 	       sizeof(z_paging_histogram_backing_store_page_out.bounds));
+
+	memset(&z_paging_histogram_page_fault, 0,
+	       sizeof(z_paging_histogram_page_fault));
+	memcpy(z_paging_histogram_page_fault.bounds,
+	       k_mem_paging_page_fault_histogram_bounds,
+	       sizeof(z_paging_histogram_page_fault.bounds));
 }
 
 /**
@@ -219,6 +248,18 @@ void z_impl_k_mem_paging_histogram_backing_store_page_out_get(
 	       sizeof(z_paging_histogram_backing_store_page_out));
 }
 
+void z_impl_k_mem_paging_histogram_page_fault_get(
+	struct k_mem_paging_histogram_t *hist)
+{
+	if (hist == NULL) {
+		return;
+	}
+
+	/* Copy histogram */
+	memcpy(hist, &z_paging_histogram_page_fault,
+	       sizeof(z_paging_histogram_page_fault));
+}
+
 #ifdef CONFIG_USERSPACE
 static inline
 void z_vrfy_k_mem_paging_histogram_eviction_get(
@@ -246,6 +287,15 @@ void z_vrfy_k_mem_paging_histogram_backing_store_page_out_get(
 	z_impl_k_mem_paging_histogram_backing_store_page_out_get(hist);
 }
 #include <syscalls/k_mem_paging_histogram_backing_store_page_out_get_mrsh.c>
+
+static inline
+void z_vrfy_k_mem_paging_histogram_page_fault_get(
+	struct k_mem_paging_histogram_t *hist)
+{
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(hist, sizeof(*hist)));
+	z_impl_k_mem_paging_histogram_page_fault_get(hist);
+}
+#include <syscalls/k_mem_paging_histogram_page_fault_get_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
 #endif /* CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM */
@@ -518,6 +518,9 @@ char *z_setup_new_thread(struct k_thread *new_thread,
 	z_object_init(stack);
 	new_thread->stack_obj = stack;
 	new_thread->syscall_frame = NULL;
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+	(void)memset(&new_thread->obj_cache, 0, sizeof(new_thread->obj_cache));
+#endif
 
 	/* Any given thread has access to itself */
 	k_object_access_grant(new_thread, new_thread);
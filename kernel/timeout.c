@@ -24,6 +24,10 @@ static struct k_spinlock timeout_lock;
 /* Cycles left to process in the currently-executing sys_clock_announce() */
 static int announce_remaining;
 
+#ifdef CONFIG_TIMEOUT_SLACK
+static struct sys_clock_slack_stats slack_stats;
+#endif
+
 #if defined(CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME)
 int z_clock_hw_cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
 
@@ -64,12 +68,41 @@ static int32_t elapsed(void)
 	return announce_remaining == 0 ? sys_clock_elapsed() : 0U;
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+/* Latest tick (relative to the last announcement) by which the
+ * timeouts at the head of the list must be served, which is the end of
+ * the tightest slack window among them.  Everything expiring up to
+ * that point is handled by a single announcement.  The list is sorted,
+ * so the walk stops at the first timeout beyond the window.
+ */
+static int64_t coalesced_expiry(struct _timeout *to)
+{
+	int64_t deadline = to->dticks;
+	int64_t latest = deadline + to->slack;
+
+	for (to = next(to); to != NULL; to = next(to)) {
+		deadline += to->dticks;
+		if (deadline > latest) {
+			break;
+		}
+		latest = MIN(latest, deadline + to->slack);
+	}
+
+	return latest;
+}
+#endif
+
 static int32_t next_timeout(void)
 {
 	struct _timeout *to = first();
 	int32_t ticks_elapsed = elapsed();
+#ifdef CONFIG_TIMEOUT_SLACK
+	int32_t ret = to == NULL ? MAX_WAIT
+		: CLAMP(coalesced_expiry(to) - ticks_elapsed, 0, MAX_WAIT);
+#else
 	int32_t ret = to == NULL ? MAX_WAIT
 		: CLAMP(to->dticks - ticks_elapsed, 0, MAX_WAIT);
+#endif
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -79,9 +112,11 @@ static int32_t next_timeout(void)
 	return ret;
 }
 
-void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
-		   k_timeout_t timeout)
+static void add_timeout(struct _timeout *to, _timeout_func_t fn,
+			k_timeout_t timeout, uint32_t slack)
 {
+	ARG_UNUSED(slack);
+
 	if (K_TIMEOUT_EQ(timeout, K_FOREVER)) {
 		return;
 	}
@@ -92,9 +127,13 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 
 	__ASSERT(!sys_dnode_is_linked(&to->node), "");
 	to->fn = fn;
+#ifdef CONFIG_TIMEOUT_SLACK
+	to->slack = slack;
+#endif
 
 	LOCKED(&timeout_lock) {
 		struct _timeout *t;
+		bool reprogram;
 
 		if (IS_ENABLED(CONFIG_TIMEOUT_64BIT) &&
 		    Z_TICK_ABS(timeout.ticks) >= 0) {
@@ -105,6 +144,10 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 			to->dticks = timeout.ticks + 1 + elapsed();
 		}
 
+#ifdef CONFIG_TIMEOUT_SLACK
+		int64_t deadline = to->dticks;
+#endif
+
 		for (t = first(); t != NULL; t = next(t)) {
 			if (t->dticks > to->dticks) {
 				t->dticks -= to->dticks;
@@ -118,7 +161,16 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 			sys_dlist_append(&timeout_list, &to->node);
 		}
 
-		if (to == first()) {
+		reprogram = to == first();
+#ifdef CONFIG_TIMEOUT_SLACK
+		/* A timeout with a tight slack may also pull in the
+		 * expiry of the earlier timeouts it is coalesced with
+		 */
+		reprogram = reprogram ||
+			    deadline <= coalesced_expiry(first());
+#endif
+
+		if (reprogram) {
 #if CONFIG_TIMESLICING
 			/*
 			 * This is not ideal, since it does not
@@ -141,6 +193,20 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 	}
 }
 
+void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
+		   k_timeout_t timeout)
+{
+	add_timeout(to, fn, timeout, 0);
+}
+
+#ifdef CONFIG_TIMEOUT_SLACK
+void z_add_timeout_slack(struct _timeout *to, _timeout_func_t fn,
+			 k_timeout_t timeout, uint32_t slack)
+{
+	add_timeout(to, fn, timeout, slack);
+}
+#endif
+
 int z_abort_timeout(struct _timeout *to)
 {
 	int ret = -EINVAL;
@@ -237,6 +303,9 @@ void sys_clock_announce(int32_t ticks)
 #endif
 
 	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
+#ifdef CONFIG_TIMEOUT_SLACK
+	bool served = false;
+#endif
 
 	announce_remaining = ticks;
 
@@ -244,6 +313,18 @@ void sys_clock_announce(int32_t ticks)
 		struct _timeout *t = first();
 		int dt = t->dticks;
 
+#ifdef CONFIG_TIMEOUT_SLACK
+		/* Timeouts expiring at a later tick than the previous
+		 * one would have needed a wakeup of their own
+		 */
+		if (!served) {
+			slack_stats.wakeups++;
+			served = true;
+		} else if (dt > 0) {
+			slack_stats.wakeups_avoided++;
+		}
+#endif
+
 		curr_tick += dt;
 		announce_remaining -= dt;
 		t->dticks = 0;
@@ -266,6 +347,15 @@ void sys_clock_announce(int32_t ticks)
 	k_spin_unlock(&timeout_lock, key);
 }
 
+#ifdef CONFIG_TIMEOUT_SLACK
+void sys_clock_slack_stats_get(struct sys_clock_slack_stats *stats)
+{
+	LOCKED(&timeout_lock) {
+		*stats = slack_stats;
+	}
+}
+#endif
+
 int64_t sys_clock_tick_get(void)
 {
 	uint64_t t = 0U;
@@ -32,8 +32,14 @@ void z_timer_expiration_handler(struct _timeout *t)
 	 */
 	if (!K_TIMEOUT_EQ(timer->period, K_NO_WAIT) &&
 	    !K_TIMEOUT_EQ(timer->period, K_FOREVER)) {
+#ifdef CONFIG_TIMEOUT_SLACK
+		z_add_timeout_slack(&timer->timeout,
+				    z_timer_expiration_handler,
+				    timer->period, timer->timeout.slack);
+#else
 		z_add_timeout(&timer->timeout, z_timer_expiration_handler,
 			     timer->period);
+#endif
 	}
 
 	/* update timer's status */
@@ -91,10 +97,10 @@ void k_timer_init(struct k_timer *timer,
 }
 
 
-void z_impl_k_timer_start(struct k_timer *timer, k_timeout_t duration,
-			  k_timeout_t period)
+static void timer_start(struct k_timer *timer, k_timeout_t duration,
+			k_timeout_t period, uint32_t slack)
 {
-	SYS_PORT_TRACING_OBJ_FUNC(k_timer, start, timer);
+	ARG_UNUSED(slack);
 
 	if (K_TIMEOUT_EQ(duration, K_FOREVER)) {
 		return;
@@ -125,8 +131,21 @@ void z_impl_k_timer_start(struct k_timer *timer, k_timeout_t duration,
 	timer->period = period;
 	timer->status = 0U;
 
+#ifdef CONFIG_TIMEOUT_SLACK
+	z_add_timeout_slack(&timer->timeout, z_timer_expiration_handler,
+			    duration, slack);
+#else
 	z_add_timeout(&timer->timeout, z_timer_expiration_handler,
 		     duration);
+#endif
+}
+
+void z_impl_k_timer_start(struct k_timer *timer, k_timeout_t duration,
+			  k_timeout_t period)
+{
+	SYS_PORT_TRACING_OBJ_FUNC(k_timer, start, timer);
+
+	timer_start(timer, duration, period, 0);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -140,6 +159,30 @@ static inline void z_vrfy_k_timer_start(struct k_timer *timer,
 #include <syscalls/k_timer_start_mrsh.c>
 #endif
 
+void z_impl_k_timer_start_slack(struct k_timer *timer, k_timeout_t duration,
+				k_timeout_t period, k_timeout_t slack)
+{
+	SYS_PORT_TRACING_OBJ_FUNC(k_timer, start, timer);
+
+	/* K_FOREVER and absolute timeouts make no sense here, and
+	 * are negative: treat them as no slack
+	 */
+	timer_start(timer, duration, period,
+		    MIN((uint64_t)MAX(slack.ticks, 0), UINT32_MAX));
+}
+
+#ifdef CONFIG_USERSPACE
+static inline void z_vrfy_k_timer_start_slack(struct k_timer *timer,
+					      k_timeout_t duration,
+					      k_timeout_t period,
+					      k_timeout_t slack)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(timer, K_OBJ_TIMER));
+	z_impl_k_timer_start_slack(timer, duration, period, slack);
+}
+#include <syscalls/k_timer_start_slack_mrsh.c>
+#endif
+
 void z_impl_k_timer_stop(struct k_timer *timer)
 {
 	SYS_PORT_TRACING_OBJ_FUNC(k_timer, stop, timer);
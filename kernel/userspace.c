@@ -52,6 +52,20 @@ static struct k_spinlock objfree_lock;     /* k_object_free */
 #endif
 static struct k_spinlock obj_lock;         /* kobj struct data */
 
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+/* Bumped whenever a thread may lose access to a kernel object, or one is
+ * freed, which invalidates the validation caches of all threads
+ */
+static atomic_t obj_cache_gen;
+#endif
+
+static inline void obj_cache_invalidate(void)
+{
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+	(void)atomic_inc(&obj_cache_gen);
+#endif
+}
+
 #define MAX_THREAD_BITS		(CONFIG_MAX_THREAD_BYTES * 8)
 
 #ifdef CONFIG_DYNAMIC_OBJECTS
@@ -401,6 +415,8 @@ void k_object_free(void *obj)
 		if (dyn->kobj.type == K_OBJ_THREAD) {
 			thread_idx_free(dyn->kobj.data.thread_id);
 		}
+
+		obj_cache_invalidate();
 	}
 	k_spin_unlock(&objfree_lock, key);
 
@@ -464,6 +480,7 @@ static void unref_check(struct z_object *ko, uintptr_t index)
 	k_spinlock_key_t key = k_spin_lock(&obj_lock);
 
 	sys_bitfield_clear_bit((mem_addr_t)&ko->perms, index);
+	obj_cache_invalidate();
 
 #ifdef CONFIG_DYNAMIC_OBJECTS
 	if ((ko->flags & K_OBJ_FLAG_ALLOC) == 0U) {
@@ -653,6 +670,26 @@ void k_object_access_all_grant(const void *object)
 	}
 }
 
+static int object_init_check(struct z_object *ko, enum _obj_init_check init)
+{
+	/* Initialization state checks. _OBJ_INIT_ANY, we don't care */
+	if (likely(init == _OBJ_INIT_TRUE)) {
+		/* Object MUST be initialized */
+		if (unlikely((ko->flags & K_OBJ_FLAG_INITIALIZED) == 0U)) {
+			return -EINVAL;
+		}
+	} else if (init == _OBJ_INIT_FALSE) { /* _OBJ_INIT_FALSE case */
+		/* Object MUST NOT be initialized */
+		if (unlikely((ko->flags & K_OBJ_FLAG_INITIALIZED) != 0U)) {
+			return -EADDRINUSE;
+		}
+	} else {
+		/* _OBJ_INIT_ANY */
+	}
+
+	return 0;
+}
+
 int z_object_validate(struct z_object *ko, enum k_objects otype,
 		       enum _obj_init_check init)
 {
@@ -668,23 +705,62 @@ int z_object_validate(struct z_object *ko, enum k_objects otype,
 		return -EPERM;
 	}
 
-	/* Initialization state checks. _OBJ_INIT_ANY, we don't care */
-	if (likely(init == _OBJ_INIT_TRUE)) {
-		/* Object MUST be initialized */
-		if (unlikely((ko->flags & K_OBJ_FLAG_INITIALIZED) == 0U)) {
-			return -EINVAL;
+	return object_init_check(ko, init);
+}
+
+#ifdef CONFIG_OBJ_VALIDATION_CACHE
+int z_object_validate_cached(const void *obj, enum k_objects otype,
+			     enum _obj_init_check init)
+{
+	struct _obj_validation_cache *cache = &_current->obj_cache;
+	uint32_t gen = (uint32_t)atomic_get(&obj_cache_gen);
+	struct z_object *ko = NULL;
+	int i, ret;
+
+	if (cache->gen != gen) {
+		/* Some thread lost access to some object since the entries
+		 * were validated, drop them all.
+		 */
+		(void)memset(cache, 0, sizeof(*cache));
+		cache->gen = gen;
+	}
+
+	for (i = 0; i < CONFIG_OBJ_VALIDATION_CACHE_SIZE; i++) {
+		if (cache->entries[i].obj == obj) {
+			ko = cache->entries[i].ko;
+			break;
 		}
-	} else if (init == _OBJ_INIT_FALSE) { /* _OBJ_INIT_FALSE case */
-		/* Object MUST NOT be initialized */
-		if (unlikely((ko->flags & K_OBJ_FLAG_INITIALIZED) != 0U)) {
-			return -EADDRINUSE;
+	}
+
+	if (likely(ko != NULL)) {
+		/* Access was granted, the object can't have changed type
+		 * but may have been initialized or uninitialized since.
+		 */
+		if (unlikely(otype != K_OBJ_ANY && ko->type != otype)) {
+			ret = -EBADF;
+		} else {
+			ret = object_init_check(ko, init);
 		}
 	} else {
-		/* _OBJ_INIT_ANY */
+		ko = z_object_find(obj);
+		ret = z_object_validate(ko, otype, init);
+		if (ret == 0) {
+			cache->entries[cache->next].obj = obj;
+			cache->entries[cache->next].ko = ko;
+			cache->next = (cache->next + 1U) %
+				      CONFIG_OBJ_VALIDATION_CACHE_SIZE;
+		}
 	}
 
-	return 0;
+#ifdef CONFIG_LOG
+	if (ret != 0) {
+		z_dump_object_error(ret, obj, ko, otype);
+	}
+#endif
+
+	return ret;
 }
+#endif /* CONFIG_OBJ_VALIDATION_CACHE */
 
 void z_object_init(const void *obj)
 {
@@ -717,6 +793,7 @@ void z_object_recycle(const void *obj)
 
 	if (ko != NULL) {
 		(void)memset(ko->perms, 0, sizeof(ko->perms));
+		obj_cache_invalidate();
 		z_thread_perms_set(ko, k_current_get());
 		ko->flags |= K_OBJ_FLAG_INITIALIZED;
 	}
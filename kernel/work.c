@@ -184,6 +184,9 @@ static void queue_flusher_locked(struct k_work_q *queue,
 	}
 
 	init_flusher(flusher);
+#ifdef CONFIG_WORKQUEUE_WORKERS
+	flusher->target = work;
+#endif
 	if (in_list) {
 		sys_slist_insert(&queue->pending, &work->node,
 				 &flusher->work.node);
@@ -207,6 +210,81 @@ static inline void queue_remove_locked(struct k_work_q *queue,
 	}
 }
 
+#ifdef CONFIG_WORKQUEUE_WORKERS
+/* Check whether the current thread is one of the threads of a queue.
+ *
+ * Invoked with work lock held.
+ */
+static bool is_queue_thread_locked(struct k_work_q *queue)
+{
+	struct k_work_q_worker *worker;
+
+	if (_current == &queue->thread) {
+		return true;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&queue->workers, worker, node) {
+		if (_current == &worker->thread) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Check whether a pending item may be started by a worker.
+ *
+ * An item resubmitted while running must wait until it completes, and so
+ * must a flusher for an item that is running.  With a single queue thread
+ * nothing is running while that thread looks for work, so this always
+ * holds.
+ *
+ * Invoked with work lock held.
+ */
+static bool work_runnable_locked(struct k_work *work)
+{
+	if (work->handler == handle_flush) {
+		work = CONTAINER_OF(work, struct z_work_flusher, work)->target;
+	}
+
+	return !flag_test(&work->flags, K_WORK_RUNNING_BIT);
+}
+#else
+static inline bool is_queue_thread_locked(struct k_work_q *queue)
+{
+	return _current == &queue->thread;
+}
+#endif
+
+/* Remove the next item to be run from a queue.
+ *
+ * Invoked with work lock held.
+ *
+ * @param queue the queue to take work from
+ *
+ * @return the node of the work item, or null if there is none that can
+ * run now
+ */
+static sys_snode_t *queue_get_locked(struct k_work_q *queue)
+{
+#ifdef CONFIG_WORKQUEUE_WORKERS
+	sys_snode_t *prev = NULL;
+	struct k_work *work;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&queue->pending, work, node) {
+		if (work_runnable_locked(work)) {
+			sys_slist_remove(&queue->pending, prev, &work->node);
+			return &work->node;
+		}
+		prev = &work->node;
+	}
+
+	return NULL;
+#else
+	return sys_slist_get(&queue->pending);
+#endif
+}
+
 /* Potentially notify a queue that it needs to look for pending work.
  *
  * This may make the work queue thread ready, but as the lock is held it
@@ -256,7 +334,7 @@ static inline int queue_submit_locked(struct k_work_q *queue,
 	}
 
 	int ret = -EBUSY;
-	bool chained = (_current == &queue->thread) && !k_is_in_isr();
+	bool chained = !k_is_in_isr() && is_queue_thread_locked(queue);
 	bool draining = flag_test(&queue->flags, K_WORK_QUEUE_DRAIN_BIT);
 	bool plugged = flag_test(&queue->flags, K_WORK_QUEUE_PLUGGED_BIT);
 
@@ -393,6 +471,46 @@ int k_work_submit(struct k_work *work)
 	return ret;
 }
 
+int k_work_submit_to_queue_batch(struct k_work_q *queue,
+				 struct k_work *const works[], size_t count)
+{
+	__ASSERT_NO_MSG((works != NULL) || (count == 0U));
+
+	bool queued = false;
+	int ret = 0;
+	size_t i;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	for (i = 0; i < count; i++) {
+		struct k_work_q *wq = queue;
+
+		__ASSERT_NO_MSG(works[i] != NULL);
+
+		ret = submit_to_queue_locked(works[i], &wq);
+		if (ret < 0) {
+			break;
+		}
+
+		queued = queued || (ret > 0);
+	}
+
+	k_spin_unlock(&lock, key);
+
+	/* As in k_work_submit_to_queue(), but only once for the whole
+	 * batch.
+	 */
+	if (queued && (k_is_preempt_thread() != 0)) {
+		k_yield();
+	}
+
+	return (i > 0U) ? (int)i : ret;
+}
+
+int k_work_submit_batch(struct k_work *const works[], size_t count)
+{
+	return k_work_submit_to_queue_batch(&k_sys_work_q, works, count);
+}
+
 /* Flush the work item if necessary.
  *
  * Flushing is necessary only if the work is either queued or running.
@@ -589,12 +707,15 @@ static void work_queue_main(void *workq_ptr, void *p2, void *p3)
 		bool yield;
 
 		/* Check for and prepare any new work. */
-		node = sys_slist_get(&queue->pending);
+		node = queue_get_locked(queue);
 		if (node != NULL) {
 			/* Mark that there's some work active that's
 			 * not on the pending list.
 			 */
 			flag_set(&queue->flags, K_WORK_QUEUE_BUSY_BIT);
+#ifdef CONFIG_WORKQUEUE_WORKERS
+			queue->running++;
+#endif
 			work = CONTAINER_OF(node, struct k_work, node);
 			flag_set(&work->flags, K_WORK_RUNNING_BIT);
 			flag_clear(&work->flags, K_WORK_QUEUED_BIT);
@@ -612,7 +733,8 @@ static void work_queue_main(void *workq_ptr, void *p2, void *p3)
 			 * This means that if node is not NULL, then work will not be NULL.
 			 */
 			handler = work->handler;
-		} else if (flag_test_and_clear(&queue->flags,
+		} else if (!flag_test(&queue->flags, K_WORK_QUEUE_BUSY_BIT) &&
+			   flag_test_and_clear(&queue->flags,
 					       K_WORK_QUEUE_DRAIN_BIT)) {
 			/* Not busy and draining: move threads waiting for
 			 * drain to ready state.  The held spinlock inhibits
@@ -660,7 +782,20 @@ static void work_queue_main(void *workq_ptr, void *p2, void *p3)
 			finalize_cancel_locked(work);
 		}
 
+#ifdef CONFIG_WORKQUEUE_WORKERS
+		if (--queue->running == 0U) {
+			flag_clear(&queue->flags, K_WORK_QUEUE_BUSY_BIT);
+		}
+
+		/* Items held back while this one was running may have
+		 * become runnable: let an idle worker have a look too.
+		 */
+		if (!sys_slist_is_empty(&queue->pending)) {
+			(void)notify_queue_locked(queue);
+		}
+#else
 		flag_clear(&queue->flags, K_WORK_QUEUE_BUSY_BIT);
+#endif
 		yield = !flag_test(&queue->flags, K_WORK_QUEUE_NO_YIELD_BIT);
 		k_spin_unlock(&lock, key);
 
@@ -700,6 +835,13 @@ void k_work_queue_start(struct k_work_q *queue,
 	sys_slist_init(&queue->pending);
 	z_waitq_init(&queue->notifyq);
 	z_waitq_init(&queue->drainq);
+#ifdef CONFIG_WORKQUEUE_WORKERS
+	/* The primary thread is queue->thread, the list only holds the
+	 * threads added with k_work_queue_add_worker().
+	 */
+	sys_slist_init(&queue->workers);
+	queue->running = 0U;
+#endif
 
 	if ((cfg != NULL) && cfg->no_yield) {
 		flags |= K_WORK_QUEUE_NO_YIELD;
@@ -724,6 +866,80 @@ void k_work_queue_start(struct k_work_q *queue,
 	SYS_PORT_TRACING_OBJ_FUNC_EXIT(k_work_queue, start, queue);
 }
 
+#ifdef CONFIG_WORKQUEUE_WORKERS
+int k_work_queue_add_worker(struct k_work_q *queue,
+			    struct k_work_q_worker *worker,
+			    k_thread_stack_t *stack, size_t stack_size,
+			    int cpu)
+{
+	__ASSERT_NO_MSG(queue);
+	__ASSERT_NO_MSG(worker);
+	__ASSERT_NO_MSG(stack);
+
+	k_spinlock_key_t key;
+	const char *name;
+	bool started;
+	int ret = 0;
+
+	key = k_spin_lock(&lock);
+	started = flag_test(&queue->flags, K_WORK_QUEUE_STARTED_BIT);
+	k_spin_unlock(&lock, key);
+
+	if (!started) {
+		return -ENODEV;
+	}
+
+	if (cpu >= CONFIG_MP_NUM_CPUS) {
+		return -EINVAL;
+	}
+
+	(void)k_thread_create(&worker->thread, stack, stack_size,
+			      work_queue_main, queue, NULL, NULL,
+			      k_thread_priority_get(&queue->thread), 0,
+			      K_FOREVER);
+
+	if (cpu >= 0) {
+#ifdef CONFIG_SCHED_CPU_MASK
+		ret = k_thread_cpu_mask_clear(&worker->thread);
+		if (ret == 0) {
+			ret = k_thread_cpu_mask_enable(&worker->thread, cpu);
+		}
+#else
+		ret = -ENOTSUP;
+#endif
+		if (ret != 0) {
+			k_thread_abort(&worker->thread);
+			return ret;
+		}
+	}
+
+	name = k_thread_name_get(&queue->thread);
+	if (name != NULL) {
+		(void)k_thread_name_set(&worker->thread, name);
+	}
+
+	key = k_spin_lock(&lock);
+	sys_slist_append(&queue->workers, &worker->node);
+	k_spin_unlock(&lock, key);
+
+	k_thread_start(&worker->thread);
+
+	return 0;
+}
+#endif /* CONFIG_WORKQUEUE_WORKERS */
+
+bool k_work_queue_is_worker(struct k_work_q *queue)
+{
+	__ASSERT_NO_MSG(queue);
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	bool ret = is_queue_thread_locked(queue);
+
+	k_spin_unlock(&lock, key);
+
+	return ret;
+}
+
 int k_work_queue_drain(struct k_work_q *queue,
 		       bool plug)
 {
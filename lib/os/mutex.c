@@ -8,6 +8,20 @@
 #include <sys/mutex.h>
 #include <syscall_handler.h>
 #include <kernel_structs.h>
+#include <kernel_internal.h>
+
+/* sys_mutex::val is zero when the mutex is free and holds the owner's
+ * thread ID when it was locked with atomic ops. Once the mutex becomes
+ * contended it is handed over to the backing k_mutex, which provides
+ * priority inheritance, and val holds SYS_MUTEX_CONTENDED plus one
+ * SYS_MUTEX_REF for every thread that owns or waits for the k_mutex.
+ * Thread IDs are at least word aligned so they never have the low bit set.
+ */
+#define SYS_MUTEX_CONTENDED	BIT(0)
+#define SYS_MUTEX_REF		BIT(1)
+
+/* Serializes the transitions between the atomic and the kernel mode */
+static struct k_spinlock lock;
 
 static struct k_mutex *get_k_mutex(struct sys_mutex *mutex)
 {
@@ -23,22 +37,111 @@ static struct k_mutex *get_k_mutex(struct sys_mutex *mutex)
 
 static bool check_sys_mutex_addr(struct sys_mutex *addr)
 {
-	/* sys_mutex memory is never touched, just used to lookup the
-	 * underlying k_mutex, but we don't want threads using mutexes
-	 * that are outside their memory domain
+	/* sys_mutex memory holds the lock state and is also used to lookup
+	 * the underlying k_mutex, we don't want threads using mutexes that
+	 * are outside their memory domain
 	 */
 	return Z_SYSCALL_MEMORY_WRITE(addr, sizeof(struct sys_mutex));
 }
 
+/* The owner ID lives in user memory, any thread could have written it.
+ * Only accept a thread the caller was granted access to, a caller could
+ * otherwise make the kernel boost the priority of any thread.
+ */
+static bool owner_valid(struct k_thread *owner)
+{
+	return z_object_validate(z_object_find(owner), K_OBJ_THREAD,
+				 _OBJ_INIT_TRUE) == 0;
+}
+
+static void put_ref(struct sys_mutex *mutex)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	/* Nobody owns or waits for the kernel mutex any more, go back to
+	 * locking with atomic ops
+	 */
+	if (atomic_sub(&mutex->val, SYS_MUTEX_REF) ==
+	    (SYS_MUTEX_CONTENDED | SYS_MUTEX_REF)) {
+		atomic_set(&mutex->val, 0);
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
 int z_impl_z_sys_mutex_kernel_lock(struct sys_mutex *mutex, k_timeout_t timeout)
 {
 	struct k_mutex *kernel_mutex = get_k_mutex(mutex);
+	struct k_thread *owner;
+	k_spinlock_key_t key;
+	atomic_val_t val;
+	int ret;
 
 	if (kernel_mutex == NULL) {
 		return -EINVAL;
 	}
 
-	return k_mutex_lock(kernel_mutex, timeout);
+	key = k_spin_lock(&lock);
+
+	for (;;) {
+		val = atomic_get(&mutex->val);
+
+		if (val == 0) {
+			if (atomic_cas(&mutex->val, 0, (atomic_val_t)_current)) {
+				k_spin_unlock(&lock, key);
+				return 0;
+			}
+
+			continue;
+		}
+
+		if ((val & SYS_MUTEX_CONTENDED) != 0) {
+			atomic_add(&mutex->val, SYS_MUTEX_REF);
+			break;
+		}
+
+		owner = (struct k_thread *)val;
+
+		if (owner != _current && K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			k_spin_unlock(&lock, key);
+			return -EBUSY;
+		}
+
+		if (owner != _current && !owner_valid(owner)) {
+			k_spin_unlock(&lock, key);
+			return -EINVAL;
+		}
+
+		/* The owner took the mutex with atomic ops. Make it the owner
+		 * of the kernel mutex as well so that it inherits the
+		 * priority of the waiters.
+		 */
+		if (!atomic_cas(&mutex->val, val,
+				SYS_MUTEX_CONTENDED | SYS_MUTEX_REF)) {
+			continue;
+		}
+
+		if (z_mutex_lock_for(kernel_mutex, owner) != 0) {
+			/* Nobody owns the kernel mutex on behalf of the atomic
+			 * owner, give the mutex back to it. The owner cannot
+			 * unlock meanwhile as its slow path needs the lock.
+			 */
+			(void)atomic_cas(&mutex->val,
+					 SYS_MUTEX_CONTENDED | SYS_MUTEX_REF,
+					 val);
+			k_spin_unlock(&lock, key);
+			return -EINVAL;
+		}
+	}
+
+	k_spin_unlock(&lock, key);
+
+	ret = k_mutex_lock(kernel_mutex, timeout);
+	if (ret != 0) {
+		put_ref(mutex);
+	}
+
+	return ret;
 }
 
 static inline int z_vrfy_z_sys_mutex_kernel_lock(struct sys_mutex *mutex,
@@ -55,12 +158,44 @@ static inline int z_vrfy_z_sys_mutex_kernel_lock(struct sys_mutex *mutex,
 int z_impl_z_sys_mutex_kernel_unlock(struct sys_mutex *mutex)
 {
 	struct k_mutex *kernel_mutex = get_k_mutex(mutex);
+	k_spinlock_key_t key;
+	atomic_val_t val;
+	int ret;
+
+	if (kernel_mutex == NULL) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&lock);
+
+	val = atomic_get(&mutex->val);
+
+	if ((val & SYS_MUTEX_CONTENDED) == 0) {
+		if (val == 0) {
+			ret = -EINVAL;
+		} else if (val != (atomic_val_t)_current) {
+			ret = -EPERM;
+		} else {
+			atomic_set(&mutex->val, 0);
+			ret = 0;
+		}
 
-	if (kernel_mutex == NULL || kernel_mutex->lock_count == 0) {
+		k_spin_unlock(&lock, key);
+		return ret;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	if (kernel_mutex->lock_count == 0) {
 		return -EINVAL;
 	}
 
-	return k_mutex_unlock(kernel_mutex);
+	ret = k_mutex_unlock(kernel_mutex);
+	if (ret == 0) {
+		put_ref(mutex);
+	}
+
+	return ret;
 }
 
 static inline int z_vrfy_z_sys_mutex_kernel_unlock(struct sys_mutex *mutex)
@@ -347,3 +347,306 @@ uint32_t ring_buf_peek(struct ring_buf *buf, uint8_t *data, uint32_t size)
 
 	return total_size;
 }
+
+/* The producer publishes its data by storing the tail with release
+ * semantics and the consumer reads the tail with acquire semantics before
+ * touching the data, and likewise the other way around for the head. This
+ * is all the ordering the lock-free ring buffers need, and it is free on
+ * strongly ordered CPUs.
+ */
+static inline uint32_t load_acquire(const uint32_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(uint32_t *ptr, uint32_t val)
+{
+	__atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+uint32_t ring_buf_spsc_size_get(struct ring_buf_spsc *buf)
+{
+	uint32_t head = load_acquire(&buf->cons.head);
+
+	return load_acquire(&buf->prod.tail) - head;
+}
+
+uint32_t ring_buf_spsc_put_claim(struct ring_buf_spsc *buf, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t tmp_tail = buf->prod.tmp_tail;
+	uint32_t offset = tmp_tail & buf->mask;
+	uint32_t space = buf->size - (tmp_tail - buf->prod.head);
+
+	/* Only fetch the consumer's cache line when the last known head does
+	 * not leave enough room.
+	 */
+	if (space < size) {
+		buf->prod.head = load_acquire(&buf->cons.head);
+		space = buf->size - (tmp_tail - buf->prod.head);
+	}
+
+	size = MIN(size, space);
+	size = MIN(size, buf->size - offset);
+
+	*data = &buf->buf[offset];
+	buf->prod.tmp_tail = tmp_tail + size;
+
+	return size;
+}
+
+int ring_buf_spsc_put_finish(struct ring_buf_spsc *buf, uint32_t size)
+{
+	uint32_t tail = buf->prod.tail;
+
+	if (size > buf->prod.tmp_tail - tail) {
+		return -EINVAL;
+	}
+
+	tail += size;
+	buf->prod.tmp_tail = tail;
+	store_release(&buf->prod.tail, tail);
+
+	return 0;
+}
+
+uint32_t ring_buf_spsc_put(struct ring_buf_spsc *buf, const uint8_t *data,
+			   uint32_t size)
+{
+	uint8_t *dst;
+	uint32_t partial_size;
+	uint32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = ring_buf_spsc_put_claim(buf, &dst, size);
+		memcpy(dst, data, partial_size);
+		total_size += partial_size;
+		size -= partial_size;
+		data += partial_size;
+	} while (size && partial_size);
+
+	err = ring_buf_spsc_put_finish(buf, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+uint32_t ring_buf_spsc_get_claim(struct ring_buf_spsc *buf, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t tmp_head = buf->cons.tmp_head;
+	uint32_t offset = tmp_head & buf->mask;
+	uint32_t avail = buf->cons.tail - tmp_head;
+
+	if (avail < size) {
+		buf->cons.tail = load_acquire(&buf->prod.tail);
+		avail = buf->cons.tail - tmp_head;
+	}
+
+	size = MIN(size, avail);
+	size = MIN(size, buf->size - offset);
+
+	*data = &buf->buf[offset];
+	buf->cons.tmp_head = tmp_head + size;
+
+	return size;
+}
+
+int ring_buf_spsc_get_finish(struct ring_buf_spsc *buf, uint32_t size)
+{
+	uint32_t head = buf->cons.head;
+
+	if (size > buf->cons.tmp_head - head) {
+		return -EINVAL;
+	}
+
+	head += size;
+	buf->cons.tmp_head = head;
+	store_release(&buf->cons.head, head);
+
+	return 0;
+}
+
+uint32_t ring_buf_spsc_get(struct ring_buf_spsc *buf, uint8_t *data,
+			   uint32_t size)
+{
+	uint8_t *src;
+	uint32_t partial_size;
+	uint32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = ring_buf_spsc_get_claim(buf, &src, size);
+		if (data) {
+			memcpy(data, src, partial_size);
+			data += partial_size;
+		}
+		total_size += partial_size;
+		size -= partial_size;
+	} while (size && partial_size);
+
+	err = ring_buf_spsc_get_finish(buf, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+/*
+ * The MPMC ring follows the bounded queue design by Dmitry Vyukov. The slot
+ * used for position pos goes through these sequence numbers, where lap is
+ * pos rounded down to a multiple of the ring size:
+ *
+ *   lap           free, may be claimed by the producer of pos
+ *   lap + 1       filled, may be claimed by the consumer of pos
+ *   lap + count   free, may be claimed by the producer of pos + count
+ *
+ * Counting laps instead of positions lets a zeroed sequence array describe
+ * an empty ring. A producer or consumer first checks the sequence number of
+ * the slots following its index and then moves the index past the ready
+ * ones with a compare and swap. Nobody else touches claimed slots until
+ * they are finished, so the data itself needs no atomic operations.
+ */
+static inline uint32_t mpmc_lap(struct ring_buf_mpmc *buf, uint32_t pos)
+{
+	return pos & ~buf->mask;
+}
+
+static uint32_t mpmc_claim(struct ring_buf_mpmc *buf, atomic_t *index,
+			   uint32_t ready, void **data, uint32_t num)
+{
+	atomic_val_t old;
+	uint32_t pos, idx, seq, max, n;
+	int32_t diff;
+
+	*data = buf->buf;
+
+	if (num == 0U) {
+		return 0U;
+	}
+
+	do {
+		old = atomic_get(index);
+		pos = (uint32_t)old;
+		idx = pos & buf->mask;
+
+		seq = load_acquire(&buf->seq[idx]);
+		diff = (int32_t)(seq - (mpmc_lap(buf, pos) + ready));
+		if (diff < 0) {
+			/* Slot not handed over yet: full or empty */
+			return 0U;
+		}
+
+		/* Otherwise somebody else claimed pos in the meantime */
+		n = 0U;
+		if (diff == 0) {
+			/* Claimed slots must not wrap */
+			max = MIN(num, buf->count - idx);
+
+			for (n = 1U; n < max; n++) {
+				seq = load_acquire(&buf->seq[idx + n]);
+				if (seq != mpmc_lap(buf, pos) + ready) {
+					break;
+				}
+			}
+		}
+	} while (n == 0U || !atomic_cas(index, old, (atomic_val_t)(pos + n)));
+
+	*data = &buf->buf[idx * buf->elem_size];
+
+	return n;
+}
+
+static int mpmc_finish(struct ring_buf_mpmc *buf, void *data, uint32_t num,
+		       uint32_t step)
+{
+	uint32_t offset, idx, i;
+
+	if ((uint8_t *)data < buf->buf) {
+		return -EINVAL;
+	}
+
+	offset = (uint8_t *)data - buf->buf;
+	idx = offset / buf->elem_size;
+
+	if ((offset % buf->elem_size) || (idx >= buf->count) ||
+	    (num > buf->count - idx)) {
+		return -EINVAL;
+	}
+
+	for (i = idx; i < idx + num; i++) {
+		store_release(&buf->seq[i], buf->seq[i] + step);
+	}
+
+	return 0;
+}
+
+uint32_t ring_buf_mpmc_put_claim(struct ring_buf_mpmc *buf, void **data,
+				 uint32_t num)
+{
+	return mpmc_claim(buf, &buf->tail, 0U, data, num);
+}
+
+int ring_buf_mpmc_put_finish(struct ring_buf_mpmc *buf, void *data,
+			     uint32_t num)
+{
+	return mpmc_finish(buf, data, num, 1U);
+}
+
+uint32_t ring_buf_mpmc_put(struct ring_buf_mpmc *buf, const void *data,
+			   uint32_t num)
+{
+	const uint8_t *src = data;
+	uint32_t partial_num;
+	uint32_t total_num = 0U;
+	void *dst;
+	int err;
+
+	do {
+		partial_num = ring_buf_mpmc_put_claim(buf, &dst, num);
+		memcpy(dst, src, partial_num * buf->elem_size);
+		err = ring_buf_mpmc_put_finish(buf, dst, partial_num);
+		__ASSERT_NO_MSG(err == 0);
+		total_num += partial_num;
+		num -= partial_num;
+		src += partial_num * buf->elem_size;
+	} while (num && partial_num);
+
+	return total_num;
+}
+
+uint32_t ring_buf_mpmc_get_claim(struct ring_buf_mpmc *buf, void **data,
+				 uint32_t num)
+{
+	return mpmc_claim(buf, &buf->head, 1U, data, num);
+}
+
+int ring_buf_mpmc_get_finish(struct ring_buf_mpmc *buf, void *data,
+			     uint32_t num)
+{
+	return mpmc_finish(buf, data, num, buf->count - 1U);
+}
+
+uint32_t ring_buf_mpmc_get(struct ring_buf_mpmc *buf, void *data,
+			   uint32_t num)
+{
+	uint8_t *dst = data;
+	uint32_t partial_num;
+	uint32_t total_num = 0U;
+	void *src;
+	int err;
+
+	do {
+		partial_num = ring_buf_mpmc_get_claim(buf, &src, num);
+		if (dst) {
+			memcpy(dst, src, partial_num * buf->elem_size);
+			dst += partial_num * buf->elem_size;
+		}
+		err = ring_buf_mpmc_get_finish(buf, src, partial_num);
+		__ASSERT_NO_MSG(err == 0);
+		total_num += partial_num;
+		num -= partial_num;
+	} while (num && partial_num);
+
+	return total_num;
+}
@@ -66,6 +66,21 @@ void k_mem_paging_backing_store_page_in(uintptr_t location)
 		     CONFIG_MMU_PAGE_SIZE);
 }
 
+size_t k_mem_paging_backing_store_page_out_batch(struct z_page_frame *pfs[],
+						 size_t count)
+{
+	size_t i;
+
+	/* Each data page has its own location, so there is always room */
+	for (i = 0; i < count; i++) {
+		(void)memcpy(location_to_flash(POINTER_TO_UINT(pfs[i]->addr)),
+			     pfs[i]->addr, CONFIG_MMU_PAGE_SIZE);
+		pfs[i]->flags |= Z_PAGE_FRAME_BACKED;
+	}
+
+	return count;
+}
+
 void k_mem_paging_backing_store_page_finalize(struct z_page_frame *pf,
 					      uintptr_t location)
 {
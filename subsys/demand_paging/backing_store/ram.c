@@ -25,36 +25,65 @@
  * 2) A backing store that has limited storage space, and is not sufficiently
  *    large to hold clean copies of all mapped memory.
  *
- * This backing store is an example of the latter case. However, locations
- * are freed as soon as pages are paged in, in
- * k_mem_paging_backing_store_page_finalize().
- * This implies that all data pages are treated as dirty as
- * Z_PAGE_FRAME_BACKED is never set, even if the data page was paged out before
- * and not modified since then.
+ * This backing store is an example of the latter case. Locations are freed
+ * as soon as pages are paged in, in k_mem_paging_backing_store_page_finalize().
+ * Without CONFIG_DEMAND_PAGING_CLEANER this implies that all data pages are
+ * treated as dirty, as Z_PAGE_FRAME_BACKED is never set, even if the data
+ * page was paged out before and not modified since then.
  *
- * An optimization a real backing store will want is have
- * k_mem_paging_backing_store_page_finalize() note the storage location of
- * a paged-in data page in a custom field of its associated z_page_frame, and
- * set the Z_PAGE_FRAME_BACKED bit. Invocations of
- * k_mem_paging_backing_store_location_get() will have logic to return
- * the previous clean page location instead of allocating
- * a new one if Z_PAGE_FRAME_BACKED is set.
+ * With CONFIG_DEMAND_PAGING_CLEANER, the page cleaner thread writes dirty
+ * data pages out ahead of time through
+ * k_mem_paging_backing_store_page_out_batch(), which keeps the location of
+ * each clean copy for its page frame and sets Z_PAGE_FRAME_BACKED. Evicting
+ * such a page frame reuses that location instead of allocating a new one.
+ * Clean copies count as free space: when no location is free, the location
+ * of a backed page frame is reclaimed and its Z_PAGE_FRAME_BACKED bit
+ * cleared, which is the clean page eviction a real backing store of this
+ * kind needs as well.
  *
- * This will, however, require the implementation of a clean page
- * eviction algorithm, to free backing store locations for loaded data pages
- * as the backing store fills up, and clear the Z_PAGE_FRAME_BACKED bit
- * appropriately.
- *
- * All of this logic is local to the backing store implementation; from the
- * core kernel's perspective the only change is that Z_PAGE_FRAME_BACKED
- * starts getting set for certain page frames after a page-in (and possibly
- * cleared at a later time).
+ * Besides calling k_mem_paging_backing_store_page_out_batch(), the kernel
+ * only sees Z_PAGE_FRAME_BACKED getting set for certain page frames and
+ * cleared again at a later time; the rest is local to the backing store.
  */
 static char backing_store[CONFIG_MMU_PAGE_SIZE *
 			  CONFIG_BACKING_STORE_RAM_PAGES];
 static struct k_mem_slab backing_slabs;
 static unsigned int free_slabs;
 
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+/*
+ * With the page cleaner, clean copies of loaded data pages are kept after
+ * k_mem_paging_backing_store_page_out_batch(), and their locations recorded
+ * here for the page frames which have Z_PAGE_FRAME_BACKED set. The kernel
+ * only asks for the location of a backed page frame when paging it out, at
+ * which point the clean copy becomes the paged out data page.
+ *
+ * Clean copies count as free space: once no location is free, they are
+ * reclaimed, still keeping one location for page faults.
+ */
+static uintptr_t backed_locations[Z_NUM_PAGE_FRAMES];
+static unsigned int backed_slabs;
+
+static int backed_location_reclaim(uintptr_t *location)
+{
+	uintptr_t phys;
+	struct z_page_frame *pf;
+
+	Z_PAGE_FRAME_FOREACH(phys, pf) {
+		if (z_page_frame_is_backed(pf) && !z_page_frame_is_busy(pf)) {
+			pf->flags &= ~Z_PAGE_FRAME_BACKED;
+			*location = backed_locations[pf - z_page_frames];
+			backed_slabs--;
+			return 0;
+		}
+	}
+
+	__ASSERT(false, "backed page frame count mismatch");
+
+	return -ENOMEM;
+}
+#endif /* CONFIG_DEMAND_PAGING_CLEANER */
+
 static void *location_to_slab(uintptr_t location)
 {
 	__ASSERT(location % CONFIG_MMU_PAGE_SIZE == 0,
@@ -81,9 +110,7 @@ static uintptr_t slab_to_location(void *slab)
 	return offset;
 }
 
-int k_mem_paging_backing_store_location_get(struct z_page_frame *pf,
-					    uintptr_t *location,
-					    bool page_fault)
+static int location_alloc(uintptr_t *location, bool page_fault)
 {
 	int ret;
 	void *slab;
@@ -101,6 +128,32 @@ int k_mem_paging_backing_store_location_get(struct z_page_frame *pf,
 	return 0;
 }
 
+int k_mem_paging_backing_store_location_get(struct z_page_frame *pf,
+					    uintptr_t *location,
+					    bool page_fault)
+{
+	int ret;
+
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	if (z_page_frame_is_backed(pf)) {
+		*location = backed_locations[pf - z_page_frames];
+		backed_slabs--;
+		return 0;
+	}
+#endif
+
+	ret = location_alloc(location, page_fault);
+
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	if (ret != 0 &&
+	    free_slabs + backed_slabs > (page_fault ? 0U : 1U)) {
+		ret = backed_location_reclaim(location);
+	}
+#endif
+
+	return ret;
+}
+
 void k_mem_paging_backing_store_location_free(uintptr_t location)
 {
 	void *slab = location_to_slab(location);
@@ -121,6 +174,34 @@ void k_mem_paging_backing_store_page_in(uintptr_t location)
 		     CONFIG_MMU_PAGE_SIZE);
 }
 
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+size_t k_mem_paging_backing_store_page_out_batch(struct z_page_frame *pfs[],
+						 size_t count)
+{
+	uintptr_t location;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (z_page_frame_is_backed(pfs[i])) {
+			/* Dirtied again since it was last stored */
+			location = backed_locations[pfs[i] - z_page_frames];
+		} else if (location_alloc(&location, false) == 0) {
+			backed_slabs++;
+		} else {
+			/* Clean copies never reclaim each other's locations */
+			break;
+		}
+
+		(void)memcpy(location_to_slab(location), pfs[i]->addr,
+			     CONFIG_MMU_PAGE_SIZE);
+		backed_locations[pfs[i] - z_page_frames] = location;
+		pfs[i]->flags |= Z_PAGE_FRAME_BACKED;
+	}
+
+	return i;
+}
+#endif /* CONFIG_DEMAND_PAGING_CLEANER */
+
 void k_mem_paging_backing_store_page_finalize(struct z_page_frame *pf,
 					      uintptr_t location)
 {
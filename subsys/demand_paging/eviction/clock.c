@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * CLOCK (second chance) eviction algorithm for demand paging
+ */
+#include <kernel.h>
+#include <mmu.h>
+#include <kernel_arch_interface.h>
+
+/* Index of the page frame the clock hand points at. Page frames from the
+ * hand onwards were least recently given a second chance, so the search for
+ * a victim starts there and the hand is left right after the victim.
+ *
+ * Each page frame passed over has its accessed state cleared, so at most
+ * one full turn is needed to find a victim, and on average the hand only
+ * advances by the number of page frames which have been accessed since it
+ * last went past them.
+ */
+static size_t clock_hand;
+
+static inline void clock_hand_advance(void)
+{
+	clock_hand++;
+	if (clock_hand == Z_NUM_PAGE_FRAMES) {
+		clock_hand = 0;
+	}
+}
+
+struct z_page_frame *k_mem_paging_eviction_select(bool *dirty_ptr)
+{
+	struct z_page_frame *pf;
+	uintptr_t flags;
+	size_t i;
+
+	/* Two turns cover the case where every page frame was accessed */
+	for (i = 0; i < 2 * Z_NUM_PAGE_FRAMES; i++) {
+		pf = &z_page_frames[clock_hand];
+		clock_hand_advance();
+
+		if (!z_page_frame_is_evictable(pf)) {
+			continue;
+		}
+
+		flags = arch_page_info_get(pf->addr, NULL, false);
+
+		/* Implies a mismatch with page frame ontology and page
+		 * tables
+		 */
+		__ASSERT((flags & ARCH_DATA_PAGE_LOADED) != 0U,
+			 "non-present page, %s",
+			 ((flags & ARCH_DATA_PAGE_NOT_MAPPED) != 0U) ?
+			 "un-mapped" : "paged out");
+
+		if ((flags & ARCH_DATA_PAGE_ACCESSED) != 0UL) {
+			/* Second chance */
+			(void)z_page_frame_accessed_clear(pf);
+			continue;
+		}
+
+		*dirty_ptr = (flags & ARCH_DATA_PAGE_DIRTY) != 0UL;
+
+		return pf;
+	}
+
+	/* Shouldn't ever happen unless every page is pinned */
+	__ASSERT(false, "no page to evict");
+
+	return NULL;
+}
+
+void k_mem_paging_eviction_init(void)
+{
+	clock_hand = 0;
+}
@@ -13,6 +13,8 @@
 #include <errno.h>
 #include <device.h>
 
+#include "disk_cache.h"
+
 #define LOG_LEVEL CONFIG_DISK_LOG_LEVEL
 #include <logging/log.h>
 LOG_MODULE_REGISTER(disk);
@@ -53,6 +55,37 @@ struct disk_info *disk_access_get_di(const char *name)
 	return disk;
 }
 
+#if defined(CONFIG_DISK_CACHE)
+/* The cache of a disk is read under the lock protecting the disk list, so
+ * that it can be attached and detached while the disk is accessed.
+ */
+struct disk_cache *disk_cache_get(struct disk_info *disk)
+{
+	struct disk_cache *cache;
+
+	k_mutex_lock(&mutex, K_FOREVER);
+	cache = disk->cache;
+	k_mutex_unlock(&mutex);
+
+	return cache;
+}
+
+bool disk_cache_set(struct disk_info *disk, struct disk_cache *old,
+		    struct disk_cache *cache)
+{
+	bool set;
+
+	k_mutex_lock(&mutex, K_FOREVER);
+	set = (disk->cache == old);
+	if (set) {
+		disk->cache = cache;
+	}
+	k_mutex_unlock(&mutex);
+
+	return set;
+}
+#endif
+
 int disk_access_init(const char *pdrv)
 {
 	struct disk_info *disk = disk_access_get_di(pdrv);
@@ -87,6 +120,14 @@ int disk_access_read(const char *pdrv, uint8_t *data_buf,
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->read != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		struct disk_cache *cache = disk_cache_get(disk);
+
+		if (cache != NULL) {
+			return disk_cache_read(disk, cache, data_buf,
+					       start_sector, num_sector);
+		}
+#endif
 		rc = disk->ops->read(disk, data_buf, start_sector, num_sector);
 	}
 
@@ -101,6 +142,14 @@ int disk_access_write(const char *pdrv, const uint8_t *data_buf,
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->write != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		struct disk_cache *cache = disk_cache_get(disk);
+
+		if (cache != NULL) {
+			return disk_cache_write(disk, cache, data_buf,
+						start_sector, num_sector);
+		}
+#endif
 		rc = disk->ops->write(disk, data_buf, start_sector, num_sector);
 	}
 
@@ -114,6 +163,16 @@ int disk_access_ioctl(const char *pdrv, uint8_t cmd, void *buf)
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->ioctl != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		struct disk_cache *cache = disk_cache_get(disk);
+
+		if ((cache != NULL) && (cmd == DISK_IOCTL_CTRL_SYNC)) {
+			rc = disk_cache_sync(disk, cache);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+#endif
 		rc = disk->ops->ioctl(disk, cmd, buf);
 	}
 
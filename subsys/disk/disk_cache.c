@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+#include <sys/util.h>
+#include <storage/disk_access.h>
+
+#include "disk_cache.h"
+
+#define LOG_LEVEL CONFIG_DISK_LOG_LEVEL
+#include <logging/log.h>
+LOG_MODULE_DECLARE(disk);
+
+/* Requests larger than this bypass the cache, so that streaming a file
+ * does not evict everything else.
+ */
+static uint32_t bypass_threshold(struct disk_cache *cache)
+{
+	return cache->num_sectors / 2U;
+}
+
+static uint8_t *entry_data(struct disk_cache *cache,
+			   struct disk_cache_entry *entry)
+{
+	return &cache->data[(entry - cache->entries) * cache->sector_size];
+}
+
+static struct disk_cache_entry *cache_find(struct disk_cache *cache,
+					   uint32_t sector)
+{
+	for (uint32_t i = 0; i < cache->num_sectors; i++) {
+		struct disk_cache_entry *entry = &cache->entries[i];
+
+		if (entry->valid && entry->sector == sector) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void cache_touch(struct disk_cache *cache,
+			struct disk_cache_entry *entry)
+{
+	entry->last_use = ++cache->clock;
+}
+
+static int cache_write_back(struct disk_info *disk,
+			    struct disk_cache_entry *entry)
+{
+	struct disk_cache *cache = disk->cache;
+	int rc;
+
+	rc = disk->ops->write(disk, entry_data(cache, entry), entry->sector, 1);
+	if (rc < 0) {
+		LOG_ERR("Failed to write back sector %u (%d)", entry->sector,
+			rc);
+		return rc;
+	}
+
+	entry->dirty = false;
+	cache->stats.write_backs++;
+
+	return 0;
+}
+
+/* Take a free entry or evict the least recently used one, writing it back
+ * first if it was modified.
+ */
+static int cache_alloc(struct disk_info *disk, uint32_t sector,
+		       struct disk_cache_entry **entry)
+{
+	struct disk_cache *cache = disk->cache;
+	struct disk_cache_entry *victim = NULL;
+	int rc;
+
+	for (uint32_t i = 0; i < cache->num_sectors; i++) {
+		struct disk_cache_entry *itr = &cache->entries[i];
+
+		if (!itr->valid) {
+			victim = itr;
+			break;
+		}
+
+		if (victim == NULL ||
+		    (int32_t)(itr->last_use - victim->last_use) < 0) {
+			victim = itr;
+		}
+	}
+
+	if (victim->valid && victim->dirty) {
+		rc = cache_write_back(disk, victim);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+
+	victim->sector = sector;
+	victim->valid = true;
+	victim->dirty = false;
+	cache_touch(cache, victim);
+	*entry = victim;
+
+	return 0;
+}
+
+/* Sectors modified in the cache are newer than those read from the disk */
+static void cache_overlay_dirty(struct disk_cache *cache, uint8_t *data_buf,
+				uint32_t start_sector, uint32_t num_sector)
+{
+	for (uint32_t i = 0; i < cache->num_sectors; i++) {
+		struct disk_cache_entry *entry = &cache->entries[i];
+		uint32_t offset = entry->sector - start_sector;
+
+		if (entry->valid && entry->dirty &&
+		    entry->sector >= start_sector && offset < num_sector) {
+			memcpy(&data_buf[offset * cache->sector_size],
+			       entry_data(cache, entry), cache->sector_size);
+		}
+	}
+}
+
+/* Read a missing sector into the cache. When it follows the previously read
+ * sector, the following sectors are read along with it in the same request.
+ */
+static int cache_fill(struct disk_info *disk, uint32_t sector,
+		      struct disk_cache_entry **entry)
+{
+	struct disk_cache *cache = disk->cache;
+	struct disk_cache_entry *ra_entry;
+	uint32_t count = 1U;
+	int rc;
+
+	if (sector == cache->next_sector) {
+		count = MIN(CONFIG_DISK_CACHE_READ_AHEAD + 1U,
+			    bypass_threshold(cache));
+		count = MIN(count, cache->disk_sectors - sector);
+		count = MAX(count, 1U);
+	}
+
+	if (count == 1U) {
+		rc = cache_alloc(disk, sector, entry);
+		if (rc < 0) {
+			return rc;
+		}
+
+		rc = disk->ops->read(disk, entry_data(cache, *entry), sector, 1);
+		if (rc < 0) {
+			(*entry)->valid = false;
+		}
+
+		return rc;
+	}
+
+	rc = disk->ops->read(disk, cache->ra_buf, sector, count);
+	if (rc < 0) {
+		return rc;
+	}
+
+	/* Cached sectors of the window may be written back and evicted while
+	 * the others are inserted, so bring the buffer up to date first.
+	 */
+	cache_overlay_dirty(cache, cache->ra_buf, sector, count);
+
+	/* Insert the following sectors first, so that the requested one is
+	 * the most recently used.
+	 */
+	for (uint32_t i = count - 1U; i > 0U; i--) {
+		if (cache_find(cache, sector + i) != NULL) {
+			continue;
+		}
+
+		rc = cache_alloc(disk, sector + i, &ra_entry);
+		if (rc < 0) {
+			return rc;
+		}
+
+		memcpy(entry_data(cache, ra_entry),
+		       &cache->ra_buf[i * cache->sector_size],
+		       cache->sector_size);
+		cache->stats.read_ahead++;
+	}
+
+	rc = cache_alloc(disk, sector, entry);
+	if (rc < 0) {
+		return rc;
+	}
+
+	memcpy(entry_data(cache, *entry), cache->ra_buf, cache->sector_size);
+
+	return 0;
+}
+
+/* Bring cached copies of sectors written directly to the disk up to date */
+static void cache_update(struct disk_cache *cache, const uint8_t *data_buf,
+			 uint32_t start_sector, uint32_t num_sector)
+{
+	for (uint32_t i = 0; i < cache->num_sectors; i++) {
+		struct disk_cache_entry *entry = &cache->entries[i];
+		uint32_t offset = entry->sector - start_sector;
+
+		if (entry->valid && entry->sector >= start_sector &&
+		    offset < num_sector) {
+			memcpy(entry_data(cache, entry),
+			       &data_buf[offset * cache->sector_size],
+			       cache->sector_size);
+			entry->dirty = false;
+		}
+	}
+}
+
+static int cache_read_direct(struct disk_info *disk, uint8_t *data_buf,
+			     uint32_t start_sector, uint32_t num_sector)
+{
+	struct disk_cache *cache = disk->cache;
+	int rc;
+
+	rc = disk->ops->read(disk, data_buf, start_sector, num_sector);
+	if (rc < 0) {
+		return rc;
+	}
+
+	cache_overlay_dirty(cache, data_buf, start_sector, num_sector);
+	cache->stats.misses += num_sector;
+
+	return 0;
+}
+
+/* The cache of a disk is looked up without its lock held, check that it
+ * has not been detached meanwhile. Called with the cache lock held.
+ */
+static bool cache_attached(struct disk_info *disk, struct disk_cache *cache)
+{
+	return disk_cache_get(disk) == cache;
+}
+
+int disk_cache_read(struct disk_info *disk, struct disk_cache *cache,
+		    uint8_t *data_buf, uint32_t start_sector,
+		    uint32_t num_sector)
+{
+	struct disk_cache_entry *entry;
+	int rc = 0;
+
+	k_mutex_lock(&cache->lock, K_FOREVER);
+
+	if (!cache_attached(disk, cache)) {
+		rc = disk->ops->read(disk, data_buf, start_sector, num_sector);
+		goto out;
+	}
+
+	if (num_sector > bypass_threshold(cache)) {
+		rc = cache_read_direct(disk, data_buf, start_sector,
+				       num_sector);
+		cache->next_sector = start_sector + num_sector;
+		goto out;
+	}
+
+	for (uint32_t i = 0; i < num_sector; i++) {
+		uint32_t sector = start_sector + i;
+
+		entry = cache_find(cache, sector);
+		if (entry != NULL) {
+			cache_touch(cache, entry);
+			cache->stats.hits++;
+		} else {
+			rc = cache_fill(disk, sector, &entry);
+			if (rc < 0) {
+				break;
+			}
+
+			cache->stats.misses++;
+		}
+
+		memcpy(&data_buf[i * cache->sector_size],
+		       entry_data(cache, entry), cache->sector_size);
+		cache->next_sector = sector + 1U;
+	}
+
+out:
+	k_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
+int disk_cache_write(struct disk_info *disk, struct disk_cache *cache,
+		     const uint8_t *data_buf, uint32_t start_sector,
+		     uint32_t num_sector)
+{
+	struct disk_cache_entry *entry;
+	int rc = 0;
+
+	k_mutex_lock(&cache->lock, K_FOREVER);
+
+	if (!cache_attached(disk, cache)) {
+		rc = disk->ops->write(disk, data_buf, start_sector, num_sector);
+		goto out;
+	}
+
+	if (!IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK) ||
+	    num_sector > bypass_threshold(cache)) {
+		rc = disk->ops->write(disk, data_buf, start_sector, num_sector);
+		if (rc == 0) {
+			cache_update(cache, data_buf, start_sector, num_sector);
+		}
+
+		goto out;
+	}
+
+	for (uint32_t i = 0; i < num_sector; i++) {
+		uint32_t sector = start_sector + i;
+
+		entry = cache_find(cache, sector);
+		if (entry != NULL) {
+			cache_touch(cache, entry);
+		} else {
+			rc = cache_alloc(disk, sector, &entry);
+			if (rc < 0) {
+				break;
+			}
+		}
+
+		memcpy(entry_data(cache, entry),
+		       &data_buf[i * cache->sector_size], cache->sector_size);
+		entry->dirty = true;
+	}
+
+out:
+	k_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
+/* Write back modified sectors in ascending order, which lets drivers with
+ * their own buffering, such as the flash disk, merge them.
+ */
+static int cache_flush(struct disk_info *disk)
+{
+	struct disk_cache *cache = disk->cache;
+	struct disk_cache_entry *next;
+	int rc;
+
+	do {
+		next = NULL;
+
+		for (uint32_t i = 0; i < cache->num_sectors; i++) {
+			struct disk_cache_entry *entry = &cache->entries[i];
+
+			if (entry->valid && entry->dirty &&
+			    (next == NULL || entry->sector < next->sector)) {
+				next = entry;
+			}
+		}
+
+		if (next != NULL) {
+			rc = cache_write_back(disk, next);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+	} while (next != NULL);
+
+	return 0;
+}
+
+int disk_cache_sync(struct disk_info *disk, struct disk_cache *cache)
+{
+	int rc = 0;
+
+	k_mutex_lock(&cache->lock, K_FOREVER);
+	if (cache_attached(disk, cache)) {
+		rc = cache_flush(disk);
+	}
+	k_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
+int disk_access_cache_attach(const char *pdrv, struct disk_cache *cache)
+{
+	struct disk_info *disk = disk_access_get_di(pdrv);
+	uint32_t sector_size;
+	int rc;
+
+	if ((disk == NULL) || (disk->ops == NULL) ||
+	    (disk->ops->read == NULL) || (disk->ops->write == NULL) ||
+	    (disk->ops->ioctl == NULL)) {
+		return -EINVAL;
+	}
+
+	if (disk_cache_get(disk) != NULL) {
+		return -EBUSY;
+	}
+
+	rc = disk->ops->ioctl(disk, DISK_IOCTL_GET_SECTOR_SIZE, &sector_size);
+	if (rc < 0) {
+		return rc;
+	}
+
+	if (sector_size != cache->sector_size) {
+		LOG_ERR("Disk %s has %u byte sectors, cache has %u", pdrv,
+			sector_size, cache->sector_size);
+		return -EINVAL;
+	}
+
+	rc = disk->ops->ioctl(disk, DISK_IOCTL_GET_SECTOR_COUNT,
+			      &cache->disk_sectors);
+	if (rc < 0) {
+		return rc;
+	}
+
+	k_mutex_lock(&cache->lock, K_FOREVER);
+	memset(cache->entries, 0,
+	       cache->num_sectors * sizeof(struct disk_cache_entry));
+	memset(&cache->stats, 0, sizeof(cache->stats));
+	cache->clock = 0U;
+	cache->next_sector = UINT32_MAX;
+	rc = disk_cache_set(disk, NULL, cache) ? 0 : -EBUSY;
+	k_mutex_unlock(&cache->lock);
+
+	if (rc < 0) {
+		return rc;
+	}
+
+	LOG_DBG("Cache of %u sectors attached to disk %s", cache->num_sectors,
+		pdrv);
+
+	return 0;
+}
+
+int disk_access_cache_detach(const char *pdrv)
+{
+	struct disk_info *disk = disk_access_get_di(pdrv);
+	struct disk_cache *cache;
+	int rc;
+
+	if (disk == NULL) {
+		return -EINVAL;
+	}
+
+	cache = disk_cache_get(disk);
+	if (cache == NULL) {
+		return -EINVAL;
+	}
+
+	/* accesses in progress complete first, later ones find the cache
+	 * detached and go to the disk
+	 */
+	k_mutex_lock(&cache->lock, K_FOREVER);
+	if (!cache_attached(disk, cache)) {
+		rc = -EINVAL;
+	} else {
+		rc = cache_flush(disk);
+		if (rc == 0) {
+			(void)disk_cache_set(disk, cache, NULL);
+		}
+	}
+	k_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
+int disk_access_cache_stats_get(const char *pdrv,
+				struct disk_cache_stats *stats)
+{
+	struct disk_info *disk = disk_access_get_di(pdrv);
+	struct disk_cache *cache;
+
+	if (disk == NULL) {
+		return -EINVAL;
+	}
+
+	cache = disk_cache_get(disk);
+	if (cache == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&cache->lock, K_FOREVER);
+	*stats = cache->stats;
+	k_mutex_unlock(&cache->lock);
+
+	return 0;
+}
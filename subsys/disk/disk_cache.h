@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_
+#define ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_
+
+#include <drivers/disk.h>
+
+struct disk_info *disk_access_get_di(const char *name);
+
+struct disk_cache *disk_cache_get(struct disk_info *disk);
+
+bool disk_cache_set(struct disk_info *disk, struct disk_cache *old,
+		    struct disk_cache *cache);
+
+int disk_cache_read(struct disk_info *disk, struct disk_cache *cache,
+		    uint8_t *data_buf, uint32_t start_sector,
+		    uint32_t num_sector);
+
+int disk_cache_write(struct disk_info *disk, struct disk_cache *cache,
+		     const uint8_t *data_buf, uint32_t start_sector,
+		     uint32_t num_sector);
+
+int disk_cache_sync(struct disk_info *disk, struct disk_cache *cache);
+
+#endif /* ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_ */
@@ -13,7 +13,9 @@
 #include <fs/fs.h>
 #include <fs/fs_sys.h>
 #include <sys/__assert.h>
+#include <sys/byteorder.h>
 #include <ff.h>
+#include <diskio.h>
 
 #define FATFS_MAX_FILE_NAME 12 /* Uses 8.3 SFN */
 
@@ -81,11 +83,616 @@ static uint8_t translate_flags(fs_mode_t flags)
 	return fat_mode;
 }
 
+#if defined(CONFIG_FS_FATFS_FREE_MAP)
+
+#if FF_MAX_SS != FF_MIN_SS
+#define FATFS_SS(fs) ((fs)->ssize)
+#else
+#define FATFS_SS(fs) FF_MIN_SS
+#endif
+
+#define FREE_MAP_NO_SECT ((LBA_t)-1)
+
+/* Largest set of entries registering a single directory entry can take */
+#if FF_USE_LFN
+#define FREE_MAP_MAX_ENTRY_SIZE (32 * (DIV_ROUND_UP(FF_MAX_LFN, 13) + 1))
+#else
+#define FREE_MAP_MAX_ENTRY_SIZE 32
+#endif
+
+/*
+ * Map of the free clusters of a mounted FAT16 or FAT32 volume, with one bit
+ * per cluster, set when the cluster is free. The work queue below builds it
+ * by reading the FAT a few sectors at a time; FAT entries from 'scanned' on
+ * have not been read yet. The operations of this driver keep the part
+ * already read up to date, and hold the lock while they call FatFs, so that
+ * the FAT is never read while FatFs is changing it.
+ */
+struct fatfs_free_map {
+	FATFS *fs;
+	struct k_mutex lock;
+	struct k_condvar built;
+	struct k_work work;
+	uint32_t *bits;
+	uint32_t scanned;
+	/* Number of free clusters below 'scanned' */
+	uint32_t free_cnt;
+	/* For finding the first cluster of files being unlinked */
+	FIL *fil;
+	/* Last FAT sector read for lookups of single entries */
+	uint8_t *sect_buf;
+	LBA_t buf_sect;
+};
+
+static K_HEAP_DEFINE(free_map_heap, CONFIG_FS_FATFS_FREE_MAP_HEAP_SIZE);
+static K_THREAD_STACK_DEFINE(free_map_stack,
+			     CONFIG_FS_FATFS_FREE_MAP_STACK_SIZE);
+static struct k_work_q free_map_wq;
+static struct fatfs_free_map free_maps[FF_VOLUMES];
+static uint8_t scan_buf[CONFIG_FS_FATFS_FREE_MAP_SCAN_SECTORS * FF_MAX_SS];
+
+static inline bool free_map_active(const struct fatfs_free_map *map)
+{
+	return map != NULL && map->fs != NULL;
+}
+
+static inline bool free_map_built(const struct fatfs_free_map *map)
+{
+	return map->scanned == map->fs->n_fatent;
+}
+
+static inline uint32_t fat_entries_per_sect(const FATFS *fs)
+{
+	return FATFS_SS(fs) / (fs->fs_type == FS_FAT16 ? 2 : 4);
+}
+
+static uint32_t fat_entry(const FATFS *fs, const uint8_t *sect, uint32_t idx)
+{
+	if (fs->fs_type == FS_FAT16) {
+		return sys_get_le16(&sect[idx * 2]);
+	}
+
+	return sys_get_le32(&sect[idx * 4]) & 0x0FFFFFFF;
+}
+
+static int free_map_get_fat(struct fatfs_free_map *map, uint32_t clst,
+			    uint32_t *val)
+{
+	FATFS *fs = map->fs;
+	uint32_t per_sect = fat_entries_per_sect(fs);
+	LBA_t sect = fs->fatbase + clst / per_sect;
+	const uint8_t *buf = map->sect_buf;
+
+	/* The window of FatFs may hold changes not written to the disk yet */
+	if (sect == fs->winsect) {
+		buf = fs->win;
+	} else if (sect != map->buf_sect) {
+		map->buf_sect = FREE_MAP_NO_SECT;
+		if (disk_read(fs->pdrv, map->sect_buf, sect, 1) != RES_OK) {
+			return -EIO;
+		}
+		map->buf_sect = sect;
+	}
+
+	*val = fat_entry(fs, buf, clst % per_sect);
+
+	return 0;
+}
+
+static void free_map_set(struct fatfs_free_map *map, uint32_t clst, bool free)
+{
+	uint32_t *word, mask;
+
+	/* Clusters not read yet get their state when they are */
+	if (clst < 2 || clst >= map->scanned) {
+		return;
+	}
+
+	word = &map->bits[clst / 32];
+	mask = BIT(clst % 32);
+
+	if (free && (*word & mask) == 0) {
+		*word |= mask;
+		map->free_cnt++;
+	} else if (!free && (*word & mask) != 0) {
+		*word &= ~mask;
+		map->free_cnt--;
+	}
+}
+
+/* Find the first free cluster from clst on, wrapping around to the start */
+static uint32_t free_map_next(struct fatfs_free_map *map, uint32_t clst)
+{
+	uint32_t words = DIV_ROUND_UP(map->fs->n_fatent, 32);
+	uint32_t i, word;
+
+	if (map->free_cnt == 0) {
+		return 0;
+	}
+
+	if (clst < 2 || clst >= map->fs->n_fatent) {
+		clst = 2;
+	}
+
+	i = clst / 32;
+	word = map->bits[i] & ~BIT_MASK(clst % 32);
+
+	for (uint32_t n = 0; n <= words; n++) {
+		if (word != 0) {
+			return i * 32 + find_lsb_set(word) - 1;
+		}
+
+		i = (i + 1 == words) ? 0 : i + 1;
+		word = map->bits[i];
+	}
+
+	return 0;
+}
+
+/*
+ * Mark the clusters of a chain, from clst up to and including last, or up
+ * to the end of the chain if last is 0.
+ */
+static int free_map_walk(struct fatfs_free_map *map, uint32_t clst,
+			 uint32_t last, bool free)
+{
+	uint32_t steps = map->fs->n_fatent;
+	uint32_t next;
+
+	while (clst >= 2 && clst < map->fs->n_fatent && steps-- > 0) {
+		if (free_map_get_fat(map, clst, &next) != 0) {
+			return -EIO;
+		}
+
+		free_map_set(map, clst, free);
+		if (clst == last) {
+			break;
+		}
+
+		clst = next;
+	}
+
+	return 0;
+}
+
+static void free_map_drop(struct fatfs_free_map *map)
+{
+	if (map->fs == NULL) {
+		return;
+	}
+
+	k_heap_free(&free_map_heap, map->fil);
+	map->fs = NULL;
+	k_condvar_broadcast(&map->built);
+}
+
+static void free_map_scan(struct k_work *work)
+{
+	struct fatfs_free_map *map = CONTAINER_OF(work, struct fatfs_free_map,
+						  work);
+	uint32_t per_sect, clst, idx;
+	const uint8_t *buf;
+	FATFS *fs;
+	LBA_t sect;
+	UINT ss, cnt;
+
+	k_mutex_lock(&map->lock, K_FOREVER);
+
+	fs = map->fs;
+	if (fs == NULL || free_map_built(map)) {
+		k_mutex_unlock(&map->lock);
+		return;
+	}
+
+	ss = FATFS_SS(fs);
+	per_sect = fat_entries_per_sect(fs);
+	clst = map->scanned;
+	sect = fs->fatbase + clst / per_sect;
+	cnt = MIN(sizeof(scan_buf) / ss,
+		  DIV_ROUND_UP(fs->n_fatent, per_sect) - clst / per_sect);
+
+	if (disk_read(fs->pdrv, scan_buf, sect, cnt) != RES_OK) {
+		/* Leave counting free clusters to FatFs */
+		free_map_drop(map);
+		k_mutex_unlock(&map->lock);
+		return;
+	}
+
+	for (UINT i = 0; i < cnt; i++) {
+		buf = (sect + i == fs->winsect) ? fs->win : &scan_buf[i * ss];
+
+		for (idx = clst % per_sect;
+		     idx < per_sect && clst < fs->n_fatent; idx++, clst++) {
+			if (fat_entry(fs, buf, idx) == 0) {
+				map->bits[clst / 32] |= BIT(clst % 32);
+				map->free_cnt++;
+			}
+		}
+	}
+
+	map->scanned = clst;
+
+	if (free_map_built(map)) {
+		/*
+		 * FatFs keeps the count from here on. It may have been read
+		 * from an FSINFO sector not updated before a reset.
+		 */
+		if (fs->free_clst != map->free_cnt) {
+			fs->free_clst = map->free_cnt;
+			fs->fsi_flag |= 1;
+		}
+		k_condvar_broadcast(&map->built);
+	} else {
+		(void)k_work_submit_to_queue(&free_map_wq, &map->work);
+	}
+
+	k_mutex_unlock(&map->lock);
+}
+
+static void free_map_rebuild(struct fatfs_free_map *map)
+{
+	(void)memset(map->bits, 0,
+		     DIV_ROUND_UP(map->fs->n_fatent, 32) * sizeof(uint32_t));
+	map->scanned = 2U;
+	map->free_cnt = 0U;
+
+	(void)k_work_submit_to_queue(&free_map_wq, &map->work);
+}
+
+static void free_map_create(struct fs_mount_t *mountp)
+{
+	FATFS *fs = mountp->fs_data;
+	struct fatfs_free_map *map = &free_maps[fs->pdrv];
+	size_t fil_size = ROUND_UP(sizeof(FIL), sizeof(uint32_t));
+	size_t bits_size = DIV_ROUND_UP(fs->n_fatent, 32) * sizeof(uint32_t);
+	uint8_t *mem;
+
+	/* FAT12 volumes are small, and exFAT has a map of its own */
+	if (fs->fs_type != FS_FAT16 && fs->fs_type != FS_FAT32) {
+		return;
+	}
+
+	mem = k_heap_alloc(&free_map_heap, fil_size + bits_size + FATFS_SS(fs),
+			   K_NO_WAIT);
+	if (mem == NULL) {
+		return;
+	}
+
+	k_mutex_lock(&map->lock, K_FOREVER);
+	map->fil = (FIL *)mem;
+	map->bits = (uint32_t *)&mem[fil_size];
+	map->sect_buf = &mem[fil_size + bits_size];
+	map->fs = fs;
+	free_map_rebuild(map);
+	k_mutex_unlock(&map->lock);
+}
+
+static void free_map_destroy(struct fs_mount_t *mountp)
+{
+	FATFS *fs = mountp->fs_data;
+	struct fatfs_free_map *map = &free_maps[fs->pdrv];
+	struct k_work_sync sync;
+
+	k_mutex_lock(&map->lock, K_FOREVER);
+	if (map->fs != fs) {
+		k_mutex_unlock(&map->lock);
+		return;
+	}
+	free_map_drop(map);
+	k_mutex_unlock(&map->lock);
+
+	(void)k_work_cancel_sync(&map->work, &sync);
+}
+
+static struct fatfs_free_map *free_map_lock(struct fs_mount_t *mountp)
+{
+	FATFS *fs = mountp->fs_data;
+	struct fatfs_free_map *map = &free_maps[fs->pdrv];
+
+	k_mutex_lock(&map->lock, K_FOREVER);
+	if (map->fs != fs) {
+		k_mutex_unlock(&map->lock);
+		return NULL;
+	}
+
+	/* FatFs may have written the sector since it was read */
+	map->buf_sect = FREE_MAP_NO_SECT;
+
+	return map;
+}
+
+static void free_map_unlock(struct fatfs_free_map *map, FRESULT res)
+{
+	if (map == NULL) {
+		return;
+	}
+
+	/* The FAT may have been left partially updated */
+	if (res == FR_DISK_ERR || res == FR_INT_ERR) {
+		free_map_drop(map);
+	}
+
+	k_mutex_unlock(&map->lock);
+}
+
+/* Wait for the map to be built, so that FatFs does not scan the FAT */
+static void free_map_wait(struct fatfs_free_map *map)
+{
+	while (free_map_active(map) && !free_map_built(map)) {
+		(void)k_condvar_wait(&map->built, &map->lock, K_FOREVER);
+	}
+}
+
+static uint32_t free_map_last(struct fatfs_free_map *map)
+{
+	return free_map_active(map) ? map->fs->last_clst : 0;
+}
+
+/*
+ * Point the allocation hint of FatFs, the last cluster allocated, just
+ * before the next free cluster, where FatFs would otherwise have to search
+ * the FAT for it.
+ */
+static void free_map_hint(struct fatfs_free_map *map)
+{
+	uint32_t next;
+
+	if (!free_map_active(map) || !free_map_built(map)) {
+		return;
+	}
+
+	next = free_map_next(map, map->fs->last_clst + 1);
+	if (next != 0) {
+		map->fs->last_clst = next - 1;
+	}
+}
+
+/*
+ * Mark the clusters a file write has added to the chain of the file, given
+ * the current cluster of the file before the write.
+ */
+static void free_map_track_file(struct fatfs_free_map *map, FIL *fp,
+				uint32_t clst)
+{
+	uint32_t next = fp->obj.sclust;
+
+	if (!free_map_active(map) || fp->clust == clst) {
+		return;
+	}
+
+	if ((clst != 0 && free_map_get_fat(map, clst, &next) != 0) ||
+	    free_map_walk(map, next, fp->clust, false) != 0) {
+		free_map_drop(map);
+	}
+}
+
+/*
+ * Mark the clusters a directory has been extended with to register a new
+ * entry, given the last cluster allocated before. Registering an entry
+ * adds a single cluster to a directory unless the clusters are smaller
+ * than the longest entry; the map is then built again instead.
+ */
+static void free_map_track_entry(struct fatfs_free_map *map, uint32_t last,
+				 FRESULT res)
+{
+	FATFS *fs;
+
+	if (!free_map_active(map) || map->fs->last_clst == last) {
+		return;
+	}
+
+	fs = map->fs;
+	if (res == FR_OK &&
+	    fs->csize * FATFS_SS(fs) >= FREE_MAP_MAX_ENTRY_SIZE) {
+		free_map_set(map, fs->last_clst, false);
+	} else {
+		free_map_rebuild(map);
+	}
+}
+
+static void free_map_track_mkdir(struct fatfs_free_map *map, const char *path,
+				 uint32_t last, FRESULT res)
+{
+	DIR dir;
+
+	if (!free_map_active(map) || res != FR_OK) {
+		free_map_track_entry(map, last, res);
+		return;
+	}
+
+	if (f_opendir(&dir, path) != FR_OK) {
+		free_map_drop(map);
+		return;
+	}
+
+	free_map_set(map, dir.obj.sclust, false);
+	(void)f_closedir(&dir);
+
+	free_map_track_entry(map, last, res);
+}
+
+/* Truncate a file at its current position, freeing the rest of its chain */
+static FRESULT free_map_truncate(struct fatfs_free_map *map, FIL *fp)
+{
+	uint32_t next = fp->obj.sclust;
+	FRESULT res;
+
+	if (!free_map_active(map)) {
+		return f_truncate(fp);
+	}
+
+	if ((fp->fptr != 0 && free_map_get_fat(map, fp->clust, &next) != 0) ||
+	    free_map_walk(map, next, 0, true) != 0) {
+		free_map_drop(map);
+	}
+
+	res = f_truncate(fp);
+
+	/* Unless FatFs failed midway, the chain is still there */
+	if (res != FR_OK && free_map_active(map) &&
+	    free_map_walk(map, next, 0, false) != 0) {
+		free_map_drop(map);
+	}
+
+	return res;
+}
+
+static FRESULT free_map_unlink(struct fatfs_free_map *map, const char *path)
+{
+	uint32_t sclust = 0;
+	bool found = true;
+	FRESULT res;
+	DIR dir;
+
+	if (!free_map_active(map)) {
+		return f_unlink(path);
+	}
+
+	/*
+	 * The chain is gone after unlinking, so free it in the map before.
+	 * Looking the first cluster up takes a file lock slot of FatFs, and
+	 * fails when all of them are in use.
+	 */
+	if (f_open(map->fil, path, FA_READ) == FR_OK) {
+		sclust = map->fil->obj.sclust;
+		(void)f_close(map->fil);
+	} else if (f_opendir(&dir, path) == FR_OK) {
+		sclust = dir.obj.sclust;
+		(void)f_closedir(&dir);
+	} else {
+		found = false;
+	}
+
+	if (free_map_walk(map, sclust, 0, true) != 0) {
+		free_map_drop(map);
+	}
+
+	res = f_unlink(path);
+
+	if (res == FR_OK && !found && free_map_active(map)) {
+		/* Clusters of unknown location were freed */
+		free_map_rebuild(map);
+	} else if (res != FR_OK && free_map_active(map) &&
+		   free_map_walk(map, sclust, 0, false) != 0) {
+		/* Unless FatFs failed midway, the chain is still there */
+		free_map_drop(map);
+	}
+
+	return res;
+}
+
+#if defined(CONFIG_ZTEST)
+/*
+ * Check the map of a volume against its FAT, for tests. Returns 0 if they
+ * match, -ENODATA if the volume has no map and -EILSEQ if they differ.
+ */
+int fatfs_free_map_verify(FATFS *fs)
+{
+	struct fatfs_free_map *map = &free_maps[fs->pdrv];
+	uint32_t cnt = 0;
+	uint32_t val;
+	int rc = 0;
+
+	k_mutex_lock(&map->lock, K_FOREVER);
+	if (map->fs == fs) {
+		free_map_wait(map);
+	}
+
+	if (map->fs != fs) {
+		k_mutex_unlock(&map->lock);
+		return -ENODATA;
+	}
+
+	map->buf_sect = FREE_MAP_NO_SECT;
+
+	for (uint32_t clst = 2; clst < fs->n_fatent; clst++) {
+		bool free = (map->bits[clst / 32] & BIT(clst % 32)) != 0;
+
+		if (free_map_get_fat(map, clst, &val) != 0) {
+			rc = -EIO;
+			break;
+		}
+
+		if (free != (val == 0)) {
+			rc = -EILSEQ;
+			break;
+		}
+
+		cnt += free ? 1 : 0;
+	}
+
+	if (rc == 0 && (cnt != map->free_cnt || cnt != fs->free_clst)) {
+		rc = -EILSEQ;
+	}
+
+	k_mutex_unlock(&map->lock);
+
+	return rc;
+}
+#endif /* CONFIG_ZTEST */
+
+static void free_map_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "fatfs_free_map",
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(free_maps); i++) {
+		k_mutex_init(&free_maps[i].lock);
+		k_condvar_init(&free_maps[i].built);
+		k_work_init(&free_maps[i].work, free_map_scan);
+	}
+
+	k_work_queue_start(&free_map_wq, free_map_stack,
+			   K_THREAD_STACK_SIZEOF(free_map_stack),
+			   CONFIG_FS_FATFS_FREE_MAP_PRIORITY, &cfg);
+}
+
+#else /* !CONFIG_FS_FATFS_FREE_MAP */
+
+struct fatfs_free_map;
+
+static inline void free_map_create(struct fs_mount_t *mountp) {}
+static inline void free_map_destroy(struct fs_mount_t *mountp) {}
+static inline struct fatfs_free_map *free_map_lock(struct fs_mount_t *mountp)
+{
+	return NULL;
+}
+static inline void free_map_unlock(struct fatfs_free_map *map,
+				   FRESULT res) {}
+static inline void free_map_wait(struct fatfs_free_map *map) {}
+static inline uint32_t free_map_last(struct fatfs_free_map *map)
+{
+	return 0;
+}
+static inline void free_map_hint(struct fatfs_free_map *map) {}
+static inline void free_map_track_file(struct fatfs_free_map *map, FIL *fp,
+				       uint32_t clst) {}
+static inline void free_map_track_entry(struct fatfs_free_map *map,
+					uint32_t last, FRESULT res) {}
+static inline void free_map_track_mkdir(struct fatfs_free_map *map,
+					const char *path, uint32_t last,
+					FRESULT res) {}
+static inline FRESULT free_map_truncate(struct fatfs_free_map *map, FIL *fp)
+{
+	return f_truncate(fp);
+}
+static inline FRESULT free_map_unlink(struct fatfs_free_map *map,
+				      const char *path)
+{
+	return f_unlink(path);
+}
+static inline void free_map_init(void) {}
+
+#endif /* CONFIG_FS_FATFS_FREE_MAP */
+
 static int fatfs_open(struct fs_file_t *zfp, const char *file_name,
 		      fs_mode_t mode)
 {
+	struct fatfs_free_map *map;
 	FRESULT res;
 	uint8_t fs_mode;
+	uint32_t last;
 	void *ptr;
 
 	if (k_mem_slab_alloc(&fatfs_filep_pool, &ptr, K_NO_WAIT) == 0) {
@@ -97,7 +704,14 @@ static int fatfs_open(struct fs_file_t *zfp, const char *file_name,
 
 	fs_mode = translate_flags(mode);
 
+	map = free_map_lock(zfp->mp);
+	if (mode & FS_O_CREATE) {
+		free_map_hint(map);
+	}
+	last = free_map_last(map);
 	res = f_open(zfp->filep, &file_name[1], fs_mode);
+	free_map_track_entry(map, last, res);
+	free_map_unlock(map, res);
 
 	if (res != FR_OK) {
 		k_mem_slab_free(&fatfs_filep_pool, &ptr);
@@ -109,9 +723,11 @@ static int fatfs_open(struct fs_file_t *zfp, const char *file_name,
 
 static int fatfs_close(struct fs_file_t *zfp)
 {
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
 	FRESULT res;
 
 	res = f_close(zfp->filep);
+	free_map_unlock(map, res);
 
 	/* Free file ptr memory */
 	k_mem_slab_free(&fatfs_filep_pool, &zfp->filep);
@@ -125,7 +741,10 @@ static int fatfs_unlink(struct fs_mount_t *mountp, const char *path)
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
-	res = f_unlink(&path[1]);
+	struct fatfs_free_map *map = free_map_lock(mountp);
+
+	res = free_map_unlink(map, &path[1]);
+	free_map_unlock(map, res);
 
 	res = translate_error(res);
 #endif
@@ -139,17 +758,26 @@ static int fatfs_rename(struct fs_mount_t *mountp, const char *from,
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(mountp);
+	uint32_t last;
 	FILINFO fno;
 
 	/* Check if 'to' path exists; remove it if it does */
 	res = f_stat(&to[1], &fno);
 	if (FR_OK == res) {
-		res = f_unlink(&to[1]);
-		if (FR_OK != res)
+		res = free_map_unlink(map, &to[1]);
+		if (FR_OK != res) {
+			free_map_unlock(map, res);
 			return translate_error(res);
+		}
 	}
 
+	free_map_hint(map);
+	last = free_map_last(map);
 	res = f_rename(&from[1], &to[1]);
+	free_map_track_entry(map, last, res);
+	free_map_unlock(map, res);
+
 	res = translate_error(res);
 #endif
 
@@ -158,10 +786,12 @@ static int fatfs_rename(struct fs_mount_t *mountp, const char *from,
 
 static ssize_t fatfs_read(struct fs_file_t *zfp, void *ptr, size_t size)
 {
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
 	FRESULT res;
 	unsigned int br;
 
 	res = f_read(zfp->filep, ptr, size, &br);
+	free_map_unlock(map, res);
 	if (res != FR_OK) {
 		return translate_error(res);
 	}
@@ -174,8 +804,10 @@ static ssize_t fatfs_write(struct fs_file_t *zfp, const void *ptr, size_t size)
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
+	FIL *fp = zfp->filep;
 	unsigned int bw;
-	off_t pos = f_size((FIL *)zfp->filep);
+	off_t pos = f_size(fp);
 	res = FR_OK;
 
 	/* FA_APPEND flag means that file has been opened for append.
@@ -184,12 +816,17 @@ static ssize_t fatfs_write(struct fs_file_t *zfp, const void *ptr, size_t size)
 	 * at the end before each write if FA_APPEND is set.
 	 */
 	if (zfp->flags & FS_O_APPEND) {
-		res = f_lseek(zfp->filep, pos);
+		res = f_lseek(fp, pos);
 	}
 
 	if (res == FR_OK) {
-		res = f_write(zfp->filep, ptr, size, &bw);
+		uint32_t clst = fp->clust;
+
+		free_map_hint(map);
+		res = f_write(fp, ptr, size, &bw);
+		free_map_track_file(map, fp, clst);
 	}
+	free_map_unlock(map, res);
 
 	if (res != FR_OK) {
 		res = translate_error(res);
@@ -201,8 +838,84 @@ static ssize_t fatfs_write(struct fs_file_t *zfp, const void *ptr, size_t size)
 	return res;
 }
 
+static ssize_t fatfs_readv(struct fs_file_t *zfp, const struct fs_iovec *iov,
+			   int iovcnt)
+{
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
+	FRESULT res = FR_OK;
+	ssize_t total = 0;
+	unsigned int br;
+
+	for (int i = 0; i < iovcnt; i++) {
+		res = f_read(zfp->filep, iov[i].base, iov[i].len, &br);
+		if (res != FR_OK) {
+			break;
+		}
+
+		total += br;
+		if (br < iov[i].len) {
+			break;
+		}
+	}
+	free_map_unlock(map, res);
+
+	if (res != FR_OK && total == 0) {
+		return translate_error(res);
+	}
+
+	return total;
+}
+
+static ssize_t fatfs_writev(struct fs_file_t *zfp, const struct fs_iovec *iov,
+			    int iovcnt)
+{
+	int res = -ENOTSUP;
+
+#if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
+	FIL *fp = zfp->filep;
+	ssize_t total = 0;
+	unsigned int bw;
+	uint32_t clst;
+
+	res = FR_OK;
+
+	/* As in fatfs_write, but all buffers are written at the end of
+	 * file after a single seek.
+	 */
+	if (zfp->flags & FS_O_APPEND) {
+		res = f_lseek(fp, f_size(fp));
+	}
+
+	clst = fp->clust;
+	free_map_hint(map);
+
+	for (int i = 0; res == FR_OK && i < iovcnt; i++) {
+		res = f_write(fp, iov[i].base, iov[i].len, &bw);
+		if (res == FR_OK) {
+			total += bw;
+			if (bw < iov[i].len) {
+				break;
+			}
+		}
+	}
+
+	free_map_track_file(map, fp, clst);
+	free_map_unlock(map, res);
+
+	if (res != FR_OK && total == 0) {
+		res = translate_error(res);
+	} else {
+		res = total;
+	}
+#endif
+
+	return res;
+}
+
 static int fatfs_seek(struct fs_file_t *zfp, off_t offset, int whence)
 {
+	struct fatfs_free_map *map;
 	FRESULT res = FR_OK;
 	off_t pos;
 
@@ -224,7 +937,9 @@ static int fatfs_seek(struct fs_file_t *zfp, off_t offset, int whence)
 		return -EINVAL;
 	}
 
+	map = free_map_lock(zfp->mp);
 	res = f_lseek(zfp->filep, pos);
+	free_map_unlock(map, res);
 
 	return translate_error(res);
 }
@@ -239,16 +954,26 @@ static int fatfs_truncate(struct fs_file_t *zfp, off_t length)
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
-	off_t cur_length = f_size((FIL *)zfp->filep);
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
+	FIL *fp = zfp->filep;
+	off_t cur_length = f_size(fp);
+	uint32_t clst = fp->clust;
 
 	/* f_lseek expands file if new position is larger than file size */
-	res = f_lseek(zfp->filep, length);
+	if (length > cur_length) {
+		free_map_hint(map);
+	}
+	res = f_lseek(fp, length);
+	if (length > cur_length) {
+		free_map_track_file(map, fp, clst);
+	}
 	if (res != FR_OK) {
+		free_map_unlock(map, res);
 		return translate_error(res);
 	}
 
 	if (length < cur_length) {
-		res = f_truncate(zfp->filep);
+		res = free_map_truncate(map, fp);
 	} else {
 		/*
 		 * Get actual length after expansion. This could be
@@ -259,6 +984,7 @@ static int fatfs_truncate(struct fs_file_t *zfp, off_t length)
 
 		res = f_lseek(zfp->filep, cur_length);
 		if (res != FR_OK) {
+			free_map_unlock(map, res);
 			return translate_error(res);
 		}
 
@@ -278,6 +1004,7 @@ static int fatfs_truncate(struct fs_file_t *zfp, off_t length)
 			}
 		}
 	}
+	free_map_unlock(map, res);
 
 	res = translate_error(res);
 #endif
@@ -290,7 +1017,11 @@ static int fatfs_sync(struct fs_file_t *zfp)
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(zfp->mp);
+
 	res = f_sync(zfp->filep);
+	free_map_unlock(map, res);
+
 	res = translate_error(res);
 #endif
 	return res;
@@ -301,7 +1032,15 @@ static int fatfs_mkdir(struct fs_mount_t *mountp, const char *path)
 	int res = -ENOTSUP;
 
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(mountp);
+	uint32_t last;
+
+	free_map_hint(map);
+	last = free_map_last(map);
 	res = f_mkdir(&path[1]);
+	free_map_track_mkdir(map, &path[1], last, res);
+	free_map_unlock(map, res);
+
 	res = translate_error(res);
 #endif
 
@@ -310,6 +1049,7 @@ static int fatfs_mkdir(struct fs_mount_t *mountp, const char *path)
 
 static int fatfs_opendir(struct fs_dir_t *zdp, const char *path)
 {
+	struct fatfs_free_map *map;
 	FRESULT res;
 	void *ptr;
 
@@ -320,7 +1060,9 @@ static int fatfs_opendir(struct fs_dir_t *zdp, const char *path)
 		return -ENOMEM;
 	}
 
+	map = free_map_lock(zdp->mp);
 	res = f_opendir(zdp->dirp, &path[1]);
+	free_map_unlock(map, res);
 
 	if (res != FR_OK) {
 		k_mem_slab_free(&fatfs_dirp_pool, &ptr);
@@ -332,10 +1074,12 @@ static int fatfs_opendir(struct fs_dir_t *zdp, const char *path)
 
 static int fatfs_readdir(struct fs_dir_t *zdp, struct fs_dirent *entry)
 {
+	struct fatfs_free_map *map = free_map_lock(zdp->mp);
 	FRESULT res;
 	FILINFO fno;
 
 	res = f_readdir(zdp->dirp, &fno);
+	free_map_unlock(map, res);
 	if (res == FR_OK) {
 		strcpy(entry->name, fno.fname);
 		if (entry->name[0] != 0) {
@@ -350,9 +1094,11 @@ static int fatfs_readdir(struct fs_dir_t *zdp, struct fs_dirent *entry)
 
 static int fatfs_closedir(struct fs_dir_t *zdp)
 {
+	struct fatfs_free_map *map = free_map_lock(zdp->mp);
 	FRESULT res;
 
 	res = f_closedir(zdp->dirp);
+	free_map_unlock(map, res);
 
 	/* Free file ptr memory */
 	k_mem_slab_free(&fatfs_dirp_pool, &zdp->dirp);
@@ -363,10 +1109,12 @@ static int fatfs_closedir(struct fs_dir_t *zdp)
 static int fatfs_stat(struct fs_mount_t *mountp,
 		      const char *path, struct fs_dirent *entry)
 {
+	struct fatfs_free_map *map = free_map_lock(mountp);
 	FRESULT res;
 	FILINFO fno;
 
 	res = f_stat(&path[1], &fno);
+	free_map_unlock(map, res);
 	if (res == FR_OK) {
 		entry->type = ((fno.fattrib & AM_DIR) ?
 			       FS_DIR_ENTRY_DIR : FS_DIR_ENTRY_FILE);
@@ -382,10 +1130,13 @@ static int fatfs_statvfs(struct fs_mount_t *mountp,
 {
 	int res = -ENOTSUP;
 #if !defined(CONFIG_FS_FATFS_READ_ONLY)
+	struct fatfs_free_map *map = free_map_lock(mountp);
 	FATFS *fs;
 	DWORD f_bfree = 0;
 
+	free_map_wait(map);
 	res = f_getfree(&mountp->mnt_point[1], &f_bfree, &fs);
+	free_map_unlock(map, res);
 	if (res != FR_OK) {
 		return -EIO;
 	}
@@ -443,6 +1194,7 @@ static int fatfs_mount(struct fs_mount_t *mountp)
 
 	if (res == FR_OK) {
 		mountp->flags |= FS_MOUNT_FLAG_USE_DISK_ACCESS;
+		free_map_create(mountp);
 	}
 
 	return translate_error(res);
@@ -453,6 +1205,7 @@ static int fatfs_unmount(struct fs_mount_t *mountp)
 {
 	FRESULT res;
 
+	free_map_destroy(mountp);
 	res = f_mount(NULL, &mountp->mnt_point[1], 0);
 
 	return translate_error(res);
@@ -464,6 +1217,8 @@ static const struct fs_file_system_t fatfs_fs = {
 	.close = fatfs_close,
 	.read = fatfs_read,
 	.write = fatfs_write,
+	.readv = fatfs_readv,
+	.writev = fatfs_writev,
 	.lseek = fatfs_seek,
 	.tell = fatfs_tell,
 	.truncate = fatfs_truncate,
@@ -484,6 +1239,8 @@ static int fatfs_init(const struct device *dev)
 {
 	ARG_UNUSED(dev);
 
+	free_map_init();
+
 	return fs_register(FS_FATFS, &fatfs_fs);
 }
 
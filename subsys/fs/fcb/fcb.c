@@ -162,6 +162,9 @@ fcb_init(int f_area_id, struct fcb *fcb)
 	fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
 	fcb->f_active_id = newest;
 
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	rc = fcb_summary_init(fcb);
+#else
 	while (1) {
 		rc = fcb_getnext_in_sector(fcb, &fcb->f_active);
 		if (rc == -ENOTSUP) {
@@ -172,6 +175,7 @@ fcb_init(int f_area_id, struct fcb *fcb)
 			break;
 		}
 	}
+#endif
 	k_mutex_init(&fcb->f_mtx);
 	return rc;
 }
@@ -273,6 +277,9 @@ fcb_sector_hdr_init(struct fcb *fcb, struct flash_sector *sector, uint16_t id)
 	if (rc != 0) {
 		return -EIO;
 	}
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	fcb_summary_forget(fcb, sector);
+#endif
 	return 0;
 }
 
@@ -46,6 +46,9 @@ fcb_append_to_scratch(struct fcb *fcb)
 	if (!sector) {
 		return -ENOSPC;
 	}
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	fcb_sector_close(fcb);
+#endif
 	rc = fcb_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
 	if (rc) {
 		return rc;
@@ -79,13 +82,17 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
 		return -EINVAL;
 	}
 	active = &fcb->f_active;
-	if (active->fe_elem_off + len + cnt > active->fe_sector->fs_size) {
+	if (active->fe_elem_off + len + cnt >
+	    fcb_sector_limit(fcb, active->fe_sector)) {
 		sector = fcb_new_sector(fcb, fcb->f_scratch_cnt);
-		if (!sector || (sector->fs_size <
+		if (!sector || (fcb_sector_limit(fcb, sector) <
 			sizeof(struct fcb_disk_area) + len + cnt)) {
 			rc = -ENOSPC;
 			goto err;
 		}
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+		fcb_sector_close(fcb);
+#endif
 		rc = fcb_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
 		if (rc) {
 			goto err;
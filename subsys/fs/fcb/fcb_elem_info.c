@@ -10,6 +10,32 @@
 #include <fs/fcb.h>
 #include "fcb_priv.h"
 
+/* Read the length of the entry, returns the size of the length field */
+static int
+fcb_elem_hdr(struct fcb *fcb, struct fcb_entry *loc, uint8_t *buf)
+{
+	int cnt;
+	uint16_t len;
+	int rc;
+
+	if (loc->fe_elem_off + 2 > fcb_sector_limit(fcb, loc->fe_sector)) {
+		return -ENOTSUP;
+	}
+	rc = fcb_flash_read(fcb, loc->fe_sector, loc->fe_elem_off, buf, 2);
+	if (rc) {
+		return -EIO;
+	}
+
+	cnt = fcb_get_len(fcb, buf, &len);
+	if (cnt < 0) {
+		return cnt;
+	}
+	loc->fe_data_off = loc->fe_elem_off + fcb_len_in_flash(fcb, cnt);
+	loc->fe_data_len = len;
+
+	return cnt;
+}
+
 /*
  * Given offset in flash sector, fill in rest of the fcb_entry, and crc8 over
  * the data.
@@ -26,20 +52,11 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
 	uint32_t end;
 	int rc;
 
-	if (loc->fe_elem_off + 2 > loc->fe_sector->fs_size) {
-		return -ENOTSUP;
-	}
-	rc = fcb_flash_read(fcb, loc->fe_sector, loc->fe_elem_off, tmp_str, 2);
-	if (rc) {
-		return -EIO;
-	}
-
-	cnt = fcb_get_len(fcb, tmp_str, &len);
+	cnt = fcb_elem_hdr(fcb, loc, tmp_str);
 	if (cnt < 0) {
 		return cnt;
 	}
-	loc->fe_data_off = loc->fe_elem_off + fcb_len_in_flash(fcb, cnt);
-	loc->fe_data_len = len;
+	len = loc->fe_data_len;
 
 	crc8 = CRC8_CCITT_INITIAL_VALUE;
 	crc8 = crc8_ccitt(crc8, tmp_str, cnt);
@@ -70,6 +87,16 @@ int fcb_elem_info(struct fcb *fcb, struct fcb_entry *loc)
 	uint8_t fl_crc8;
 	off_t off;
 
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	if (fcb_summary_valid(fcb, loc->fe_sector)) {
+		/* The sector summary vouches for the entry */
+		uint8_t len_buf[2];
+
+		rc = fcb_elem_hdr(fcb, loc, len_buf);
+		return (rc < 0) ? rc : 0;
+	}
+#endif
+
 	rc = fcb_elem_crc8(fcb, loc, &crc8);
 	if (rc) {
 		return rc;
@@ -49,6 +49,22 @@ struct fcb_disk_area {
 	uint16_t fd_id;
 };
 
+/*
+ * Record written at the end of a sector when it is closed, that is when
+ * appending moves on to the next sector. It vouches for the entries in
+ * front of it, so that they can be served without checking each of them.
+ */
+struct fcb_sector_summary {
+	uint32_t fss_magic;
+	uint16_t fss_id;	/* Id of the sector */
+	uint16_t _pad;
+	uint32_t fss_cnt;	/* Number of entries, all of them valid */
+	uint32_t fss_end;	/* End of the last entry */
+	uint32_t fss_crc;	/* CRC-32 of the sector from the header to end */
+};
+
+#define FCB_SUMMARY_MAGIC 0x53756d6dU
+
 int fcb_put_len(const struct fcb *fcb, uint8_t *buf, uint16_t len);
 int fcb_get_len(const struct fcb *fcb, uint8_t *buf, uint16_t *len);
 
@@ -60,6 +76,21 @@ static inline int fcb_len_in_flash(struct fcb *fcb, uint16_t len)
 	return (len + (fcb->f_align - 1U)) & ~(fcb->f_align - 1U);
 }
 
+/*
+ * Offset up to which entries can be placed in a sector. With sector summaries
+ * the end of each sector is reserved for the summary record.
+ */
+static inline uint32_t fcb_sector_limit(struct fcb *fcb,
+					const struct flash_sector *sector)
+{
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	return sector->fs_size -
+	       fcb_len_in_flash(fcb, sizeof(struct fcb_sector_summary));
+#else
+	return sector->fs_size;
+#endif
+}
+
 const struct flash_area *fcb_open_flash(const struct fcb *fcb);
 uint8_t fcb_get_align(const struct fcb *fcb);
 int fcb_erase_sector(const struct fcb *fcb, const struct flash_sector *sector);
@@ -76,6 +107,15 @@ int fcb_sector_hdr_init(struct fcb *fcb, struct flash_sector *sector, uint16_t i
 int fcb_sector_hdr_read(struct fcb *fcb, struct flash_sector *sector,
 			struct fcb_disk_area *fdap);
 
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+int fcb_summary_init(struct fcb *fcb);
+void fcb_summary_forget(struct fcb *fcb, struct flash_sector *sector);
+bool fcb_summary_valid(struct fcb *fcb, struct flash_sector *sector);
+void fcb_sector_close(struct fcb *fcb);
+int fcb_walk_closed(struct fcb *fcb, struct fcb_entry_ctx *entry_ctx, bool all,
+		    fcb_walk_cb cb, void *cb_arg);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
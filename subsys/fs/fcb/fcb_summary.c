@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <sys/crc.h>
+#include <sys/util.h>
+#include <sys/__assert.h>
+
+#include <fs/fcb.h>
+#include "fcb_priv.h"
+
+/*
+ * Sequential reader over the entries of a sector. The sector is read front
+ * to back in pieces of the scan buffer size instead of a few bytes per flash
+ * read, and everything read is added to a running CRC-32.
+ */
+struct fcb_scan {
+	struct fcb *fcb;
+	struct flash_sector *sector;
+	uint32_t buf_off;	/* Sector offset of buf[0] */
+	uint32_t buf_len;
+	uint32_t end;		/* End of the region to read */
+	uint32_t crc;
+	uint8_t buf[CONFIG_FCB_SCAN_BUF_SIZE];
+};
+
+BUILD_ASSERT(CONFIG_FCB_SCAN_BUF_SIZE >= 16, "Scan buffer too small");
+
+/*
+ * Largest flash write block size. f_align holds it in 8 bits and
+ * fcb_len_in_flash() takes it to be a power of two.
+ */
+#define SUMMARY_ALIGN_MAX 128U
+#define SUMMARY_BUF_SIZE \
+	ROUND_UP(sizeof(struct fcb_sector_summary), SUMMARY_ALIGN_MAX)
+
+static void scan_init(struct fcb_scan *sc, struct fcb *fcb,
+		      struct flash_sector *sector, uint32_t end)
+{
+	sc->fcb = fcb;
+	sc->sector = sector;
+	sc->buf_off = sizeof(struct fcb_disk_area);
+	sc->buf_len = 0U;
+	sc->end = end;
+	sc->crc = 0U;
+}
+
+/* Make [off, off + len) available in the buffer, reading ahead as needed */
+static int scan_get(struct fcb_scan *sc, uint32_t off, uint32_t len,
+		    const uint8_t **p)
+{
+	uint32_t buf_end;
+	uint32_t drop;
+	uint32_t chunk;
+	int rc;
+
+	if (off < sc->buf_off || len > sizeof(sc->buf) ||
+	    off + len > sc->end) {
+		return -EINVAL;
+	}
+
+	while (off + len > sc->buf_off + sc->buf_len) {
+		buf_end = sc->buf_off + sc->buf_len;
+
+		/* Keep what is still needed at the front of the buffer */
+		drop = MIN(off, buf_end) - sc->buf_off;
+		memmove(sc->buf, sc->buf + drop, sc->buf_len - drop);
+		sc->buf_off += drop;
+		sc->buf_len -= drop;
+
+		chunk = MIN(sizeof(sc->buf) - sc->buf_len, sc->end - buf_end);
+		rc = fcb_flash_read(sc->fcb, sc->sector, buf_end,
+				    sc->buf + sc->buf_len, chunk);
+		if (rc) {
+			return -EIO;
+		}
+		sc->crc = crc32_ieee_update(sc->crc, sc->buf + sc->buf_len,
+					    chunk);
+		sc->buf_len += chunk;
+	}
+
+	*p = sc->buf + (off - sc->buf_off);
+	return 0;
+}
+
+/*
+ * Same as fcb_elem_info() for the entry at loc->fe_elem_off, but served from
+ * the scan buffer.
+ */
+static int scan_elem(struct fcb_scan *sc, struct fcb_entry *loc)
+{
+	struct fcb *fcb = sc->fcb;
+	const uint8_t *p;
+	uint8_t len_buf[2];
+	uint32_t blk_sz;
+	uint32_t off;
+	uint32_t end;
+	uint16_t len;
+	uint8_t crc8;
+	int cnt;
+	int rc;
+
+	if (loc->fe_elem_off + 2 > sc->end) {
+		return -ENOTSUP;
+	}
+	rc = scan_get(sc, loc->fe_elem_off, sizeof(len_buf), &p);
+	if (rc) {
+		return -EIO;
+	}
+	memcpy(len_buf, p, sizeof(len_buf));
+
+	cnt = fcb_get_len(fcb, len_buf, &len);
+	if (cnt < 0) {
+		return cnt;
+	}
+	loc->fe_data_off = loc->fe_elem_off + fcb_len_in_flash(fcb, cnt);
+	loc->fe_data_len = len;
+
+	crc8 = CRC8_CCITT_INITIAL_VALUE;
+	crc8 = crc8_ccitt(crc8, len_buf, cnt);
+
+	off = loc->fe_data_off;
+	end = loc->fe_data_off + len;
+	for (; off < end; off += blk_sz) {
+		blk_sz = MIN(end - off, sizeof(sc->buf));
+
+		rc = scan_get(sc, off, blk_sz, &p);
+		if (rc) {
+			return -EIO;
+		}
+		crc8 = crc8_ccitt(crc8, p, blk_sz);
+	}
+
+	rc = scan_get(sc, loc->fe_data_off + fcb_len_in_flash(fcb, len),
+		      FCB_CRC_SZ, &p);
+	if (rc) {
+		return -EIO;
+	}
+
+	if (*p != crc8) {
+		return -EBADMSG;
+	}
+	return 0;
+}
+
+static uint32_t elem_next(struct fcb *fcb, const struct fcb_entry *loc)
+{
+	return loc->fe_data_off + fcb_len_in_flash(fcb, loc->fe_data_len) +
+	       fcb_len_in_flash(fcb, FCB_CRC_SZ);
+}
+
+/*
+ * Go through the entries of a sector up to end, which has to be where the
+ * last entry ends. Fails with -EBADMSG if any of the entries is not valid.
+ */
+static int scan_region(struct fcb *fcb, struct flash_sector *sector,
+		       uint32_t end, uint32_t *cnt, uint32_t *crc)
+{
+	struct fcb_entry loc = { .fe_sector = sector };
+	struct fcb_scan sc;
+	const uint8_t *p;
+	uint32_t off;
+	int rc;
+
+	scan_init(&sc, fcb, sector, end);
+	*cnt = 0U;
+
+	for (off = sizeof(struct fcb_disk_area); ; off = elem_next(fcb, &loc)) {
+		loc.fe_elem_off = off;
+		rc = scan_elem(&sc, &loc);
+		if (rc) {
+			break;
+		}
+		(*cnt)++;
+	}
+	if (rc != -ENOTSUP) {
+		return rc;
+	}
+	if (off != end) {
+		return -EBADMSG;
+	}
+
+	/* Take the padding after the last entry into the CRC too */
+	if (end > sizeof(struct fcb_disk_area)) {
+		rc = scan_get(&sc, end - 1, 1, &p);
+		if (rc) {
+			return -EIO;
+		}
+	}
+
+	*crc = sc.crc;
+	return 0;
+}
+
+static inline uint32_t summary_magic(const struct fcb *fcb)
+{
+	return fcb_flash_magic(fcb) ^ FCB_SUMMARY_MAGIC;
+}
+
+static bool summary_read(struct fcb *fcb, struct flash_sector *sector,
+			 uint16_t id, struct fcb_sector_summary *sum)
+{
+	uint32_t limit = fcb_sector_limit(fcb, sector);
+
+	if (fcb_flash_read(fcb, sector, limit, sum, sizeof(*sum))) {
+		return false;
+	}
+
+	return sum->fss_magic == summary_magic(fcb) && sum->fss_id == id &&
+	       sum->fss_end >= sizeof(struct fcb_disk_area) &&
+	       sum->fss_end <= limit;
+}
+
+static inline bool sector_bit(const uint32_t *map, int idx)
+{
+	return (map[idx / 32] & BIT(idx % 32)) != 0U;
+}
+
+static inline void sector_bit_set(uint32_t *map, int idx)
+{
+	map[idx / 32] |= BIT(idx % 32);
+}
+
+static inline void sector_bit_clear(uint32_t *map, int idx)
+{
+	map[idx / 32] &= ~BIT(idx % 32);
+}
+
+int fcb_summary_init(struct fcb *fcb)
+{
+	struct fcb_entry *active = &fcb->f_active;
+	struct fcb_sector_summary sum;
+	struct fcb_entry loc = { .fe_sector = active->fe_sector };
+	struct fcb_scan sc;
+	uint32_t limit;
+	uint32_t off;
+	int rc;
+
+	(void)memset(fcb->f_sum_checked, 0, sizeof(fcb->f_sum_checked));
+	(void)memset(fcb->f_sum_valid, 0, sizeof(fcb->f_sum_valid));
+
+	limit = fcb_sector_limit(fcb, active->fe_sector);
+
+	/*
+	 * The newest sector has been closed, but the next one was not set up
+	 * before a reset. Entries cannot be added to it anymore.
+	 */
+	if (summary_read(fcb, active->fe_sector, fcb->f_active_id, &sum)) {
+		active->fe_elem_off = limit;
+		return 0;
+	}
+
+	scan_init(&sc, fcb, active->fe_sector, limit);
+
+	for (off = sizeof(struct fcb_disk_area); ; off = elem_next(fcb, &loc)) {
+		loc.fe_elem_off = off;
+		rc = scan_elem(&sc, &loc);
+		if (rc != 0 && rc != -EBADMSG) {
+			break;
+		}
+	}
+	if (rc != -ENOTSUP) {
+		return rc;
+	}
+
+	active->fe_elem_off = off;
+	return 0;
+}
+
+void fcb_summary_forget(struct fcb *fcb, struct flash_sector *sector)
+{
+	int idx = sector - fcb->f_sectors;
+
+	sector_bit_clear(fcb->f_sum_checked, idx);
+	sector_bit_clear(fcb->f_sum_valid, idx);
+}
+
+bool fcb_summary_valid(struct fcb *fcb, struct flash_sector *sector)
+{
+	struct fcb_sector_summary sum;
+	struct fcb_disk_area fda;
+	int idx = sector - fcb->f_sectors;
+	uint32_t cnt;
+	uint32_t crc;
+
+	if (sector == fcb->f_active.fe_sector ||
+	    idx < 0 || idx >= fcb->f_sector_cnt) {
+		return false;
+	}
+	if (sector_bit(fcb->f_sum_checked, idx)) {
+		return sector_bit(fcb->f_sum_valid, idx);
+	}
+	sector_bit_set(fcb->f_sum_checked, idx);
+
+	/* Check the summary against the sector once, in one pass */
+	if (fcb_sector_hdr_read(fcb, sector, &fda) != 1 ||
+	    !summary_read(fcb, sector, fda.fd_id, &sum) ||
+	    scan_region(fcb, sector, sum.fss_end, &cnt, &crc) ||
+	    cnt != sum.fss_cnt || crc != sum.fss_crc) {
+		return false;
+	}
+
+	sector_bit_set(fcb->f_sum_valid, idx);
+	return true;
+}
+
+void fcb_sector_close(struct fcb *fcb)
+{
+	struct fcb_entry *active = &fcb->f_active;
+	struct flash_sector *sector = active->fe_sector;
+	struct fcb_sector_summary sum;
+	uint8_t buf[SUMMARY_BUF_SIZE];
+	int len = fcb_len_in_flash(fcb, sizeof(sum));
+	int idx = sector - fcb->f_sectors;
+	int rc;
+
+	/* Already closed before a reset, see fcb_summary_init() */
+	if (summary_read(fcb, sector, fcb->f_active_id, &sum)) {
+		return;
+	}
+
+	/*
+	 * A sector with entries that are not valid, or not finished yet, gets
+	 * no summary. Its entries will be checked one by one, as without
+	 * summaries.
+	 */
+	rc = scan_region(fcb, sector, active->fe_elem_off, &sum.fss_cnt,
+			 &sum.fss_crc);
+	sector_bit_set(fcb->f_sum_checked, idx);
+	if (rc) {
+		return;
+	}
+
+	sum.fss_magic = summary_magic(fcb);
+	sum.fss_id = fcb->f_active_id;
+	sum._pad = fcb->f_erase_value | (fcb->f_erase_value << 8);
+	sum.fss_end = active->fe_elem_off;
+
+	__ASSERT_NO_MSG(len <= sizeof(buf));
+	(void)memset(buf, fcb->f_erase_value, len);
+	memcpy(buf, &sum, sizeof(sum));
+
+	rc = fcb_flash_write(fcb, sector, fcb_sector_limit(fcb, sector), buf,
+			     len);
+	if (rc == 0) {
+		sector_bit_set(fcb->f_sum_valid, idx);
+	}
+}
+
+int fcb_walk_closed(struct fcb *fcb, struct fcb_entry_ctx *entry_ctx, bool all,
+		    fcb_walk_cb cb, void *cb_arg)
+{
+	struct fcb_entry *loc = &entry_ctx->loc;
+	struct flash_sector *oldest;
+	struct fcb_scan sc;
+	uint32_t off;
+	int rc;
+
+	if (loc->fe_sector == NULL) {
+		loc->fe_sector = fcb->f_oldest;
+	}
+
+	while (loc->fe_sector != fcb->f_active.fe_sector) {
+		scan_init(&sc, fcb, loc->fe_sector,
+			  fcb_sector_limit(fcb, loc->fe_sector));
+
+		for (off = sizeof(struct fcb_disk_area); ;
+		     off = elem_next(fcb, loc)) {
+			loc->fe_elem_off = off;
+			rc = scan_elem(&sc, loc);
+			if (rc == -EBADMSG) {
+				continue;
+			}
+			if (rc) {
+				break;
+			}
+
+			oldest = fcb->f_oldest;
+			k_mutex_unlock(&fcb->f_mtx);
+
+			entry_ctx->fap = fcb->fap;
+			rc = cb(entry_ctx, cb_arg);
+			if (rc) {
+				return rc;
+			}
+
+			rc = k_mutex_lock(&fcb->f_mtx, K_FOREVER);
+			if (rc < 0) {
+				return -EINVAL;
+			}
+
+			/*
+			 * The callback has erased sectors, the buffered data
+			 * may be gone. Leave the rest to fcb_getnext.
+			 */
+			if (fcb->f_oldest != oldest) {
+				return 0;
+			}
+		}
+
+		loc->fe_sector = fcb_getnext_sector(fcb, loc->fe_sector);
+		loc->fe_elem_off = 0U;
+		if (!all) {
+			break;
+		}
+	}
+
+	return 0;
+}
@@ -26,6 +26,16 @@ fcb_walk(struct fcb *fcb, struct flash_sector *sector, fcb_walk_cb cb,
 	if (rc < 0) {
 		return -EINVAL;
 	}
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+	rc = fcb_walk_closed(fcb, &entry_ctx, sector == NULL, cb, cb_arg);
+	if (rc) {
+		return rc;
+	}
+	if (sector && entry_ctx.loc.fe_sector != sector) {
+		k_mutex_unlock(&fcb->f_mtx);
+		return 0;
+	}
+#endif
 	while ((rc = fcb_getnext_nolock(fcb, &entry_ctx.loc)) !=
 	       -ENOTSUP) {
 		k_mutex_unlock(&fcb->f_mtx);
@@ -35,6 +35,12 @@ struct registry_entry {
 };
 static struct registry_entry registry[CONFIG_FILE_SYSTEM_MAX_TYPES];
 
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+static K_THREAD_STACK_DEFINE(fs_async_stack,
+			     CONFIG_FILE_SYSTEM_ASYNC_STACK_SIZE);
+static struct k_work_q fs_async_wq;
+#endif
+
 static inline void registry_clear_entry(struct registry_entry *ep)
 {
 	ep->fstp = NULL;
@@ -235,6 +241,94 @@ ssize_t fs_write(struct fs_file_t *zfp, const void *ptr, size_t size)
 	return rc;
 }
 
+/* Transfer one buffer at a time, for file systems without vectored I/O */
+static ssize_t fs_iov_transfer(struct fs_file_t *zfp,
+			       const struct fs_iovec *iov, int iovcnt,
+			       bool write)
+{
+	ssize_t total = 0;
+	ssize_t rc = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+		if (write) {
+			rc = zfp->mp->fs->write(zfp, iov[i].base, iov[i].len);
+		} else {
+			rc = zfp->mp->fs->read(zfp, iov[i].base, iov[i].len);
+		}
+
+		if (rc < 0) {
+			break;
+		}
+
+		total += rc;
+		if (rc < iov[i].len) {
+			break;
+		}
+	}
+
+	return (rc < 0 && total == 0) ? rc : total;
+}
+
+ssize_t fs_readv(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		 int iovcnt)
+{
+	ssize_t rc = -EINVAL;
+
+	if (zfp->mp == NULL) {
+		return -EBADF;
+	}
+
+	if (iovcnt < 0) {
+		return -EINVAL;
+	}
+
+	if (zfp->mp->fs->readv != NULL) {
+		rc = zfp->mp->fs->readv(zfp, iov, iovcnt);
+	} else {
+		CHECKIF(zfp->mp->fs->read == NULL) {
+			return -ENOTSUP;
+		}
+
+		rc = fs_iov_transfer(zfp, iov, iovcnt, false);
+	}
+
+	if (rc < 0) {
+		LOG_ERR("file read error (%d)", (int)rc);
+	}
+
+	return rc;
+}
+
+ssize_t fs_writev(struct fs_file_t *zfp, const struct fs_iovec *iov,
+		  int iovcnt)
+{
+	ssize_t rc = -EINVAL;
+
+	if (zfp->mp == NULL) {
+		return -EBADF;
+	}
+
+	if (iovcnt < 0) {
+		return -EINVAL;
+	}
+
+	if (zfp->mp->fs->writev != NULL) {
+		rc = zfp->mp->fs->writev(zfp, iov, iovcnt);
+	} else {
+		CHECKIF(zfp->mp->fs->write == NULL) {
+			return -ENOTSUP;
+		}
+
+		rc = fs_iov_transfer(zfp, iov, iovcnt, true);
+	}
+
+	if (rc < 0) {
+		LOG_ERR("file write error (%d)", (int)rc);
+	}
+
+	return rc;
+}
+
 int fs_seek(struct fs_file_t *zfp, off_t offset, int whence)
 {
 	int rc = -ENOTSUP;
@@ -315,6 +409,137 @@ int fs_sync(struct fs_file_t *zfp)
 	return rc;
 }
 
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+static struct k_work_q *fs_async_queue(struct fs_mount_t *mp)
+{
+	return (mp->async_wq != NULL) ? mp->async_wq : &fs_async_wq;
+}
+
+static void fs_async_handler(struct k_work *work)
+{
+	struct fs_mount_t *mp = CONTAINER_OF(work, struct fs_mount_t,
+					     async_work);
+	struct fs_async_req *req;
+	k_spinlock_key_t key;
+	sys_snode_t *node;
+	fs_async_cb_t cb;
+	ssize_t rc;
+
+	for (;;) {
+		key = k_spin_lock(&mp->async_lock);
+		node = sys_slist_get(&mp->async_queue);
+		k_spin_unlock(&mp->async_lock, key);
+
+		if (node == NULL) {
+			break;
+		}
+
+		req = CONTAINER_OF(node, struct fs_async_req, node);
+
+		switch (req->op) {
+		case FS_ASYNC_READ:
+			rc = fs_readv(req->zfp, req->iov, req->iovcnt);
+			break;
+		case FS_ASYNC_WRITE:
+			rc = fs_writev(req->zfp, req->iov, req->iovcnt);
+			break;
+		default:
+			rc = fs_sync(req->zfp);
+			break;
+		}
+
+		/* The request may be reused as soon as the caller is told */
+		cb = req->cb;
+#if defined(CONFIG_POLL)
+		struct k_poll_signal *signal = req->signal;
+#endif
+
+		req->result = rc;
+		if (cb != NULL) {
+			cb(req, rc);
+		}
+#if defined(CONFIG_POLL)
+		if (signal != NULL) {
+			k_poll_signal_raise(signal, (int)rc);
+		}
+#endif
+	}
+}
+
+int fs_async_submit(struct fs_async_req *req)
+{
+	struct fs_mount_t *mp;
+	k_spinlock_key_t key;
+
+	if (req == NULL || req->zfp == NULL) {
+		return -EINVAL;
+	}
+
+	/* The request queue is the only part of the mount point changed */
+	mp = (struct fs_mount_t *)req->zfp->mp;
+	if (mp == NULL) {
+		return -EBADF;
+	}
+
+	if (req->op > FS_ASYNC_SYNC ||
+	    (req->op != FS_ASYNC_SYNC && req->iovcnt < 0)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&mp->async_lock);
+	if (mp->async_closed) {
+		k_spin_unlock(&mp->async_lock, key);
+		return -EBUSY;
+	}
+
+	req->result = -EINPROGRESS;
+	sys_slist_append(&mp->async_queue, &req->node);
+	k_spin_unlock(&mp->async_lock, key);
+
+	(void)k_work_submit_to_queue(fs_async_queue(mp), &mp->async_work);
+
+	return 0;
+}
+
+static void fs_async_reopen(struct fs_mount_t *mp)
+{
+	k_spinlock_key_t key = k_spin_lock(&mp->async_lock);
+
+	mp->async_closed = false;
+	k_spin_unlock(&mp->async_lock, key);
+}
+
+/* Reject new requests and let those already submitted complete. Called with
+ * the mount lock held, which is released meanwhile as the requests take it.
+ */
+static int fs_async_close(struct fs_mount_t *mp)
+{
+	struct k_work_sync sync;
+	k_spinlock_key_t key;
+
+	if (k_work_queue_is_worker(fs_async_queue(mp))) {
+		LOG_ERR("fs unmount from its own request");
+		return -EDEADLK;
+	}
+
+	key = k_spin_lock(&mp->async_lock);
+	if (mp->async_closed) {
+		/* already being unmounted */
+		k_spin_unlock(&mp->async_lock, key);
+		return -EBUSY;
+	}
+
+	mp->async_closed = true;
+	k_spin_unlock(&mp->async_lock, key);
+
+	k_mutex_unlock(&mutex);
+	(void)k_work_flush(&mp->async_work, &sync);
+	k_mutex_lock(&mutex, K_FOREVER);
+
+	return 0;
+}
+#endif /* CONFIG_FILE_SYSTEM_ASYNC */
+
 /* Directory operations */
 int fs_opendir(struct fs_dir_t *zdp, const char *abs_path)
 {
@@ -705,6 +930,11 @@ int fs_mount(struct fs_mount_t *mp)
 	/* Update mount point data and append it to the list */
 	mp->mountp_len = len;
 	mp->fs = fs;
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+	sys_slist_init(&mp->async_queue);
+	k_work_init(&mp->async_work, fs_async_handler);
+	mp->async_closed = false;
+#endif
 
 	sys_dlist_append(&fs_mnt_list, &mp->node);
 	LOG_DBG("fs mounted at %s", log_strdup(mp->mnt_point));
@@ -736,9 +966,19 @@ int fs_unmount(struct fs_mount_t *mp)
 		goto unmount_err;
 	}
 
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+	rc = fs_async_close(mp);
+	if (rc < 0) {
+		goto unmount_err;
+	}
+#endif
+
 	rc = mp->fs->unmount(mp);
 	if (rc < 0) {
 		LOG_ERR("fs unmount error (%d)", rc);
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+		fs_async_reopen(mp);
+#endif
 		goto unmount_err;
 	}
 
@@ -831,6 +1071,17 @@ static int fs_init(const struct device *dev)
 {
 	k_mutex_init(&mutex);
 	sys_dlist_init(&fs_mnt_list);
+
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+	const struct k_work_queue_config cfg = {
+		.name = "fs_async",
+	};
+
+	k_work_queue_start(&fs_async_wq, fs_async_stack,
+			   K_THREAD_STACK_SIZEOF(fs_async_stack),
+			   CONFIG_FILE_SYSTEM_ASYNC_PRIORITY, &cfg);
+#endif
+
 	return 0;
 }
 
@@ -32,6 +32,8 @@
 
 #define DIR_END '\0'
 
+#define WRITE_BUF_IOV_MAX 8
+
 static struct fs_file_t files[NUMBER_OF_OPEN_FILES];
 static uint8_t file_handles[NUMBER_OF_OPEN_FILES];
 
@@ -326,6 +328,66 @@ static int fuse_fs_access_write(const char *path, const char *buf, size_t size,
 	return err;
 }
 
+static int fuse_fs_access_write_buf(const char *path, struct fuse_bufvec *bufv,
+		off_t off, struct fuse_file_info *fi)
+{
+	struct fs_iovec iov[WRITE_BUF_IOV_MAX];
+	size_t cnt = bufv->count - bufv->idx;
+	void *copy = NULL;
+	bool join = false;
+	ssize_t size;
+	int err;
+
+	ARG_UNUSED(path);
+
+	if (fi->fh == INVALID_FILE_HANDLE) {
+		return -EINVAL;
+	}
+
+	/* Pass memory buffers on as they are, without joining them */
+	for (size_t i = 0; i < cnt; i++) {
+		const struct fuse_buf *buf = &bufv->buf[bufv->idx + i];
+		size_t skip = (i == 0) ? bufv->off : 0;
+
+		if (i >= ARRAY_SIZE(iov) || (buf->flags & FUSE_BUF_IS_FD)) {
+			join = true;
+			break;
+		}
+
+		iov[i].base = (char *)buf->mem + skip;
+		iov[i].len = buf->size - skip;
+	}
+
+	if (join) {
+		struct fuse_bufvec dst = FUSE_BUFVEC_INIT(fuse_buf_size(bufv));
+
+		copy = malloc(dst.buf[0].size);
+		if (copy == NULL) {
+			return -ENOMEM;
+		}
+
+		dst.buf[0].mem = copy;
+		size = fuse_buf_copy(&dst, bufv, 0);
+		if (size < 0) {
+			free(copy);
+			return size;
+		}
+
+		iov[0].base = copy;
+		iov[0].len = size;
+		cnt = 1;
+	}
+
+	err = fs_seek(&files[fi->fh], off, FS_SEEK_SET);
+	if (err == 0) {
+		err = fs_writev(&files[fi->fh], iov, cnt);
+	}
+
+	free(copy);
+
+	return err;
+}
+
 static int fuse_fs_access_ftruncate(const char *path, off_t size,
 				struct fuse_file_info *fi)
 {
@@ -442,7 +504,7 @@ static struct fuse_operations fuse_fs_access_oper = {
 	.flag_reserved = 0,
 	.ioctl = NULL,
 	.poll = NULL,
-	.write_buf = NULL,
+	.write_buf = fuse_fs_access_write_buf,
 	.read_buf = NULL,
 	.flock = NULL,
 	.fallocate = NULL,
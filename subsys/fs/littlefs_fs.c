@@ -47,13 +47,59 @@ K_MEM_SLAB_DEFINE_STATIC(lfs_dir_pool, sizeof(struct lfs_dir),
  */
 #define FC_HEAP_PER_ALLOC_OVERHEAD CONFIG_FS_LITTLEFS_HEAP_PER_ALLOC_OVERHEAD_SIZE
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+/* A line of the shared read cache holds cache_size bytes of a block */
+struct lfs_shared_line {
+	lfs_block_t block;
+	lfs_off_t off;
+	uint32_t last_use;
+};
+
+#define SHARED_LINE_INVALID ((lfs_block_t)-1)
+
+struct littlefs_shared_cache {
+	uint32_t line_cnt;
+	uint32_t clock;
+	uint8_t *data;
+	struct lfs_shared_line lines[];
+};
+
+/* Heap space taken by a shared cache of size bytes in lines of cache_size */
+#define SHARED_CACHE_HEAP_SIZE_OF(size, cache_size)			\
+	(sizeof(struct littlefs_shared_cache) +				\
+	 ((size) / (cache_size)) *					\
+	 (sizeof(struct lfs_shared_line) + (cache_size)) +		\
+	 FC_HEAP_PER_ALLOC_OVERHEAD)
+#define SHARED_CACHE_NODE_SIZE(node)					\
+	(DT_PROP_OR(node, shared_cache_size, 0) > 0 ?			\
+	 DT_PROP_OR(node, shared_cache_size, 0) :			\
+	 CONFIG_FS_LITTLEFS_SHARED_CACHE_SIZE)
+#define SHARED_CACHE_NODE_HEAP_SIZE(node)				\
+	+ SHARED_CACHE_HEAP_SIZE_OF(SHARED_CACHE_NODE_SIZE(node),	\
+				    DT_PROP(node, cache_size))
+/* One shared cache for each fstab entry, or one of the default size when
+ * the application sets up its mounts itself.
+ */
+#define SHARED_CACHE_HEAP_SIZE						\
+	COND_CODE_1(DT_HAS_COMPAT_STATUS_OKAY(zephyr_fstab_littlefs),	\
+		((0 DT_FOREACH_STATUS_OKAY(zephyr_fstab_littlefs,	\
+					   SHARED_CACHE_NODE_HEAP_SIZE))), \
+		(SHARED_CACHE_HEAP_SIZE_OF(				\
+			CONFIG_FS_LITTLEFS_SHARED_CACHE_SIZE,		\
+			CONFIG_FS_LITTLEFS_CACHE_SIZE)))
+#else
+#define SHARED_CACHE_HEAP_SIZE 0
+#endif /* CONFIG_FS_LITTLEFS_SHARED_CACHE */
+
 #if (CONFIG_FS_LITTLEFS_FC_HEAP_SIZE - 0) <= 0
 BUILD_ASSERT((CONFIG_FS_LITTLEFS_HEAP_PER_ALLOC_OVERHEAD_SIZE % 8) == 0);
-/* Auto-generate heap size from cache size and number of files */
+/* Auto-generate heap size from cache size and number of files, and the
+ * shared read caches of the mounts.
+ */
 #undef CONFIG_FS_LITTLEFS_FC_HEAP_SIZE
 #define CONFIG_FS_LITTLEFS_FC_HEAP_SIZE						\
 	((CONFIG_FS_LITTLEFS_CACHE_SIZE + FC_HEAP_PER_ALLOC_OVERHEAD) *		\
-	CONFIG_FS_LITTLEFS_NUM_FILES)
+	CONFIG_FS_LITTLEFS_NUM_FILES + SHARED_CACHE_HEAP_SIZE)
 #endif /* CONFIG_FS_LITTLEFS_FC_HEAP_SIZE */
 
 static K_HEAP_DEFINE(file_cache_heap, CONFIG_FS_LITTLEFS_FC_HEAP_SIZE);
@@ -158,6 +204,161 @@ static int errno_to_lfs(int error)
 	}
 }
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+/*
+ * The shared read cache sits below littlefs and keeps the most recently read
+ * pieces of blocks for all files and metadata of a mount. Programs update
+ * cached data and erases drop it, so it never holds stale data.
+ */
+static inline struct littlefs_shared_cache *shared_cache_get(
+	const struct lfs_config *c)
+{
+	return CONTAINER_OF(c, struct fs_littlefs, cfg)->shared_cache;
+}
+
+static inline uint8_t *shared_line_data(const struct lfs_config *c,
+					struct littlefs_shared_cache *sc,
+					struct lfs_shared_line *line)
+{
+	return sc->data + (line - sc->lines) * c->cache_size;
+}
+
+static int shared_cache_read(const struct lfs_config *c,
+			     struct littlefs_shared_cache *sc,
+			     lfs_block_t block, lfs_off_t off,
+			     uint8_t *buffer, lfs_size_t size)
+{
+	const struct flash_area *fa = c->context;
+	struct lfs_shared_line *line;
+	lfs_off_t line_off;
+	lfs_size_t len;
+	int rc;
+
+	while (size > 0) {
+		line_off = off - (off % c->cache_size);
+		line = NULL;
+
+		for (uint32_t i = 0; i < sc->line_cnt; i++) {
+			if (sc->lines[i].block == block &&
+			    sc->lines[i].off == line_off) {
+				line = &sc->lines[i];
+				break;
+			}
+			if (line == NULL ||
+			    sc->lines[i].last_use < line->last_use) {
+				line = &sc->lines[i];
+			}
+		}
+
+		if (line->block != block || line->off != line_off) {
+			/* Replace the least recently used line */
+			line->block = SHARED_LINE_INVALID;
+			rc = flash_area_read(fa, block * c->block_size +
+					     line_off,
+					     shared_line_data(c, sc, line),
+					     c->cache_size);
+			if (rc < 0) {
+				line->last_use = 0U;
+				return rc;
+			}
+			line->block = block;
+			line->off = line_off;
+		}
+		line->last_use = ++sc->clock;
+
+		len = MIN(size, line_off + c->cache_size - off);
+		memcpy(buffer, shared_line_data(c, sc, line) +
+		       (off - line_off), len);
+
+		buffer += len;
+		off += len;
+		size -= len;
+	}
+
+	return 0;
+}
+
+static void shared_cache_update(const struct lfs_config *c,
+				struct littlefs_shared_cache *sc,
+				lfs_block_t block, lfs_off_t off,
+				const uint8_t *buffer, lfs_size_t size,
+				bool ok)
+{
+	struct lfs_shared_line *line;
+	lfs_off_t start, end;
+
+	for (uint32_t i = 0; i < sc->line_cnt; i++) {
+		line = &sc->lines[i];
+		start = MAX(off, line->off);
+		end = MIN(off + size, line->off + c->cache_size);
+
+		if (line->block != block || start >= end) {
+			continue;
+		}
+
+		if (ok) {
+			memcpy(shared_line_data(c, sc, line) +
+			       (start - line->off), buffer + (start - off),
+			       end - start);
+		} else {
+			line->block = SHARED_LINE_INVALID;
+			line->last_use = 0U;
+		}
+	}
+}
+
+static void shared_cache_drop(struct littlefs_shared_cache *sc,
+			      lfs_block_t block)
+{
+	for (uint32_t i = 0; i < sc->line_cnt; i++) {
+		if (sc->lines[i].block == block) {
+			sc->lines[i].block = SHARED_LINE_INVALID;
+			sc->lines[i].last_use = 0U;
+		}
+	}
+}
+
+static int shared_cache_alloc(struct fs_littlefs *fs)
+{
+	lfs_size_t size = fs->shared_cache_size;
+	struct littlefs_shared_cache *sc;
+	uint32_t line_cnt;
+
+	if (size == 0) {
+		size = CONFIG_FS_LITTLEFS_SHARED_CACHE_SIZE;
+	}
+
+	line_cnt = size / fs->cfg.cache_size;
+	if (line_cnt == 0) {
+		return 0;
+	}
+
+	sc = fc_allocate(sizeof(*sc) + line_cnt * sizeof(sc->lines[0]) +
+			 line_cnt * fs->cfg.cache_size);
+	if (sc == NULL) {
+		return -ENOMEM;
+	}
+
+	sc->line_cnt = line_cnt;
+	sc->clock = 0U;
+	sc->data = (uint8_t *)&sc->lines[line_cnt];
+	for (uint32_t i = 0; i < line_cnt; i++) {
+		sc->lines[i].block = SHARED_LINE_INVALID;
+		sc->lines[i].last_use = 0U;
+	}
+
+	fs->shared_cache = sc;
+	return 0;
+}
+
+static void shared_cache_free(struct fs_littlefs *fs)
+{
+	if (fs->shared_cache != NULL) {
+		fc_release(fs->shared_cache);
+		fs->shared_cache = NULL;
+	}
+}
+#endif /* CONFIG_FS_LITTLEFS_SHARED_CACHE */
 
 static int lfs_api_read(const struct lfs_config *c, lfs_block_t block,
 			lfs_off_t off, void *buffer, lfs_size_t size)
@@ -165,6 +366,16 @@ static int lfs_api_read(const struct lfs_config *c, lfs_block_t block,
 	const struct flash_area *fa = c->context;
 	size_t offset = block * c->block_size + off;
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+	struct littlefs_shared_cache *sc = shared_cache_get(c);
+
+	/* Bulk reads go around the cache so as not to flush it */
+	if (sc != NULL && size <= c->cache_size) {
+		return errno_to_lfs(shared_cache_read(c, sc, block, off,
+						      buffer, size));
+	}
+#endif
+
 	int rc = flash_area_read(fa, offset, buffer, size);
 
 	return errno_to_lfs(rc);
@@ -178,6 +389,14 @@ static int lfs_api_prog(const struct lfs_config *c, lfs_block_t block,
 
 	int rc = flash_area_write(fa, offset, buffer, size);
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+	struct littlefs_shared_cache *sc = shared_cache_get(c);
+
+	if (sc != NULL) {
+		shared_cache_update(c, sc, block, off, buffer, size, rc == 0);
+	}
+#endif
+
 	return errno_to_lfs(rc);
 }
 
@@ -186,6 +405,14 @@ static int lfs_api_erase(const struct lfs_config *c, lfs_block_t block)
 	const struct flash_area *fa = c->context;
 	size_t offset = block * c->block_size;
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+	struct littlefs_shared_cache *sc = shared_cache_get(c);
+
+	if (sc != NULL) {
+		shared_cache_drop(sc, block);
+	}
+#endif
+
 	int rc = flash_area_erase(fa, offset, c->block_size);
 
 	return errno_to_lfs(rc);
@@ -381,6 +608,55 @@ static ssize_t littlefs_write(struct fs_file_t *fp, const void *ptr, size_t len)
 	return lfs_to_errno(ret);
 }
 
+/* Vectored transfers hold the lock once, so that they are not interleaved
+ * with other operations on the file system.
+ */
+static ssize_t littlefs_iov_transfer(struct fs_file_t *fp,
+				     const struct fs_iovec *iov, int iovcnt,
+				     bool write)
+{
+	struct fs_littlefs *fs = fp->mp->fs_data;
+	ssize_t total = 0;
+	lfs_ssize_t ret = 0;
+
+	fs_lock(fs);
+
+	for (int i = 0; i < iovcnt; i++) {
+		if (write) {
+			ret = lfs_file_write(&fs->lfs, LFS_FILEP(fp),
+					     iov[i].base, iov[i].len);
+		} else {
+			ret = lfs_file_read(&fs->lfs, LFS_FILEP(fp),
+					    iov[i].base, iov[i].len);
+		}
+
+		if (ret < 0) {
+			break;
+		}
+
+		total += ret;
+		if (ret < iov[i].len) {
+			break;
+		}
+	}
+
+	fs_unlock(fs);
+
+	return (ret < 0 && total == 0) ? lfs_to_errno(ret) : total;
+}
+
+static ssize_t littlefs_readv(struct fs_file_t *fp,
+			      const struct fs_iovec *iov, int iovcnt)
+{
+	return littlefs_iov_transfer(fp, iov, iovcnt, false);
+}
+
+static ssize_t littlefs_writev(struct fs_file_t *fp,
+			       const struct fs_iovec *iov, int iovcnt)
+{
+	return littlefs_iov_transfer(fp, iov, iovcnt, true);
+}
+
 BUILD_ASSERT((FS_SEEK_SET == LFS_SEEK_SET)
 	     && (FS_SEEK_CUR == LFS_SEEK_CUR)
 	     && (FS_SEEK_END == LFS_SEEK_END));
@@ -749,6 +1025,13 @@ static int littlefs_mount(struct fs_mount_t *mountp)
 		lookahead_size = CONFIG_FS_LITTLEFS_LOOKAHEAD_SIZE;
 	}
 
+	lfs_size_t metadata_max = lcp->metadata_max;
+
+	if (metadata_max == 0) {
+		/* Zero here as well means the whole block */
+		metadata_max = CONFIG_FS_LITTLEFS_METADATA_MAX;
+	}
+
 	/* No, you don't get to override this. */
 	lfs_size_t block_count;
 
@@ -786,6 +1069,8 @@ static int littlefs_mount(struct fs_mount_t *mountp)
 		 "erase size must be multiple of write size");
 	__ASSERT((block_size % cache_size) == 0,
 		 "cache size incompatible with block size");
+	__ASSERT(metadata_max <= block_size,
+		 "metadata size limit larger than block size");
 
 	lcp->context = fs->backend;
 	/* Set the validated/defaulted values. */
@@ -821,6 +1106,17 @@ static int littlefs_mount(struct fs_mount_t *mountp)
 	lcp->block_size = block_size;
 	lcp->block_count = block_count;
 	lcp->block_cycles = block_cycles;
+	lcp->metadata_max = metadata_max;
+
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+	if (!(IS_ENABLED(CONFIG_FS_LITTLEFS_BLK_DEV) && block_dev)) {
+		/* The mount works without it, only slower */
+		if (shared_cache_alloc(fs) < 0) {
+			LOG_WRN("Unable to allocate shared cache");
+			fs->shared_cache = NULL;
+		}
+	}
+#endif
 
 	/* Mount it, formatting if needed. */
 	ret = lfs_mount(&fs->lfs, &fs->cfg);
@@ -853,6 +1149,9 @@ static int littlefs_mount(struct fs_mount_t *mountp)
 out:
 	if (ret < 0) {
 		fs->backend = NULL;
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+		shared_cache_free(fs);
+#endif
 	}
 
 	fs_unlock(fs);
@@ -872,6 +1171,10 @@ static int littlefs_unmount(struct fs_mount_t *mountp)
 		flash_area_close(fs->backend);
 	}
 
+#ifdef CONFIG_FS_LITTLEFS_SHARED_CACHE
+	shared_cache_free(fs);
+#endif
+
 	fs->backend = NULL;
 	fs_unlock(fs);
 
@@ -886,6 +1189,8 @@ static const struct fs_file_system_t littlefs_fs = {
 	.close = littlefs_close,
 	.read = littlefs_read,
 	.write = littlefs_write,
+	.readv = littlefs_readv,
+	.writev = littlefs_writev,
 	.lseek = littlefs_seek,
 	.tell = littlefs_tell,
 	.truncate = littlefs_truncate,
@@ -927,10 +1232,15 @@ static struct fs_littlefs fs_data_##inst = { \
 		.prog_size = DT_INST_PROP(inst, prog_size), \
 		.cache_size = DT_INST_PROP(inst, cache_size), \
 		.lookahead_size = DT_INST_PROP(inst, lookahead_size), \
+		.block_cycles = DT_INST_PROP(inst, block_cycles), \
+		.metadata_max = DT_INST_PROP_OR(inst, metadata_max, 0), \
 		.read_buffer = read_buffer_##inst, \
 		.prog_buffer = prog_buffer_##inst, \
 		.lookahead_buffer = lookahead_buffer_##inst, \
 	}, \
+	IF_ENABLED(CONFIG_FS_LITTLEFS_SHARED_CACHE, \
+		   (.shared_cache_size = \
+			DT_INST_PROP_OR(inst, shared_cache_size, 0),)) \
 }; \
 struct fs_mount_t FS_FSTAB_ENTRY(DT_DRV_INST(inst)) = { \
 	.type = FS_LITTLEFS, \
@@ -90,8 +90,13 @@ static struct hawkbit_context {
 	uint8_t recv_buf_tcp[RECV_BUFFER_SIZE];
 	enum hawkbit_response code_status;
 	bool final_data_received;
+	bool keep_alive;
+	bool conn_reused;
 } hb_context;
 
+/* Connection kept open between probes, or -1 */
+static int hb_idle_sock = -1;
+
 static union {
 	struct hawkbit_dep_res dep;
 	struct hawkbit_ctl_res base;
@@ -226,6 +231,34 @@ static const struct json_obj_descr json_dep_fbk_descr[] = {
 			      json_status_descr),
 };
 
+static bool reuse_http_client(void)
+{
+	struct pollfd fds = {
+		.fd = hb_idle_sock,
+		.events = POLLIN,
+	};
+
+	if (hb_idle_sock < 0) {
+		return false;
+	}
+
+	hb_context.sock = hb_idle_sock;
+	hb_idle_sock = -1;
+
+	/* An idle connection has nothing to read unless the server closed
+	 * it or it failed.
+	 */
+	if (poll(&fds, 1, 0) == 0) {
+		LOG_DBG("Reusing connection to the server");
+		return true;
+	}
+
+	LOG_DBG("Idle connection closed by the server");
+	close(hb_context.sock);
+
+	return false;
+}
+
 static bool start_http_client(void)
 {
 	int ret = -1;
@@ -233,6 +266,11 @@ static bool start_http_client(void)
 	struct addrinfo hints;
 	int resolve_attempts = 10;
 
+	hb_context.conn_reused = reuse_http_client();
+	if (hb_context.conn_reused) {
+		return true;
+	}
+
 #if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
 	int protocol = IPPROTO_TLS_1_2;
 #else
@@ -303,6 +341,13 @@ err:
 
 static void cleanup_connection(void)
 {
+	if (IS_ENABLED(CONFIG_HAWKBIT_KEEP_ALIVE) && hb_context.keep_alive &&
+	    hb_context.code_status != HAWKBIT_NETWORKING_ERROR &&
+	    hb_context.code_status != HAWKBIT_UPDATE_INSTALLED) {
+		hb_idle_sock = hb_context.sock;
+		return;
+	}
+
 	if (close(hb_context.sock) < 0) {
 		LOG_ERR("Could not close the socket");
 	}
@@ -685,6 +730,10 @@ static void response_cb(struct http_response *rsp,
 
 	type = enum_for_http_req_string(userdata);
 
+	if (final_data == HTTP_DATA_FINAL) {
+		hb_context.keep_alive = rsp->keep_alive;
+	}
+
 	switch (type) {
 	case HAWKBIT_PROBE:
 		if (hb_context.dl.http_content_size == 0) {
@@ -928,6 +977,7 @@ static bool send_request(enum http_method method,
 	hb_context.http_req.header_fields = (const char **)headers;
 #endif
 	hb_context.final_data_received = false;
+	hb_context.keep_alive = false;
 
 	switch (type) {
 	case HAWKBIT_PROBE:
@@ -1129,8 +1179,25 @@ enum hawkbit_response hawkbit_probe(void)
 		 HAWKBIT_JSON_URL, CONFIG_BOARD, device_id);
 	memset(&hawkbit_results.base, 0, sizeof(hawkbit_results.base));
 
-	if (!send_request(HTTP_GET, HAWKBIT_PROBE, HAWKBIT_STATUS_FINISHED_NONE,
-			  HAWKBIT_STATUS_EXEC_NONE)) {
+	ret = send_request(HTTP_GET, HAWKBIT_PROBE,
+			   HAWKBIT_STATUS_FINISHED_NONE, HAWKBIT_STATUS_EXEC_NONE);
+	if (!ret && hb_context.conn_reused) {
+		/* The server may close an idle connection at any time, retry
+		 * once on a new one.
+		 */
+		close(hb_context.sock);
+
+		if (!start_http_client()) {
+			hb_context.code_status = HAWKBIT_NETWORKING_ERROR;
+			goto error;
+		}
+
+		ret = send_request(HTTP_GET, HAWKBIT_PROBE,
+				   HAWKBIT_STATUS_FINISHED_NONE,
+				   HAWKBIT_STATUS_EXEC_NONE);
+	}
+
+	if (!ret) {
 		LOG_ERR("Send request failed (HAWKBIT_PROBE)");
 		hb_context.code_status = HAWKBIT_NETWORKING_ERROR;
 		goto cleanup;
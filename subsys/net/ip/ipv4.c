@@ -303,6 +303,24 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 		goto drop;
 	}
 
+	if (((hdr->offset[0] << 8) | hdr->offset[1]) &
+	    (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAGH_OFFSET_MASK)) {
+		/* The packet is a fragment, hand it over to reassembly. The
+		 * reassembled packet is fed back to the IP stack.
+		 */
+		if (!IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT)) {
+			NET_DBG("DROP: fragmented pkt, reassembly disabled");
+			goto drop;
+		}
+
+		verdict = net_ipv4_handle_fragment_hdr(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	net_pkt_acknowledge_data(pkt, &ipv4_access);
 
 	if (opts_len) {
@@ -0,0 +1,685 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include <random/rand32.h>
+#include "net_private.h"
+#include "connection.h"
+#include "icmpv4.h"
+#include "ipv4.h"
+#include "net_stats.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+/* The smallest MTU every IPv4 host must be able to handle, RFC 791 */
+#define NET_IPV4_MIN_MTU 68
+
+static void reassembly_timeout(struct k_work *work);
+static bool reassembly_init_done;
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+static inline uint16_t ipv4_hdr_fragment_flags(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->offset[0] << 8) | hdr->offset[1];
+}
+
+static inline uint16_t ipv4_hdr_id(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->id[0] << 8) | hdr->id[1];
+}
+
+static inline uint16_t fragment_hdr_len(struct net_pkt *pkt)
+{
+	return net_pkt_ip_hdr_len(pkt) + net_pkt_ipv4_opts_len(pkt);
+}
+
+static struct net_ipv4_reassembly *reassembly_get(uint16_t id,
+						  uint8_t protocol,
+						  struct in_addr *src,
+						  struct in_addr *dst)
+{
+	int i, avail = -1;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (k_work_delayable_remaining_get(&reassembly[i].timer) &&
+		    reassembly[i].id == id &&
+		    reassembly[i].protocol == protocol &&
+		    net_ipv4_addr_cmp(src, &reassembly[i].src) &&
+		    net_ipv4_addr_cmp(dst, &reassembly[i].dst)) {
+			return &reassembly[i];
+		}
+
+		if (k_work_delayable_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		if (avail < 0) {
+			avail = i;
+		}
+	}
+
+	if (avail < 0) {
+		return NULL;
+	}
+
+	k_work_reschedule(&reassembly[avail].timer, IPV4_REASSEMBLY_TIMEOUT);
+
+	net_ipaddr_copy(&reassembly[avail].src, src);
+	net_ipaddr_copy(&reassembly[avail].dst, dst);
+
+	reassembly[avail].id = id;
+	reassembly[avail].protocol = protocol;
+
+	return &reassembly[avail];
+}
+
+static void reassembly_release(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	k_work_cancel_delayable(&reass->timer);
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] IPv4 reassembly pkt %p %zd bytes data",
+			i, reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		net_stats_update_ipv4_frag_drop(net_pkt_iface(reass->pkt[i]));
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reass->id = 0U;
+	reass->protocol = 0U;
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms", str, reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		k_ticks_to_ms_ceil32(
+			k_work_delayable_remaining_get(&reass->timer)));
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct net_ipv4_reassembly *reass =
+		CONTAINER_OF(dwork, struct net_ipv4_reassembly, timer);
+
+	reassembly_info("Reassembly cancelled", reass);
+
+	if (reass->pkt[0]) {
+		net_stats_update_ipv4_frag_timeout(net_pkt_iface(reass->pkt[0]));
+
+		/* Send ICMP Time Exceeded only if we received the first
+		 * fragment (RFC 792).
+		 */
+		if (net_pkt_ipv4_fragment_offset(reass->pkt[0]) == 0) {
+			net_icmpv4_send_error(reass->pkt[0],
+				NET_ICMPV4_TIME_EXCEEDED,
+				NET_ICMPV4_TIME_EXCEEDED_FRAGMENT_REASSEMBLY_TIME);
+		}
+	}
+
+	reassembly_release(reass);
+}
+
+static void reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	struct net_buf *last;
+	int i;
+
+	k_work_cancel_delayable(&reass->timer);
+
+	NET_ASSERT(reass->pkt[0]);
+
+	last = net_buf_frag_last(reass->pkt[0]->buffer);
+
+	/* We start from 2nd packet which is then appended to
+	 * the first one.
+	 */
+	for (i = 1; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		int removed_len;
+
+		pkt = reass->pkt[i];
+		if (!pkt) {
+			break;
+		}
+
+		net_pkt_cursor_init(pkt);
+
+		/* Get rid of IPv4 header and options which are at the
+		 * beginning of the fragment.
+		 */
+		removed_len = fragment_hdr_len(pkt);
+
+		NET_DBG("Removing %d bytes from start of pkt %p",
+			removed_len, pkt->buffer);
+
+		if (net_pkt_pull(pkt, removed_len)) {
+			NET_ERR("Failed to pull headers");
+			reassembly_release(reass);
+			return;
+		}
+
+		/* Attach the data to previous pkt */
+		last->frags = pkt->buffer;
+		last = net_buf_frag_last(pkt->buffer);
+
+		pkt->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(pkt);
+	}
+
+	pkt = reass->pkt[0];
+	reass->pkt[0] = NULL;
+	reass->id = 0U;
+	reass->protocol = 0U;
+
+	/* The header of the first fragment becomes the header of the
+	 * reassembled packet, so clear the fragmentation fields and fix
+	 * the length and checksum.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	hdr->offset[0] = 0U;
+	hdr->offset[1] = 0U;
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	net_pkt_set_overwrite(pkt, false);
+	net_pkt_set_ipv4_fragment_flags(pkt, 0U);
+	net_pkt_set_ipv4_reassembled(pkt, true);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt, net_pkt_get_len(pkt));
+
+	net_stats_update_ipv4_frag_reassembled(net_pkt_iface(pkt));
+
+	/* We need to use the queue when feeding the packet back into the
+	 * IP stack as we might run out of stack if we call processing_data()
+	 * directly. As the packet does not contain link layer header, we
+	 * MUST NOT pass it to L2 so there will be a special check for that
+	 * in process_data() when handling the packet.
+	 */
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	int i;
+
+	for (i = 0; reassembly_init_done &&
+		     i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!k_work_delayable_remaining_get(&reassembly[i].timer)) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+}
+
+/* Verify that we have all the fragments received and in correct order.
+ * Return:
+ * - a negative value if the fragments are erroneous and must be dropped
+ * - zero if we are expecting more fragments
+ * - a positive value if we can proceed with the reassembly
+ */
+static int fragments_are_ready(struct net_ipv4_reassembly *reass)
+{
+	unsigned int expected_offset = 0;
+	bool more = true;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		struct net_pkt *pkt = reass->pkt[i];
+		unsigned int offset;
+		int payload_len;
+
+		if (!pkt) {
+			break;
+		}
+
+		offset = net_pkt_ipv4_fragment_offset(pkt);
+
+		if (offset < expected_offset) {
+			/* Overlapping fragments, drop the whole datagram
+			 * (RFC 5722 applies the same rule to IPv6). Exact
+			 * duplicates were already discarded on arrival.
+			 */
+			return -EBADMSG;
+		} else if (offset != expected_offset) {
+			/* Not contiguous, let's wait for fragments */
+			return 0;
+		}
+
+		payload_len = net_pkt_get_len(pkt) - fragment_hdr_len(pkt);
+		if (payload_len < 0) {
+			return -EBADMSG;
+		}
+
+		expected_offset += payload_len;
+		more = net_pkt_ipv4_fragment_more(pkt);
+	}
+
+	if (more) {
+		return 0;
+	}
+
+	/* The reassembled packet must fit into the 16 bit length field */
+	if (expected_offset + fragment_hdr_len(reass->pkt[0]) > UINT16_MAX) {
+		return -EMSGSIZE;
+	}
+
+	return 1;
+}
+
+static bool fragment_is_duplicate(struct net_pkt *stored,
+				  struct net_pkt *pkt)
+{
+	return net_pkt_ipv4_fragment_offset(stored) ==
+		net_pkt_ipv4_fragment_offset(pkt) &&
+	       net_pkt_ipv4_fragment_more(stored) ==
+		net_pkt_ipv4_fragment_more(pkt) &&
+	       net_pkt_get_len(stored) - fragment_hdr_len(stored) ==
+		net_pkt_get_len(pkt) - fragment_hdr_len(pkt);
+}
+
+static int shift_packets(struct net_ipv4_reassembly *reass, int pos)
+{
+	int i;
+
+	for (i = pos + 1; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (!reass->pkt[i]) {
+			NET_DBG("Moving [%d] %p (offset 0x%x) to [%d]",
+				pos, reass->pkt[pos],
+				net_pkt_ipv4_fragment_offset(reass->pkt[pos]),
+				pos + 1);
+
+			/* pkt[i] is free, so shift everything between
+			 * [pos] and [i - 1] by one element
+			 */
+			memmove(&reass->pkt[pos + 1], &reass->pkt[pos],
+				sizeof(void *) * (i - pos));
+
+			/* pkt[pos] is now free */
+			reass->pkt[pos] = NULL;
+
+			return 0;
+		}
+	}
+
+	/* We do not have free space left in the array */
+	return -ENOMEM;
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass = NULL;
+	uint16_t flags;
+	bool found;
+	int ret;
+	int i;
+
+	if (!reassembly_init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+			k_work_init_delayable(&reassembly[i].timer,
+					      reassembly_timeout);
+		}
+
+		reassembly_init_done = true;
+	}
+
+	net_stats_update_ipv4_frag_recv(net_pkt_iface(pkt));
+
+	flags = ipv4_hdr_fragment_flags(hdr);
+	net_pkt_set_ipv4_fragment_flags(pkt, flags);
+
+	if ((flags & NET_IPV4_MORE_FRAG_MASK) &&
+	    (net_pkt_get_len(pkt) - fragment_hdr_len(pkt)) % 8) {
+		/* Only the last fragment may have a payload length that is
+		 * not a multiple of 8 octets.
+		 */
+		NET_DBG("Fragment length is not multiple of 8, dropping");
+		goto drop;
+	}
+
+	reass = reassembly_get(ipv4_hdr_id(hdr), hdr->proto,
+			       (struct in_addr *)hdr->src,
+			       (struct in_addr *)hdr->dst);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		goto drop;
+	}
+
+	/* The fragments might come in wrong order so place them
+	 * in reassembly chain in correct order.
+	 */
+	for (i = 0, found = false; i < CONFIG_NET_IPV4_FRAGMENT_MAX_PKT; i++) {
+		if (reass->pkt[i]) {
+			if (net_pkt_ipv4_fragment_offset(reass->pkt[i]) <
+			    net_pkt_ipv4_fragment_offset(pkt)) {
+				continue;
+			}
+
+			if (fragment_is_duplicate(reass->pkt[i], pkt)) {
+				/* Duplicated by the network, keep the
+				 * reassembly going without this copy.
+				 */
+				NET_DBG("Duplicate fragment offset %d, "
+					"dropping pkt %p",
+					net_pkt_ipv4_fragment_offset(pkt), pkt);
+				net_stats_update_ipv4_frag_drop(
+							net_pkt_iface(pkt));
+				return NET_DROP;
+			}
+
+			/* Make room for this fragment. If there is no room,
+			 * then it will discard the whole reassembly.
+			 */
+			if (shift_packets(reass, i)) {
+				break;
+			}
+		}
+
+		NET_DBG("Storing pkt %p to slot %d offset %d",
+			pkt, i, net_pkt_ipv4_fragment_offset(pkt));
+		reass->pkt[i] = pkt;
+		found = true;
+
+		break;
+	}
+
+	if (!found) {
+		/* We could not add this fragment into our saved fragment
+		 * list. We must discard the whole packet at this point.
+		 */
+		NET_DBG("No slots available for 0x%x", reass->id);
+		goto drop;
+	}
+
+	ret = fragments_are_ready(reass);
+	if (ret < 0) {
+		NET_DBG("Reassembled IPv4 verify failed, dropping id %u",
+			reass->id);
+
+		/* The reassembly releases also the inserted pkt, but the
+		 * caller must not touch it after that.
+		 */
+		reassembly_release(reass);
+		return NET_OK;
+	} else if (ret == 0) {
+		reassembly_info("Reassembly nth pkt", reass);
+
+		NET_DBG("More fragments to be received");
+		return NET_OK;
+	}
+
+	reassembly_info("Reassembly last pkt", reass);
+
+	/* The last fragment received, reassemble the packet */
+	reassemble_packet(reass);
+
+	return NET_OK;
+
+drop:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+
+	if (reass) {
+		reassembly_release(reass);
+	}
+
+	return NET_DROP;
+}
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+static int send_ipv4_fragment(struct net_pkt *pkt,
+			      uint16_t hdr_len,
+			      uint16_t fit_len,
+			      uint16_t frag_offset,
+			      uint16_t id,
+			      bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *frag_pkt;
+	uint16_t flags;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     hdr_len + fit_len,
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	/* Every fragment carries a copy of the original IPv4 header and
+	 * options followed by its part of the payload.
+	 */
+	if (net_pkt_copy(frag_pkt, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_ipv4_opts_len(frag_pkt, net_pkt_ipv4_opts_len(pkt));
+	net_pkt_set_ipv4_ttl(frag_pkt, net_pkt_ipv4_ttl(pkt));
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt, &ipv4_access);
+	if (!hdr) {
+		goto fail;
+	}
+
+	flags = (frag_offset / 8U) & NET_IPV4_FRAGH_OFFSET_MASK;
+	if (!final) {
+		flags |= NET_IPV4_MORE_FRAG_MASK;
+	}
+
+	hdr->id[0] = id >> 8;
+	hdr->id[1] = id;
+	hdr->offset[0] = flags >> 8;
+	hdr->offset[1] = flags;
+	hdr->len = htons(hdr_len + fit_len);
+	hdr->chksum = 0U;
+
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	net_pkt_set_overwrite(frag_pkt, false);
+	net_pkt_set_ipv4_fragment_flags(frag_pkt, flags);
+	net_pkt_set_ipv4_fragment_id(frag_pkt, id);
+
+	net_pkt_cursor_init(frag_pkt);
+
+	/* If everything has been ok so far, we can send the packet. */
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_stats_update_ipv4_frag_sent(net_pkt_iface(pkt));
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int send_fragmented_pkt(struct net_pkt *pkt, size_t pkt_len,
+			       uint16_t mtu)
+{
+	uint16_t frag_offset;
+	uint16_t hdr_len;
+	size_t length;
+	uint16_t id;
+	int fit_len;
+	int ret;
+
+	hdr_len = fragment_hdr_len(pkt);
+
+	/* The maximum payload that fits into each fragment after the IPv4
+	 * header and options. All but the last fragment must carry a
+	 * multiple of 8 octets.
+	 */
+	fit_len = (mtu - hdr_len) & ~7;
+	if (fit_len <= 0) {
+		NET_DBG("No room for IPv4 payload MTU %d hdr_len %d",
+			mtu, hdr_len);
+		return -EINVAL;
+	}
+
+	id = sys_rand32_get();
+	net_pkt_set_ipv4_fragment_id(pkt, id);
+
+	frag_offset = 0U;
+
+	length = pkt_len - hdr_len;
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, hdr_len, fit_len, frag_offset,
+					 id, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	size_t pkt_len = net_pkt_get_len(pkt);
+	uint16_t mtu;
+	int ret;
+
+	mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	if (mtu == 0U || pkt_len <= mtu) {
+		return NET_OK;
+	}
+
+	/* TCP packets with a segment size are split into segments later */
+	if (net_pkt_gso_size(pkt) > 0U) {
+		return NET_OK;
+	}
+
+	mtu = MAX(NET_IPV4_MIN_MTU, mtu);
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		return NET_DROP;
+	}
+
+	if (ipv4_hdr_fragment_flags(hdr) & NET_IPV4_DO_NOT_FRAG_MASK) {
+		NET_DBG("DROP: pkt %p too large (%zd > %d) and DF set",
+			pkt, pkt_len, mtu);
+		return NET_DROP;
+	}
+
+	ret = send_fragmented_pkt(pkt, pkt_len, mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			return NET_OK;
+		}
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet. This is crucial thing to do here and
+	 * will cause free memory access if not done.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet sending. */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments will be sent separately to network.
+	 */
+	return NET_CONTINUE;
+}
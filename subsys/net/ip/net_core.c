@@ -78,6 +78,11 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+	/* Same applies to a reassembled IPv4 packet. */
+	if (net_pkt_ipv4_reassembled(pkt)) {
+		locally_routed = true;
+	}
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
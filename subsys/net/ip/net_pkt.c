@@ -972,6 +972,13 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 
 		max_len = MAX(max_len, NET_IPV6_MTU);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) && (size > max_len)) {
+			/* We support larger packets if IPv4 fragmentation is
+			 * enabled.
+			 */
+			max_len = size;
+		}
+
 		max_len = MAX(max_len, NET_IPV4_MTU);
 	} else { /* family == AF_UNSPEC */
 #if defined (CONFIG_NET_L2_ETHERNET)
@@ -988,6 +995,14 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 		}
 	}
 
+	if (IS_ENABLED(CONFIG_NET_TCP_GSO) && proto == IPPROTO_TCP &&
+	    family != AF_UNSPEC && size > max_len) {
+		/* TCP packets larger than the MTU are segmented before they
+		 * are given to the driver.
+		 */
+		max_len = size;
+	}
+
 	max_len -= existing;
 
 	return MIN(size, max_len);
@@ -1774,11 +1789,18 @@ static void clone_pkt_attributes(struct net_pkt *pkt, struct net_pkt *clone_pkt)
 	net_pkt_set_orig_iface(clone_pkt, net_pkt_orig_iface(pkt));
 	net_pkt_set_captured(clone_pkt, net_pkt_is_captured(pkt));
 	net_pkt_set_l2_bridged(clone_pkt, net_pkt_is_l2_bridged(pkt));
+	net_pkt_set_gso_size(clone_pkt, net_pkt_gso_size(pkt));
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
 		net_pkt_set_ipv4_ttl(clone_pkt, net_pkt_ipv4_ttl(pkt));
 		net_pkt_set_ipv4_opts_len(clone_pkt,
 					  net_pkt_ipv4_opts_len(pkt));
+		net_pkt_set_ipv4_fragment_flags(clone_pkt,
+						net_pkt_ipv4_fragment_flags(pkt));
+		net_pkt_set_ipv4_fragment_id(clone_pkt,
+					     net_pkt_ipv4_fragment_id(pkt));
+		net_pkt_set_ipv4_reassembled(clone_pkt,
+					     net_pkt_ipv4_reassembled(pkt));
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_pkt_family(pkt) == AF_INET6) {
 		net_pkt_set_ipv6_hop_limit(clone_pkt,
@@ -345,6 +345,39 @@ static inline void net_stats_update_ipv4_igmp_drop(struct net_if *iface)
 #define net_stats_update_ipv4_igmp_drop(iface)
 #endif /* CONFIG_NET_STATISTICS_IGMP */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT) && defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_ipv4_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.recv++);
+}
+
+static inline void net_stats_update_ipv4_frag_sent(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.sent++);
+}
+
+static inline void net_stats_update_ipv4_frag_reassembled(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv4_frag_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.drop++);
+}
+
+static inline void net_stats_update_ipv4_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.timeout++);
+}
+#else
+#define net_stats_update_ipv4_frag_recv(iface)
+#define net_stats_update_ipv4_frag_sent(iface)
+#define net_stats_update_ipv4_frag_reassembled(iface)
+#define net_stats_update_ipv4_frag_drop(iface)
+#define net_stats_update_ipv4_frag_timeout(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS) && defined(CONFIG_NET_STATISTICS)
 static inline void net_stats_update_tx_time(struct net_if *iface,
 					    uint32_t start_time,
@@ -17,6 +17,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include "net_private.h"
 #include "net_stats.h"
 #include "net_tc_mapping.h"
+#include "tcp_internal.h"
 
 /* Template for thread name. The "xx" is either "TX" denoting transmit thread,
  * or "RX" denoting receive thread. The "q[y]" denotes the traffic class queue
@@ -248,6 +249,13 @@ static void tc_rx_handler(struct k_fifo *fifo)
 		}
 
 		net_process_rx_packet(pkt);
+
+		if (IS_ENABLED(CONFIG_NET_TCP_GRO) && k_fifo_is_empty(fifo)) {
+			/* No more packets that could be merged with the
+			 * coalesced TCP segments, so let TCP process them.
+			 */
+			net_tcp_gro_flush();
+		}
 	}
 }
 #endif
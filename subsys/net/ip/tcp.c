@@ -420,6 +420,12 @@ static int tcp_conn_unref(struct tcp *conn)
 		tcp_pkt_unref(conn->queue_recv_data);
 	}
 
+#if defined(CONFIG_NET_TCP_GRO)
+	if (conn->gro_pkt) {
+		tcp_pkt_unref(conn->gro_pkt);
+	}
+#endif
+
 	k_work_cancel_delayable(&conn->timewait_timer);
 	k_work_cancel_delayable(&conn->fin_timer);
 
@@ -848,12 +854,44 @@ static bool is_destination_local(struct net_pkt *pkt)
 	return false;
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+/* Size of the segments a packet larger than the MTU is split into, or 0
+ * if the packets of this connection must not be larger than one segment.
+ */
+static uint16_t tcp_gso_seg_size(struct tcp *conn)
+{
+	uint16_t mss = MIN(conn_mss(conn), net_tcp_get_recv_mss(conn));
+	uint16_t mtu;
+
+	if (conn->iface == NULL) {
+		return 0;
+	}
+
+	mtu = net_if_get_mtu(conn->iface);
+
+	/* The IPv6 MSS is never less than what fits into the minimum MTU.
+	 * If the interface MTU is smaller than that, the packet has to be
+	 * fragmented at IP level instead.
+	 */
+	if (net_context_get_family(conn->context) == AF_INET6 &&
+	    mss + NET_IPV6TCPH_LEN > mtu) {
+		return 0;
+	}
+
+	return mss;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		       uint32_t seq)
 {
 	size_t alloc_len = sizeof(struct tcphdr);
+	size_t data_len = data ? net_pkt_get_len(data) : 0;
 	struct net_pkt *pkt;
 	int ret = 0;
+#if defined(CONFIG_NET_TCP_GSO)
+	uint16_t seg_size;
+#endif
 
 	if (conn->send_options.mss_found) {
 		alloc_len += sizeof(uint32_t);
@@ -891,6 +929,20 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		}
 	}
 
+#if defined(CONFIG_NET_TCP_GSO)
+	seg_size = tcp_gso_seg_size(conn);
+
+	/* Locally routed packets are not segmented, so the checksum must
+	 * be calculated for them here.
+	 */
+	if (seg_size > 0 && data_len > seg_size &&
+	    !is_destination_local(pkt)) {
+		net_pkt_set_gso_size(pkt, seg_size);
+	}
+#else
+	ARG_UNUSED(data_len);
+#endif
+
 	ret = tcp_finalize_pkt(pkt);
 	if (ret < 0) {
 		tcp_pkt_unref(pkt);
@@ -984,6 +1036,20 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
+/* How much data can be put into one packet given to the IP layer */
+static int tcp_send_max_len(struct tcp *conn)
+{
+#if defined(CONFIG_NET_TCP_GSO)
+	uint16_t seg_size = tcp_gso_seg_size(conn);
+
+	if (seg_size > 0) {
+		return seg_size * CONFIG_NET_TCP_GSO_MAX_SEGS;
+	}
+#endif
+
+	return conn_mss(conn);
+}
+
 static int tcp_send_data(struct tcp *conn)
 {
 	int ret = 0;
@@ -993,7 +1059,7 @@ static int tcp_send_data(struct tcp *conn)
 	pos = conn->unacked_len;
 	len = MIN3(conn->send_data_total - conn->unacked_len,
 		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
+		   tcp_send_max_len(conn));
 	if (len == 0) {
 		NET_DBG("conn: %p no data to send", conn);
 		ret = -ENODATA;
@@ -1329,6 +1395,191 @@ static struct tcp *tcp_conn_search(struct net_pkt *pkt)
 
 static struct tcp *tcp_conn_new(struct net_pkt *pkt);
 
+#if defined(CONFIG_NET_TCP_GRO)
+/* Let TCP process the segments coalesced so far */
+static void tcp_gro_flush_conn(struct tcp *conn)
+{
+	struct net_pkt *pkt;
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	pkt = conn->gro_pkt;
+	conn->gro_pkt = NULL;
+	conn->gro_segs = 0U;
+
+	k_mutex_unlock(&conn->lock);
+
+	if (pkt) {
+		NET_DBG("conn: %p pkt %p len %zu", conn, pkt,
+			tcp_data_len(pkt));
+
+		tcp_in(conn, pkt);
+		tcp_pkt_unref(pkt);
+	}
+}
+
+static bool tcp_gro_mergeable(struct tcp *conn, struct tcphdr *th,
+			      size_t len)
+{
+	uint8_t fl = th_flags(th) & ~(ECN | CWR);
+
+	return conn->state == TCP_ESTABLISHED && len > 0 &&
+		(fl == ACK || fl == (PSH | ACK)) && th_off(th) == 5;
+}
+
+/* Append the data of pkt to the segments held in conn->gro_pkt */
+static int tcp_gro_merge(struct tcp *conn, struct tcphdr *held_th,
+			 struct net_pkt *pkt, struct tcphdr *th)
+{
+	size_t hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt) +
+		sizeof(struct tcphdr);
+	struct net_pkt *held = conn->gro_pkt;
+	uint32_t ack = UNALIGNED_GET(&th->th_ack);
+	uint16_t win = UNALIGNED_GET(&th->th_win);
+	uint8_t flags = th_flags(th);
+
+	/* The header values are read above as th is not valid after this */
+	if (tcp_pkt_pull(pkt, hdr_len) < 0) {
+		return -EINVAL;
+	}
+
+	net_pkt_append_buffer(held, pkt->buffer);
+	pkt->buffer = NULL;
+
+	UNALIGNED_PUT(ack, &held_th->th_ack);
+	UNALIGNED_PUT(win, &held_th->th_win);
+	UNALIGNED_PUT(th_flags(held_th) | flags, &held_th->th_flags);
+
+	/* The checksums are not verified again, only the length is kept
+	 * consistent with the merged data.
+	 */
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(held) == AF_INET) {
+		NET_IPV4_HDR(held)->len = htons(net_pkt_get_len(held));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(held) == AF_INET6) {
+		NET_IPV6_HDR(held)->len = htons(net_pkt_get_len(held) -
+						sizeof(struct net_ipv6_hdr));
+	}
+
+	net_stats_update_tcp_seg_recv(conn->iface);
+
+	return 0;
+}
+
+/* Returns true if pkt was taken for coalescing, false if it has to be
+ * processed by tcp_in() right away.
+ */
+static bool tcp_gro_receive(struct tcp *conn, struct net_pkt *pkt)
+{
+	struct tcphdr *th = th_get(pkt);
+	struct tcphdr *held_th;
+	bool flush = false;
+	size_t len;
+
+	if (!th) {
+		goto not_merged;
+	}
+
+	len = tcp_data_len(pkt);
+
+	if (!tcp_gro_mergeable(conn, th, len)) {
+		goto not_merged;
+	}
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	if (!conn->gro_pkt) {
+		/* Only in-order data is held, tcp_in() queues the rest */
+		if (th_seq(th) != conn->ack) {
+			k_mutex_unlock(&conn->lock);
+			return false;
+		}
+
+		conn->gro_pkt = tcp_pkt_ref(pkt);
+		conn->gro_segs = 1U;
+
+		k_mutex_unlock(&conn->lock);
+		return true;
+	}
+
+	held_th = th_get(conn->gro_pkt);
+	if (!held_th || th_seq(th) != th_seq(held_th) +
+	    tcp_data_len(conn->gro_pkt)) {
+		k_mutex_unlock(&conn->lock);
+		goto not_merged;
+	}
+
+	if (tcp_gro_merge(conn, held_th, pkt, th) < 0) {
+		k_mutex_unlock(&conn->lock);
+		goto not_merged;
+	}
+
+	if (++conn->gro_segs >= CONFIG_NET_TCP_GRO_MAX_SEGS) {
+		flush = true;
+	}
+
+	k_mutex_unlock(&conn->lock);
+
+	if (flush) {
+		tcp_gro_flush_conn(conn);
+	}
+
+	return true;
+
+not_merged:
+	/* Keep the order of the segments */
+	tcp_gro_flush_conn(conn);
+
+	return false;
+}
+
+/* Take a reference unless the connection is already being released */
+static bool tcp_conn_try_ref(struct tcp *conn)
+{
+	atomic_val_t ref_count;
+
+	do {
+		ref_count = atomic_get(&conn->ref_count);
+		if (ref_count == 0) {
+			return false;
+		}
+	} while (!atomic_cas(&conn->ref_count, ref_count, ref_count + 1));
+
+	return true;
+}
+
+void net_tcp_gro_flush(void)
+{
+	struct tcp *conn;
+	struct tcp *tmp;
+
+	k_mutex_lock(&tcp_lock, K_FOREVER);
+
+	conn = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp_conns, conn, next);
+
+	while (conn) {
+		/* The reference keeps conn in the list while tcp_lock is
+		 * released, so the next connection is looked up only once
+		 * the lock is held again.
+		 */
+		if (conn->gro_pkt && tcp_conn_try_ref(conn)) {
+			k_mutex_unlock(&tcp_lock);
+			tcp_gro_flush_conn(conn);
+			k_mutex_lock(&tcp_lock, K_FOREVER);
+
+			tmp = SYS_SLIST_PEEK_NEXT_CONTAINER(conn, next);
+			(void)tcp_conn_unref(conn);
+		} else {
+			tmp = SYS_SLIST_PEEK_NEXT_CONTAINER(conn, next);
+		}
+
+		conn = tmp;
+	}
+
+	k_mutex_unlock(&tcp_lock);
+}
+#endif /* CONFIG_NET_TCP_GRO */
+
 static enum net_verdict tcp_recv(struct net_conn *net_conn,
 				 struct net_pkt *pkt,
 				 union net_ip_header *ip,
@@ -1362,6 +1613,12 @@ static enum net_verdict tcp_recv(struct net_conn *net_conn,
 		conn->accepted_conn = conn_old;
 	}
  in:
+#if defined(CONFIG_NET_TCP_GRO)
+	if (conn && tcp_gro_receive(conn, pkt)) {
+		return NET_DROP;
+	}
+#endif
+
 	if (conn) {
 		tcp_in(conn, pkt);
 	}
@@ -2473,13 +2730,134 @@ int net_tcp_finalize(struct net_pkt *pkt)
 
 	tcp_hdr->chksum = 0U;
 
-	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+	/* The checksum of a packet that is going to be segmented is
+	 * calculated for each segment separately.
+	 */
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    net_pkt_gso_size(pkt) == 0U) {
 		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
 	}
 
 	return net_pkt_set_data(pkt, &tcp_access);
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+static struct net_pkt *tcp_gso_segment(struct net_pkt *pkt, size_t hdr_len,
+				       size_t pos, size_t len, bool last)
+{
+	struct net_pkt *seg;
+	struct tcphdr *th;
+	uint8_t flags;
+
+	seg = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), hdr_len + len,
+					AF_UNSPEC, 0, TCP_PKT_ALLOC_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_pkt_set_family(seg, net_pkt_family(pkt));
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tag(seg, net_pkt_vlan_tag(pkt));
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		net_pkt_set_ipv4_ttl(seg, net_pkt_ipv4_ttl(pkt));
+		net_pkt_set_ipv4_opts_len(seg, net_pkt_ipv4_opts_len(pkt));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		net_pkt_set_ipv6_hop_limit(seg, net_pkt_ipv6_hop_limit(pkt));
+		net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+		net_pkt_set_ipv6_next_hdr(seg, net_pkt_ipv6_next_hdr(pkt));
+	}
+
+	/* The link layer addresses have been resolved already */
+	*net_pkt_lladdr_src(seg) = *net_pkt_lladdr_src(pkt);
+	*net_pkt_lladdr_dst(seg) = *net_pkt_lladdr_dst(pkt);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_copy(seg, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, pos) ||
+	    net_pkt_copy(seg, pkt, len)) {
+		goto fail;
+	}
+
+	th = th_get(seg);
+	if (!th) {
+		goto fail;
+	}
+
+	UNALIGNED_PUT(htonl(th_seq(th) + pos), &th->th_seq);
+
+	/* PSH and FIN belong to the end of the data only */
+	if (!last) {
+		flags = th_flags(th) & ~(PSH | FIN);
+		UNALIGNED_PUT(flags, &th->th_flags);
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(seg) == AF_INET) {
+		NET_IPV4_HDR(seg)->chksum = 0U;
+	}
+
+	if (tcp_finalize_pkt(seg) < 0) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(seg);
+
+	return seg;
+
+fail:
+	net_pkt_unref(seg);
+
+	return NULL;
+}
+
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	uint16_t seg_size = net_pkt_gso_size(pkt);
+	size_t hdr_len, data_len, pos, len;
+	struct net_pkt *seg;
+	struct tcphdr *th;
+	int sent = 0;
+	int ret;
+
+	th = th_get(pkt);
+	if (!th) {
+		return -EINVAL;
+	}
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt) +
+		th_off(th) * 4;
+	data_len = net_pkt_get_len(pkt) - hdr_len;
+
+	NET_DBG("pkt %p len %zu segment size %hu", pkt, data_len, seg_size);
+
+	for (pos = 0; pos < data_len; pos += len) {
+		len = MIN(seg_size, data_len - pos);
+
+		seg = tcp_gso_segment(pkt, hdr_len, pos, len,
+				      pos + len == data_len);
+		if (!seg) {
+			return -ENOBUFS;
+		}
+
+		ret = net_if_l2(iface)->send(iface, seg);
+		if (ret < 0) {
+			net_pkt_unref(seg);
+			return ret;
+		}
+
+		sent += ret;
+	}
+
+	net_pkt_unref(pkt);
+
+	return sent;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 struct net_tcp_hdr *net_tcp_input(struct net_pkt *pkt,
 				  struct net_pkt_data_access *tcp_access)
 {
@@ -359,6 +359,42 @@ static inline int net_tcp_put(struct net_context *context)
 }
 #endif
 
+/**
+ * @brief Split a TCP packet larger than the MTU into segments and send them
+ *
+ * The segment size is taken from net_pkt_gso_size(). Every segment gets
+ * a copy of the IP and TCP headers with the length, sequence number and
+ * checksums updated, and is given to the L2 of the interface. The
+ * original packet is released if all the segments were sent.
+ *
+ * @param iface Network interface the packet is sent to
+ * @param pkt Network packet
+ *
+ * @return Number of bytes sent on success, negative errno otherwise.
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt);
+#else
+static inline int net_tcp_gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(pkt);
+
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Pass the TCP segments held for receive coalescing to TCP
+ *
+ * This is called by the RX thread when it has no more packets to process.
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_flush(void);
+#else
+#define net_tcp_gro_flush(...)
+#endif
+
 #define NET_TCP_MAX_OPT_SIZE  8
 
 #if defined(CONFIG_NET_NATIVE_TCP)
@@ -225,6 +225,9 @@ struct tcp { /* TCP connection */
 	struct net_context *context;
 	struct net_pkt *send_data;
 	struct net_pkt *queue_recv_data;
+#if defined(CONFIG_NET_TCP_GRO)
+	struct net_pkt *gro_pkt; /* coalesced segments not yet processed */
+#endif
 	struct net_if *iface;
 	void *recv_user_data;
 	sys_slist_t send_queue;
@@ -262,6 +265,9 @@ struct tcp { /* TCP connection */
 	uint16_t recv_win;
 	uint16_t send_win;
 	uint8_t send_data_retries;
+#if defined(CONFIG_NET_TCP_GRO)
+	uint8_t gro_segs;
+#endif
 	bool in_retransmission : 1;
 	bool in_connect : 1;
 	bool in_close : 1;
@@ -487,32 +487,134 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
-static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
+/* The one's complement sum does not depend on the byte order (RFC 1071),
+ * so the data is summed a word at a time in host byte order into a wide
+ * accumulator and the carries are folded back only once at the end.
+ */
+static inline uint16_t chksum_fold(uint64_t sum)
 {
-	const uint8_t *end;
-	uint16_t tmp;
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
 
-	end = data + len - 1;
+	return (uint16_t)sum;
+}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+#if defined(CONFIG_ARMV7_M_ARMV8_M_MAINLINE)
+/* Add four words with an add-with-carry chain. The end-around carry keeps
+ * the 32-bit sum a valid one's complement sum, so this needs one addition
+ * per word where the 64-bit accumulator needs two on a 32-bit CPU.
+ */
+static inline uint32_t chksum_add16(uint32_t sum, const uint8_t *data)
+{
+	uint32_t w0, w1, w2, w3;
+
+	__asm__ ("ldr %[w0], [%[p]]\n\t"
+		 "ldr %[w1], [%[p], #4]\n\t"
+		 "ldr %[w2], [%[p], #8]\n\t"
+		 "ldr %[w3], [%[p], #12]\n\t"
+		 "adds %[sum], %[sum], %[w0]\n\t"
+		 "adcs %[sum], %[sum], %[w1]\n\t"
+		 "adcs %[sum], %[sum], %[w2]\n\t"
+		 "adcs %[sum], %[sum], %[w3]\n\t"
+		 "adc %[sum], %[sum], #0"
+		 : [sum] "+r" (sum), [w0] "=&r" (w0), [w1] "=&r" (w1),
+		   [w2] "=&r" (w2), [w3] "=&r" (w3)
+		 : [p] "r" (data), "m" (*(const uint8_t (*)[16])data)
+		 : "cc");
 
+	return sum;
+}
+#endif
+
+static uint16_t calc_chksum_native(const uint8_t *data, size_t len)
+{
+	bool odd = (uintptr_t)data & 1;
+	uint64_t sum = 0U;
+	uint16_t result;
+
+	if (len == 0) {
+		return 0U;
+	}
+
+	/* Sum the words at their aligned addresses. If the data starts at
+	 * an odd address, every byte is then in the wrong half of its word,
+	 * which is corrected by swapping the bytes of the result.
+	 */
+	if (odd) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		sum = (uint16_t)(*data << 8);
+#else
+		sum = *data;
+#endif
+		data++;
+		len--;
+	}
+
+	if (len >= 2 && ((uintptr_t)data & 2)) {
+		sum += UNALIGNED_GET((const uint16_t *)data);
 		data += 2;
+		len -= 2;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+#if defined(CONFIG_ARMV7_M_ARMV8_M_MAINLINE)
+	if (len >= 16) {
+		uint32_t sum32 = 0U;
+
+		do {
+			sum32 = chksum_add16(sum32, data);
+			data += 16;
+			len -= 16;
+		} while (len >= 16);
+
+		sum += sum32;
 	}
+#else
+	while (len >= 16) {
+		sum += (uint64_t)UNALIGNED_GET((const uint32_t *)data) +
+		       UNALIGNED_GET((const uint32_t *)(data + 4)) +
+		       UNALIGNED_GET((const uint32_t *)(data + 8)) +
+		       UNALIGNED_GET((const uint32_t *)(data + 12));
+		data += 16;
+		len -= 16;
+	}
+#endif
 
-	return sum;
+	while (len >= 4) {
+		sum += UNALIGNED_GET((const uint32_t *)data);
+		data += 4;
+		len -= 4;
+	}
+
+	if (len >= 2) {
+		sum += UNALIGNED_GET((const uint16_t *)data);
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		sum += *data;
+#else
+		sum += (uint16_t)(*data << 8);
+#endif
+	}
+
+	result = chksum_fold(sum);
+
+	if (odd) {
+		result = (uint16_t)((result << 8) | (result >> 8));
+	}
+
+	return result;
+}
+
+static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
+{
+	uint32_t tmp = (uint32_t)sum + ntohs(calc_chksum_native(data, len));
+
+	return (uint16_t)((tmp & 0xffff) + (tmp >> 16));
 }
 
 static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
@@ -253,6 +253,14 @@ static int on_body(struct http_parser *parser, const char *at, size_t length)
 						struct http_request,
 						internal.parser);
 
+	/* The body of a server error is read to find the end of the message,
+	 * so that the connection can be reused, but it is not reported.
+	 */
+	if (parser->status_code >= 500 && parser->status_code < 600) {
+		NET_DBG("Status %d, discarding body", parser->status_code);
+		return 0;
+	}
+
 	req->internal.response.body_found = 1;
 	req->internal.response.processed += length;
 
@@ -283,11 +291,6 @@ static int on_headers_complete(struct http_parser *parser)
 		req->internal.response.http_cb->on_headers_complete(parser);
 	}
 
-	if (parser->status_code >= 500 && parser->status_code < 600) {
-		NET_DBG("Status %d, skipping body", parser->status_code);
-		return 1;
-	}
-
 	if ((req->method == HTTP_HEAD || req->method == HTTP_OPTIONS) &&
 	    req->internal.response.content_length > 0) {
 		NET_DBG("No body expected");
@@ -331,6 +334,12 @@ static int on_message_complete(struct http_parser *parser)
 		http_method_str(req->method));
 
 	req->internal.response.message_complete = 1;
+	req->internal.response.keep_alive = http_should_keep_alive(parser);
+
+	/* Stop parsing at the end of the message so that any data after it
+	 * is left for the next pipelined response.
+	 */
+	http_parser_pause(parser, 1);
 
 	return 0;
 }
@@ -380,21 +389,38 @@ static void http_client_init_parser(struct http_parser *parser,
 	settings->on_url = on_url;
 }
 
-static int http_wait_data(int sock, struct http_request *req)
+/* Receive and parse one response. The first "pending" bytes of recv_buf
+ * are data left over from the previous pipelined response. On return,
+ * "pending" is set to the amount of data received past the end of this
+ * response, which is moved to the start of recv_buf.
+ */
+static int http_wait_data(int sock, struct http_request *req, size_t *pending)
 {
 	int total_received = 0;
 	size_t offset = 0;
+	size_t extra = 0;
+	size_t extra_start = 0;
+	size_t parsed;
 	int received, ret;
 
 	do {
-		received = zsock_recv(sock, req->internal.response.recv_buf + offset,
-				      req->internal.response.recv_buf_len - offset,
-				      0);
+		if (*pending > 0) {
+			received = *pending;
+			*pending = 0;
+		} else {
+			received = zsock_recv(sock,
+					      req->internal.response.recv_buf + offset,
+					      req->internal.response.recv_buf_len - offset,
+					      0);
+		}
+
 		if (received == 0) {
 			/* Connection closed */
 			LOG_DBG("Connection closed");
 			ret = total_received;
 
+			req->internal.response.keep_alive = 0;
+
 			if (req->internal.response.cb) {
 				NET_DBG("Calling callback for closed connection");
 
@@ -410,13 +436,20 @@ static int http_wait_data(int sock, struct http_request *req)
 			ret = -errno;
 			break;
 		} else {
-			req->internal.response.data_len += received;
-
-			(void)http_parser_execute(
+			parsed = http_parser_execute(
 				&req->internal.parser,
 				&req->internal.parser_settings,
 				req->internal.response.recv_buf + offset,
 				received);
+
+			if (req->internal.response.message_complete &&
+			    parsed < (size_t)received) {
+				extra = received - parsed;
+				extra_start = offset + parsed;
+				received = parsed;
+			}
+
+			req->internal.response.data_len += received;
 		}
 
 		total_received += received;
@@ -456,6 +489,13 @@ static int http_wait_data(int sock, struct http_request *req)
 		}
 
 		if (req->internal.response.message_complete) {
+			if (extra > 0) {
+				memmove(req->internal.response.recv_buf,
+					req->internal.response.recv_buf + extra_start,
+					extra);
+				*pending = extra;
+			}
+
 			ret = total_received;
 			break;
 		}
@@ -474,32 +514,65 @@ static void http_timeout(struct k_work *work)
 	(void)zsock_close(data->sock);
 }
 
-int http_client_req(int sock, struct http_request *req,
-		    int32_t timeout, void *user_data)
+static int http_send_chunks(int sock, struct http_request *req,
+			    void *user_data)
+{
+	static const char last_chunk[] = "0" HTTP_CRLF HTTP_CRLF;
+	char chunk_hdr[sizeof("ffffffff" HTTP_CRLF)];
+	const uint8_t *chunk;
+	int total_sent = 0;
+	int ret, len;
+
+	while (true) {
+		len = req->payload_chunk_cb(req, &chunk, user_data);
+		if (len < 0) {
+			return len;
+		}
+
+		if (len == 0) {
+			break;
+		}
+
+		ret = snprintk(chunk_hdr, sizeof(chunk_hdr), "%x" HTTP_CRLF,
+			       len);
+		total_sent += ret + len + sizeof(HTTP_CRLF) - 1;
+
+		ret = sendall(sock, chunk_hdr, ret);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = sendall(sock, chunk, len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = sendall(sock, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	/* Last chunk without trailer fields */
+	ret = sendall(sock, last_chunk, sizeof(last_chunk) - 1);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total_sent + sizeof(last_chunk) - 1;
+}
+
+static int http_send_request(int sock, struct http_request *req,
+			     void *user_data)
 {
 	/* Utilize the network usage by sending data in bigger blocks */
 	char send_buf[MAX_SEND_BUF_LEN];
 	const size_t send_buf_max_len = sizeof(send_buf);
 	size_t send_buf_pos = 0;
 	int total_sent = 0;
-	int ret, total_recv, i;
+	int ret, i;
 	const char *method;
 
-	if (sock < 0 || req == NULL || req->response == NULL ||
-	    req->recv_buf == NULL || req->recv_buf_len == 0) {
-		return -EINVAL;
-	}
-
-	memset(&req->internal.response, 0, sizeof(req->internal.response));
-
-	req->internal.response.http_cb = req->http_cb;
-	req->internal.response.cb = req->response;
-	req->internal.response.recv_buf = req->recv_buf;
-	req->internal.response.recv_buf_len = req->recv_buf_len;
-	req->internal.user_data = user_data;
-	req->internal.sock = sock;
-	req->internal.timeout = SYS_TIMEOUT_MS(timeout);
-
 	method = http_method_str(req->method);
 
 	ret = http_send_data(sock, send_buf, send_buf_max_len, &send_buf_pos,
@@ -584,7 +657,30 @@ int http_client_req(int sock, struct http_request *req,
 		total_sent += ret;
 	}
 
-	if (req->payload || req->payload_cb) {
+	if (req->payload_chunk_cb) {
+		ret = http_send_data(sock, send_buf, send_buf_max_len,
+				     &send_buf_pos, "Transfer-Encoding", ": ",
+				     "chunked", HTTP_CRLF, HTTP_CRLF, NULL);
+		if (ret < 0) {
+			goto out;
+		}
+
+		total_sent += ret;
+
+		ret = http_flush_data(sock, send_buf, send_buf_pos);
+		if (ret < 0) {
+			goto out;
+		}
+
+		send_buf_pos = 0;
+
+		ret = http_send_chunks(sock, req, user_data);
+		if (ret < 0) {
+			goto out;
+		}
+
+		total_sent += ret;
+	} else if (req->payload || req->payload_cb) {
 		if (req->payload_len) {
 			char content_len_str[HTTP_CONTENT_LEN_SIZE];
 
@@ -660,6 +756,37 @@ int http_client_req(int sock, struct http_request *req,
 
 	NET_DBG("Sent %d bytes", total_sent);
 
+	return total_sent;
+
+out:
+	return ret;
+}
+
+static bool http_request_is_valid(int sock, struct http_request *req)
+{
+	return sock >= 0 && req != NULL && req->response != NULL &&
+	       req->recv_buf != NULL && req->recv_buf_len != 0;
+}
+
+static void http_request_init(int sock, struct http_request *req,
+			      int32_t timeout, void *user_data)
+{
+	memset(&req->internal.response, 0, sizeof(req->internal.response));
+
+	req->internal.response.http_cb = req->http_cb;
+	req->internal.response.cb = req->response;
+	req->internal.response.recv_buf = req->recv_buf;
+	req->internal.response.recv_buf_len = req->recv_buf_len;
+	req->internal.user_data = user_data;
+	req->internal.sock = sock;
+	req->internal.timeout = SYS_TIMEOUT_MS(timeout);
+}
+
+static int http_recv_response(int sock, struct http_request *req,
+			      size_t *pending)
+{
+	int total_recv;
+
 	http_client_init_parser(&req->internal.parser,
 				&req->internal.parser_settings);
 
@@ -671,7 +798,7 @@ int http_client_req(int sock, struct http_request *req,
 	}
 
 	/* Request is sent, now wait data to be received */
-	total_recv = http_wait_data(sock, req);
+	total_recv = http_wait_data(sock, req, pending);
 	if (total_recv < 0) {
 		NET_DBG("Wait data failure (%d)", total_recv);
 	} else {
@@ -683,8 +810,98 @@ int http_client_req(int sock, struct http_request *req,
 		(void)k_work_cancel_delayable(&req->internal.work);
 	}
 
+	return total_recv;
+}
+
+int http_client_req(int sock, struct http_request *req,
+		    int32_t timeout, void *user_data)
+{
+	size_t pending = 0;
+	int total_sent;
+
+	if (!http_request_is_valid(sock, req)) {
+		return -EINVAL;
+	}
+
+	http_request_init(sock, req, timeout, user_data);
+
+	total_sent = http_send_request(sock, req, user_data);
+	if (total_sent < 0) {
+		return total_sent;
+	}
+
+	(void)http_recv_response(sock, req, &pending);
+
 	return total_sent;
+}
 
-out:
-	return ret;
+int http_client_req_pipeline(int sock, struct http_request **reqs,
+			     size_t count, int32_t timeout, void *user_data)
+{
+	size_t pending = 0;
+	int total_sent = 0;
+	int ret;
+	size_t i;
+
+	if (reqs == NULL || count == 0) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct http_request *req = reqs[i];
+
+		if (!http_request_is_valid(sock, req)) {
+			return -EINVAL;
+		}
+
+		/* Only idempotent requests without a body may be pipelined
+		 * (RFC 7230, section 6.3.2).
+		 */
+		if ((req->method != HTTP_GET && req->method != HTTP_HEAD &&
+		     req->method != HTTP_OPTIONS) ||
+		    req->payload || req->payload_cb || req->payload_chunk_cb) {
+			return -EINVAL;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		http_request_init(sock, reqs[i], timeout, user_data);
+
+		ret = http_send_request(sock, reqs[i], user_data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		total_sent += ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct http_request *req = reqs[i];
+
+		ret = http_recv_response(sock, req, &pending);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!req->internal.response.message_complete) {
+			/* Connection was closed before all the responses
+			 * were received.
+			 */
+			return -ECONNRESET;
+		}
+
+		if (pending > 0 && i + 1 < count) {
+			struct http_request *next = reqs[i + 1];
+
+			if (pending > next->recv_buf_len) {
+				return -ENOBUFS;
+			}
+
+			if (next->recv_buf != req->recv_buf) {
+				memcpy(next->recv_buf, req->recv_buf, pending);
+			}
+		}
+	}
+
+	return total_sent;
 }
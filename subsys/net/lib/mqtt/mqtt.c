@@ -59,6 +59,11 @@ static void client_disconnect(struct mqtt_client *client, int result,
 	/* Reset internal state. */
 	client_reset(client);
 
+	/* Outstanding messages only survive in a persistent session. */
+	if (client->clean_session) {
+		mqtt_inflight_reset(client);
+	}
+
 	if (notify) {
 		struct mqtt_evt evt = {
 			.type = MQTT_EVT_DISCONNECT,
@@ -261,8 +266,14 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
+	err_code = mqtt_inflight_add(client, param);
+	if (err_code < 0) {
+		goto error;
+	}
+
 	err_code = publish_encode(param, &packet);
 	if (err_code < 0) {
+		mqtt_inflight_remove(client, param->message_id);
 		goto error;
 	}
 
@@ -277,6 +288,9 @@ int mqtt_publish(struct mqtt_client *client,
 	msg.msg_iovlen = ARRAY_SIZE(io_vector);
 
 	err_code = client_write_msg(client, &msg);
+	if (err_code < 0) {
+		mqtt_inflight_remove(client, param->message_id);
+	}
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -382,6 +396,13 @@ int mqtt_publish_qos2_release(struct mqtt_client *client,
 		goto error;
 	}
 
+	/* PUBREL of a tracked message is sent by the library on PUBREC. */
+	if (mqtt_inflight_pubrel_sent(client, param->message_id)) {
+		MQTT_TRC("[CID %p]: PUBREL for 0x%04x already sent",
+			 client, param->message_id);
+		goto error;
+	}
+
 	err_code = publish_release_encode(param, &packet);
 	if (err_code < 0) {
 		goto error;
@@ -596,11 +617,23 @@ int mqtt_live(struct mqtt_client *client)
 	int err_code = 0;
 	uint32_t elapsed_time;
 	bool ping_sent = false;
+	bool retransmitted = false;
 
 	NULL_PARAM_CHECK(client);
 
 	mqtt_mutex_lock(client);
 
+	if (MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		err_code = mqtt_inflight_retransmit(client, false);
+		if (err_code < 0) {
+			client_disconnect(client, err_code, true);
+			goto exit;
+		}
+
+		retransmitted = (err_code > 0);
+		err_code = 0;
+	}
+
 	elapsed_time = mqtt_elapsed_time_in_ms_get(
 				client->internal.last_activity);
 	if ((client->keepalive > 0) &&
@@ -609,9 +642,10 @@ int mqtt_live(struct mqtt_client *client)
 		ping_sent = true;
 	}
 
+exit:
 	mqtt_mutex_unlock(client);
 
-	if (ping_sent) {
+	if (ping_sent || retransmitted || err_code < 0) {
 		return err_code;
 	} else {
 		return -EAGAIN;
@@ -623,17 +657,25 @@ int mqtt_keepalive_time_left(const struct mqtt_client *client)
 	uint32_t elapsed_time = mqtt_elapsed_time_in_ms_get(
 					client->internal.last_activity);
 	uint32_t keepalive_ms = 1000U * client->keepalive;
+	int retransmit_ms = mqtt_inflight_time_left(client);
+	int time_left;
 
 	if (client->keepalive == 0) {
 		/* Keep alive not enabled. */
-		return -1;
+		return retransmit_ms;
 	}
 
 	if (keepalive_ms <= elapsed_time) {
 		return 0;
 	}
 
-	return keepalive_ms - elapsed_time;
+	time_left = keepalive_ms - elapsed_time;
+
+	if (retransmit_ms >= 0 && retransmit_ms < time_left) {
+		return retransmit_ms;
+	}
+
+	return time_left;
 }
 
 int mqtt_input(struct mqtt_client *client)
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file mqtt_inflight.c
+ *
+ * @brief Tracking of outstanding QoS 1 and QoS 2 publish messages.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_mqtt_inflight, CONFIG_MQTT_LOG_LEVEL);
+
+#include <net/mqtt.h>
+
+#include "mqtt_transport.h"
+#include "mqtt_internal.h"
+#include "mqtt_os.h"
+
+/**@brief States of an in-flight entry. */
+enum mqtt_inflight_state {
+	/** Entry unused. */
+	MQTT_INFLIGHT_FREE = 0,
+
+	/** QoS 1 PUBLISH sent, waiting for PUBACK. */
+	MQTT_INFLIGHT_WAIT_PUBACK,
+
+	/** QoS 2 PUBLISH sent, waiting for PUBREC. */
+	MQTT_INFLIGHT_WAIT_PUBREC,
+
+	/** PUBREL sent, waiting for PUBCOMP. */
+	MQTT_INFLIGHT_WAIT_PUBCOMP,
+};
+
+#define RETRANSMIT_TIMEOUT CONFIG_MQTT_INFLIGHT_RETRANSMIT_TIMEOUT
+
+static struct mqtt_inflight_entry *inflight_find(struct mqtt_client *client,
+						 uint16_t message_id)
+{
+	struct mqtt_inflight_entry *entry;
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->state != MQTT_INFLIGHT_FREE &&
+		    entry->param.message_id == message_id) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static int inflight_send_publish(struct mqtt_client *client,
+				 struct mqtt_inflight_entry *entry)
+{
+	int err_code;
+	struct buf_ctx packet;
+	struct iovec io_vector[2];
+	struct msghdr msg;
+
+	memset(client->tx_buf, 0, client->tx_buf_size);
+	packet.cur = client->tx_buf;
+	packet.end = client->tx_buf + client->tx_buf_size;
+
+	/* Every retransmission of a PUBLISH carries the DUP flag. */
+	entry->param.dup_flag = 1U;
+
+	err_code = publish_encode(&entry->param, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	io_vector[0].iov_base = packet.cur;
+	io_vector[0].iov_len = packet.end - packet.cur;
+	io_vector[1].iov_base = entry->param.message.payload.data;
+	io_vector[1].iov_len = entry->param.message.payload.len;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+
+	return mqtt_transport_write_msg(client, &msg);
+}
+
+static int inflight_send_pubrel(struct mqtt_client *client,
+				struct mqtt_inflight_entry *entry)
+{
+	int err_code;
+	struct buf_ctx packet;
+	const struct mqtt_pubrel_param param = {
+		.message_id = entry->param.message_id
+	};
+
+	memset(client->tx_buf, 0, client->tx_buf_size);
+	packet.cur = client->tx_buf;
+	packet.end = client->tx_buf + client->tx_buf_size;
+
+	err_code = publish_release_encode(&param, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	return mqtt_transport_write(client, packet.cur, packet.end - packet.cur);
+}
+
+static int inflight_send(struct mqtt_client *client,
+			 struct mqtt_inflight_entry *entry)
+{
+	int err_code;
+
+	if (entry->state == MQTT_INFLIGHT_WAIT_PUBCOMP) {
+		err_code = inflight_send_pubrel(client, entry);
+	} else {
+		err_code = inflight_send_publish(client, entry);
+	}
+
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	entry->timestamp = mqtt_sys_tick_in_ms_get();
+	client->internal.last_activity = entry->timestamp;
+
+	return 0;
+}
+
+int mqtt_inflight_add(struct mqtt_client *client,
+		      const struct mqtt_publish_param *param)
+{
+	struct mqtt_inflight_entry *free_entry = NULL;
+	struct mqtt_inflight_entry *entry;
+
+	if (param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		return 0;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->state == MQTT_INFLIGHT_FREE) {
+			if (free_entry == NULL) {
+				free_entry = entry;
+			}
+		} else if (entry->param.message_id == param->message_id) {
+			MQTT_TRC("[CID %p]: Message id 0x%04x already in flight",
+				 client, param->message_id);
+			return -EBUSY;
+		}
+	}
+
+	if (free_entry == NULL) {
+		return -EAGAIN;
+	}
+
+	free_entry->param = *param;
+	free_entry->timestamp = mqtt_sys_tick_in_ms_get();
+
+	if (param->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+		free_entry->state = MQTT_INFLIGHT_WAIT_PUBACK;
+	} else {
+		free_entry->state = MQTT_INFLIGHT_WAIT_PUBREC;
+	}
+
+	return 0;
+}
+
+void mqtt_inflight_remove(struct mqtt_client *client, uint16_t message_id)
+{
+	struct mqtt_inflight_entry *entry = inflight_find(client, message_id);
+
+	if (entry != NULL) {
+		entry->state = MQTT_INFLIGHT_FREE;
+	}
+}
+
+int mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		      uint16_t message_id)
+{
+	struct mqtt_inflight_entry *entry = inflight_find(client, message_id);
+
+	if (entry == NULL) {
+		MQTT_TRC("[CID %p]: Message id 0x%04x not in flight",
+			 client, message_id);
+		return 0;
+	}
+
+	switch (type) {
+	case MQTT_PKT_TYPE_PUBACK:
+		if (entry->state == MQTT_INFLIGHT_WAIT_PUBACK) {
+			entry->state = MQTT_INFLIGHT_FREE;
+		}
+
+		break;
+
+	case MQTT_PKT_TYPE_PUBREC:
+		/* A duplicated PUBREC is answered with PUBREL again. */
+		if (entry->state == MQTT_INFLIGHT_WAIT_PUBREC ||
+		    entry->state == MQTT_INFLIGHT_WAIT_PUBCOMP) {
+			entry->state = MQTT_INFLIGHT_WAIT_PUBCOMP;
+			return inflight_send(client, entry);
+		}
+
+		break;
+
+	case MQTT_PKT_TYPE_PUBCOMP:
+		if (entry->state == MQTT_INFLIGHT_WAIT_PUBCOMP) {
+			entry->state = MQTT_INFLIGHT_FREE;
+		}
+
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+bool mqtt_inflight_pubrel_sent(struct mqtt_client *client,
+			       uint16_t message_id)
+{
+	struct mqtt_inflight_entry *entry = inflight_find(client, message_id);
+
+	return entry != NULL && entry->state == MQTT_INFLIGHT_WAIT_PUBCOMP;
+}
+
+int mqtt_inflight_retransmit(struct mqtt_client *client, bool all)
+{
+	struct mqtt_inflight_entry *entry;
+	int err_code;
+	int count = 0;
+
+	if (!all && RETRANSMIT_TIMEOUT == 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->state == MQTT_INFLIGHT_FREE) {
+			continue;
+		}
+
+		if (!all && mqtt_elapsed_time_in_ms_get(entry->timestamp) <
+			    RETRANSMIT_TIMEOUT) {
+			continue;
+		}
+
+		MQTT_TRC("[CID %p]: Retransmitting message id 0x%04x",
+			 client, entry->param.message_id);
+
+		err_code = inflight_send(client, entry);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+int mqtt_inflight_time_left(const struct mqtt_client *client)
+{
+	const struct mqtt_inflight_entry *entry;
+	uint32_t elapsed_time;
+	int time_left = -1;
+
+	if (RETRANSMIT_TIMEOUT == 0) {
+		return -1;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->state == MQTT_INFLIGHT_FREE) {
+			continue;
+		}
+
+		elapsed_time = mqtt_elapsed_time_in_ms_get(entry->timestamp);
+		if (elapsed_time >= RETRANSMIT_TIMEOUT) {
+			return 0;
+		}
+
+		if (time_left < 0 ||
+		    (int)(RETRANSMIT_TIMEOUT - elapsed_time) < time_left) {
+			time_left = RETRANSMIT_TIMEOUT - elapsed_time;
+		}
+	}
+
+	return time_left;
+}
+
+void mqtt_inflight_reset(struct mqtt_client *client)
+{
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		client->internal.inflight[i].state = MQTT_INFLIGHT_FREE;
+	}
+}
+
+int mqtt_inflight_window_free(const struct mqtt_client *client)
+{
+	int count = 0;
+
+	NULL_PARAM_CHECK(client);
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		if (client->internal.inflight[i].state == MQTT_INFLIGHT_FREE) {
+			count++;
+		}
+	}
+
+	return count;
+}
@@ -393,6 +393,110 @@ int subscribe_ack_decode(struct buf_ctx *buf,
 int unsubscribe_ack_decode(struct buf_ctx *buf,
 			   struct mqtt_unsuback_param *param);
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/**@brief Reserve an in-flight entry for a QoS 1 or QoS 2 publish message.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] param Publish message to track.
+ *
+ * @return 0 if the procedure is successful, -EAGAIN if the window is full,
+ *         -EBUSY if the message id is already in flight.
+ */
+int mqtt_inflight_add(struct mqtt_client *client,
+		      const struct mqtt_publish_param *param);
+
+/**@brief Release the in-flight entry of a message that was not sent.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] message_id Message id of the entry to release.
+ */
+void mqtt_inflight_remove(struct mqtt_client *client, uint16_t message_id);
+
+/**@brief Update the in-flight table on PUBACK, PUBREC or PUBCOMP reception.
+ *        PUBREL is sent in response to PUBREC.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] type Received packet type.
+ * @param[in] message_id Message id of the received packet.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		      uint16_t message_id);
+
+/**@brief Check whether the library has already sent PUBREL for a message.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] message_id Message id of the QoS 2 message.
+ *
+ * @return true if the message is waiting for PUBCOMP, false otherwise.
+ */
+bool mqtt_inflight_pubrel_sent(struct mqtt_client *client,
+			       uint16_t message_id);
+
+/**@brief Retransmit outstanding messages.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] all Retransmit all messages if true, only the timed out ones
+ *                otherwise.
+ *
+ * @return Number of messages retransmitted or an error code.
+ */
+int mqtt_inflight_retransmit(struct mqtt_client *client, bool all);
+
+/**@brief Time left until the next retransmission is due.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ *
+ * @return Time in milliseconds, or -1 if no retransmission is pending.
+ */
+int mqtt_inflight_time_left(const struct mqtt_client *client);
+
+/**@brief Drop all outstanding messages.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ */
+void mqtt_inflight_reset(struct mqtt_client *client);
+#else
+static inline int mqtt_inflight_add(struct mqtt_client *client,
+				    const struct mqtt_publish_param *param)
+{
+	return 0;
+}
+
+static inline void mqtt_inflight_remove(struct mqtt_client *client,
+					uint16_t message_id)
+{
+}
+
+static inline int mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+				    uint16_t message_id)
+{
+	return 0;
+}
+
+static inline bool mqtt_inflight_pubrel_sent(struct mqtt_client *client,
+					     uint16_t message_id)
+{
+	return false;
+}
+
+static inline int mqtt_inflight_retransmit(struct mqtt_client *client,
+					   bool all)
+{
+	return 0;
+}
+
+static inline int mqtt_inflight_time_left(const struct mqtt_client *client)
+{
+	return -1;
+}
+
+static inline void mqtt_inflight_reset(struct mqtt_client *client)
+{
+}
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 #ifdef __cplusplus
 }
 #endif
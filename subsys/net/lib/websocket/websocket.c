@@ -560,25 +560,32 @@ static int sendmsg_all(int sock, const struct msghdr *message, int flags)
 
 static int websocket_prepare_and_send(struct websocket_context *ctx,
 				      uint8_t *header, size_t header_len,
-				      uint8_t *payload, size_t payload_len,
-				      int32_t timeout)
+				      const struct iovec *payload,
+				      size_t payload_cnt, int32_t timeout)
 {
-	struct iovec io_vector[2];
+	struct iovec io_vector[1 + MAX_SEND_IOVCNT];
 	struct msghdr msg;
+	size_t i;
 
 	io_vector[0].iov_base = header;
 	io_vector[0].iov_len = header_len;
-	io_vector[1].iov_base = payload;
-	io_vector[1].iov_len = payload_len;
+
+	for (i = 0; i < payload_cnt; i++) {
+		io_vector[1 + i] = payload[i];
+	}
 
 	memset(&msg, 0, sizeof(msg));
 
 	msg.msg_iov = io_vector;
-	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+	msg.msg_iovlen = 1 + payload_cnt;
 
 	if (HEXDUMP_SENT_PACKETS) {
 		LOG_HEXDUMP_DBG(header, header_len, "Header");
-		LOG_HEXDUMP_DBG(payload, payload_len, "Payload");
+
+		for (i = 0; i < payload_cnt; i++) {
+			LOG_HEXDUMP_DBG(payload[i].iov_base,
+					payload[i].iov_len, "Payload");
+		}
 	}
 
 #if defined(CONFIG_NET_TEST)
@@ -598,15 +605,38 @@ static int websocket_prepare_and_send(struct websocket_context *ctx,
 #endif /* CONFIG_NET_TEST */
 }
 
-int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
-		       enum websocket_opcode opcode, bool mask, bool final,
-		       int32_t timeout)
+/* Apply the masking key to len bytes of src and store the result to dst.
+ * The dst and src can point to the same buffer. The offset is the position
+ * of the first byte in the message, it selects the masking key byte to start
+ * from. The data is processed a machine word at a time.
+ */
+void websocket_mask_payload(uint8_t *dst, const uint8_t *src, size_t len,
+			    uint32_t masking_value, uint64_t offset)
 {
-	struct websocket_context *ctx;
-	uint8_t header[MAX_HEADER_LEN], hdr_len = 2;
-	uint8_t *data_to_send = (uint8_t *)payload;
-	int ret;
+	uint8_t key[sizeof(unsigned long)];
+	unsigned long key_word;
+	unsigned long word;
+	size_t i;
+
+	for (i = 0; i < sizeof(key); i++) {
+		key[i] = masking_value >> (8 * (3 - (offset + i) % 4));
+	}
+
+	memcpy(&key_word, key, sizeof(key_word));
+
+	for (i = 0; i + sizeof(word) <= len; i += sizeof(word)) {
+		memcpy(&word, &src[i], sizeof(word));
+		word ^= key_word;
+		memcpy(&dst[i], &word, sizeof(word));
+	}
 
+	for (; i < len; i++) {
+		dst[i] = src[i] ^ key[i % sizeof(key)];
+	}
+}
+
+static int websocket_validate_opcode(enum websocket_opcode opcode)
+{
 	if (opcode != WEBSOCKET_OPCODE_DATA_TEXT &&
 	    opcode != WEBSOCKET_OPCODE_DATA_BINARY &&
 	    opcode != WEBSOCKET_OPCODE_CONTINUE &&
@@ -616,6 +646,13 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		return -EINVAL;
 	}
 
+	return 0;
+}
+
+static struct websocket_context *websocket_send_ctx_get(int ws_sock)
+{
+	struct websocket_context *ctx;
+
 #if defined(CONFIG_NET_TEST)
 	/* Websocket unit test does not use socket layer but feeds
 	 * the data directly here when testing this function.
@@ -624,18 +661,30 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 #else
 	ctx = z_get_fd_obj(ws_sock, NULL, 0);
 	if (ctx == NULL) {
-		return -EBADF;
+		errno = EBADF;
+		return NULL;
 	}
 
 	if (!PART_OF_ARRAY(contexts, ctx)) {
-		return -ENOENT;
+		errno = ENOENT;
+		return NULL;
 	}
 #endif /* CONFIG_NET_TEST */
 
-	NET_DBG("[%p] Len %zd %s/%d/%s", ctx, payload_len, opcode2str(opcode),
-		mask, final ? "final" : "more");
+	return ctx;
+}
+
+/* Fill in the websocket header and return its length. A new masking value
+ * is generated if the payload is to be masked.
+ */
+static size_t websocket_prepare_header(struct websocket_context *ctx,
+				       uint8_t *header, size_t payload_len,
+				       enum websocket_opcode opcode,
+				       bool mask, bool final)
+{
+	size_t hdr_len = 2;
 
-	memset(header, 0, sizeof(header));
+	memset(header, 0, MAX_HEADER_LEN);
 
 	/* Is this the last packet? */
 	header[0] = final ? BIT(7) : 0;
@@ -668,40 +717,130 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 
 	/* Add masking value if needed */
 	if (mask) {
-		int i;
-
 		ctx->masking_value = sys_rand32_get();
 
 		header[hdr_len++] |= ctx->masking_value >> 24;
 		header[hdr_len++] |= ctx->masking_value >> 16;
 		header[hdr_len++] |= ctx->masking_value >> 8;
 		header[hdr_len++] |= ctx->masking_value;
+	}
+
+	return hdr_len;
+}
+
+int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
+		       enum websocket_opcode opcode, bool mask, bool final,
+		       int32_t timeout)
+{
+	struct websocket_context *ctx;
+	uint8_t header[MAX_HEADER_LEN];
+	size_t hdr_len;
+	struct iovec io_vector;
+	uint8_t *data_to_send = (uint8_t *)payload;
+	int ret;
+
+	ret = websocket_validate_opcode(opcode);
+	if (ret < 0) {
+		return ret;
+	}
 
+	ctx = websocket_send_ctx_get(ws_sock);
+	if (ctx == NULL) {
+		return -errno;
+	}
+
+	NET_DBG("[%p] Len %zd %s/%d/%s", ctx, payload_len, opcode2str(opcode),
+		mask, final ? "final" : "more");
+
+	hdr_len = websocket_prepare_header(ctx, header, payload_len, opcode,
+					   mask, final);
+
+	if (mask) {
 		data_to_send = k_malloc(payload_len);
 		if (!data_to_send) {
 			return -ENOMEM;
 		}
 
-		memcpy(data_to_send, payload, payload_len);
-
-		for (i = 0; i < payload_len; i++) {
-			data_to_send[i] ^=
-				ctx->masking_value >> (8 * (3 - i % 4));
-		}
+		/* The masking is done while copying the payload. */
+		websocket_mask_payload(data_to_send, payload, payload_len,
+				       ctx->masking_value, 0);
 	}
 
+	io_vector.iov_base = data_to_send;
+	io_vector.iov_len = payload_len;
+
 	ret = websocket_prepare_and_send(ctx, header, hdr_len,
-					 data_to_send, payload_len, timeout);
+					 &io_vector, 1, timeout);
 	if (ret < 0) {
 		NET_DBG("Cannot send ws msg (%d)", -errno);
 		goto quit;
 	}
 
+	ret -= hdr_len;
+
 quit:
 	if (data_to_send != payload) {
 		k_free(data_to_send);
 	}
 
+	return ret;
+}
+
+int websocket_send_msgv(int ws_sock, struct iovec *iov, size_t iovcnt,
+			enum websocket_opcode opcode, bool mask, bool final,
+			int32_t timeout)
+{
+	struct websocket_context *ctx;
+	uint8_t header[MAX_HEADER_LEN];
+	size_t payload_len = 0;
+	size_t hdr_len;
+	size_t i;
+	int ret;
+
+	ret = websocket_validate_opcode(opcode);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (iovcnt > MAX_SEND_IOVCNT || (iovcnt > 0 && iov == NULL)) {
+		return -EINVAL;
+	}
+
+	ctx = websocket_send_ctx_get(ws_sock);
+	if (ctx == NULL) {
+		return -errno;
+	}
+
+	for (i = 0; i < iovcnt; i++) {
+		payload_len += iov[i].iov_len;
+	}
+
+	NET_DBG("[%p] Len %zd (%zd vectors) %s/%d/%s", ctx, payload_len,
+		iovcnt, opcode2str(opcode), mask, final ? "final" : "more");
+
+	hdr_len = websocket_prepare_header(ctx, header, payload_len, opcode,
+					   mask, final);
+
+	if (mask) {
+		uint64_t offset = 0;
+
+		/* Mask the data in place, no copy is needed. */
+		for (i = 0; i < iovcnt; i++) {
+			websocket_mask_payload(iov[i].iov_base,
+					       iov[i].iov_base,
+					       iov[i].iov_len,
+					       ctx->masking_value, offset);
+			offset += iov[i].iov_len;
+		}
+	}
+
+	ret = websocket_prepare_and_send(ctx, header, hdr_len, iov, iovcnt,
+					 timeout);
+	if (ret < 0) {
+		NET_DBG("Cannot send ws msg (%d)", -errno);
+		return ret;
+	}
+
 	return ret - hdr_len;
 }
 
@@ -897,72 +1036,80 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	/* Now read the whole payload or parts of it */
 
 	if (ctx->tmp_buf_pos == 0) {
-		/* Read more data into temp buffer */
+		/* Nothing is buffered, so read the payload directly into
+		 * the caller's buffer and unmask it there. The read is
+		 * limited to the current message so that the next header
+		 * is not consumed.
+		 */
+		size_t to_read = MIN(ctx->message_len - ctx->total_read,
+				     buf_len);
+
+		if (to_read > 0) {
 #if defined(CONFIG_NET_TEST)
-		size_t input_len = MIN(ctx->tmp_buf_len, test_data->input_len);
+			size_t input_len = MIN(to_read, test_data->input_len);
 
-		memcpy(ctx->tmp_buf, test_data->input_buf, input_len);
-		test_data->input_buf += input_len;
+			memcpy(buf, test_data->input_buf, input_len);
+			test_data->input_buf += input_len;
 
-		ret = input_len;
+			ret = input_len;
 #else
-		ret = recv(ctx->real_sock, ctx->tmp_buf, ctx->tmp_buf_len,
-			   K_TIMEOUT_EQ(tout, K_NO_WAIT) ? MSG_DONTWAIT : 0);
+			ret = recv(ctx->real_sock, buf, to_read,
+				   K_TIMEOUT_EQ(tout, K_NO_WAIT) ?
+				   MSG_DONTWAIT : 0);
 #endif /* CONFIG_NET_TEST */
 
-		if (ret < 0) {
-			return -errno;
-		}
+			if (ret < 0) {
+				return -errno;
+			}
 
-		if (ret == 0) {
-			return 0;
+			if (ret == 0) {
+				return 0;
+			}
+		} else {
+			ret = 0;
 		}
 
-		ctx->tmp_buf_pos = ret;
-	}
-
-	if (ctx->tmp_buf_pos <= buf_len) {
-		/* Is there already any data in the temp buffer? If yes,
-		 * just return it to the caller.
-		 */
-		can_copy = MIN(ctx->message_len - ctx->total_read,
-			       ctx->tmp_buf_pos);
+		recv_len = ret;
 	} else {
-		/* We have more data in tmp buffer that will fit into
-		 * user buffer.
-		 */
-		can_copy = MIN(ctx->message_len - ctx->total_read, buf_len);
-	}
+		if (ctx->tmp_buf_pos <= buf_len) {
+			/* Is there already any data in the temp buffer? If
+			 * yes, just return it to the caller.
+			 */
+			can_copy = MIN(ctx->message_len - ctx->total_read,
+				       ctx->tmp_buf_pos);
+		} else {
+			/* We have more data in tmp buffer that will fit into
+			 * user buffer.
+			 */
+			can_copy = MIN(ctx->message_len - ctx->total_read,
+				       buf_len);
+		}
 
-	left = ctx->tmp_buf_pos - can_copy;
+		left = ctx->tmp_buf_pos - can_copy;
 
-	NET_ASSERT(ctx->tmp_buf_pos >= can_copy);
+		NET_ASSERT(ctx->tmp_buf_pos >= can_copy);
 
-	memmove(buf, ctx->tmp_buf, can_copy);
-	recv_len = can_copy;
+		memmove(buf, ctx->tmp_buf, can_copy);
+		recv_len = can_copy;
 
-	if (left > 0) {
-		memmove(ctx->tmp_buf, &ctx->tmp_buf[can_copy], left);
-	}
+		if (left > 0) {
+			memmove(ctx->tmp_buf, &ctx->tmp_buf[can_copy], left);
+		}
 
-	ctx->tmp_buf_pos = left;
-	ctx->total_read += recv_len;
+		ctx->tmp_buf_pos = left;
+	}
 
-	/* Unmask the data */
+	/* Unmask the data. As we might have less than 4 received bytes
+	 * earlier, the offset in the message selects the masking key byte
+	 * to start from.
+	 */
 	if (ctx->masked) {
-		/* As we might have less than 4 received bytes, we must select
-		 * which byte from masking value to take. The mask_shift will
-		 * tell that.
-		 */
-		int mask_shift = (ctx->total_read - recv_len) % sizeof(uint32_t);
-		int i;
-
-		for (i = 0; i < recv_len; i++) {
-			buf[i] ^= ctx->masking_value >>
-				(8 * (3 - (i + mask_shift) % 4));
-		}
+		websocket_mask_payload(buf, buf, recv_len, ctx->masking_value,
+				       ctx->total_read);
 	}
 
+	ctx->total_read += recv_len;
+
 #if HEXDUMP_RECV_PACKETS
 	LOG_HEXDUMP_DBG(buf, recv_len, "Payload");
 #endif
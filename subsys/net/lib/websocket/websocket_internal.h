@@ -20,6 +20,9 @@
 /* Max Websocket header length */
 #define MAX_HEADER_LEN 14
 
+/* Max number of payload vectors in websocket_send_msgv() */
+#define MAX_SEND_IOVCNT CONFIG_WEBSOCKET_MAX_SEND_IOVCNT
+
 /* From RFC 6455 chapter 4.2.2 */
 #define WS_MAGIC "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
 
@@ -105,6 +108,18 @@ __net_socket struct websocket_context {
 	uint8_t header_received : 1;
 };
 
+/**
+ * @brief Mask or unmask Websocket payload.
+ *
+ * @param dst Destination buffer, can be the same as src.
+ * @param src Source buffer.
+ * @param len Length of the data.
+ * @param masking_value Masking key of the message.
+ * @param offset Position of the first byte of the data in the message.
+ */
+void websocket_mask_payload(uint8_t *dst, const uint8_t *src, size_t len,
+			    uint32_t masking_value, uint64_t offset);
+
 /**
  * @brief Disconnect the Websocket.
  *
@@ -10,14 +10,18 @@
 #include <zephyr/types.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <kernel.h>
 #include <device.h>
 #include <storage/flash_map.h>
 #include "flash_map_priv.h"
 #include <drivers/flash.h>
 #include <soc.h>
 #include <init.h>
+#include <sys/byteorder.h>
+#include <sys/crc.h>
+#include <errno.h>
+#include <string.h>
 
-#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY)
 #define SHA256_DIGEST_SIZE 32
 #if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
 #include <tinycrypt/constants.h>
@@ -25,107 +29,262 @@
 #else
 #include <mbedtls/md.h>
 #endif
-#include <string.h>
-#endif /* CONFIG_FLASH_AREA_CHECK_INTEGRITY */
 
-int flash_area_check_int_sha256(const struct flash_area *fa,
-				const struct flash_area_check *fac)
+static int hash_start(struct flash_area_check_ctx *ctx)
 {
-	unsigned char hash[SHA256_DIGEST_SIZE];
+	if (ctx->alg == FLASH_AREA_CHECK_CRC32) {
+		ctx->crc = 0U;
+		return 0;
+	}
+
 #if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
-	struct tc_sha256_state_struct sha;
+	if (tc_sha256_init(&ctx->sha) != TC_CRYPTO_SUCCESS) {
+		return -ESRCH;
+	}
 #else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-	mbedtls_md_context_t mbed_hash_ctx;
-	const mbedtls_md_info_t *mbed_hash_info;
-#endif
-	const struct device *dev;
-	int to_read;
-	int pos;
-	int rc;
+	mbedtls_md_init(&ctx->md);
 
-	if (fa == NULL || fac == NULL || fac->match == NULL ||
-	    fac->rbuf == NULL || fac->clen == 0 || fac->rblen == 0) {
-		return -EINVAL;
+	if (mbedtls_md_setup(&ctx->md,
+			     mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+			     0) != 0) {
+		mbedtls_md_free(&ctx->md);
+		return -ESRCH;
 	}
 
-	if (!is_in_flash_area_bounds(fa, fac->off, fac->clen)) {
-		return -EINVAL;
+	if (mbedtls_md_starts(&ctx->md) != 0) {
+		mbedtls_md_free(&ctx->md);
+		return -ESRCH;
+	}
+#endif
+
+	return 0;
+}
+
+static int hash_update(struct flash_area_check_ctx *ctx, const uint8_t *data,
+		       size_t len)
+{
+	if (ctx->alg == FLASH_AREA_CHECK_CRC32) {
+		ctx->crc = crc32_ieee_update(ctx->crc, data, len);
+		return 0;
 	}
 
 #if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
-	if (tc_sha256_init(&sha) != TC_CRYPTO_SUCCESS) {
+	if (tc_sha256_update(&ctx->sha, data, len) != TC_CRYPTO_SUCCESS) {
 		return -ESRCH;
 	}
 #else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-	mbed_hash_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+	if (mbedtls_md_update(&ctx->md, data, len) != 0) {
+		return -ESRCH;
+	}
+#endif
 
-	mbedtls_md_init(&mbed_hash_ctx);
+	return 0;
+}
 
-	if (mbedtls_md_setup(&mbed_hash_ctx, mbed_hash_info, 0) != 0) {
+static void hash_free(struct flash_area_check_ctx *ctx)
+{
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS)
+	if (ctx->alg == FLASH_AREA_CHECK_SHA256) {
+		mbedtls_md_free(&ctx->md);
+	}
+#endif
+	ctx->fa = NULL;
+}
+
+int flash_area_check_init(struct flash_area_check_ctx *ctx,
+			  const struct flash_area *fa,
+			  enum flash_area_check_alg alg, off_t off, size_t len,
+			  uint8_t *rbuf, size_t rblen)
+{
+	if (ctx == NULL || fa == NULL || rbuf == NULL || len == 0 ||
+	    rblen == 0) {
+		return -EINVAL;
+	}
+
+	if (alg != FLASH_AREA_CHECK_CRC32 && alg != FLASH_AREA_CHECK_SHA256) {
+		return -EINVAL;
+	}
+
+	if (!is_in_flash_area_bounds(fa, off, len)) {
+		return -EINVAL;
+	}
+
+	ctx->dev = device_get_binding(fa->fa_dev_name);
+	if (ctx->dev == NULL) {
+		return -ENODEV;
+	}
+
+	ctx->alg = alg;
+	ctx->off = fa->fa_off + off;
+	ctx->remaining = len;
+	ctx->rbuf = rbuf;
+	ctx->rblen = rblen;
+
+	if (hash_start(ctx) != 0) {
 		return -ESRCH;
 	}
 
-	if (mbedtls_md_starts(&mbed_hash_ctx)) {
-		rc = -ESRCH;
-		goto error;
+	ctx->fa = fa;
+
+	return 0;
+}
+
+int flash_area_check_update(struct flash_area_check_ctx *ctx, size_t len)
+{
+	size_t to_read;
+	int rc;
+
+	if (ctx == NULL || ctx->fa == NULL || len > ctx->remaining) {
+		return -EINVAL;
 	}
-#endif
 
-	dev = device_get_binding(fa->fa_dev_name);
-	to_read = fac->rblen;
+	while (len > 0) {
+		to_read = MIN(len, ctx->rblen);
 
-	for (pos = 0; pos < fac->clen; pos += to_read) {
-		if (pos + to_read > fac->clen) {
-			to_read = fac->clen - pos;
+		rc = flash_read(ctx->dev, ctx->off, ctx->rbuf, to_read);
+		if (rc != 0) {
+			return rc;
 		}
 
-		rc = flash_read(dev, (fa->fa_off + fac->off + pos),
-				fac->rbuf, to_read);
+		rc = hash_update(ctx, ctx->rbuf, to_read);
 		if (rc != 0) {
-#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
 			return rc;
-#else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-			goto error;
-#endif
 		}
 
+		ctx->off += to_read;
+		ctx->remaining -= to_read;
+		len -= to_read;
+	}
+
+	return 0;
+}
+
+int flash_area_check_final(struct flash_area_check_ctx *ctx,
+			   const uint8_t *match)
+{
+	unsigned char hash[SHA256_DIGEST_SIZE];
+	size_t hash_len;
+	int rc = 0;
+
+	if (ctx == NULL || ctx->fa == NULL) {
+		return -EINVAL;
+	}
+
+	if (match == NULL || ctx->remaining != 0) {
+		rc = -EINVAL;
+		goto out;
+	}
+
+	if (ctx->alg == FLASH_AREA_CHECK_CRC32) {
+		sys_put_le32(ctx->crc, hash);
+		hash_len = sizeof(uint32_t);
+	} else {
 #if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
-		if (tc_sha256_update(&sha,
-				     fac->rbuf,
-				     to_read) != TC_CRYPTO_SUCCESS) {
-			return -ESRCH;
+		if (tc_sha256_final(hash, &ctx->sha) != TC_CRYPTO_SUCCESS) {
+			rc = -ESRCH;
+			goto out;
 		}
 #else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-		if (mbedtls_md_update(&mbed_hash_ctx, fac->rbuf, to_read) != 0) {
+		if (mbedtls_md_finish(&ctx->md, hash) != 0) {
 			rc = -ESRCH;
-			goto error;
+			goto out;
 		}
 #endif
+		hash_len = SHA256_DIGEST_SIZE;
 	}
 
-#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
-	if (tc_sha256_final(hash, &sha) != TC_CRYPTO_SUCCESS) {
-		return -ESRCH;
+	if (memcmp(hash, match, hash_len)) {
+		rc = -EILSEQ;
 	}
-#else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-	if (mbedtls_md_finish(&mbed_hash_ctx, hash) != 0) {
-		rc = -ESRCH;
-		goto error;
+
+out:
+	hash_free(ctx);
+	return rc;
+}
+
+void flash_area_check_abort(struct flash_area_check_ctx *ctx)
+{
+	if (ctx != NULL && ctx->fa != NULL) {
+		hash_free(ctx);
 	}
-#endif
+}
 
-	if (memcmp(hash, fac->match, SHA256_DIGEST_SIZE)) {
-#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
-		return -EILSEQ;
-#else /* CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS */
-		rc = -EILSEQ;
-		goto error;
-#endif
+static void check_work_handler(struct k_work *item)
+{
+	struct flash_area_check_work *work =
+		CONTAINER_OF(item, struct flash_area_check_work, work);
+	struct flash_area_check_ctx *ctx = &work->ctx;
+	int rc;
+
+	rc = flash_area_check_update(ctx, MIN(work->slice, ctx->remaining));
+	if (rc != 0) {
+		flash_area_check_abort(ctx);
+		work->cb(work, rc);
+		return;
 	}
 
-#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_MBEDTLS)
-error:
-	mbedtls_md_free(&mbed_hash_ctx);
-#endif
-	return rc;
+	if (ctx->remaining > 0) {
+		/* Let the other items of the queue run before the next slice */
+		(void)k_work_submit_to_queue(work->queue, &work->work);
+		return;
+	}
+
+	work->cb(work, flash_area_check_final(ctx, work->match));
+}
+
+void flash_area_check_work_init(struct flash_area_check_work *work)
+{
+	k_work_init(&work->work, check_work_handler);
+}
+
+int flash_area_check_work_submit(struct flash_area_check_work *work,
+				 struct k_work_q *queue, size_t slice,
+				 const uint8_t *match,
+				 flash_area_check_work_cb_t cb)
+{
+	int rc;
+
+	if (work == NULL || work->ctx.fa == NULL || slice == 0 ||
+	    match == NULL || cb == NULL) {
+		return -EINVAL;
+	}
+
+	if (k_work_busy_get(&work->work) != 0) {
+		return -EBUSY;
+	}
+
+	work->queue = (queue != NULL) ? queue : &k_sys_work_q;
+	work->slice = slice;
+	work->match = match;
+	work->cb = cb;
+
+	rc = k_work_submit_to_queue(work->queue, &work->work);
+
+	return (rc < 0) ? rc : 0;
+}
+
+int flash_area_check_int_sha256(const struct flash_area *fa,
+				const struct flash_area_check *fac)
+{
+	struct flash_area_check_ctx ctx;
+	int rc;
+
+	if (fa == NULL || fac == NULL || fac->match == NULL ||
+	    fac->rbuf == NULL || fac->clen == 0 || fac->rblen == 0) {
+		return -EINVAL;
+	}
+
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   fac->off, fac->clen, fac->rbuf, fac->rblen);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = flash_area_check_update(&ctx, fac->clen);
+	if (rc != 0) {
+		flash_area_check_abort(&ctx);
+		return rc;
+	}
+
+	return flash_area_check_final(&ctx, fac->match);
 }
@@ -317,6 +317,18 @@
 	sys_trace_k_msgq_get_exit(msgq, data, timeout, ret)
 #define sys_port_trace_k_msgq_peek(msgq, ret) sys_trace_k_msgq_peek(msgq, data, ret)
 #define sys_port_trace_k_msgq_purge(msgq) sys_trace_k_msgq_purge(msgq)
+#define sys_port_trace_k_msgq_alloc_put_batch_enter(msgq)                                          \
+	sys_trace_k_msgq_alloc_put_batch_enter(msgq)
+#define sys_port_trace_k_msgq_alloc_put_batch_exit(msgq, ret)                                      \
+	sys_trace_k_msgq_alloc_put_batch_exit(msgq, ret)
+#define sys_port_trace_k_msgq_commit_enter(msgq) sys_trace_k_msgq_commit_enter(msgq)
+#define sys_port_trace_k_msgq_commit_exit(msgq, ret) sys_trace_k_msgq_commit_exit(msgq, ret)
+#define sys_port_trace_k_msgq_peek_claim_batch_enter(msgq)                                         \
+	sys_trace_k_msgq_peek_claim_batch_enter(msgq)
+#define sys_port_trace_k_msgq_peek_claim_batch_exit(msgq, ret)                                     \
+	sys_trace_k_msgq_peek_claim_batch_exit(msgq, ret)
+#define sys_port_trace_k_msgq_release_enter(msgq) sys_trace_k_msgq_release_enter(msgq)
+#define sys_port_trace_k_msgq_release_exit(msgq, ret) sys_trace_k_msgq_release_exit(msgq, ret)
 
 #define sys_port_trace_k_mbox_init(mbox) sys_trace_k_mbox_init(mbox)
 #define sys_port_trace_k_mbox_message_put_enter(mbox, timeout)                                     \
@@ -652,6 +664,14 @@ void sys_trace_k_msgq_get_blocking(struct k_msgq *msgq, const void *data, k_time
 void sys_trace_k_msgq_get_exit(struct k_msgq *msgq, const void *data, k_timeout_t timeout, int ret);
 void sys_trace_k_msgq_peek(struct k_msgq *msgq, void *data, int ret);
 void sys_trace_k_msgq_purge(struct k_msgq *msgq);
+void sys_trace_k_msgq_alloc_put_batch_enter(struct k_msgq *msgq);
+void sys_trace_k_msgq_alloc_put_batch_exit(struct k_msgq *msgq, int ret);
+void sys_trace_k_msgq_commit_enter(struct k_msgq *msgq);
+void sys_trace_k_msgq_commit_exit(struct k_msgq *msgq, int ret);
+void sys_trace_k_msgq_peek_claim_batch_enter(struct k_msgq *msgq);
+void sys_trace_k_msgq_peek_claim_batch_exit(struct k_msgq *msgq, int ret);
+void sys_trace_k_msgq_release_enter(struct k_msgq *msgq);
+void sys_trace_k_msgq_release_exit(struct k_msgq *msgq, int ret);
 
 void sys_trace_k_heap_init(struct k_heap *h, void *mem, size_t bytes);
 void sys_trace_k_heap_alloc_enter(struct k_heap *h, size_t bytes, k_timeout_t timeout);
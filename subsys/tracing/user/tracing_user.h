@@ -233,6 +233,14 @@ void sys_trace_idle(void);
 #define sys_port_trace_k_msgq_get_exit(msgq, timeout, ret)
 #define sys_port_trace_k_msgq_peek(msgq, ret)
 #define sys_port_trace_k_msgq_purge(msgq)
+#define sys_port_trace_k_msgq_alloc_put_batch_enter(msgq)
+#define sys_port_trace_k_msgq_alloc_put_batch_exit(msgq, ret)
+#define sys_port_trace_k_msgq_commit_enter(msgq)
+#define sys_port_trace_k_msgq_commit_exit(msgq, ret)
+#define sys_port_trace_k_msgq_peek_claim_batch_enter(msgq)
+#define sys_port_trace_k_msgq_peek_claim_batch_exit(msgq, ret)
+#define sys_port_trace_k_msgq_release_enter(msgq)
+#define sys_port_trace_k_msgq_release_exit(msgq, ret)
 
 #define sys_port_trace_k_mbox_init(mbox)
 #define sys_port_trace_k_mbox_message_put_enter(mbox, timeout)
@@ -53,9 +53,10 @@ LOG_MODULE_REGISTER(usb_msc);
 #define BLOCK_SIZE	512
 #define DISK_THREAD_PRIO	-5
 
-#define THREAD_OP_READ_QUEUED		1
-#define THREAD_OP_WRITE_QUEUED		3
-#define THREAD_OP_WRITE_DONE		4
+/* Blocks transferred by a single disk access */
+#define BUF_BLOCKS	CONFIG_MASS_STORAGE_BUF_BLOCKS
+#define BUF_SIZE	(BUF_BLOCKS * BLOCK_SIZE)
+#define NUM_BUFS	(IS_ENABLED(CONFIG_MASS_STORAGE_DOUBLE_BUFFER) ? 2 : 1)
 
 #define MASS_STORAGE_IN_EP_ADDR		0x82
 #define MASS_STORAGE_OUT_EP_ADDR	0x01
@@ -101,21 +102,55 @@ USBD_CLASS_DESCR_DEFINE(primary, 0) struct usb_mass_config mass_cfg = {
 	},
 };
 
-static volatile int thread_op;
 static K_KERNEL_STACK_DEFINE(mass_thread_stack, CONFIG_MASS_STORAGE_STACK_SIZE);
 static struct k_thread mass_thread_data;
-static struct k_sem disk_wait_sem;
-static volatile uint32_t defered_wr_sz;
+
+enum buf_state {
+	BUF_FREE,	/* not in use */
+	BUF_DISK,	/* queued to or being accessed by the disk thread */
+	BUF_USB,	/* being filled from or sent to the host */
+};
 
 /*
- * Keep block buffer larger than BLOCK_SIZE for the case
- * the dCBWDataTransferLength is multiple of the BLOCK_SIZE and
- * the length of the transferred data is not aligned to the BLOCK_SIZE.
+ * Data buffer exchanged between the USB transfers and the disk thread.
+ * With CONFIG_MASS_STORAGE_DOUBLE_BUFFER, one buffer is transferred over
+ * USB while the disk thread reads or writes the other.
+ *
+ * Keep the buffer larger than BUF_SIZE for the case the length of the
+ * packets received from the host is not aligned to the BLOCK_SIZE, the
+ * overflowing data is moved to the next buffer.
  *
  * Align for cases where the underlying disk access requires word-aligned
  * addresses.
  */
-static uint8_t __aligned(4) page[BLOCK_SIZE + CONFIG_MASS_STORAGE_BULK_EP_MPS];
+struct msc_buf {
+	uint8_t __aligned(4) data[BUF_SIZE + CONFIG_MASS_STORAGE_BULK_EP_MPS];
+	/* first block and number of blocks held by the buffer */
+	uint32_t lba;
+	uint32_t blocks;
+	/* bytes received from or sent to the host */
+	uint32_t len;
+	enum buf_state state;
+	bool write;
+};
+
+static struct msc_buf bufs[NUM_BUFS];
+K_MSGQ_DEFINE(disk_msgq, sizeof(struct msc_buf *), NUM_BUFS, 4);
+static struct k_spinlock buf_lock;
+
+/* buffer currently transferred over USB */
+static uint8_t usb_buf;
+/* blocks of the current command not yet assigned to a buffer */
+static uint32_t disk_lba;
+static uint32_t disk_blocks;
+/* buffers queued to the disk thread */
+static uint8_t disk_pending;
+/* USB transfers wait for the disk thread to release a buffer */
+static bool usb_waiting;
+/* data received past the end of the last queued buffer */
+static uint8_t *carry;
+static uint32_t carry_len;
+static bool disk_error;
 
 /* Initialized during mass_storage_init() */
 static uint32_t memory_size;
@@ -214,7 +249,6 @@ static void msd_init(void)
 {
 	(void)memset((void *)&cbw, 0, sizeof(struct CBW));
 	(void)memset((void *)&csw, 0, sizeof(struct CSW));
-	(void)memset(page, 0, sizeof(page));
 	addr = 0U;
 	length = 0U;
 }
@@ -372,63 +406,198 @@ static bool readCapacity(void)
 	return write(capacity, sizeof(capacity));
 }
 
-static void thread_memory_read_done(void)
+/* Assign the next blocks of the command to free buffers, in the order they
+ * are going to be transferred over USB, and queue them to the disk thread.
+ * Called with buf_lock held.
+ */
+static void queue_reads(void)
+{
+	for (int i = 0; i < NUM_BUFS && disk_blocks; i++) {
+		struct msc_buf *buf = &bufs[(usb_buf + i) % NUM_BUFS];
+
+		if (buf->state != BUF_FREE) {
+			continue;
+		}
+
+		buf->lba = disk_lba;
+		buf->blocks = MIN(disk_blocks, BUF_BLOCKS);
+		buf->len = 0U;
+		buf->write = false;
+		buf->state = BUF_DISK;
+		disk_lba += buf->blocks;
+		disk_blocks -= buf->blocks;
+		disk_pending++;
+
+		(void)k_msgq_put(&disk_msgq, &buf, K_NO_WAIT);
+	}
+}
+
+static void transfer_start(void)
+{
+	for (int i = 0; i < NUM_BUFS; i++) {
+		bufs[i].state = BUF_FREE;
+	}
+
+	usb_buf = 0U;
+	disk_lba = addr / BLOCK_SIZE;
+	disk_blocks = length / BLOCK_SIZE;
+	disk_pending = 0U;
+	usb_waiting = false;
+	disk_error = false;
+}
+
+/* Send the next packet of a read command, called once the previous one has
+ * been sent and by the disk thread when it has read the blocks the USB
+ * transfers were waiting for.
+ */
+static void memoryRead(void)
 {
+	k_spinlock_key_t key = k_spin_lock(&buf_lock);
+	struct msc_buf *buf = &bufs[usb_buf];
 	uint32_t n;
 
-	n = (length > MAX_PACKET) ? MAX_PACKET : length;
-	if ((addr + n) > memory_size) {
-		n = memory_size - addr;
-		stage = MSC_ERROR;
+	if (buf->state == BUF_USB && buf->len == buf->blocks * BLOCK_SIZE) {
+		/* all sent, the buffer can receive the next blocks */
+		buf->state = BUF_FREE;
+		usb_buf = (usb_buf + 1) % NUM_BUFS;
+		queue_reads();
+		buf = &bufs[usb_buf];
+	}
+
+	if (buf->state != BUF_USB) {
+		usb_waiting = true;
+		k_spin_unlock(&buf_lock, key);
+		return;
 	}
 
+	k_spin_unlock(&buf_lock, key);
+
+	n = MIN(length, MIN(MAX_PACKET, buf->blocks * BLOCK_SIZE - buf->len));
+
 	if (usb_write(mass_ep_data[MSD_IN_EP_IDX].ep_addr,
-		&page[addr % BLOCK_SIZE], n, NULL) != 0) {
+		      &buf->data[buf->len], n, NULL) != 0) {
 		LOG_ERR("Failed to write EP 0x%x",
 			mass_ep_data[MSD_IN_EP_IDX].ep_addr);
 	}
+
+	buf->len += n;
 	addr += n;
 	length -= n;
 
 	csw.DataResidue -= n;
 
-	if (!length || (stage != MSC_PROCESS_CBW)) {
-		csw.Status = (stage == MSC_PROCESS_CBW) ?
-			CSW_PASSED : CSW_FAILED;
-		stage = (stage == MSC_PROCESS_CBW) ? MSC_SEND_CSW : stage;
+	if (!length) {
+		csw.Status = disk_error ? CSW_FAILED : CSW_PASSED;
+		stage = MSC_SEND_CSW;
 	}
 }
 
+static void memoryReadStart(void)
+{
+	k_spinlock_key_t key;
+
+	transfer_start();
 
-static void memoryRead(void)
+	key = k_spin_lock(&buf_lock);
+	queue_reads();
+	k_spin_unlock(&buf_lock, key);
+
+	memoryRead();
+}
+
+/* Start filling a buffer with the next blocks of a write command, moving
+ * the data received past the end of the previous buffer to it.
+ * Called with buf_lock held.
+ */
+static void fill_next(struct msc_buf *buf)
 {
-	uint32_t n;
+	if (carry_len) {
+		memmove(buf->data, carry, carry_len);
+	}
 
-	n = (length > MAX_PACKET) ? MAX_PACKET : length;
-	if ((addr + n) > memory_size) {
-		n = memory_size - addr;
-		stage = MSC_ERROR;
+	buf->lba = disk_lba;
+	buf->blocks = MIN(disk_blocks, BUF_BLOCKS);
+	buf->len = carry_len;
+	buf->write = true;
+	buf->state = BUF_USB;
+	disk_lba += buf->blocks;
+	disk_blocks -= buf->blocks;
+
+	usb_buf = buf - bufs;
+	carry_len = 0U;
+}
+
+static void memoryWriteStart(void)
+{
+	k_spinlock_key_t key;
+
+	transfer_start();
+	carry_len = 0U;
+
+	key = k_spin_lock(&buf_lock);
+	fill_next(&bufs[0]);
+	k_spin_unlock(&buf_lock, key);
+}
+
+/* Hand the current buffer to the disk thread once it is full and switch to
+ * the next one. Returns false if the USB transfers have to wait until the
+ * disk thread has released a buffer, or have received all the data.
+ */
+static bool queue_write(void)
+{
+	while (true) {
+		struct msc_buf *buf = &bufs[usb_buf];
+		uint32_t buf_size = buf->blocks * BLOCK_SIZE;
+		struct msc_buf *next;
+		k_spinlock_key_t key;
+
+		if (buf->len < buf_size && length) {
+			return true;
+		}
+
+		LOG_DBG("Disk WRITE Qd %d", buf->lba);
+
+		key = k_spin_lock(&buf_lock);
+
+		carry = &buf->data[buf_size];
+		carry_len = buf->len - MIN(buf->len, buf_size);
+		buf->state = BUF_DISK;
+		disk_pending++;
+		(void)k_msgq_put(&disk_msgq, &buf, K_NO_WAIT);
+
+		if (!length && !carry_len) {
+			/* the disk thread sends the CSW once all is written */
+			k_spin_unlock(&buf_lock, key);
+			return false;
+		}
+
+		next = &bufs[(usb_buf + 1) % NUM_BUFS];
+		if (next->state != BUF_FREE) {
+			usb_waiting = true;
+			k_spin_unlock(&buf_lock, key);
+			return false;
+		}
+
+		fill_next(next);
+		k_spin_unlock(&buf_lock, key);
 	}
+}
 
-	/* we read an entire block */
-	if (!(addr % BLOCK_SIZE)) {
-		thread_op = THREAD_OP_READ_QUEUED;
-		LOG_DBG("Signal thread for %d", (addr/BLOCK_SIZE));
-		k_sem_give(&disk_wait_sem);
-		return;
+/* Account for a packet received in place in the current buffer */
+static bool memoryWrite(uint16_t size)
+{
+	if (size > length) {
+		LOG_WRN("Ignoring %u bytes beyond the transfer length",
+			size - length);
+		size = length;
 	}
-	usb_write(mass_ep_data[MSD_IN_EP_IDX].ep_addr,
-		  &page[addr % BLOCK_SIZE], n, NULL);
-	addr += n;
-	length -= n;
 
-	csw.DataResidue -= n;
+	bufs[usb_buf].len += size;
+	addr += size;
+	length -= size;
+	csw.DataResidue -= size;
 
-	if (!length || (stage != MSC_PROCESS_CBW)) {
-		csw.Status = (stage == MSC_PROCESS_CBW) ?
-			CSW_PASSED : CSW_FAILED;
-		stage = (stage == MSC_PROCESS_CBW) ? MSC_SEND_CSW : stage;
-	}
+	return queue_write();
 }
 
 static bool check_cbw_data_length(void)
@@ -479,6 +648,19 @@ static bool infoTransfer(void)
 	}
 
 	LOG_DBG("Size (block) : 0x%x ", n);
+	if (n > block_count - addr / BLOCK_SIZE) {
+		LOG_ERR("Transfer out of range");
+		if ((cbw.Flags & 0x80) != 0U) {
+			usb_ep_set_stall(mass_ep_data[MSD_IN_EP_IDX].ep_addr);
+		} else {
+			usb_ep_set_stall(mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
+		}
+
+		csw.Status = CSW_FAILED;
+		sendCSW();
+		return false;
+	}
+
 	length = n * BLOCK_SIZE;
 
 	if (cbw.DataLength != length) {
@@ -570,7 +752,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			if (infoTransfer()) {
 				if ((cbw.Flags & 0x80)) {
 					stage = MSC_PROCESS_CBW;
-					memoryRead();
+					memoryReadStart();
 				} else {
 					usb_ep_set_stall(
 					  mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
@@ -586,6 +768,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			if (infoTransfer()) {
 				if (!(cbw.Flags & 0x80)) {
 					stage = MSC_PROCESS_CBW;
+					memoryWriteStart();
 				} else {
 					usb_ep_set_stall(
 					  mass_ep_data[MSD_IN_EP_IDX].ep_addr);
@@ -643,14 +826,15 @@ static void memoryVerify(uint8_t *buf, uint16_t size)
 	/* beginning of a new block -> load a whole block in RAM */
 	if (!(addr % BLOCK_SIZE)) {
 		LOG_DBG("Disk READ sector %d", addr/BLOCK_SIZE);
-		if (disk_access_read(disk_pdrv, page, addr/BLOCK_SIZE, 1)) {
+		if (disk_access_read(disk_pdrv, bufs[0].data,
+				     addr/BLOCK_SIZE, 1)) {
 			LOG_ERR("---- Disk Read Error %d", addr/BLOCK_SIZE);
 		}
 	}
 
 	/* info are in RAM -> no need to re-read memory */
 	for (n = 0U; n < size; n++) {
-		if (page[addr%BLOCK_SIZE + n] != buf[n]) {
+		if (bufs[0].data[addr%BLOCK_SIZE + n] != buf[n]) {
 			LOG_DBG("Mismatch sector %d offset %d",
 				addr/BLOCK_SIZE, n);
 			memOK = false;
@@ -669,43 +853,6 @@ static void memoryVerify(uint8_t *buf, uint16_t size)
 	}
 }
 
-static void memoryWrite(uint8_t *buf, uint16_t size)
-{
-	if ((addr + size) > memory_size) {
-		size = memory_size - addr;
-		stage = MSC_ERROR;
-		usb_ep_set_stall(mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
-		LOG_WRN("Stall OUT endpoint");
-	}
-
-	/* we fill an array in RAM of 1 block before writing it in memory */
-	for (int i = 0; i < size; i++) {
-		page[addr % BLOCK_SIZE + i] = buf[i];
-	}
-
-	/* if the array is filled, write it in memory */
-	if ((addr % BLOCK_SIZE) + size >= BLOCK_SIZE) {
-		if (!(disk_access_status(disk_pdrv) &
-					DISK_STATUS_WR_PROTECT)) {
-			LOG_DBG("Disk WRITE Qd %d", (addr/BLOCK_SIZE));
-			thread_op = THREAD_OP_WRITE_QUEUED;  /* write_queued */
-			defered_wr_sz = size;
-			k_sem_give(&disk_wait_sem);
-			return;
-		}
-	}
-
-	addr += size;
-	length -= size;
-	csw.DataResidue -= size;
-
-	if ((!length) || (stage != MSC_PROCESS_CBW)) {
-		csw.Status = (stage == MSC_ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
-	}
-}
-
-
 static void mass_storage_bulk_out(uint8_t ep,
 		enum usb_dc_ep_cb_status_code ep_status)
 {
@@ -714,6 +861,23 @@ static void mass_storage_bulk_out(uint8_t ep,
 
 	ARG_UNUSED(ep_status);
 
+	if (stage == MSC_PROCESS_CBW &&
+	    (cbw.CB[0] == WRITE10 || cbw.CB[0] == WRITE12)) {
+		struct msc_buf *buf = &bufs[usb_buf];
+
+		/* receive the data in place, past what is already there */
+		usb_ep_read_wait(ep, &buf->data[buf->len],
+				 CONFIG_MASS_STORAGE_BULK_EP_MPS, &bytes_read);
+
+		if (memoryWrite(bytes_read)) {
+			usb_ep_read_continue(ep);
+		} else {
+			LOG_DBG("> BO not clearing NAKs yet");
+		}
+
+		return;
+	}
+
 	usb_ep_read_wait(ep, bo_buf, CONFIG_MASS_STORAGE_BULK_EP_MPS,
 			 &bytes_read);
 
@@ -727,11 +891,6 @@ static void mass_storage_bulk_out(uint8_t ep,
 	/*the device has to receive data from the host*/
 	case MSC_PROCESS_CBW:
 		switch (cbw.CB[0]) {
-		case WRITE10:
-		case WRITE12:
-			/* LOG_DBG("> BO - PROC_CBW WR");*/
-			memoryWrite(bo_buf, bytes_read);
-			break;
 		case VERIFY10:
 			LOG_DBG("> BO - PROC_CBW VER");
 			memoryVerify(bo_buf, bytes_read);
@@ -751,36 +910,7 @@ static void mass_storage_bulk_out(uint8_t ep,
 		break;
 	}
 
-	if (thread_op != THREAD_OP_WRITE_QUEUED) {
-		usb_ep_read_continue(ep);
-	} else {
-		LOG_DBG("> BO not clearing NAKs yet");
-	}
-
-}
-
-static void thread_memory_write_done(void)
-{
-	uint32_t size = defered_wr_sz;
-	size_t overflowed_len = (addr + size) % CONFIG_MASS_STORAGE_BULK_EP_MPS;
-
-	if (overflowed_len) {
-		memmove(page, &page[BLOCK_SIZE], overflowed_len);
-	}
-
-	addr += size;
-	length -= size;
-	csw.DataResidue -= size;
-
-
-	if ((!length) || (stage != MSC_PROCESS_CBW)) {
-		csw.Status = (stage == MSC_ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
-	}
-
-	thread_op = THREAD_OP_WRITE_DONE;
-
-	usb_ep_read_continue(mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
+	usb_ep_read_continue(ep);
 }
 
 /**
@@ -908,35 +1038,91 @@ USBD_DEFINE_CFG_DATA(mass_storage_config) = {
 	.endpoint = mass_ep_data
 };
 
+static void thread_memory_read_done(struct msc_buf *buf)
+{
+	k_spinlock_key_t key = k_spin_lock(&buf_lock);
+	bool resume = usb_waiting && buf == &bufs[usb_buf];
+
+	buf->state = BUF_USB;
+	disk_pending--;
+	if (resume) {
+		usb_waiting = false;
+	}
+
+	k_spin_unlock(&buf_lock, key);
+
+	if (resume) {
+		memoryRead();
+	}
+}
+
+static void thread_memory_write_done(struct msc_buf *buf)
+{
+	k_spinlock_key_t key = k_spin_lock(&buf_lock);
+	bool resume = false;
+	bool done;
+
+	buf->state = BUF_FREE;
+	disk_pending--;
+
+	/* buffers are written in order, the one released is the one the USB
+	 * transfers are waiting for
+	 */
+	if (usb_waiting) {
+		usb_waiting = false;
+		fill_next(buf);
+		resume = true;
+	}
+
+	done = !resume && !length && !disk_pending;
+
+	k_spin_unlock(&buf_lock, key);
+
+	if (resume) {
+		if (queue_write()) {
+			usb_ep_read_continue(
+				mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
+		}
+	} else if (done) {
+		csw.Status = (disk_error || stage != MSC_PROCESS_CBW) ?
+			CSW_FAILED : CSW_PASSED;
+		sendCSW();
+		usb_ep_read_continue(mass_ep_data[MSD_OUT_EP_IDX].ep_addr);
+	}
+}
+
 static void mass_thread_main(int arg1, int unused)
 {
+	struct msc_buf *buf;
+
 	ARG_UNUSED(unused);
 	ARG_UNUSED(arg1);
 
 	while (1) {
-		k_sem_take(&disk_wait_sem, K_FOREVER);
-		LOG_DBG("sem %d", thread_op);
-
-		switch (thread_op) {
-		case THREAD_OP_READ_QUEUED:
-			if (disk_access_read(disk_pdrv,
-						page, (addr/BLOCK_SIZE), 1)) {
-				LOG_ERR("!! Disk Read Error %d !",
-					addr/BLOCK_SIZE);
+		k_msgq_get(&disk_msgq, &buf, K_FOREVER);
+		LOG_DBG("%s %d+%d", buf->write ? "write" : "read",
+			buf->lba, buf->blocks);
+
+		if (!buf->write) {
+			if (disk_access_read(disk_pdrv, buf->data,
+					     buf->lba, buf->blocks)) {
+				LOG_ERR("!! Disk Read Error %d !", buf->lba);
+				disk_error = true;
 			}
 
-			thread_memory_read_done();
-			break;
-		case THREAD_OP_WRITE_QUEUED:
-			if (disk_access_write(disk_pdrv,
-						page, (addr/BLOCK_SIZE), 1)) {
+			thread_memory_read_done(buf);
+		} else {
+			if (disk_access_status(disk_pdrv) &
+			    DISK_STATUS_WR_PROTECT) {
+				LOG_DBG("Disk write protected");
+			} else if (disk_access_write(disk_pdrv, buf->data,
+						     buf->lba, buf->blocks)) {
 				LOG_ERR("!!!!! Disk Write Error %d !!!!!",
-					addr/BLOCK_SIZE);
+					buf->lba);
+				disk_error = true;
 			}
-			thread_memory_write_done();
-			break;
-		default:
-			LOG_ERR("XXXXXX thread_op  %d ! XXXXX", thread_op);
+
+			thread_memory_write_done(buf);
 		}
 	}
 }
@@ -990,8 +1176,6 @@ static int mass_storage_init(const struct device *dev)
 	msd_state_machine_reset();
 	msd_init();
 
-	k_sem_init(&disk_wait_sem, 0, 1);
-
 	/* Start a thread to offload disk ops */
 	k_thread_create(&mass_thread_data, mass_thread_stack,
 			CONFIG_MASS_STORAGE_STACK_SIZE,
@@ -10,6 +10,63 @@
 
 #ifdef FIFO_BENCH
 
+#define ZC_BATCH 8
+
+/**
+ *
+ * @brief Copying versus zero-copy transfer of 64 bytes messages
+ *
+ */
+static void queue_zero_copy_test(void)
+{
+	void *slots[ZC_BATCH];
+	uint32_t et; /* elapsed time */
+	int i, j, n;
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_FIFO_RUNS; i++) {
+		k_msgq_put(&DEMOQX64, data_bench, K_FOREVER);
+		k_msgq_get(&DEMOQX64, msg, K_FOREVER);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	PRINT_F(output_file, FORMAT, "enqueue and dequeue 64 bytes msg in FIFO",
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_FIFO_RUNS));
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_FIFO_RUNS; i++) {
+		k_msgq_alloc_put(&DEMOQX64, &slots[0]);
+		memcpy(slots[0], data_bench, 64);
+		k_msgq_commit(&DEMOQX64);
+		k_msgq_peek_claim(&DEMOQX64, &slots[0]);
+		k_msgq_release(&DEMOQX64);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	PRINT_F(output_file, FORMAT,
+			"zero-copy enqueue and dequeue 64 bytes msg in FIFO",
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_FIFO_RUNS));
+
+	et = BENCH_START();
+	for (i = 0; i < NR_OF_FIFO_RUNS; i += ZC_BATCH) {
+		n = k_msgq_alloc_put_batch(&DEMOQX64, slots, ZC_BATCH);
+		for (j = 0; j < n; j++) {
+			memcpy(slots[j], data_bench, 64);
+		}
+		k_msgq_commit(&DEMOQX64);
+		k_msgq_peek_claim_batch(&DEMOQX64, slots, ZC_BATCH);
+		k_msgq_release(&DEMOQX64);
+	}
+	et = TIME_STAMP_DELTA_GET(et);
+	check_result();
+
+	PRINT_F(output_file, FORMAT,
+			"zero-copy enqueue and dequeue 64 bytes msg in batches of 8",
+			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_FIFO_RUNS));
+}
+
 /**
  *
  * @brief Queue transfer speed test
@@ -60,6 +117,8 @@ void queue_test(void)
 	PRINT_F(output_file, FORMAT, "dequeue 4 bytes msg in FIFO",
 			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(et, NR_OF_FIFO_RUNS));
 
+	queue_zero_copy_test();
+
 	k_sem_give(&STARTRCV);
 
 	et = BENCH_START();
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Create small files in a directory of a FAT volume, then list the
+ * directory and read the files back, and report the run time of each phase
+ * along with the sector cache statistics and, on the flash disk, the flash
+ * simulator operations. The simulator adds its read, write and erase times
+ * to the run time. Build for the RAM disk and the flash disk, with and
+ * without CONFIG_DISK_CACHE, to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fs.h>
+#include <ff.h>
+#include <storage/disk_access.h>
+#include <drivers/flash/flash_simulator.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(CONFIG_DISK_DRIVER_RAM)
+#define DISK_NAME CONFIG_DISK_RAM_VOLUME_NAME
+#define SECTOR_SIZE 512
+#else
+#define DISK_NAME CONFIG_DISK_FLASH_VOLUME_NAME
+#define SECTOR_SIZE CONFIG_DISK_FLASH_SECTOR_SIZE
+#endif
+
+#define FATFS_MNTP "/" DISK_NAME ":"
+#define DIR_PATH FATFS_MNTP "/files"
+
+#define NUM_FILES 32
+#define FILE_SIZE 200
+#define LIST_PASSES 10
+#define CACHE_SECTORS 32
+
+static FATFS fat_fs;
+
+static struct fs_mount_t fatfs_mnt = {
+	.type = FS_FATFS,
+	.mnt_point = FATFS_MNTP,
+	.fs_data = &fat_fs,
+};
+
+#if defined(CONFIG_DISK_CACHE)
+DISK_CACHE_DEFINE(bench_cache, CACHE_SECTORS, SECTOR_SIZE);
+#endif
+
+static uint8_t file_buf[FILE_SIZE];
+
+struct flash_counters {
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t erases;
+};
+
+static struct flash_counters flash_before;
+
+static void get_counters(struct flash_counters *counters)
+{
+	(void)memset(counters, 0, sizeof(*counters));
+
+#if defined(CONFIG_FLASH_SIMULATOR_WEAR_STATS)
+	const struct device *flash_dev =
+		device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
+	struct flash_simulator_wear wear;
+	int ret;
+
+	zassert_not_null(flash_dev, "Flash simulator not found");
+
+	ret = flash_simulator_wear_get(flash_dev, &wear, NULL, 0);
+	zassert_equal(ret, 0, "Wear statistics not available (%d)", ret);
+	counters->reads = wear.read_calls;
+	counters->writes = wear.write_calls;
+	counters->erases = wear.erase_calls;
+#endif
+}
+
+static int64_t phase_start(void)
+{
+	get_counters(&flash_before);
+
+	return k_uptime_ticks();
+}
+
+static void phase_end(const char *name, int64_t start)
+{
+	uint64_t us = k_ticks_to_us_floor64(k_uptime_ticks() - start);
+	struct flash_counters after;
+
+	get_counters(&after);
+
+	TC_PRINT("%-8s %6u us", name, (uint32_t)us);
+	if (IS_ENABLED(CONFIG_FLASH_SIMULATOR_WEAR_STATS)) {
+		TC_PRINT(", flash reads %u, writes %u, erases %u",
+			 after.reads - flash_before.reads,
+			 after.writes - flash_before.writes,
+			 after.erases - flash_before.erases);
+	}
+	TC_PRINT("\n");
+}
+
+static void file_path(char *path, size_t size, int i)
+{
+	snprintf(path, size, DIR_PATH "/f%02d.txt", i);
+}
+
+static void create_files(void)
+{
+	struct fs_file_t file;
+	char path[32];
+	int ret;
+
+	ret = fs_mkdir(DIR_PATH);
+	zassert_equal(ret, 0, "Failed to create directory (%d)", ret);
+
+	for (int i = 0; i < NUM_FILES; i++) {
+		file_path(path, sizeof(path), i);
+		(void)memset(file_buf, 'a' + i % 26, sizeof(file_buf));
+
+		fs_file_t_init(&file);
+		ret = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE);
+		zassert_equal(ret, 0, "Failed to create %s (%d)", path, ret);
+		ret = fs_write(&file, file_buf, sizeof(file_buf));
+		zassert_equal(ret, FILE_SIZE, "Write failed (%d)", ret);
+		zassert_equal(fs_close(&file), 0, NULL);
+	}
+}
+
+static void list_dir(void)
+{
+	struct fs_dirent entry;
+	struct fs_dir_t dir;
+	int count;
+	int ret;
+
+	for (int pass = 0; pass < LIST_PASSES; pass++) {
+		count = 0;
+
+		fs_dir_t_init(&dir);
+		ret = fs_opendir(&dir, DIR_PATH);
+		zassert_equal(ret, 0, "Failed to open directory (%d)", ret);
+
+		for (;;) {
+			ret = fs_readdir(&dir, &entry);
+			zassert_equal(ret, 0, "Failed to read directory (%d)",
+				      ret);
+			if (entry.name[0] == 0) {
+				break;
+			}
+			count++;
+		}
+
+		zassert_equal(fs_closedir(&dir), 0, NULL);
+		zassert_equal(count, NUM_FILES, "Found %d files", count);
+	}
+}
+
+static void read_files(void)
+{
+	struct fs_dirent entry;
+	struct fs_file_t file;
+	char path[32];
+	int ret;
+
+	for (int i = 0; i < NUM_FILES; i++) {
+		file_path(path, sizeof(path), i);
+
+		ret = fs_stat(path, &entry);
+		zassert_equal(ret, 0, "Failed to stat %s (%d)", path, ret);
+		zassert_equal(entry.size, FILE_SIZE, NULL);
+
+		fs_file_t_init(&file);
+		ret = fs_open(&file, path, FS_O_READ);
+		zassert_equal(ret, 0, "Failed to open %s (%d)", path, ret);
+		ret = fs_read(&file, file_buf, sizeof(file_buf));
+		zassert_equal(ret, FILE_SIZE, "Read failed (%d)", ret);
+		zassert_equal(file_buf[0], 'a' + i % 26, "Bad contents");
+		zassert_equal(fs_close(&file), 0, NULL);
+	}
+}
+
+static void test_small_files(void)
+{
+	int64_t start;
+	int ret;
+
+	ret = disk_access_init(DISK_NAME);
+	zassert_equal(ret, 0, "Failed to initialize disk (%d)", ret);
+
+#if defined(CONFIG_DISK_CACHE)
+	ret = disk_access_cache_attach(DISK_NAME, &bench_cache);
+	zassert_equal(ret, 0, "Failed to attach cache (%d)", ret);
+#endif
+
+	ret = fs_mount(&fatfs_mnt);
+	zassert_equal(ret, 0, "Failed to mount (%d)", ret);
+
+	TC_PRINT("disk: %s, sector cache: %s\n", DISK_NAME,
+		 IS_ENABLED(CONFIG_DISK_CACHE) ? "on" : "off");
+
+	start = phase_start();
+	create_files();
+	phase_end("create", start);
+
+	start = phase_start();
+	list_dir();
+	phase_end("list", start);
+
+	start = phase_start();
+	read_files();
+	phase_end("read", start);
+
+	zassert_equal(fs_unmount(&fatfs_mnt), 0, NULL);
+
+#if defined(CONFIG_DISK_CACHE)
+	struct disk_cache_stats stats;
+
+	ret = disk_access_cache_stats_get(DISK_NAME, &stats);
+	zassert_equal(ret, 0, NULL);
+	TC_PRINT("cache hits %u, misses %u, read ahead %u, written back %u\n",
+		 stats.hits, stats.misses, stats.read_ahead,
+		 stats.write_backs);
+
+	ret = disk_access_cache_detach(DISK_NAME);
+	zassert_equal(ret, 0, "Failed to detach cache (%d)", ret);
+#endif
+}
+
+void test_main(void)
+{
+	ztest_test_suite(disk_cache_bench,
+			 ztest_unit_test(test_small_files));
+
+	ztest_run_test_suite(disk_cache_bench);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Fill a 2 GiB FAT32 volume with 4 KiB clusters, on the flash disk driver on
+ * top of the flash simulator, leaving one free cluster in every 1024, like a
+ * card which has filled up while old files were deleted. The free cluster
+ * count and the allocation hint in the FSINFO sector are then invalidated,
+ * as after a reset. Report how long mounting, the first fs_statvfs and
+ * writing a log file then take. The simulator adds its read and write
+ * times to the run time. Build with and without CONFIG_FS_FATFS_FREE_MAP
+ * to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fs.h>
+#include <storage/disk_access.h>
+#include <sys/byteorder.h>
+#include <ff.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DISK_NAME "NAND"
+#define FATFS_DRV DISK_NAME ":"
+#define FATFS_MNTP "/" FATFS_DRV
+#define LOG_FILE FATFS_MNTP "/log.bin"
+
+#define CLUSTER_SIZE 4096
+#define HOLE_STRIDE 1024
+#define LOG_CLUSTERS 256
+
+#define FSINFO_SECT 1
+#define FSINFO_LEAD_SIG 0x41615252
+#define FSINFO_FREE_COUNT 488
+#define FSINFO_NEXT_FREE 492
+
+static FATFS fat_fs;
+
+static struct fs_mount_t fatfs_mnt = {
+	.type = FS_FATFS,
+	.mnt_point = FATFS_MNTP,
+	.fs_data = &fat_fs,
+};
+
+static FIL fil;
+static uint8_t buf[CLUSTER_SIZE];
+
+static void extend_file(const char *prefix, int n, int clusters)
+{
+	char name[16];
+
+	snprintf(name, sizeof(name), FATFS_DRV "/%s%04d.bin", prefix, n);
+	zassert_equal(f_open(&fil, name, FA_CREATE_NEW | FA_WRITE), FR_OK,
+		      "Failed to create %s", name);
+	/* Seeking past the end allocates clusters without writing them */
+	zassert_equal(f_lseek(&fil, clusters * CLUSTER_SIZE), FR_OK,
+		      "Failed to extend %s", name);
+	zassert_equal(f_close(&fil), FR_OK, "Failed to close %s", name);
+}
+
+/* Uses FatFs directly, before the volume is mounted through fs_mount */
+static void fill_volume(void)
+{
+	MKFS_PARM mkfs_opt = {
+		.fmt = FM_FAT32 | FM_SFD,
+		.n_fat = 1,
+		.au_size = CLUSTER_SIZE,
+	};
+	char name[16];
+	FATFS *fs;
+	DWORD nclst;
+	int n = 0;
+
+	zassert_equal(f_mkfs(FATFS_DRV, &mkfs_opt, buf, sizeof(buf)), FR_OK,
+		      "Failed to format");
+	zassert_equal(f_mount(&fat_fs, FATFS_DRV, 1), FR_OK,
+		      "Failed to mount");
+
+	do {
+		extend_file("d", n, HOLE_STRIDE - 1);
+		extend_file("h", n, 1);
+		n++;
+
+		zassert_equal(f_getfree(FATFS_DRV, &nclst, &fs), FR_OK, NULL);
+	} while (nclst >= HOLE_STRIDE);
+
+	for (int i = 0; i < n; i++) {
+		snprintf(name, sizeof(name), FATFS_DRV "/h%04d.bin", i);
+		zassert_equal(f_unlink(name), FR_OK, "Failed to delete %s",
+			      name);
+	}
+
+	zassert_equal(f_getfree(FATFS_DRV, &nclst, &fs), FR_OK, NULL);
+	TC_PRINT("%d MiB in %u clusters, %u free\n",
+		 (int)((uint64_t)(fs->n_fatent - 2) * CLUSTER_SIZE / MB(1)),
+		 (uint32_t)(fs->n_fatent - 2), (uint32_t)nclst);
+
+	zassert_equal(f_mount(NULL, FATFS_DRV, 0), FR_OK, "Failed to unmount");
+}
+
+static void invalidate_fsinfo(void)
+{
+	int ret;
+
+	ret = disk_access_read(DISK_NAME, buf, FSINFO_SECT, 1);
+	zassert_equal(ret, 0, "Failed to read FSINFO (%d)", ret);
+	zassert_equal(sys_get_le32(buf), FSINFO_LEAD_SIG, "No FSINFO sector");
+
+	sys_put_le32(0xFFFFFFFF, &buf[FSINFO_FREE_COUNT]);
+	sys_put_le32(0xFFFFFFFF, &buf[FSINFO_NEXT_FREE]);
+
+	ret = disk_access_write(DISK_NAME, buf, FSINFO_SECT, 1);
+	zassert_equal(ret, 0, "Failed to write FSINFO (%d)", ret);
+	ret = disk_access_ioctl(DISK_NAME, DISK_IOCTL_CTRL_SYNC, NULL);
+	zassert_equal(ret, 0, "Failed to sync disk (%d)", ret);
+}
+
+static uint32_t report(const char *name, uint32_t start)
+{
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	TC_PRINT("  %-14s %9u us\n", name, us);
+
+	return us;
+}
+
+static unsigned long free_clusters(const char *name)
+{
+	struct fs_statvfs stat;
+	uint32_t start;
+	int ret;
+
+	start = k_cycle_get_32();
+	ret = fs_statvfs(FATFS_MNTP, &stat);
+	report(name, start);
+	zassert_equal(ret, 0, "fs_statvfs failure (%d)", ret);
+
+	return stat.f_bfree;
+}
+
+static void write_log(void)
+{
+	struct fs_file_t file;
+	uint32_t start, us, total;
+	uint32_t worst = 0U;
+	ssize_t len;
+	int ret;
+
+	fs_file_t_init(&file);
+	ret = fs_open(&file, LOG_FILE, FS_O_CREATE | FS_O_WRITE);
+	zassert_equal(ret, 0, "Failed to create log (%d)", ret);
+
+	total = k_cycle_get_32();
+	for (int i = 0; i < LOG_CLUSTERS; i++) {
+		(void)memset(buf, i, sizeof(buf));
+
+		start = k_cycle_get_32();
+		len = fs_write(&file, buf, sizeof(buf));
+		us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+		zassert_equal(len, sizeof(buf), "Write failed (%d)", (int)len);
+
+		worst = MAX(worst, us);
+	}
+
+	ret = fs_close(&file);
+	zassert_equal(ret, 0, "Failed to close log (%d)", ret);
+	us = report("log write", total);
+
+	TC_PRINT("  %d KiB, %u KB/s, %u us worst write\n",
+		 LOG_CLUSTERS * CLUSTER_SIZE / 1024,
+		 (uint32_t)((uint64_t)LOG_CLUSTERS * CLUSTER_SIZE * 1000U /
+			    MAX(us, 1U)), worst);
+}
+
+static void test_fatfs_free_map(void)
+{
+	unsigned long free;
+	uint32_t start;
+	int ret;
+
+	fill_volume();
+	invalidate_fsinfo();
+
+	TC_PRINT("free cluster map: %s\n",
+		 IS_ENABLED(CONFIG_FS_FATFS_FREE_MAP) ? "on" : "off");
+
+	start = k_cycle_get_32();
+	ret = fs_mount(&fatfs_mnt);
+	report("mount", start);
+	zassert_equal(ret, 0, "Failed to mount (%d)", ret);
+
+	free = free_clusters("statvfs");
+	zassert_equal(free_clusters("statvfs again"), free, NULL);
+
+	write_log();
+
+	zassert_equal(free_clusters("statvfs after"), free - LOG_CLUSTERS,
+		      "Free cluster count not updated");
+
+	ret = fs_unmount(&fatfs_mnt);
+	zassert_equal(ret, 0, "Failed to unmount (%d)", ret);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(fatfs_free_map_bench,
+			 ztest_unit_test(test_fatfs_free_map));
+
+	ztest_run_test_suite(fatfs_free_map_bench);
+}
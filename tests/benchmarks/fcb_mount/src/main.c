@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Fill flash circular buffers of several sizes on the flash simulator with
+ * small entries, then report the run time and number of flash reads of
+ * fcb_init and of reading all entries back with fcb_getnext, as settings
+ * loading does, and with fcb_walk. The simulator adds its read times to the
+ * run time. Build with and without CONFIG_FCB_SECTOR_SUMMARY to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fcb.h>
+#include <drivers/flash/flash_simulator.h>
+#include <string.h>
+
+#define SECTOR_SIZE 4096
+#define MAX_SECTORS 64
+#define ENTRY_LEN 32
+
+static const int sector_counts[] = { 4, 16, 64 };
+
+static struct flash_sector sectors[MAX_SECTORS];
+static struct fcb bench_fcb;
+static uint8_t entry[ENTRY_LEN];
+static const struct device *flash_dev;
+
+static uint32_t read_calls(void)
+{
+	struct flash_simulator_wear wear;
+	int rc;
+
+	rc = flash_simulator_wear_get(flash_dev, &wear, NULL, 0);
+	zassert_equal(rc, 0, "Wear statistics not available (%d)", rc);
+
+	return wear.read_calls;
+}
+
+static void mount(int sector_cnt)
+{
+	int rc;
+
+	(void)memset(&bench_fcb, 0, sizeof(bench_fcb));
+	bench_fcb.f_magic = 0x5fcb5fcb;
+	bench_fcb.f_sector_cnt = sector_cnt;
+	bench_fcb.f_sectors = sectors;
+
+	rc = fcb_init(FLASH_AREA_ID(image_1), &bench_fcb);
+	zassert_equal(rc, 0, "fcb_init failure (%d)", rc);
+}
+
+static int fill(int sector_cnt)
+{
+	const struct flash_area *fa;
+	struct fcb_entry loc;
+	int cnt = 0;
+	int rc;
+
+	rc = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	zassert_equal(rc, 0, "flash_area_open() fail (%d)", rc);
+	zassert_true(fa->fa_size >= MAX_SECTORS * SECTOR_SIZE,
+		     "Flash area too small");
+	flash_dev = flash_area_get_device(fa);
+
+	rc = flash_area_erase(fa, 0, sector_cnt * SECTOR_SIZE);
+	zassert_equal(rc, 0, "Flash erase failure (%d)", rc);
+
+	for (int i = 0; i < sector_cnt; i++) {
+		sectors[i].fs_off = i * SECTOR_SIZE;
+		sectors[i].fs_size = SECTOR_SIZE;
+	}
+
+	mount(sector_cnt);
+
+	/* Leave the last sector half full */
+	while (bench_fcb.f_active.fe_sector != &sectors[sector_cnt - 1] ||
+	       bench_fcb.f_active.fe_elem_off < SECTOR_SIZE / 2) {
+		(void)memset(entry, cnt, sizeof(entry));
+
+		rc = fcb_append(&bench_fcb, sizeof(entry), &loc);
+		zassert_equal(rc, 0, "fcb_append failure (%d)", rc);
+		rc = flash_area_write(fa, FCB_ENTRY_FA_DATA_OFF(loc), entry,
+				      sizeof(entry));
+		zassert_equal(rc, 0, "Flash write failure (%d)", rc);
+		rc = fcb_append_finish(&bench_fcb, &loc);
+		zassert_equal(rc, 0, "fcb_append_finish failure (%d)", rc);
+		cnt++;
+	}
+
+	return cnt;
+}
+
+static int count_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	(*(int *)arg)++;
+	return 0;
+}
+
+static void report(const char *name, uint32_t start, uint32_t reads)
+{
+	TC_PRINT("  %-14s %8u us, %6u flash reads\n", name,
+		 k_cyc_to_us_floor32(k_cycle_get_32() - start),
+		 read_calls() - reads);
+}
+
+static void test_fcb_mount(void)
+{
+	struct fcb_entry loc;
+	uint32_t start, reads;
+	int entries;
+	int cnt;
+	int rc;
+
+	TC_PRINT("sector summaries: %s\n",
+		 IS_ENABLED(CONFIG_FCB_SECTOR_SUMMARY) ? "on" : "off");
+
+	for (int i = 0; i < ARRAY_SIZE(sector_counts); i++) {
+		entries = fill(sector_counts[i]);
+
+		TC_PRINT("%d KiB, %d entries:\n",
+			 sector_counts[i] * SECTOR_SIZE / 1024, entries);
+
+		reads = read_calls();
+		start = k_cycle_get_32();
+		mount(sector_counts[i]);
+		report("fcb_init", start, reads);
+
+		for (int pass = 1; pass <= 2; pass++) {
+			cnt = 0;
+			(void)memset(&loc, 0, sizeof(loc));
+			reads = read_calls();
+			start = k_cycle_get_32();
+			while (fcb_getnext(&bench_fcb, &loc) == 0) {
+				cnt++;
+			}
+			report(pass == 1 ? "fcb_getnext" : "fcb_getnext 2",
+			       start, reads);
+			zassert_equal(cnt, entries, "Read %d entries", cnt);
+		}
+
+		cnt = 0;
+		reads = read_calls();
+		start = k_cycle_get_32();
+		rc = fcb_walk(&bench_fcb, NULL, count_cb, &cnt);
+		report("fcb_walk", start, reads);
+		zassert_equal(rc, 0, "fcb_walk failure (%d)", rc);
+		zassert_equal(cnt, entries, "Walked %d entries", cnt);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(fcb_mount_bench,
+			 ztest_unit_test(test_fcb_mount));
+
+	ztest_run_test_suite(fcb_mount_bench);
+}
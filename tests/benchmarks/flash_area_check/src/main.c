@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure the throughput of flash area integrity checks on the flash
+ * simulator, for CRC-32 and SHA-256 and for several read chunk sizes, and
+ * how long a check run from the system work queue holds up other work items
+ * when it is run in one go or in slices. The simulator adds its read times
+ * to the run time.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <storage/flash_map.h>
+
+#define CHECK_SIZE (256 * 1024)
+#define WRITE_SIZE 4096
+#define SLICE_SIZE (16 * 1024)
+
+/* Digests of the pattern written by fill_area() */
+static const uint8_t pattern_sha[] = {
+	0x23, 0x29, 0x5a, 0xc6, 0xe5, 0x61, 0x86, 0xbd,
+	0xc6, 0x71, 0x50, 0x65, 0xc5, 0x25, 0x88, 0xed,
+	0x68, 0x85, 0x91, 0x87, 0xbe, 0xfc, 0xff, 0x70,
+	0x1d, 0xe6, 0x09, 0xc7, 0x84, 0x1a, 0xb3, 0x8f };
+static const uint8_t pattern_crc[] = { 0x6c, 0x6b, 0x34, 0x9f };
+
+static const size_t chunk_sizes[] = { 64, 256, 1024, 4096 };
+
+static uint8_t buf[WRITE_SIZE];
+
+static const struct flash_area *fa;
+
+static void fill_area(void)
+{
+	int rc;
+
+	rc = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	zassert_equal(rc, 0, "flash_area_open() fail (%d)", rc);
+	zassert_true(fa->fa_size >= CHECK_SIZE, "Flash area too small");
+
+	rc = flash_area_erase(fa, 0, CHECK_SIZE);
+	zassert_equal(rc, 0, "Flash erase failure (%d)", rc);
+
+	for (size_t off = 0; off < CHECK_SIZE; off += WRITE_SIZE) {
+		for (size_t i = 0; i < WRITE_SIZE; i++) {
+			buf[i] = (uint8_t)((off + i) * 7 + ((off + i) >> 8));
+		}
+
+		rc = flash_area_write(fa, off, buf, WRITE_SIZE);
+		zassert_equal(rc, 0, "Flash write failure (%d)", rc);
+	}
+}
+
+static uint32_t check_us(enum flash_area_check_alg alg, size_t chunk)
+{
+	struct flash_area_check_ctx ctx;
+	uint32_t start, cycles;
+	int rc;
+
+	start = k_cycle_get_32();
+
+	rc = flash_area_check_init(&ctx, fa, alg, 0, CHECK_SIZE, buf, chunk);
+	zassert_equal(rc, 0, "Check init failure (%d)", rc);
+	rc = flash_area_check_update(&ctx, CHECK_SIZE);
+	zassert_equal(rc, 0, "Check update failure (%d)", rc);
+	rc = flash_area_check_final(&ctx, alg == FLASH_AREA_CHECK_CRC32 ?
+				    pattern_crc : pattern_sha);
+	zassert_equal(rc, 0, "Check failure (%d)", rc);
+
+	cycles = k_cycle_get_32() - start;
+
+	return k_cyc_to_us_floor32(cycles);
+}
+
+static uint32_t kbps(uint32_t us)
+{
+	return (uint32_t)(((uint64_t)CHECK_SIZE * 1000U) / MAX(us, 1U));
+}
+
+static void test_check_throughput(void)
+{
+	uint32_t crc_us, sha_us;
+
+	fill_area();
+
+	TC_PRINT("chunk    CRC-32 KB/s    SHA-256 KB/s\n");
+
+	for (int i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		crc_us = check_us(FLASH_AREA_CHECK_CRC32, chunk_sizes[i]);
+		sha_us = check_us(FLASH_AREA_CHECK_SHA256, chunk_sizes[i]);
+
+		TC_PRINT("%5zu    %11u    %12u\n", chunk_sizes[i],
+			 kbps(crc_us), kbps(sha_us));
+	}
+}
+
+static K_SEM_DEFINE(check_done, 0, 1);
+static int check_result;
+static uint32_t check_end;
+static uint32_t probe_run;
+
+static void check_cb(struct flash_area_check_work *work, int result)
+{
+	check_result = result;
+	check_end = k_cycle_get_32();
+	k_sem_give(&check_done);
+}
+
+static void probe_handler(struct k_work *work)
+{
+	probe_run = k_cycle_get_32();
+}
+
+static K_WORK_DEFINE(probe_work, probe_handler);
+
+static struct flash_area_check_work check_work;
+
+static void run_sliced(size_t slice)
+{
+	struct k_work_sync sync;
+	uint32_t start;
+	int rc;
+
+	rc = flash_area_check_init(&check_work.ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   0, CHECK_SIZE, buf, 1024);
+	zassert_equal(rc, 0, "Check init failure (%d)", rc);
+
+	start = k_cycle_get_32();
+
+	rc = flash_area_check_work_submit(&check_work, NULL, slice,
+					  pattern_sha, check_cb);
+	zassert_equal(rc, 0, "Check submit failure (%d)", rc);
+
+	/* Another item queued behind the check */
+	rc = k_work_submit(&probe_work);
+	zassert_true(rc >= 0, "Probe submit failure (%d)", rc);
+
+	zassert_equal(k_sem_take(&check_done, K_SECONDS(30)), 0,
+		      "Check did not complete");
+	zassert_equal(check_result, 0, "Check failure (%d)", check_result);
+	(void)k_work_flush(&probe_work, &sync);
+
+	TC_PRINT("slice %6zu: check %7u us, other work held up %7u us\n",
+		 slice, k_cyc_to_us_floor32(check_end - start),
+		 k_cyc_to_us_floor32(probe_run - start));
+}
+
+static void test_check_work(void)
+{
+	flash_area_check_work_init(&check_work);
+
+	run_sliced(CHECK_SIZE);
+	run_sliced(SLICE_SIZE);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(flash_area_check_bench,
+			 ztest_unit_test(test_check_throughput),
+			 ztest_unit_test(test_check_work));
+
+	ztest_run_test_suite(flash_area_check_bench);
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Copy a file on a FAT volume backed by the flash disk driver on top of
+ * the flash simulator, and report the number of flash erases, the highest
+ * number of erases of a single erase block and the copy throughput. The
+ * simulator adds its erase and write times to the run time. Build with and
+ * without CONFIG_DISK_FLASH_WRITE_BACK and CONFIG_DISK_FLASH_FTL to
+ * compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fs.h>
+#include <ff.h>
+#include <drivers/flash/flash_simulator.h>
+#include <string.h>
+
+#define FATFS_MNTP "/NAND:"
+#define SRC_FILE FATFS_MNTP "/src.bin"
+#define DST_FILE FATFS_MNTP "/dst.bin"
+
+#define FILE_SIZE (256 * 1024)
+#define CHUNK_SIZE 1024
+#define MAX_UNITS 256
+
+static FATFS fat_fs;
+
+static struct fs_mount_t fatfs_mnt = {
+	.type = FS_FATFS,
+	.mnt_point = FATFS_MNTP,
+	.fs_data = &fat_fs,
+};
+
+static uint8_t chunk[CHUNK_SIZE];
+
+struct flash_counters {
+	uint32_t erases;
+	uint32_t unit_erases[MAX_UNITS];
+};
+
+static void get_counters(struct flash_counters *counters)
+{
+	const struct device *flash_dev =
+		device_get_binding(CONFIG_DISK_FLASH_DEV_NAME);
+	struct flash_simulator_wear wear;
+	int ret;
+
+	zassert_not_null(flash_dev, "Flash simulator not found");
+
+	(void)memset(counters, 0, sizeof(*counters));
+	ret = flash_simulator_wear_get(flash_dev, &wear, counters->unit_erases,
+				       MAX_UNITS);
+	zassert_true(ret >= 0, "Wear statistics not available (%d)", ret);
+	counters->erases = wear.erase_calls;
+}
+
+static void fill_chunk(size_t offset)
+{
+	for (size_t i = 0; i < CHUNK_SIZE; i++) {
+		chunk[i] = (uint8_t)((offset + i) * 7 + ((offset + i) >> 8));
+	}
+}
+
+static void create_source(void)
+{
+	struct fs_file_t file;
+	int ret;
+
+	fs_file_t_init(&file);
+	ret = fs_open(&file, SRC_FILE, FS_O_CREATE | FS_O_WRITE);
+	zassert_equal(ret, 0, "Failed to create source file (%d)", ret);
+
+	for (size_t offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE) {
+		fill_chunk(offset);
+		ret = fs_write(&file, chunk, CHUNK_SIZE);
+		zassert_equal(ret, CHUNK_SIZE, "Write failed (%d)", ret);
+	}
+
+	zassert_equal(fs_close(&file), 0, NULL);
+}
+
+static void copy_file(void)
+{
+	struct fs_file_t src, dst;
+	ssize_t len;
+	int ret;
+
+	fs_file_t_init(&src);
+	fs_file_t_init(&dst);
+
+	ret = fs_open(&src, SRC_FILE, FS_O_READ);
+	zassert_equal(ret, 0, "Failed to open source file (%d)", ret);
+	ret = fs_open(&dst, DST_FILE, FS_O_CREATE | FS_O_WRITE);
+	zassert_equal(ret, 0, "Failed to create copy (%d)", ret);
+
+	do {
+		len = fs_read(&src, chunk, CHUNK_SIZE);
+		zassert_true(len >= 0, "Read failed (%d)", (int)len);
+
+		if (len > 0) {
+			ret = fs_write(&dst, chunk, len);
+			zassert_equal(ret, len, "Write failed (%d)", ret);
+		}
+	} while (len > 0);
+
+	zassert_equal(fs_close(&src), 0, NULL);
+	zassert_equal(fs_close(&dst), 0, NULL);
+}
+
+static void check_copy(void)
+{
+	uint8_t expected[CHUNK_SIZE];
+	struct fs_file_t file;
+	int ret;
+
+	fs_file_t_init(&file);
+	ret = fs_open(&file, DST_FILE, FS_O_READ);
+	zassert_equal(ret, 0, "Failed to open copy (%d)", ret);
+
+	for (size_t offset = 0; offset < FILE_SIZE; offset += CHUNK_SIZE) {
+		fill_chunk(offset);
+		memcpy(expected, chunk, CHUNK_SIZE);
+
+		ret = fs_read(&file, chunk, CHUNK_SIZE);
+		zassert_equal(ret, CHUNK_SIZE, "Read failed (%d)", ret);
+		zassert_mem_equal(chunk, expected, CHUNK_SIZE,
+				  "Copy differs at offset %zu", offset);
+	}
+
+	zassert_equal(fs_close(&file), 0, NULL);
+}
+
+static void test_fat_copy(void)
+{
+	static struct flash_counters before, after;
+	uint32_t max_unit_erases = 0U;
+	int64_t start;
+	uint64_t us;
+	int ret;
+
+	ret = fs_mount(&fatfs_mnt);
+	zassert_equal(ret, 0, "Failed to mount (%d)", ret);
+
+	create_source();
+
+	get_counters(&before);
+	start = k_uptime_ticks();
+
+	copy_file();
+
+	us = k_ticks_to_us_floor64(k_uptime_ticks() - start);
+	get_counters(&after);
+
+	check_copy();
+
+	for (int i = 0; i < MAX_UNITS; i++) {
+		max_unit_erases = MAX(max_unit_erases, after.unit_erases[i] -
+				      before.unit_erases[i]);
+	}
+
+	TC_PRINT("write-back cache: %s, FTL: %s\n",
+		 IS_ENABLED(CONFIG_DISK_FLASH_WRITE_BACK) ? "on" : "off",
+		 IS_ENABLED(CONFIG_DISK_FLASH_FTL) ? "on" : "off");
+	TC_PRINT("copied %u KiB in %u ms: %u KB/s\n", FILE_SIZE / 1024,
+		 (uint32_t)(us / 1000U),
+		 (uint32_t)(us ? ((uint64_t)FILE_SIZE * 1000U) / us : 0));
+	TC_PRINT("erases: %u, most erased block: %u\n",
+		 after.erases - before.erases, max_unit_erases);
+
+	zassert_equal(fs_unmount(&fatfs_mnt), 0, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(flashdisk_fat_bench,
+			 ztest_unit_test(test_fat_copy));
+
+	ztest_run_test_suite(flashdisk_fat_bench);
+}
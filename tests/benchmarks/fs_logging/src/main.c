@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Sensor logging workload on littlefs on the flash simulator. Each record is
+ * made of a header, a block of samples and a trailer, which are written:
+ *  - copied into one buffer, with fs_write,
+ *  - as they are, with fs_writev,
+ *  - with asynchronous requests, with two records in flight.
+ * For each way the records are first written back to back, to measure
+ * throughput, and then one per sample period, to measure how long the
+ * logging thread is blocked per record. The simulator adds its flash
+ * operation times to the run time.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fs.h>
+#include <fs/littlefs.h>
+#include <storage/flash_map.h>
+#include <string.h>
+
+#define MNT_POINT "/lfs"
+#define LOG_FILE MNT_POINT "/log"
+#define RECORD_CNT 256
+#define SAMPLE_CNT 24
+#define SAMPLE_PERIOD_US 2000
+#define ASYNC_SLOTS 2
+
+FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(bench_lfs);
+
+static struct fs_mount_t bench_mnt = {
+	.type = FS_LITTLEFS,
+	.fs_data = &bench_lfs,
+	.storage_dev = (void *)FLASH_AREA_ID(image_1),
+	.mnt_point = MNT_POINT,
+};
+
+struct record_hdr {
+	uint32_t seq;
+	uint32_t timestamp;
+};
+
+struct record {
+	struct record_hdr hdr;
+	int16_t samples[SAMPLE_CNT];
+	uint32_t trailer;
+	struct fs_iovec iov[3];
+};
+
+enum log_mode {
+	LOG_COPY,
+	LOG_WRITEV,
+	LOG_ASYNC,
+};
+
+static const char *const mode_names[] = {
+	[LOG_COPY] = "fs_write",
+	[LOG_WRITEV] = "fs_writev",
+	[LOG_ASYNC] = "async",
+};
+
+static struct fs_file_t log_file;
+static struct record records[ASYNC_SLOTS];
+static struct fs_async_req reqs[ASYNC_SLOTS];
+static uint8_t copy_buf[sizeof(struct record_hdr) +
+			SAMPLE_CNT * sizeof(int16_t) + sizeof(uint32_t)];
+static K_SEM_DEFINE(free_slots, ASYNC_SLOTS, ASYNC_SLOTS);
+static ssize_t async_error;
+
+static void async_cb(struct fs_async_req *req, ssize_t result)
+{
+	if (result < 0) {
+		async_error = result;
+	}
+	k_sem_give(&free_slots);
+}
+
+static void sample(struct record *rec, uint32_t seq)
+{
+	rec->hdr.seq = seq;
+	rec->hdr.timestamp = k_cycle_get_32();
+	for (int i = 0; i < SAMPLE_CNT; i++) {
+		rec->samples[i] = (int16_t)(seq * 13 + i);
+	}
+	rec->trailer = rec->hdr.seq ^ rec->hdr.timestamp;
+
+	rec->iov[0].base = &rec->hdr;
+	rec->iov[0].len = sizeof(rec->hdr);
+	rec->iov[1].base = rec->samples;
+	rec->iov[1].len = sizeof(rec->samples);
+	rec->iov[2].base = &rec->trailer;
+	rec->iov[2].len = sizeof(rec->trailer);
+}
+
+static void log_record(enum log_mode mode, uint32_t seq)
+{
+	struct record *rec = &records[seq % ASYNC_SLOTS];
+	struct fs_async_req *req = &reqs[seq % ASYNC_SLOTS];
+	ssize_t rc = sizeof(copy_buf);
+	size_t off = 0;
+
+	if (mode == LOG_ASYNC) {
+		/* Wait for the request last using the slot */
+		zassert_equal(k_sem_take(&free_slots, K_FOREVER), 0, NULL);
+	}
+
+	sample(rec, seq);
+
+	switch (mode) {
+	case LOG_COPY:
+		for (int i = 0; i < ARRAY_SIZE(rec->iov); i++) {
+			memcpy(&copy_buf[off], rec->iov[i].base,
+			       rec->iov[i].len);
+			off += rec->iov[i].len;
+		}
+		rc = fs_write(&log_file, copy_buf, off);
+		break;
+	case LOG_WRITEV:
+		rc = fs_writev(&log_file, rec->iov, ARRAY_SIZE(rec->iov));
+		break;
+	case LOG_ASYNC:
+		req->zfp = &log_file;
+		req->op = FS_ASYNC_WRITE;
+		req->iov = rec->iov;
+		req->iovcnt = ARRAY_SIZE(rec->iov);
+		req->cb = async_cb;
+		zassert_equal(fs_async_submit(req), 0, "Submit failed");
+		break;
+	}
+
+	zassert_equal(rc, sizeof(copy_buf), "Write failed (%d)", (int)rc);
+}
+
+static void log_finish(enum log_mode mode)
+{
+	if (mode == LOG_ASYNC) {
+		for (int i = 0; i < ASYNC_SLOTS; i++) {
+			zassert_equal(k_sem_take(&free_slots, K_FOREVER), 0,
+				      NULL);
+		}
+		for (int i = 0; i < ASYNC_SLOTS; i++) {
+			k_sem_give(&free_slots);
+		}
+		zassert_equal(async_error, 0, "Async write failed (%d)",
+			      (int)async_error);
+	}
+
+	zassert_equal(fs_sync(&log_file), 0, "Sync failed");
+}
+
+static void log_open(void)
+{
+	int rc;
+
+	fs_file_t_init(&log_file);
+	rc = fs_open(&log_file, LOG_FILE, FS_O_CREATE | FS_O_WRITE);
+	zassert_equal(rc, 0, "fs_open failure (%d)", rc);
+	rc = fs_truncate(&log_file, 0);
+	zassert_equal(rc, 0, "fs_truncate failure (%d)", rc);
+}
+
+static void log_close(void)
+{
+	struct fs_dirent entry;
+	int rc;
+
+	rc = fs_close(&log_file);
+	zassert_equal(rc, 0, "fs_close failure (%d)", rc);
+	rc = fs_stat(LOG_FILE, &entry);
+	zassert_equal(rc, 0, "fs_stat failure (%d)", rc);
+	zassert_equal(entry.size, RECORD_CNT * sizeof(copy_buf),
+		      "Log file size %zu", entry.size);
+}
+
+static void run_burst(enum log_mode mode)
+{
+	uint32_t start, us;
+
+	log_open();
+
+	start = k_cycle_get_32();
+	for (uint32_t seq = 0; seq < RECORD_CNT; seq++) {
+		log_record(mode, seq);
+	}
+	log_finish(mode);
+	us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	log_close();
+
+	TC_PRINT("  %-10s burst: %8u us, %6u B/s\n", mode_names[mode], us,
+		 (uint32_t)((uint64_t)RECORD_CNT * sizeof(copy_buf) *
+			    USEC_PER_SEC / MAX(us, 1U)));
+}
+
+static void run_paced(enum log_mode mode)
+{
+	uint32_t blocked = 0U;
+	uint32_t worst = 0U;
+	uint32_t start, us;
+
+	log_open();
+
+	for (uint32_t seq = 0; seq < RECORD_CNT; seq++) {
+		start = k_cycle_get_32();
+		log_record(mode, seq);
+		us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		blocked += us;
+		worst = MAX(worst, us);
+		k_sleep(K_USEC(SAMPLE_PERIOD_US));
+	}
+	log_finish(mode);
+
+	log_close();
+
+	TC_PRINT("  %-10s paced: %6u us blocked per record, %6u us worst\n",
+		 mode_names[mode], blocked / RECORD_CNT, worst);
+}
+
+static void test_fs_logging(void)
+{
+	const struct flash_area *fa;
+	int rc;
+
+	rc = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	zassert_equal(rc, 0, "flash_area_open() fail (%d)", rc);
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_equal(rc, 0, "Flash erase failure (%d)", rc);
+	flash_area_close(fa);
+
+	rc = fs_mount(&bench_mnt);
+	zassert_equal(rc, 0, "fs_mount failure (%d)", rc);
+
+	TC_PRINT("%d records of %zu B, one per %d us when paced:\n",
+		 RECORD_CNT, sizeof(copy_buf), SAMPLE_PERIOD_US);
+
+	for (int mode = LOG_COPY; mode <= LOG_ASYNC; mode++) {
+		run_burst(mode);
+		run_paced(mode);
+	}
+
+	rc = fs_unmount(&bench_mnt);
+	zassert_equal(rc, 0, "fs_unmount failure (%d)", rc);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(fs_logging_bench,
+			 ztest_unit_test(test_fs_logging));
+
+	ztest_run_test_suite(fs_logging_bench);
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Create a number of small files on littlefs on the flash simulator, append
+ * to each of them in turn a few times and read them all back, then report
+ * the run time, number of flash operations and simulated flash busy time of
+ * each step, and the wear of the flash at the end. The simulator adds its
+ * operation times to the run time. Build with different littlefs cache
+ * options to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <fs/fs.h>
+#include <fs/littlefs.h>
+#include <drivers/flash/flash_simulator.h>
+#include <storage/flash_map.h>
+#include <stdio.h>
+
+#define MNT_POINT "/lfs"
+#define FILE_CNT 32
+#define APPEND_CNT 4
+#define CHUNK_LEN 24
+
+FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(bench_lfs);
+
+static struct fs_mount_t bench_mnt = {
+	.type = FS_LITTLEFS,
+	.fs_data = &bench_lfs,
+	.storage_dev = (void *)FLASH_AREA_ID(image_1),
+	.mnt_point = MNT_POINT,
+};
+
+struct flash_ops {
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t erases;
+	uint64_t busy_us;
+};
+
+static const struct device *flash_dev;
+
+static uint8_t chunk[CHUNK_LEN];
+static uint8_t data[CHUNK_LEN * (APPEND_CNT + 1)];
+
+static void flash_ops_get(struct flash_ops *ops)
+{
+	struct flash_simulator_wear wear;
+	int rc;
+
+	rc = flash_simulator_wear_get(flash_dev, &wear, NULL, 0);
+	zassert_equal(rc, 0, "Wear statistics not available (%d)", rc);
+	ops->reads = wear.read_calls;
+	ops->writes = wear.write_calls;
+	ops->erases = wear.erase_calls;
+	ops->busy_us = wear.read_time_us + wear.write_time_us +
+		       wear.erase_time_us;
+}
+
+static void report(const char *name, uint32_t start,
+		   const struct flash_ops *before)
+{
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	struct flash_ops now;
+
+	flash_ops_get(&now);
+	TC_PRINT("  %-8s %8u us, %6u reads, %5u writes, %4u erases, "
+		 "%8u us busy\n", name, us, now.reads - before->reads,
+		 now.writes - before->writes, now.erases - before->erases,
+		 (uint32_t)(now.busy_us - before->busy_us));
+}
+
+static void report_wear(void)
+{
+	struct flash_simulator_wear wear;
+	int rc;
+
+	rc = flash_simulator_wear_get(flash_dev, &wear, NULL, 0);
+	zassert_equal(rc, 0, "Wear statistics not available (%d)", rc);
+
+	TC_PRINT("  wear: %u erases, %u to %u per block; blocks by erases:",
+		 (uint32_t)wear.total_erases, wear.min_erases, wear.max_erases);
+	for (int i = 0; i < FLASH_SIMULATOR_WEAR_BUCKETS; i++) {
+		if (wear.histogram[i] != 0U) {
+			TC_PRINT(" %s%u: %u", i == 0 ? "" : "<",
+				 i == 0 ? 0U : BIT(i), wear.histogram[i]);
+		}
+	}
+	TC_PRINT("\n");
+}
+
+static void file_name(char *name, size_t size, int i)
+{
+	snprintf(name, size, MNT_POINT "/f%02d", i);
+}
+
+static void fill_chunk(int i, int n)
+{
+	for (int j = 0; j < sizeof(chunk); j++) {
+		chunk[j] = (uint8_t)(i * 31 + n * 7 + j);
+	}
+}
+
+static void write_chunk(int i, int n, fs_mode_t flags)
+{
+	struct fs_file_t file;
+	char name[16];
+	ssize_t len;
+	int rc;
+
+	file_name(name, sizeof(name), i);
+	fill_chunk(i, n);
+	fs_file_t_init(&file);
+
+	rc = fs_open(&file, name, flags);
+	zassert_equal(rc, 0, "fs_open failure (%d)", rc);
+	len = fs_write(&file, chunk, sizeof(chunk));
+	zassert_equal(len, sizeof(chunk), "fs_write failure (%d)", (int)len);
+	rc = fs_close(&file);
+	zassert_equal(rc, 0, "fs_close failure (%d)", rc);
+}
+
+static void read_file(int i)
+{
+	struct fs_file_t file;
+	char name[16];
+	ssize_t len;
+	int rc;
+
+	file_name(name, sizeof(name), i);
+	fs_file_t_init(&file);
+
+	rc = fs_open(&file, name, FS_O_READ);
+	zassert_equal(rc, 0, "fs_open failure (%d)", rc);
+	len = fs_read(&file, data, sizeof(data));
+	zassert_equal(len, sizeof(data), "fs_read failure (%d)", (int)len);
+	rc = fs_close(&file);
+	zassert_equal(rc, 0, "fs_close failure (%d)", rc);
+
+	for (int n = 0; n <= APPEND_CNT; n++) {
+		fill_chunk(i, n);
+		zassert_mem_equal(&data[n * CHUNK_LEN], chunk, CHUNK_LEN,
+				  "File %d chunk %d differs", i, n);
+	}
+}
+
+static void test_littlefs_small_files(void)
+{
+	const struct flash_area *fa;
+	struct flash_ops ops;
+	uint32_t start;
+	int rc;
+
+	TC_PRINT("cache %u B, metadata_max %u B, shared cache %u B\n",
+		 CONFIG_FS_LITTLEFS_CACHE_SIZE,
+		 CONFIG_FS_LITTLEFS_METADATA_MAX,
+		 COND_CODE_1(CONFIG_FS_LITTLEFS_SHARED_CACHE,
+			     (CONFIG_FS_LITTLEFS_SHARED_CACHE_SIZE), (0)));
+	TC_PRINT("%d files, %d appends of %d B each:\n", FILE_CNT, APPEND_CNT,
+		 CHUNK_LEN);
+
+	rc = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	zassert_equal(rc, 0, "flash_area_open() fail (%d)", rc);
+	flash_dev = flash_area_get_device(fa);
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_equal(rc, 0, "Flash erase failure (%d)", rc);
+	flash_area_close(fa);
+	flash_simulator_wear_reset(flash_dev);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	rc = fs_mount(&bench_mnt);
+	report("format", start, &ops);
+	zassert_equal(rc, 0, "fs_mount failure (%d)", rc);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	for (int i = 0; i < FILE_CNT; i++) {
+		write_chunk(i, 0, FS_O_CREATE | FS_O_WRITE);
+	}
+	report("create", start, &ops);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	for (int n = 1; n <= APPEND_CNT; n++) {
+		for (int i = 0; i < FILE_CNT; i++) {
+			write_chunk(i, n, FS_O_WRITE | FS_O_APPEND);
+		}
+	}
+	report("append", start, &ops);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	for (int i = 0; i < FILE_CNT; i++) {
+		read_file(i);
+	}
+	report("read", start, &ops);
+
+	rc = fs_unmount(&bench_mnt);
+	zassert_equal(rc, 0, "fs_unmount failure (%d)", rc);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	rc = fs_mount(&bench_mnt);
+	report("mount", start, &ops);
+	zassert_equal(rc, 0, "fs_mount failure (%d)", rc);
+
+	flash_ops_get(&ops);
+	start = k_cycle_get_32();
+	for (int i = 0; i < FILE_CNT; i++) {
+		read_file(i);
+	}
+	report("reread", start, &ops);
+	report_wear();
+
+	rc = fs_unmount(&bench_mnt);
+	zassert_equal(rc, 0, "fs_unmount failure (%d)", rc);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(littlefs_small_files_bench,
+			 ztest_unit_test(test_littlefs_small_files));
+
+	ztest_run_test_suite(littlefs_small_files_bench);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure the memory slab alloc/free throughput with one thread per CPU
+ * hammering the same slab, and check that the usage statistics and the
+ * blocking allocation still behave with CONFIG_MEM_SLAB_PER_CPU_CACHE.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#define BLK_SIZE 64
+#define BLK_NUM 128
+#define BURST 4
+#define ITERATIONS 20000
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define WORKER_PRIO K_PRIO_COOP(10)
+
+K_MEM_SLAB_DEFINE(bench_slab, BLK_SIZE, BLK_NUM, 4);
+
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, CONFIG_MP_NUM_CPUS,
+				   STACK_SIZE);
+static struct k_thread worker_threads[CONFIG_MP_NUM_CPUS];
+static int worker_result[CONFIG_MP_NUM_CPUS];
+
+static void *blocks[BLK_NUM];
+
+static void worker(void *p1, void *p2, void *p3)
+{
+	int id = POINTER_TO_INT(p1);
+	void *burst[BURST];
+	int i, j, ret;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		for (j = 0; j < BURST; j++) {
+			ret = k_mem_slab_alloc(&bench_slab, &burst[j],
+					       K_FOREVER);
+			if (ret != 0) {
+				worker_result[id] = ret;
+				return;
+			}
+
+			*(uint8_t *)burst[j] = (uint8_t)id;
+		}
+
+		for (j = 0; j < BURST; j++) {
+			if (*(uint8_t *)burst[j] != (uint8_t)id) {
+				worker_result[id] = -EFAULT;
+			}
+
+			k_mem_slab_free(&bench_slab, &burst[j]);
+		}
+	}
+}
+
+static void test_slab_smp_throughput(void)
+{
+	uint32_t start, cycles;
+	uint64_t ops;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		worker_result[i] = 0;
+		k_thread_create(&worker_threads[i], worker_stacks[i],
+				STACK_SIZE, worker, INT_TO_POINTER(i),
+				NULL, NULL, WORKER_PRIO, 0, K_FOREVER);
+	}
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_start(&worker_threads[i]);
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_join(&worker_threads[i], K_FOREVER);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		zassert_equal(worker_result[i], 0, "Worker %d failed (%d)",
+			      i, worker_result[i]);
+	}
+
+	ops = (uint64_t)CONFIG_MP_NUM_CPUS * ITERATIONS * BURST;
+
+	TC_PRINT("%d CPUs: %u cycles per alloc/free pair, %u pairs/Mcycle\n",
+		 CONFIG_MP_NUM_CPUS, (uint32_t)(cycles / ops),
+		 cycles ? (uint32_t)(ops * 1000000U / cycles) : 0U);
+
+	zassert_equal(k_mem_slab_num_used_get(&bench_slab), 0,
+		      "Blocks still in use");
+	zassert_equal(k_mem_slab_num_free_get(&bench_slab), BLK_NUM,
+		      "Blocks missing");
+	zassert_true(k_mem_slab_max_used_get(&bench_slab) >= BURST &&
+		     k_mem_slab_max_used_get(&bench_slab) <=
+		     CONFIG_MP_NUM_CPUS * BURST,
+		     "Bad maximum usage %u",
+		     k_mem_slab_max_used_get(&bench_slab));
+}
+
+static void free_one(void *p1, void *p2, void *p3)
+{
+	k_msleep(10);
+	k_mem_slab_free(&bench_slab, &blocks[0]);
+}
+
+static void test_slab_smp_exhaust(void)
+{
+	void *block;
+	int i, ret;
+
+	/* Blocks cached by the workers' CPUs must be found as well */
+	for (i = 0; i < BLK_NUM; i++) {
+		ret = k_mem_slab_alloc(&bench_slab, &blocks[i], K_NO_WAIT);
+		zassert_equal(ret, 0, "Cannot allocate block %d", i);
+	}
+
+	zassert_equal(k_mem_slab_num_used_get(&bench_slab), BLK_NUM,
+		      "Bad used count");
+	zassert_equal(k_mem_slab_alloc(&bench_slab, &block, K_NO_WAIT),
+		      -ENOMEM, "Allocated from an empty slab");
+
+	/* A block freed on another CPU wakes up a waiting allocation */
+	k_thread_create(&worker_threads[0], worker_stacks[0], STACK_SIZE,
+			free_one, NULL, NULL, NULL, WORKER_PRIO, 0, K_NO_WAIT);
+
+	ret = k_mem_slab_alloc(&bench_slab, &block, K_MSEC(1000));
+	zassert_equal(ret, 0, "Waiting allocation failed (%d)", ret);
+	zassert_equal(block, blocks[0], "Got a different block");
+
+	k_thread_join(&worker_threads[0], K_FOREVER);
+
+	for (i = 0; i < BLK_NUM; i++) {
+		k_mem_slab_free(&bench_slab, &blocks[i]);
+	}
+
+	zassert_equal(k_mem_slab_num_used_get(&bench_slab), 0,
+		      "Blocks still in use");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mem_slab_smp,
+			 ztest_unit_test(test_slab_smp_throughput),
+			 ztest_unit_test(test_slab_smp_exhaust));
+
+	ztest_run_test_suite(mem_slab_smp);
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Verify the Internet checksum against a reference implementation and
+ * measure how many cycles it takes for packets of different sizes.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <random/rand32.h>
+
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/dummy.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define TEST_MTU 1500
+#define ITERATIONS 1000
+#define ALLOC_TIMEOUT K_MSEC(100)
+
+#define MAX_FLAT_LEN 300
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static const size_t pkt_sizes[] = { 64, 128, 256, 512, 1024, 1472 };
+
+static uint8_t flat_buf[MAX_FLAT_LEN + sizeof(uint32_t)];
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int net_iface_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = net_iface_send,
+};
+
+NET_DEVICE_INIT(net_chksum_test, "net_chksum_test",
+		net_iface_dev_init, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2),
+		TEST_MTU);
+
+/* Straightforward RFC 1071 checksum used as a reference */
+static uint16_t ref_chksum(uint32_t sum, const uint8_t *data, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (data[i] << 8) | data[i + 1];
+	}
+
+	if (len & 1) {
+		sum += data[len - 1] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static uint16_t ref_chksum_final(uint16_t sum)
+{
+	sum = (sum == 0U) ? 0xffff : htons(sum);
+
+	return ~sum;
+}
+
+static struct net_pkt *create_udp_pkt(size_t len)
+{
+	struct net_if *iface;
+	struct net_pkt *pkt;
+	size_t i;
+	int ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	pkt = net_pkt_alloc_with_buffer(iface, NET_UDPH_LEN + len, AF_INET,
+					IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	ret = net_ipv4_create(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(1234), htons(4321));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	for (i = 0; i < len; i++) {
+		ret = net_pkt_write_u8(pkt, sys_rand32_get());
+		zassert_equal(ret, 0, "Cannot write data");
+	}
+
+	/* The UDP checksum field is left zero for the measurements */
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+/* Reference checksum over a linear copy of the pseudo header and the
+ * UDP datagram.
+ */
+static uint16_t ref_chksum_udp(struct net_pkt *pkt)
+{
+	static uint8_t data[TEST_MTU];
+	size_t len = net_pkt_get_len(pkt) - NET_IPV4H_LEN;
+	uint32_t sum;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	zassert_equal(net_pkt_skip(pkt, NET_IPV4H_LEN), 0, "skip");
+	zassert_equal(net_pkt_read(pkt, data, len), 0, "read");
+
+	sum = ref_chksum(len + IPPROTO_UDP, NET_IPV4_HDR(pkt)->src,
+			 2 * sizeof(struct in_addr));
+	sum = ref_chksum(sum, data, len);
+	sum = ref_chksum_final(sum);
+
+	/* Zero is transmitted as all ones in UDP */
+	return sum == 0U ? 0xffff : sum;
+}
+
+static void test_chksum_flat(void)
+{
+	size_t len, offset, i;
+	uint16_t expected;
+
+	/* All lengths at all alignments, as the fast path handles the
+	 * unaligned head and the tail separately.
+	 */
+	for (offset = 0; offset < sizeof(uint32_t); offset++) {
+		for (len = 0; len <= MAX_FLAT_LEN; len++) {
+			for (i = 0; i < len; i++) {
+				flat_buf[offset + i] = sys_rand32_get();
+			}
+
+			expected = ref_chksum_final(
+				ref_chksum(0, &flat_buf[offset], len));
+
+			zassert_equal(net_calc_chksum_igmp(&flat_buf[offset],
+							   len),
+				      expected,
+				      "Checksum mismatch, len %zu offset %zu",
+				      len, offset);
+		}
+	}
+
+	/* Large sums must wrap around correctly */
+	memset(flat_buf, 0xff, sizeof(flat_buf));
+
+	zassert_equal(net_calc_chksum_igmp(flat_buf, MAX_FLAT_LEN),
+		      ref_chksum_final(ref_chksum(0, flat_buf, MAX_FLAT_LEN)),
+		      "Checksum mismatch with all ones");
+}
+
+static void test_chksum_pkt(void)
+{
+	struct net_pkt *pkt;
+	uint16_t chksum;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pkt_sizes); i++) {
+		pkt = create_udp_pkt(pkt_sizes[i]);
+
+		chksum = net_calc_chksum_udp(pkt);
+		zassert_equal(chksum, ref_chksum_udp(pkt),
+			      "Checksum mismatch, size %zu", pkt_sizes[i]);
+
+		net_pkt_unref(pkt);
+	}
+}
+
+static void test_chksum_perf(void)
+{
+	struct net_pkt *pkt;
+	uint32_t start, cycles;
+	volatile uint16_t chksum;
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(pkt_sizes); i++) {
+		pkt = create_udp_pkt(pkt_sizes[i]);
+
+		start = k_cycle_get_32();
+
+		for (j = 0; j < ITERATIONS; j++) {
+			chksum = net_calc_chksum_udp(pkt);
+		}
+
+		cycles = k_cycle_get_32() - start;
+
+		TC_PRINT("size %4zu: %u cycles/packet, %u bytes/kcycle\n",
+			 pkt_sizes[i], cycles / ITERATIONS,
+			 cycles ? (uint32_t)((uint64_t)pkt_sizes[i] *
+					     ITERATIONS * 1000U / cycles) : 0U);
+
+		net_pkt_unref(pkt);
+	}
+
+	ARG_UNUSED(chksum);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_chksum,
+			 ztest_unit_test(test_chksum_flat),
+			 ztest_unit_test(test_chksum_pkt),
+			 ztest_unit_test(test_chksum_perf));
+
+	ztest_run_test_suite(net_chksum);
+}
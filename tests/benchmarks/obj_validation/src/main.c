@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure the round-trip cost of system calls on common kernel objects made
+ * from user mode, which is dominated by the kernel object validation. Build
+ * with and without CONFIG_OBJ_VALIDATION_CACHE to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#define ITERATIONS 10000
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+K_SEM_DEFINE(bench_sem, 0, 1);
+K_MUTEX_DEFINE(bench_mutex);
+K_MSGQ_DEFINE(bench_msgq, sizeof(uint32_t), 1, 4);
+
+static ZTEST_BMEM int loop_result;
+
+static K_THREAD_STACK_DEFINE(user_stack, STACK_SIZE);
+static struct k_thread user_thread;
+
+static void sem_loop(void *p1, void *p2, void *p3)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		k_sem_give(&bench_sem);
+		ret = k_sem_take(&bench_sem, K_NO_WAIT);
+	}
+
+	loop_result = ret;
+}
+
+static void mutex_loop(void *p1, void *p2, void *p3)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		ret = k_mutex_lock(&bench_mutex, K_NO_WAIT);
+		if (ret == 0) {
+			ret = k_mutex_unlock(&bench_mutex);
+		}
+	}
+
+	loop_result = ret;
+}
+
+static void msgq_loop(void *p1, void *p2, void *p3)
+{
+	uint32_t data = 0U;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		ret = k_msgq_put(&bench_msgq, &data, K_NO_WAIT);
+		if (ret == 0) {
+			ret = k_msgq_get(&bench_msgq, &data, K_NO_WAIT);
+		}
+	}
+
+	loop_result = ret;
+}
+
+/* All three objects in turn, as a thread juggling a few objects would */
+static void mixed_loop(void *p1, void *p2, void *p3)
+{
+	uint32_t data = 0U;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		k_sem_give(&bench_sem);
+		ret = k_sem_take(&bench_sem, K_NO_WAIT);
+		if (ret == 0) {
+			ret = k_mutex_lock(&bench_mutex, K_NO_WAIT);
+		}
+		if (ret == 0) {
+			ret = k_mutex_unlock(&bench_mutex);
+		}
+		if (ret == 0) {
+			ret = k_msgq_put(&bench_msgq, &data, K_NO_WAIT);
+		}
+		if (ret == 0) {
+			ret = k_msgq_get(&bench_msgq, &data, K_NO_WAIT);
+		}
+	}
+
+	loop_result = ret;
+}
+
+/* The cycle counter is not accessible from user mode, so time the whole
+ * user thread from the supervisor side instead.
+ */
+static uint32_t run_user_loop(k_thread_entry_t loop, int calls)
+{
+	uint32_t start, cycles;
+
+	loop_result = -EINPROGRESS;
+
+	k_thread_create(&user_thread, user_stack, STACK_SIZE, loop,
+			NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()),
+			K_USER, K_FOREVER);
+	k_thread_access_grant(&user_thread, &bench_sem, &bench_mutex,
+			      &bench_msgq);
+
+	start = k_cycle_get_32();
+
+	k_thread_start(&user_thread);
+	k_thread_join(&user_thread, K_FOREVER);
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(loop_result, 0, "System call failed (%d)", loop_result);
+
+	return cycles / (ITERATIONS * calls);
+}
+
+static void test_obj_validation_perf(void)
+{
+	TC_PRINT("validation cache: %s\n",
+		 IS_ENABLED(CONFIG_OBJ_VALIDATION_CACHE) ? "on" : "off");
+	TC_PRINT("k_sem give/take:     %u cycles/syscall\n",
+		 run_user_loop(sem_loop, 2));
+	TC_PRINT("k_mutex lock/unlock: %u cycles/syscall\n",
+		 run_user_loop(mutex_loop, 2));
+	TC_PRINT("k_msgq put/get:      %u cycles/syscall\n",
+		 run_user_loop(msgq_loop, 2));
+	TC_PRINT("mixed:               %u cycles/syscall\n",
+		 run_user_loop(mixed_loop, 6));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(obj_validation_bench,
+			 ztest_unit_test(test_obj_validation_perf));
+
+	ztest_run_test_suite(obj_validation_bench);
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Stream data through the ring buffers with producers and consumers running
+ * on different CPUs, check that nothing gets lost or reordered and measure
+ * the throughput of the lock-free variants against a spinlock protected
+ * ring_buf.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <sys/ring_buffer.h>
+
+#define SPSC_SIZE 256
+#define SPSC_CHUNK 16
+#define SPSC_BYTES (256 * 1024)
+
+#define MPMC_COUNT 64
+#define MPMC_BATCH 4
+#define MPMC_ELEMS 20000
+
+#define NUM_THREADS (2 * CONFIG_MP_NUM_CPUS)
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define THREAD_PRIO K_PRIO_COOP(10)
+
+RING_BUF_DECLARE(locked_buf, SPSC_SIZE);
+RING_BUF_SPSC_DECLARE(spsc_buf, SPSC_SIZE);
+RING_BUF_MPMC_DECLARE(mpmc_buf, sizeof(uint32_t), MPMC_COUNT);
+
+static struct k_spinlock locked_buf_lock;
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, NUM_THREADS, STACK_SIZE);
+static struct k_thread threads[NUM_THREADS];
+static int thread_result[NUM_THREADS];
+
+static atomic_t mpmc_consumed;
+
+static uint32_t locked_put(uint8_t cnt)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_buf_lock);
+	uint8_t *data;
+	uint32_t len, i;
+
+	len = ring_buf_put_claim(&locked_buf, &data, SPSC_CHUNK);
+	for (i = 0; i < len; i++) {
+		data[i] = cnt++;
+	}
+
+	ring_buf_put_finish(&locked_buf, len);
+	k_spin_unlock(&locked_buf_lock, key);
+
+	return len;
+}
+
+static uint32_t locked_get(uint8_t cnt, int *result)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_buf_lock);
+	uint8_t *data;
+	uint32_t len, i;
+
+	len = ring_buf_get_claim(&locked_buf, &data, SPSC_CHUNK);
+	for (i = 0; i < len; i++) {
+		if (data[i] != cnt++) {
+			*result = -EIO;
+		}
+	}
+
+	ring_buf_get_finish(&locked_buf, len);
+	k_spin_unlock(&locked_buf_lock, key);
+
+	return len;
+}
+
+static uint32_t spsc_put(uint8_t cnt)
+{
+	uint8_t *data;
+	uint32_t len, i;
+
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, SPSC_CHUNK);
+	for (i = 0; i < len; i++) {
+		data[i] = cnt++;
+	}
+
+	ring_buf_spsc_put_finish(&spsc_buf, len);
+
+	return len;
+}
+
+static uint32_t spsc_get(uint8_t cnt, int *result)
+{
+	uint8_t *data;
+	uint32_t len, i;
+
+	len = ring_buf_spsc_get_claim(&spsc_buf, &data, SPSC_CHUNK);
+	for (i = 0; i < len; i++) {
+		if (data[i] != cnt++) {
+			*result = -EIO;
+		}
+	}
+
+	ring_buf_spsc_get_finish(&spsc_buf, len);
+
+	return len;
+}
+
+static void byte_producer(void *p1, void *p2, void *p3)
+{
+	uint32_t (*put)(uint8_t cnt) = p1;
+	uint32_t total = 0;
+	uint32_t len;
+
+	while (total < SPSC_BYTES) {
+		len = put((uint8_t)total);
+		if (len == 0) {
+			k_yield();
+		}
+
+		total += len;
+	}
+}
+
+static void byte_consumer(void *p1, void *p2, void *p3)
+{
+	uint32_t (*get)(uint8_t cnt, int *result) = p1;
+	int id = POINTER_TO_INT(p2);
+	uint32_t total = 0;
+	uint32_t len;
+
+	while (total < SPSC_BYTES) {
+		len = get((uint8_t)total, &thread_result[id]);
+		if (len == 0) {
+			k_yield();
+		}
+
+		total += len;
+	}
+}
+
+/* Start all threads at once and wait for them, returns elapsed cycles */
+static uint32_t run_threads(int num)
+{
+	uint32_t start;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < num; i++) {
+		k_thread_start(&threads[i]);
+	}
+
+	for (i = 0; i < num; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+static uint32_t run_byte_stream(void *put, void *get)
+{
+	uint32_t cycles;
+
+	thread_result[1] = 0;
+
+	k_thread_create(&threads[0], stacks[0], STACK_SIZE, byte_producer,
+			put, NULL, NULL, THREAD_PRIO, 0, K_FOREVER);
+	k_thread_create(&threads[1], stacks[1], STACK_SIZE, byte_consumer,
+			get, INT_TO_POINTER(1), NULL, THREAD_PRIO, 0, K_FOREVER);
+
+	cycles = run_threads(2);
+
+	zassert_equal(thread_result[1], 0, "Data corrupted");
+
+	return cycles;
+}
+
+static void test_spsc_throughput(void)
+{
+	uint32_t locked_cycles, spsc_cycles;
+
+	locked_cycles = run_byte_stream(locked_put, locked_get);
+	spsc_cycles = run_byte_stream(spsc_put, spsc_get);
+
+	zassert_equal(ring_buf_spsc_size_get(&spsc_buf), 0, "Data left");
+
+	TC_PRINT("spinlock ring_buf: %u cycles/kB\n",
+		 locked_cycles / (SPSC_BYTES / 1024));
+	TC_PRINT("lock-free SPSC:    %u cycles/kB\n",
+		 spsc_cycles / (SPSC_BYTES / 1024));
+}
+
+/* Elements are tagged with the producer ID and a running count */
+static void mpmc_producer(void *p1, void *p2, void *p3)
+{
+	uint32_t id = POINTER_TO_UINT(p1);
+	uint32_t cnt = 0;
+	uint32_t num, i;
+	void *data;
+
+	while (cnt < MPMC_ELEMS) {
+		num = ring_buf_mpmc_put_claim(&mpmc_buf, &data,
+					      MIN(MPMC_BATCH, MPMC_ELEMS - cnt));
+		if (num == 0) {
+			k_yield();
+			continue;
+		}
+
+		for (i = 0; i < num; i++) {
+			((uint32_t *)data)[i] = (id << 24) | ++cnt;
+		}
+
+		ring_buf_mpmc_put_finish(&mpmc_buf, data, num);
+	}
+}
+
+static void mpmc_consumer(void *p1, void *p2, void *p3)
+{
+	uint32_t id = POINTER_TO_UINT(p1);
+	uint32_t last[CONFIG_MP_NUM_CPUS] = { 0 };
+	uint32_t total = CONFIG_MP_NUM_CPUS * MPMC_ELEMS;
+	uint32_t num, i, val, prod;
+	void *data;
+
+	while (atomic_get(&mpmc_consumed) < total) {
+		num = ring_buf_mpmc_get_claim(&mpmc_buf, &data, MPMC_BATCH);
+		if (num == 0) {
+			k_yield();
+			continue;
+		}
+
+		for (i = 0; i < num; i++) {
+			val = ((uint32_t *)data)[i];
+			prod = val >> 24;
+
+			/* Each producer's elements are consumed in order */
+			if (prod >= CONFIG_MP_NUM_CPUS ||
+			    (val & 0xffffff) <= last[prod]) {
+				thread_result[id] = -EIO;
+			} else {
+				last[prod] = val & 0xffffff;
+			}
+		}
+
+		ring_buf_mpmc_get_finish(&mpmc_buf, data, num);
+		atomic_add(&mpmc_consumed, num);
+	}
+}
+
+static void test_mpmc_throughput(void)
+{
+	uint32_t cycles, total;
+	int i;
+
+	atomic_set(&mpmc_consumed, 0);
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		int cons = CONFIG_MP_NUM_CPUS + i;
+
+		thread_result[cons] = 0;
+
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				mpmc_producer, UINT_TO_POINTER(i), NULL, NULL,
+				THREAD_PRIO, 0, K_FOREVER);
+		k_thread_create(&threads[cons], stacks[cons], STACK_SIZE,
+				mpmc_consumer, UINT_TO_POINTER(cons), NULL,
+				NULL, THREAD_PRIO, 0, K_FOREVER);
+	}
+
+	cycles = run_threads(NUM_THREADS);
+
+	for (i = CONFIG_MP_NUM_CPUS; i < NUM_THREADS; i++) {
+		zassert_equal(thread_result[i], 0, "Consumer %d got bad data",
+			      i);
+	}
+
+	total = CONFIG_MP_NUM_CPUS * MPMC_ELEMS;
+
+	zassert_equal(atomic_get(&mpmc_consumed), total, "Elements lost");
+
+	TC_PRINT("%d producers, %d consumers: %u cycles/element\n",
+		 CONFIG_MP_NUM_CPUS, CONFIG_MP_NUM_CPUS, cycles / total);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(ring_buffer_smp,
+			 ztest_unit_test(test_spsc_throughput),
+			 ztest_unit_test(test_mpmc_throughput));
+
+	ztest_run_test_suite(ring_buffer_smp);
+}
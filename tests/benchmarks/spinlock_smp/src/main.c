@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Contend on a single spinlock with one thread per CPU and report, for
+ * each CPU, the distribution of the time it took to acquire the lock.
+ * Build with and without CONFIG_TICKET_SPINLOCKS to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <spinlock.h>
+
+#define ITERATIONS 20000
+#define HOLD_LOOPS 32
+
+/* Bin i counts acquisitions which took less than 2^(BIN_SHIFT + i) cycles,
+ * the last bin everything slower.
+ */
+#define NUM_BINS 10
+#define BIN_SHIFT 4
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define WORKER_PRIO K_PRIO_COOP(10)
+
+struct lock_stats {
+	int cpu;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t bins[NUM_BINS];
+	int result;
+};
+
+static struct k_spinlock bench_lock;
+static volatile int lock_owner = -1;
+static volatile uint32_t lock_count;
+
+static atomic_t workers_ready;
+
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, CONFIG_MP_NUM_CPUS,
+				   STACK_SIZE);
+static struct k_thread worker_threads[CONFIG_MP_NUM_CPUS];
+static struct lock_stats worker_stats[CONFIG_MP_NUM_CPUS];
+
+static void record(struct lock_stats *stats, uint32_t cycles)
+{
+	int bin = 0;
+
+	while (bin < NUM_BINS - 1 && cycles >= BIT(BIN_SHIFT + bin)) {
+		bin++;
+	}
+
+	stats->bins[bin]++;
+	stats->total += cycles;
+	stats->min = MIN(stats->min, cycles);
+	stats->max = MAX(stats->max, cycles);
+}
+
+static void worker(void *p1, void *p2, void *p3)
+{
+	int id = POINTER_TO_INT(p1);
+	struct lock_stats *stats = &worker_stats[id];
+	k_spinlock_key_t key;
+	uint32_t start, cycles;
+	int i, j;
+
+	/* Cooperative threads do not migrate, so this stays valid */
+	stats->cpu = arch_curr_cpu()->id;
+
+	/* Start contending only once every CPU has a worker */
+	atomic_inc(&workers_ready);
+	while (atomic_get(&workers_ready) < CONFIG_MP_NUM_CPUS) {
+	}
+
+	for (i = 0; i < ITERATIONS; i++) {
+		start = k_cycle_get_32();
+		key = k_spin_lock(&bench_lock);
+		cycles = k_cycle_get_32() - start;
+
+		if (lock_owner != -1) {
+			stats->result = -EBUSY;
+		}
+
+		lock_owner = id;
+		lock_count++;
+
+		for (j = 0; j < HOLD_LOOPS; j++) {
+			if (lock_owner != id) {
+				stats->result = -EBUSY;
+			}
+		}
+
+		lock_owner = -1;
+		k_spin_unlock(&bench_lock, key);
+
+		record(stats, cycles);
+	}
+}
+
+static void print_stats(struct lock_stats *stats)
+{
+	int i;
+
+	TC_PRINT("CPU %d: min %u avg %u max %u cycles\n", stats->cpu,
+		 stats->min, (uint32_t)(stats->total / ITERATIONS),
+		 stats->max);
+
+	for (i = 0; i < NUM_BINS; i++) {
+		if (i < NUM_BINS - 1) {
+			TC_PRINT("  < %6lu: %u\n", BIT(BIN_SHIFT + i),
+				 stats->bins[i]);
+		} else {
+			TC_PRINT("  >=%6lu: %u\n", BIT(BIN_SHIFT + i - 1),
+				 stats->bins[i]);
+		}
+	}
+}
+
+static void test_spinlock_smp_contention(void)
+{
+	int i;
+
+	TC_PRINT("ticket spinlocks: %s\n",
+		 IS_ENABLED(CONFIG_TICKET_SPINLOCKS) ? "on" : "off");
+
+	atomic_clear(&workers_ready);
+	lock_count = 0U;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		(void)memset(&worker_stats[i], 0, sizeof(worker_stats[i]));
+		worker_stats[i].min = UINT32_MAX;
+		k_thread_create(&worker_threads[i], worker_stacks[i],
+				STACK_SIZE, worker, INT_TO_POINTER(i),
+				NULL, NULL, WORKER_PRIO, 0, K_NO_WAIT);
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_join(&worker_threads[i], K_FOREVER);
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		print_stats(&worker_stats[i]);
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		zassert_equal(worker_stats[i].result, 0,
+			      "Mutual exclusion violated on worker %d", i);
+	}
+
+	zassert_equal(lock_count, CONFIG_MP_NUM_CPUS * ITERATIONS,
+		      "Lost lock acquisitions");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(spinlock_smp,
+			 ztest_unit_test(test_spinlock_smp_contention));
+
+	ztest_run_test_suite(spinlock_smp);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure how many cycles an uncontended sys_mutex lock/unlock pair takes
+ * in user mode, with the atomic fast path and with a syscall every time.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <sys/mutex.h>
+
+#define ITERATIONS 10000
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+ZTEST_BMEM SYS_MUTEX_DEFINE(bench_mutex);
+static ZTEST_BMEM int loop_result;
+
+static K_THREAD_STACK_DEFINE(user_stack, STACK_SIZE);
+static struct k_thread user_thread;
+
+static void fast_path_loop(void *p1, void *p2, void *p3)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		ret = sys_mutex_lock(&bench_mutex, K_FOREVER);
+		if (ret == 0) {
+			ret = sys_mutex_unlock(&bench_mutex);
+		}
+	}
+
+	loop_result = ret;
+}
+
+/* What sys_mutex_lock() and sys_mutex_unlock() cost without the fast path */
+static void syscall_loop(void *p1, void *p2, void *p3)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ITERATIONS && ret == 0; i++) {
+		ret = z_sys_mutex_kernel_lock(&bench_mutex, K_FOREVER);
+		if (ret == 0) {
+			ret = z_sys_mutex_kernel_unlock(&bench_mutex);
+		}
+	}
+
+	loop_result = ret;
+}
+
+/* The cycle counter is not accessible from user mode, so time the whole
+ * user thread from the supervisor side instead.
+ */
+static uint32_t run_user_loop(k_thread_entry_t loop)
+{
+	uint32_t start, cycles;
+
+	loop_result = -EINPROGRESS;
+
+	k_thread_create(&user_thread, user_stack, STACK_SIZE, loop,
+			NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()),
+			K_USER | K_INHERIT_PERMS, K_FOREVER);
+
+	start = k_cycle_get_32();
+
+	k_thread_start(&user_thread);
+	k_thread_join(&user_thread, K_FOREVER);
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(loop_result, 0, "Lock/unlock failed (%d)", loop_result);
+
+	return cycles / ITERATIONS;
+}
+
+static void test_sys_mutex_perf(void)
+{
+	uint32_t syscall_cycles, fast_cycles;
+
+	syscall_cycles = run_user_loop(syscall_loop);
+	fast_cycles = run_user_loop(fast_path_loop);
+
+	TC_PRINT("syscall:   %u cycles/lock+unlock\n", syscall_cycles);
+	TC_PRINT("fast path: %u cycles/lock+unlock\n", fast_cycles);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(sys_mutex_bench,
+			 ztest_unit_test(test_sys_mutex_perf));
+
+	ztest_run_test_suite(sys_mutex_bench);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Run a set of periodic timers with slightly different periods, as a
+ * system polling a few sensors and sending keepalives would, and count the
+ * timer wakeups they cause. Build with and without CONFIG_TIMEOUT_SLACK
+ * to compare.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#define NUM_TIMERS 8
+#define BASE_PERIOD_MS 100
+#define PERIOD_STEP_MS 7
+#define SLACK_MS 25
+#define RUN_MS 5000
+
+static struct k_timer timers[NUM_TIMERS];
+
+static uint32_t expiries;
+static uint32_t wakeups;
+static int64_t last_expiry = -1;
+
+/* Timers expiring on the same tick were served by the same wakeup */
+static void timer_expire(struct k_timer *timer)
+{
+	int64_t now = k_uptime_ticks();
+
+	expiries++;
+	if (now != last_expiry) {
+		wakeups++;
+		last_expiry = now;
+	}
+}
+
+static void test_timer_slack_wakeups(void)
+{
+	k_timeout_t period;
+	int i;
+
+#ifdef CONFIG_TIMEOUT_SLACK
+	struct sys_clock_slack_stats before, after;
+
+	sys_clock_slack_stats_get(&before);
+#endif
+
+	for (i = 0; i < NUM_TIMERS; i++) {
+		period = K_MSEC(BASE_PERIOD_MS + i * PERIOD_STEP_MS);
+		k_timer_init(&timers[i], timer_expire, NULL);
+		k_timer_start_slack(&timers[i], period, period,
+				    K_MSEC(SLACK_MS));
+	}
+
+	k_msleep(RUN_MS);
+
+	for (i = 0; i < NUM_TIMERS; i++) {
+		k_timer_stop(&timers[i]);
+	}
+
+	TC_PRINT("timeout slack: %s\n",
+		 IS_ENABLED(CONFIG_TIMEOUT_SLACK) ? "on" : "off");
+	TC_PRINT("%u expiries, %u wakeups/s\n", expiries,
+		 wakeups * MSEC_PER_SEC / RUN_MS);
+
+#ifdef CONFIG_TIMEOUT_SLACK
+	sys_clock_slack_stats_get(&after);
+
+	TC_PRINT("kernel: %u wakeups/s, %u wakeups avoided/s\n",
+		 (uint32_t)((after.wakeups - before.wakeups) *
+			    MSEC_PER_SEC / RUN_MS),
+		 (uint32_t)((after.wakeups_avoided - before.wakeups_avoided) *
+			    MSEC_PER_SEC / RUN_MS));
+
+	zassert_true(after.wakeups_avoided > before.wakeups_avoided,
+		     "No wakeups avoided");
+#endif
+
+	zassert_true(wakeups <= expiries, "Bad wakeup count");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(timer_slack,
+			 ztest_unit_test(test_timer_slack_wakeups));
+
+	ztest_run_test_suite(timer_slack);
+}
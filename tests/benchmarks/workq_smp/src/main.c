@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure the work item throughput of a work queue with 1, 2 and 4 worker
+ * threads, submitting the items in batches, and check that no item ever
+ * ran concurrently with itself.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#define NUM_ITEMS 16
+#define ROUNDS 200
+#define ITEM_LOOPS 2000
+
+/* Runs with 1, 2 and 4 workers, i.e. 0 + 1 + 3 threads besides the
+ * work queue threads themselves.
+ */
+#define NUM_RUNS 3
+#define NUM_EXTRA_WORKERS 4
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define WORKER_PRIO K_PRIO_PREEMPT(1)
+
+struct bench_item {
+	struct k_work work;
+	atomic_t active;
+	uint32_t runs;
+	uint32_t sum;
+	bool overlap;
+};
+
+static K_THREAD_STACK_ARRAY_DEFINE(queue_stacks, NUM_RUNS, STACK_SIZE);
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, NUM_EXTRA_WORKERS,
+				   STACK_SIZE);
+
+/* Workers cannot be removed from a queue, so each run uses its own
+ * queue.  The threads of the previous runs stay idle.
+ */
+static struct k_work_q queues[NUM_RUNS];
+static struct k_work_q_worker workers[NUM_EXTRA_WORKERS];
+static int workers_used;
+
+static struct bench_item items[NUM_ITEMS];
+
+static void item_handler(struct k_work *work)
+{
+	struct bench_item *item = CONTAINER_OF(work, struct bench_item, work);
+	uint32_t sum = item->sum;
+	int i;
+
+	if (atomic_inc(&item->active) != 0) {
+		item->overlap = true;
+	}
+
+	for (i = 0; i < ITEM_LOOPS; i++) {
+		sum = sum * 33U + (uint32_t)i;
+	}
+
+	item->sum = sum;
+	item->runs++;
+
+	atomic_dec(&item->active);
+}
+
+static struct k_work_q *start_queue(int run, int num_workers)
+{
+	struct k_work_q *queue = &queues[run];
+	int i, cpu, rc;
+
+	k_work_queue_start(queue, queue_stacks[run], STACK_SIZE, WORKER_PRIO,
+			   NULL);
+
+	for (i = 1; i < num_workers; i++) {
+		zassert_true(workers_used < NUM_EXTRA_WORKERS,
+			     "Out of workers");
+
+		cpu = IS_ENABLED(CONFIG_SCHED_CPU_MASK)
+			? i % CONFIG_MP_NUM_CPUS : -1;
+		rc = k_work_queue_add_worker(queue, &workers[workers_used],
+					     worker_stacks[workers_used],
+					     STACK_SIZE, cpu);
+		zassert_equal(rc, 0, "Cannot add worker %d (%d)", i, rc);
+		workers_used++;
+	}
+
+	return queue;
+}
+
+static void run_bench(int run, int num_workers)
+{
+	struct k_work_q *queue = start_queue(run, num_workers);
+	struct k_work *works[NUM_ITEMS];
+	uint32_t start, cycles;
+	uint64_t runs = 0U;
+	int i, rc;
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		(void)memset(&items[i], 0, sizeof(items[i]));
+		k_work_init(&items[i].work, item_handler);
+		works[i] = &items[i].work;
+	}
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < ROUNDS; i++) {
+		rc = k_work_submit_to_queue_batch(queue, works, NUM_ITEMS);
+		zassert_equal(rc, NUM_ITEMS, "Batch submission failed (%d)",
+			      rc);
+		(void)k_work_queue_drain(queue, false);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		zassert_false(items[i].overlap, "Item %d ran concurrently", i);
+		runs += items[i].runs;
+	}
+
+	zassert_equal(runs, (uint64_t)NUM_ITEMS * ROUNDS, "Lost work items");
+
+	TC_PRINT("%d worker(s): %u cycles per item, %u items/Mcycle\n",
+		 num_workers, (uint32_t)(cycles / runs),
+		 cycles ? (uint32_t)(runs * 1000000U / cycles) : 0U);
+}
+
+static void test_workq_smp_throughput(void)
+{
+	run_bench(0, 1);
+	run_bench(1, 2);
+	run_bench(2, 4);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(workq_smp,
+			 ztest_unit_test(test_workq_smp_throughput));
+
+	ztest_run_test_suite(workq_smp);
+}
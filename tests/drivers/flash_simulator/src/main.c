@@ -7,6 +7,7 @@
 #include <ztest.h>
 #include <drivers/flash.h>
 #include <device.h>
+#include <string.h>
 
 /* configuration derived from DT */
 #ifdef CONFIG_ARCH_POSIX
@@ -299,6 +300,94 @@ static void test_get_mock(void)
 #endif
 }
 
+#define SIM_FLASH_NODE DT_INST(0, zephyr_sim_flash)
+
+static void test_wear(void)
+{
+#ifndef CONFIG_FLASH_SIMULATOR_WEAR_STATS
+	ztest_test_skip();
+#else
+	struct flash_simulator_wear wear;
+	uint32_t counts[4];
+	uint8_t buf[512];
+	int rc;
+
+	flash_simulator_wear_reset(flash_dev);
+
+	/* Erase the second unit twice and the next two once */
+	for (int i = 0; i < 2; i++) {
+		rc = flash_erase(flash_dev, FLASH_SIMULATOR_BASE_OFFSET +
+				 FLASH_SIMULATOR_ERASE_UNIT,
+				 FLASH_SIMULATOR_ERASE_UNIT);
+		zassert_equal(0, rc, "flash_erase should succeed");
+	}
+	rc = flash_erase(flash_dev, FLASH_SIMULATOR_BASE_OFFSET +
+			 FLASH_SIMULATOR_ERASE_UNIT * 2,
+			 FLASH_SIMULATOR_ERASE_UNIT * 2);
+	zassert_equal(0, rc, "flash_erase should succeed");
+
+	(void)memset(buf, 0x5a, sizeof(buf));
+	rc = flash_write(flash_dev, FLASH_SIMULATOR_BASE_OFFSET +
+			 FLASH_SIMULATOR_ERASE_UNIT + 128, buf, sizeof(buf));
+	zassert_equal(0, rc, "flash_write should succeed");
+	rc = flash_read(flash_dev, FLASH_SIMULATOR_BASE_OFFSET, buf, 100);
+	zassert_equal(0, rc, "flash_read should succeed");
+
+	rc = flash_simulator_wear_get(flash_dev, &wear, counts,
+				      ARRAY_SIZE(counts));
+	zassert_equal(rc, ARRAY_SIZE(counts), "Expected %d counts, got %d",
+		      ARRAY_SIZE(counts), rc);
+	zassert_equal(counts[0], 0, "Unit 0 should not be erased");
+	zassert_equal(counts[1], 2, "Unit 1 should be erased twice");
+	zassert_equal(counts[2], 1, "Unit 2 should be erased once");
+	zassert_equal(counts[3], 1, "Unit 3 should be erased once");
+
+	zassert_equal(wear.sector_count,
+		      FLASH_SIMULATOR_FLASH_SIZE / FLASH_SIMULATOR_ERASE_UNIT,
+		      "Unexpected number of units");
+	zassert_equal(wear.total_erases, 4, "Unexpected number of erases");
+	zassert_equal(wear.min_erases, 0, "Unexpected lowest erase count");
+	zassert_equal(wear.max_erases, 2, "Unexpected highest erase count");
+	zassert_equal(wear.histogram[0], wear.sector_count - 3,
+		      "Unexpected number of units never erased");
+	zassert_equal(wear.histogram[1], 2,
+		      "Unexpected number of units erased once");
+	zassert_equal(wear.histogram[2], 1,
+		      "Unexpected number of units erased twice");
+	zassert_equal(wear.erase_calls, 3, "Unexpected number of erase calls");
+	zassert_equal(wear.write_calls, 1, "Unexpected number of write calls");
+	zassert_equal(wear.read_calls, 1, "Unexpected number of read calls");
+
+#if defined(CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING) && \
+	DT_NODE_HAS_PROP(SIM_FLASH_NODE, page_program_time_us)
+	/* 512 bytes at offset 128 of the unit span three program pages */
+	BUILD_ASSERT(DT_PROP(SIM_FLASH_NODE, program_page_size) == 256);
+
+	zassert_equal(wear.erase_time_us,
+		      3 * CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US +
+		      4 * DT_PROP(SIM_FLASH_NODE, sector_erase_time_us),
+		      "Unexpected erase time");
+	zassert_equal(wear.write_time_us,
+		      CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US +
+		      3 * DT_PROP(SIM_FLASH_NODE, page_program_time_us),
+		      "Unexpected write time");
+	zassert_equal(wear.read_time_us,
+		      CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US +
+		      ceiling_fraction(100 * USEC_PER_SEC,
+				       DT_PROP(SIM_FLASH_NODE,
+					       read_bandwidth)),
+		      "Unexpected read time");
+#endif
+
+	flash_simulator_wear_reset(flash_dev);
+	rc = flash_simulator_wear_get(flash_dev, &wear, NULL, 0);
+	zassert_equal(rc, 0, "No counts should be copied");
+	zassert_equal(wear.total_erases, 0, "Erase counts should be cleared");
+	zassert_equal(wear.erase_time_us, 0, "Busy time should be cleared");
+	zassert_equal(wear.erase_calls, 0, "Call counts should be cleared");
+#endif /* CONFIG_FLASH_SIMULATOR_WEAR_STATS */
+}
+
 void test_main(void)
 {
 	ztest_test_suite(flash_sim_api,
@@ -310,7 +399,8 @@ void test_main(void)
 			 ztest_unit_test(test_align),
 			 ztest_unit_test(test_get_erase_value),
 			 ztest_unit_test(test_double_write),
-			 ztest_unit_test(test_get_mock));
+			 ztest_unit_test(test_get_mock),
+			 ztest_unit_test(test_wear));
 
 	ztest_run_test_suite(flash_sim_api);
 }
@@ -49,6 +49,21 @@ k_mem_paging_backing_store_histogram_bounds[
 	1000000,
 	ULONG_MAX
 };
+
+unsigned long
+k_mem_paging_page_fault_histogram_bounds[
+	CONFIG_DEMAND_PAGING_TIMING_HISTOGRAM_NUM_BINS] = {
+	50000,
+	100000,
+	200000,
+	300000,
+	400000,
+	500000,
+	750000,
+	1000000,
+	2000000,
+	ULONG_MAX
+};
 #else
 #error "Need to define paging histogram bounds"
 #endif
@@ -111,6 +126,19 @@ void print_paging_stats(struct k_mem_paging_stats_t *stats, const char *scope)
 	       stats->eviction.clean);
 	printk("    - Dirty pages evicted: %lu\n",
 	       stats->eviction.dirty);
+
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	printk("* Readahead (%s):\n", scope);
+	printk("    - Pages read ahead: %lu\n", stats->readahead.pages);
+	printk("    - Hits: %lu\n", stats->readahead.hits);
+	printk("    - Misses: %lu\n", stats->readahead.misses);
+#endif
+
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	printk("* Page cleaner (%s):\n", scope);
+	printk("    - Pages written back: %lu\n", stats->cleaner.pages);
+	printk("    - Batches: %lu\n", stats->cleaner.batches);
+#endif
 }
 
 void test_touch_anon_pages(void)
@@ -153,11 +181,25 @@ void test_touch_anon_pages(void)
 	print_paging_stats(&stats, "kernel");
 	zassert_not_equal(stats.eviction.dirty, 0UL,
 			  "there should be dirty pages being evicted.");
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	zassert_not_equal(stats.readahead.pages, 0UL,
+			  "sequential accesses should have been read ahead.");
+#endif
 
 #ifdef CONFIG_EVICTION_NRU
 	k_msleep(CONFIG_EVICTION_NRU_PERIOD * 2);
 #endif /* CONFIG_EVICTION_NRU */
 
+#ifdef CONFIG_DEMAND_PAGING_CLEANER
+	/* Let the page cleaner write back the untouched part of the arena */
+	k_msleep(CONFIG_DEMAND_PAGING_CLEANER_PERIOD * 2);
+
+	k_mem_paging_stats_get(&stats);
+	print_paging_stats(&stats, "kernel");
+	zassert_not_equal(stats.cleaner.pages, 0UL,
+			  "page cleaner should have written back pages.");
+#endif /* CONFIG_DEMAND_PAGING_CLEANER */
+
 	/* There should be some clean pages to be evicted now,
 	 * since the arena is not modified.
 	 */
@@ -210,9 +252,16 @@ void test_k_mem_page_out(void)
 	faults = z_num_pagefaults_get() - faults;
 	irq_unlock(key);
 
+#ifdef CONFIG_DEMAND_PAGING_READAHEAD
+	/* Sequential writes only fault until readahead kicks in */
+	zassert_true(faults > 0 && faults < HALF_PAGES,
+		     "unexpected num pagefaults expected < %lu got %d",
+		     HALF_PAGES, faults);
+#else
 	zassert_equal(faults, HALF_PAGES,
 		      "unexpected num pagefaults expected %lu got %d",
 		      HALF_PAGES, faults);
+#endif
 
 	ret = k_mem_page_out(arena, arena_size);
 	zassert_equal(ret, -ENOMEM, "k_mem_page_out should have failed");
@@ -401,6 +450,12 @@ void test_user_get_hist(void)
 	zassert_true(print_histogram(&hist),
 		     "should have non-zero counts in histogram.");
 	printk("\n");
+
+	printk("Page Fault Histogram:\n");
+	k_mem_paging_histogram_page_fault_get(&hist);
+	zassert_true(print_histogram(&hist),
+		     "should have non-zero counts in histogram.");
+	printk("\n");
 }
 
 /* ztest main entry*/
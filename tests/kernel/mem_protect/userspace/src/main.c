@@ -36,6 +36,7 @@ extern void arm_core_mpu_disable(void);
 #define STACKSIZE (256 + CONFIG_TEST_EXTRA_STACKSIZE)
 
 K_SEM_DEFINE(test_revoke_sem, 0, 1);
+K_SEM_DEFINE(test_revoke_cached_sem, 0, 1);
 
 /* Used for tests that switch between domains, we will switch between the
  * default domain and this one.
@@ -569,6 +570,31 @@ static void test_access_after_revoke(void)
 	zassert_unreachable("Using revoked object did not fault");
 }
 
+/**
+ * @brief Test to access object after revoking access, once it was used
+ *
+ * @details With CONFIG_OBJ_VALIDATION_CACHE, the first access caches the
+ * object as valid for the thread. Revoking access must drop it from the
+ * cache.
+ *
+ * @ingroup kernel_memprotect_tests
+ */
+static void test_access_after_revoke_cached(void)
+{
+	k_sem_give(&test_revoke_cached_sem);
+	zassert_equal(k_sem_take(&test_revoke_cached_sem, K_NO_WAIT), 0,
+		      "Cannot take semaphore");
+
+	k_object_release(&test_revoke_cached_sem);
+
+	/* Try to access an object after revoking access to it */
+	set_fault(K_ERR_KERNEL_OOPS);
+
+	k_sem_take(&test_revoke_cached_sem, K_NO_WAIT);
+
+	zassert_unreachable("Using revoked object did not fault");
+}
+
 static void umode_enter_func(void)
 {
 	zassert_true(k_is_user_context(),
@@ -1038,7 +1064,7 @@ void test_main(void)
 #endif
 	k_thread_access_grant(k_current_get(),
 			      &test_thread, &test_stack,
-			      &test_revoke_sem, &kpipe);
+			      &test_revoke_sem, &test_revoke_cached_sem, &kpipe);
 	ztest_test_suite(userspace,
 		ztest_user_unit_test(test_is_usermode),
 		ztest_user_unit_test(test_write_control),
@@ -1058,6 +1084,7 @@ void test_main(void)
 		ztest_1cpu_user_unit_test(test_write_other_stack),
 		ztest_user_unit_test(test_revoke_noperms_object),
 		ztest_user_unit_test(test_access_after_revoke),
+		ztest_user_unit_test(test_access_after_revoke_cached),
 		ztest_unit_test(test_user_mode_enter),
 		ztest_user_unit_test(test_write_kobject_user_pipe),
 		ztest_user_unit_test(test_read_kobject_user_pipe),
@@ -23,6 +23,10 @@ extern void test_msgq_alloc(void);
 extern void test_msgq_pend_thread(void);
 extern void test_msgq_empty(void);
 extern void test_msgq_full(void);
+extern void test_msgq_alloc_put(void);
+extern void test_msgq_commit_to_waiting(void);
+extern void test_msgq_peek_claim(void);
+extern void test_msgq_release_to_waiting(void);
 #ifdef CONFIG_USERSPACE
 extern void test_msgq_user_thread(void);
 extern void test_msgq_user_thread_overflow(void);
@@ -84,6 +88,10 @@ void test_main(void)
 			 ztest_1cpu_unit_test(test_msgq_pend_thread),
 			 ztest_1cpu_unit_test(test_msgq_empty),
 			 ztest_1cpu_unit_test(test_msgq_full),
+			 ztest_unit_test(test_msgq_alloc_put),
+			 ztest_1cpu_unit_test(test_msgq_commit_to_waiting),
+			 ztest_unit_test(test_msgq_peek_claim),
+			 ztest_1cpu_unit_test(test_msgq_release_to_waiting),
 			 ztest_unit_test(test_msgq_alloc));
 	ztest_run_test_suite(msgq_api);
 }
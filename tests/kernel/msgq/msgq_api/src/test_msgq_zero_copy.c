@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+#define ZC_MSGQ_LEN 4
+
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_thread tdata;
+extern struct k_msgq msgq;
+static char __aligned(4) zc_buffer[MSG_SIZE * ZC_MSGQ_LEN];
+static uint32_t zc_data[ZC_MSGQ_LEN] = { MSG0, MSG1, MSG0 + 1, MSG1 + 1 };
+
+static void receiver_entry(void *p1, void *p2, void *p3)
+{
+	uint32_t rx_data;
+	int ret;
+
+	ret = k_msgq_get((struct k_msgq *)p1, &rx_data, TIMEOUT);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(rx_data, MSG0, NULL);
+}
+
+static void sender_entry(void *p1, void *p2, void *p3)
+{
+	int ret = k_msgq_put((struct k_msgq *)p1, &zc_data[1], TIMEOUT);
+
+	zassert_equal(ret, 0, NULL);
+}
+
+/**
+ * @addtogroup kernel_message_queue_tests
+ * @{
+ */
+
+/**
+ * @brief Test sending messages written in place
+ * @see k_msgq_alloc_put_batch(), k_msgq_commit()
+ */
+void test_msgq_alloc_put(void)
+{
+	void *slots[ZC_MSGQ_LEN + 1];
+	uint32_t rx_data;
+	int ret, i;
+
+	k_msgq_init(&msgq, zc_buffer, MSG_SIZE, ZC_MSGQ_LEN);
+
+	ret = k_msgq_alloc_put(&msgq, &slots[0]);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(k_msgq_num_free_get(&msgq), ZC_MSGQ_LEN - 1, NULL);
+
+	/**TESTPOINT: only one reservation at a time, no other senders */
+	zassert_equal(k_msgq_alloc_put(&msgq, &slots[1]), -EBUSY, NULL);
+	zassert_equal(k_msgq_put(&msgq, &zc_data[1], K_FOREVER), -EBUSY,
+		      NULL);
+
+	/**TESTPOINT: reserved messages are not visible before commit */
+	*(uint32_t *)slots[0] = zc_data[0];
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), -ENOMSG, NULL);
+
+	zassert_equal(k_msgq_commit(&msgq), 0, NULL);
+	zassert_equal(k_msgq_commit(&msgq), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 1, NULL);
+
+	/**TESTPOINT: batch reservation is limited by the free space */
+	ret = k_msgq_alloc_put_batch(&msgq, slots, ARRAY_SIZE(slots));
+	zassert_equal(ret, ZC_MSGQ_LEN - 1, NULL);
+
+	for (i = 0; i < ret; i++) {
+		*(uint32_t *)slots[i] = zc_data[i + 1];
+	}
+
+	zassert_equal(k_msgq_commit(&msgq), 0, NULL);
+	zassert_equal(k_msgq_alloc_put(&msgq, &slots[0]), -ENOMSG, NULL);
+
+	for (i = 0; i < ZC_MSGQ_LEN; i++) {
+		zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+		zassert_equal(rx_data, zc_data[i], NULL);
+	}
+}
+
+/**
+ * @brief Test commit waking up a waiting receiver
+ * @see k_msgq_alloc_put(), k_msgq_commit()
+ */
+void test_msgq_commit_to_waiting(void)
+{
+	void *slot;
+
+	k_msgq_init(&msgq, zc_buffer, MSG_SIZE, ZC_MSGQ_LEN);
+
+	k_thread_create(&tdata, tstack, STACK_SIZE, receiver_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_msleep(TIMEOUT_MS >> 1);
+
+	zassert_equal(k_msgq_alloc_put(&msgq, &slot), 0, NULL);
+	*(uint32_t *)slot = MSG0;
+	zassert_equal(k_msgq_commit(&msgq), 0, NULL);
+
+	k_thread_join(&tdata, K_FOREVER);
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+}
+
+/**
+ * @brief Test receiving messages in place
+ * @see k_msgq_peek_claim_batch(), k_msgq_release()
+ */
+void test_msgq_peek_claim(void)
+{
+	void *slots[ZC_MSGQ_LEN + 1];
+	uint32_t rx_data;
+	int ret, i;
+
+	k_msgq_init(&msgq, zc_buffer, MSG_SIZE, ZC_MSGQ_LEN);
+
+	zassert_equal(k_msgq_peek_claim(&msgq, &slots[0]), -ENOMSG, NULL);
+
+	for (i = 0; i < ZC_MSGQ_LEN; i++) {
+		ret = k_msgq_put(&msgq, &zc_data[i], K_NO_WAIT);
+		zassert_equal(ret, 0, NULL);
+	}
+
+	ret = k_msgq_peek_claim(&msgq, &slots[0]);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(*(uint32_t *)slots[0], zc_data[0], NULL);
+
+	/**TESTPOINT: only one claim at a time, no other receivers */
+	zassert_equal(k_msgq_peek_claim(&msgq, &slots[1]), -EBUSY, NULL);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_FOREVER), -EBUSY, NULL);
+
+	/**TESTPOINT: claimed slots are not reused before release */
+	zassert_equal(k_msgq_num_used_get(&msgq), ZC_MSGQ_LEN, NULL);
+	zassert_equal(k_msgq_put(&msgq, &zc_data[0], K_NO_WAIT), -ENOMSG,
+		      NULL);
+
+	zassert_equal(k_msgq_release(&msgq), 0, NULL);
+	zassert_equal(k_msgq_release(&msgq), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), ZC_MSGQ_LEN - 1, NULL);
+
+	/**TESTPOINT: batch claim is limited by the queued messages */
+	ret = k_msgq_peek_claim_batch(&msgq, slots, ARRAY_SIZE(slots));
+	zassert_equal(ret, ZC_MSGQ_LEN - 1, NULL);
+
+	for (i = 0; i < ret; i++) {
+		zassert_equal(*(uint32_t *)slots[i], zc_data[i + 1], NULL);
+	}
+
+	zassert_equal(k_msgq_release(&msgq), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+}
+
+/**
+ * @brief Test release adding the message of a waiting sender
+ * @see k_msgq_peek_claim(), k_msgq_release()
+ */
+void test_msgq_release_to_waiting(void)
+{
+	uint32_t rx_data;
+	void *slot;
+	int i;
+
+	k_msgq_init(&msgq, zc_buffer, MSG_SIZE, ZC_MSGQ_LEN);
+
+	for (i = 0; i < ZC_MSGQ_LEN; i++) {
+		zassert_equal(k_msgq_put(&msgq, &zc_data[0], K_NO_WAIT), 0,
+			      NULL);
+	}
+
+	k_thread_create(&tdata, tstack, STACK_SIZE, sender_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_msleep(TIMEOUT_MS >> 1);
+
+	zassert_equal(k_msgq_peek_claim(&msgq, &slot), 0, NULL);
+	zassert_equal(k_msgq_release(&msgq), 0, NULL);
+
+	k_thread_join(&tdata, K_FOREVER);
+	zassert_equal(k_msgq_num_used_get(&msgq), ZC_MSGQ_LEN, NULL);
+
+	for (i = 0; i < ZC_MSGQ_LEN; i++) {
+		zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	}
+
+	zassert_equal(rx_data, zc_data[1], NULL);
+}
+
+/**
+ * @}
+ */
@@ -49,6 +49,9 @@
 #include <zephyr.h>
 #include <ztest.h>
 #include <sys/mutex.h>
+#ifdef CONFIG_USERSPACE
+#include <syscall_handler.h>
+#endif
 
 #define STACKSIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
 
@@ -62,11 +65,17 @@ ZTEST_BMEM SYS_MUTEX_DEFINE(mutex_2);
 ZTEST_BMEM SYS_MUTEX_DEFINE(mutex_3);
 ZTEST_BMEM SYS_MUTEX_DEFINE(mutex_4);
 
-#ifdef CONFIG_USERSPACE
+#if defined(CONFIG_USERSPACE) && !defined(CONFIG_SYS_MUTEX_FAST_PATH)
 static SYS_MUTEX_DEFINE(no_access_mutex);
 #endif
 static ZTEST_BMEM SYS_MUTEX_DEFINE(not_my_mutex);
 static ZTEST_BMEM SYS_MUTEX_DEFINE(bad_count_mutex);
+#ifdef CONFIG_USERSPACE
+static ZTEST_BMEM SYS_MUTEX_DEFINE(handover_mutex);
+#endif
+#ifdef CONFIG_SYS_MUTEX_FAST_PATH
+static ZTEST_BMEM SYS_MUTEX_DEFINE(forged_mutex);
+#endif
 extern void test_mutex_multithread_competition(void);
 
 /**
@@ -359,8 +368,10 @@ void test_supervisor_access(void)
 {
 	int rv;
 
-#ifdef CONFIG_USERSPACE
-	/* coverage for get_k_mutex checks */
+#if defined(CONFIG_USERSPACE) && !defined(CONFIG_SYS_MUTEX_FAST_PATH)
+	/* coverage for get_k_mutex checks, the fast path would dereference
+	 * the bad pointers without entering the kernel
+	 */
 	rv = sys_mutex_lock((struct sys_mutex *)NULL, K_NO_WAIT);
 	zassert_true(rv == -EINVAL, "accepted bad mutex pointer");
 	rv = sys_mutex_lock((struct sys_mutex *)k_current_get(), K_NO_WAIT);
@@ -369,7 +380,7 @@ void test_supervisor_access(void)
 	zassert_true(rv == -EINVAL, "accepted bad mutex pointer");
 	rv = sys_mutex_unlock((struct sys_mutex *)k_current_get());
 	zassert_true(rv == -EINVAL, "accepted object that was not a mutex");
-#endif /* CONFIG_USERSPACE */
+#endif
 
 	rv = sys_mutex_unlock(&not_my_mutex);
 	zassert_true(rv == -EPERM, "unlocked a mutex that wasn't owner");
@@ -377,18 +388,76 @@ void test_supervisor_access(void)
 	zassert_true(rv == -EINVAL, "mutex wasn't locked");
 }
 
-void test_user_access(void)
+void test_handover_failure(void)
 {
 #ifdef CONFIG_USERSPACE
+	struct k_mutex *kernel_mutex;
+	int rv;
+
+	kernel_mutex = z_object_find(&handover_mutex)->data.mutex;
+
+	/* Taken with atomic ops, val holds our thread ID */
+	rv = sys_mutex_lock(&handover_mutex, K_NO_WAIT);
+	zassert_equal(rv, 0, "failed to lock mutex");
+
+	/* With the kernel mutex already busy, the kernel cannot hand the
+	 * mutex over to the atomic owner and the recursive lock fails
+	 */
+	rv = k_mutex_lock(kernel_mutex, K_NO_WAIT);
+	zassert_equal(rv, 0, "failed to lock kernel mutex");
+	rv = sys_mutex_lock(&handover_mutex, K_MSEC(10));
+	zassert_equal(rv, -EINVAL, "handover to a busy kernel mutex");
+	zassert_equal(atomic_get(&handover_mutex.val),
+		      (atomic_val_t)k_current_get(), "owner not restored");
+	rv = k_mutex_unlock(kernel_mutex);
+	zassert_equal(rv, 0, "failed to unlock kernel mutex");
+
+	/* The owner still unlocks, and the mutex can be locked again */
+	rv = sys_mutex_unlock(&handover_mutex);
+	zassert_equal(rv, 0, "owner failed to unlock mutex");
+	rv = sys_mutex_lock(&handover_mutex, K_NO_WAIT);
+	zassert_equal(rv, 0, "mutex stuck after failed handover");
+	rv = sys_mutex_unlock(&handover_mutex);
+	zassert_equal(rv, 0, "failed to unlock mutex");
+#else
+	ztest_test_skip();
+#endif
+}
+
+#ifdef CONFIG_SYS_MUTEX_FAST_PATH
+/* Never started, no other thread has access to it */
+static void forged_owner_entry(void)
+{
+}
+
+K_THREAD_DEFINE(forged_owner, STACKSIZE, forged_owner_entry, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, SYS_FOREVER_MS);
+#endif
+
+void test_user_access(void)
+{
+#if defined(CONFIG_USERSPACE) && !defined(CONFIG_SYS_MUTEX_FAST_PATH)
 	int rv;
 
 	rv = sys_mutex_lock(&no_access_mutex, K_NO_WAIT);
 	zassert_true(rv == -EACCES, "accessed mutex not in memory domain");
 	rv = sys_mutex_unlock(&no_access_mutex);
 	zassert_true(rv == -EACCES, "accessed mutex not in memory domain");
+#elif defined(CONFIG_SYS_MUTEX_FAST_PATH)
+	int rv;
+
+	/* The owner ID lives in user memory, the kernel must not make a
+	 * thread we have no access to the owner of the kernel mutex
+	 */
+	atomic_set(&forged_mutex.val, (atomic_val_t)forged_owner);
+	rv = sys_mutex_lock(&forged_mutex, K_MSEC(10));
+	zassert_equal(rv, -EINVAL, "accepted a forged owner");
+	zassert_equal(atomic_get(&forged_mutex.val), (atomic_val_t)forged_owner,
+		      "forged mutex modified");
+	atomic_set(&forged_mutex.val, 0);
 #else
 	ztest_test_skip();
-#endif /* CONFIG_USERSPACE */
+#endif
 }
 
 K_THREAD_DEFINE(THREAD_05, STACKSIZE, thread_05, NULL, NULL, NULL,
@@ -433,7 +502,8 @@ void test_main(void)
 	ztest_test_suite(mutex_complex,
 			 ztest_user_unit_test(test_mutex),
 			 ztest_user_unit_test(test_user_access),
-			 ztest_unit_test(test_supervisor_access));
+			 ztest_unit_test(test_supervisor_access),
+			 ztest_unit_test(test_handover_failure));
 
 	ztest_run_test_suite(mutex_complex);
 #else
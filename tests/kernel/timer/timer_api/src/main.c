@@ -575,6 +575,74 @@ void test_timer_k_define(void)
 	k_timer_stop(&ktimer);
 }
 
+#define SLACK_EARLY_MS 20
+#define SLACK_LATE_MS 30
+
+static struct k_timer slack_timer;
+static struct k_timer strict_timer;
+static int64_t slack_expiry, strict_expiry;
+
+static void slack_expire(struct k_timer *timer)
+{
+	if (timer == &slack_timer) {
+		slack_expiry = k_uptime_ticks();
+	} else {
+		strict_expiry = k_uptime_ticks();
+	}
+}
+
+/**
+ * @brief Test timer expiry coalescing within the slack
+ *
+ * A timer whose slack window covers the expiry of another timer must not
+ * expire later than its slack allows, and with CONFIG_TIMEOUT_SLACK on a
+ * tickless kernel it shares the wakeup of the other timer.
+ *
+ * @ingroup kernel_timer_tests
+ *
+ * @see k_timer_start_slack()
+ */
+void test_timer_slack(void)
+{
+	int64_t start;
+
+	k_timer_init(&slack_timer, slack_expire, NULL);
+	k_timer_init(&strict_timer, slack_expire, NULL);
+	slack_expiry = 0;
+	strict_expiry = 0;
+
+	tick_sync();
+	start = k_uptime_ticks();
+
+	k_timer_start_slack(&slack_timer, K_MSEC(SLACK_EARLY_MS), K_NO_WAIT,
+			    K_MSEC(SLACK_LATE_MS - SLACK_EARLY_MS));
+	k_timer_start(&strict_timer, K_MSEC(SLACK_LATE_MS), K_NO_WAIT);
+
+	k_msleep(2 * SLACK_LATE_MS);
+
+	/** TESTPOINT: both expired, the slack timer within its window */
+	zassert_not_equal(slack_expiry, 0, "slack timer did not expire");
+	zassert_not_equal(strict_expiry, 0, "strict timer did not expire");
+	zassert_true(slack_expiry - start >= k_ms_to_ticks_floor64(
+			     SLACK_EARLY_MS), "slack timer expired early");
+	zassert_true(slack_expiry <= strict_expiry,
+		     "slack timer expired after its slack");
+
+	/** TESTPOINT: the expiries were coalesced */
+	if (IS_ENABLED(CONFIG_TIMEOUT_SLACK) &&
+	    IS_ENABLED(CONFIG_TICKLESS_KERNEL)) {
+		zassert_equal(slack_expiry, strict_expiry,
+			      "expiries not coalesced");
+	}
+
+#ifdef CONFIG_TIMEOUT_SLACK
+	struct sys_clock_slack_stats stats;
+
+	sys_clock_slack_stats_get(&stats);
+	zassert_not_equal(stats.wakeups, 0, "no wakeups counted");
+#endif
+}
+
 static void user_data_timer_handler(struct k_timer *timer);
 
 K_TIMER_DEFINE(timer0, user_data_timer_handler, NULL);
@@ -853,6 +921,7 @@ void test_main(void)
 			 ztest_user_unit_test(test_timer_user_data),
 			 ztest_user_unit_test(test_timer_remaining),
 			 ztest_user_unit_test(test_timeout_abs),
-			 ztest_user_unit_test(test_sleep_abs));
+			 ztest_user_unit_test(test_sleep_abs),
+			 ztest_unit_test(test_timer_slack));
 	ztest_run_test_suite(timer_api);
 }
@@ -1552,6 +1552,146 @@ static void test_1cpu_legacy_delayed_cancel(void)
 }
 
 
+/* Check submission of several items at once. */
+static void test_1cpu_submit_batch(void)
+{
+	struct k_work *works[] = { &work, &work1 };
+	int rc;
+
+	reset_counters();
+	k_work_init(&work, counter_handler);
+	k_work_init(&work1, counter_handler);
+
+	/* Without a queue the first item is rejected */
+	rc = k_work_submit_to_queue_batch(NULL, works, ARRAY_SIZE(works));
+	zassert_equal(rc, -EINVAL, NULL);
+	zassert_equal(k_work_busy_get(&work1), 0, NULL);
+
+	rc = k_work_submit_to_queue_batch(&coophi_queue, works,
+					  ARRAY_SIZE(works));
+	zassert_equal(rc, ARRAY_SIZE(works), NULL);
+	zassert_equal(k_work_busy_get(&work), K_WORK_QUEUED, NULL);
+	zassert_equal(k_work_busy_get(&work1), K_WORK_QUEUED, NULL);
+
+	/* Items already queued count as submitted */
+	rc = k_work_submit_to_queue_batch(NULL, works, ARRAY_SIZE(works));
+	zassert_equal(rc, ARRAY_SIZE(works), NULL);
+
+	/* Let them run, then check they both finished once. */
+	k_sleep(K_TICKS(1));
+	zassert_equal(coophi_counter(), ARRAY_SIZE(works), NULL);
+	zassert_equal(k_work_busy_get(&work), 0, NULL);
+	zassert_equal(k_work_busy_get(&work1), 0, NULL);
+
+	/* Flush the sync state from completion */
+	rc = k_sem_take(&sync_sem, K_NO_WAIT);
+	zassert_equal(rc, 0, NULL);
+}
+
+#ifdef CONFIG_WORKQUEUE_WORKERS
+#define NUM_WORKERS 2
+#define WORKERS_ITEMS 4
+#define WORKERS_ROUNDS 50
+
+static K_THREAD_STACK_DEFINE(workers_stack, STACK_SIZE);
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, NUM_WORKERS, STACK_SIZE);
+static struct k_work_q workers_queue;
+static struct k_work_q_worker workers[NUM_WORKERS];
+static struct k_work_q unstarted_queue;
+
+struct workers_item {
+	struct k_work work;
+	atomic_t active;
+	atomic_t runs;
+	bool overlap;
+};
+
+static struct workers_item workers_items[WORKERS_ITEMS];
+
+static void workers_handler(struct k_work *work)
+{
+	struct workers_item *item
+		= CONTAINER_OF(work, struct workers_item, work);
+
+	if (atomic_inc(&item->active) != 0) {
+		item->overlap = true;
+	}
+
+	k_busy_wait(100);
+
+	atomic_inc(&item->runs);
+	atomic_dec(&item->active);
+}
+
+/* Check that a queue with several workers runs every item, never
+ * concurrently with itself, and can be flushed and drained.
+ */
+static void test_workers_queue(void)
+{
+	struct k_work *works[WORKERS_ITEMS];
+	struct workers_item *item;
+	int rc, i;
+
+	rc = k_work_queue_add_worker(&unstarted_queue, &workers[0],
+				     worker_stacks[0], STACK_SIZE, -1);
+	zassert_equal(rc, -ENODEV, NULL);
+
+	/* Starting sets up the state of the workers, only the flags need to
+	 * be clear beforehand.
+	 */
+	(void)memset(&workers_queue, 0xa5, sizeof(workers_queue));
+	workers_queue.flags = 0U;
+
+	k_work_queue_start(&workers_queue, workers_stack, STACK_SIZE,
+			   PREEMPT_PRIORITY, NULL);
+
+	rc = k_work_queue_add_worker(&workers_queue, &workers[0],
+				     worker_stacks[0], STACK_SIZE,
+				     CONFIG_MP_NUM_CPUS);
+	zassert_equal(rc, -EINVAL, NULL);
+
+	for (i = 0; i < NUM_WORKERS; i++) {
+		rc = k_work_queue_add_worker(&workers_queue, &workers[i],
+					     worker_stacks[i], STACK_SIZE, -1);
+		zassert_equal(rc, 0, NULL);
+	}
+
+	for (i = 0; i < WORKERS_ITEMS; i++) {
+		item = &workers_items[i];
+		k_work_init(&item->work, workers_handler);
+		works[i] = &item->work;
+	}
+
+	/* Resubmit the items while the workers may be running them */
+	for (i = 0; i < WORKERS_ROUNDS; i++) {
+		rc = k_work_submit_to_queue_batch(&workers_queue, works,
+						  WORKERS_ITEMS);
+		zassert_equal(rc, WORKERS_ITEMS, NULL);
+		k_busy_wait(50);
+	}
+
+	/* Flushing must wait for the running instance as well */
+	(void)k_work_submit_to_queue(&workers_queue, works[0]);
+	(void)k_work_flush(works[0], &work_sync);
+	zassert_equal(k_work_busy_get(works[0]), 0, NULL);
+
+	rc = k_work_queue_drain(&workers_queue, false);
+	zassert_true(rc >= 0, NULL);
+
+	for (i = 0; i < WORKERS_ITEMS; i++) {
+		item = &workers_items[i];
+		zassert_false(item->overlap, "item %d ran concurrently", i);
+		zassert_true(atomic_get(&item->runs) > 0, NULL);
+		zassert_equal(k_work_busy_get(&item->work), 0, NULL);
+	}
+}
+#else
+static void test_workers_queue(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_WORKQUEUE_WORKERS */
+
 static void test_nop(void)
 {
 	ztest_test_skip();
@@ -1601,6 +1741,8 @@ void test_main(void)
 			 ztest_1cpu_unit_test(
 				 test_1cpu_legacy_delayed_resubmit),
 			 ztest_1cpu_unit_test(test_1cpu_legacy_delayed_cancel),
+			 ztest_1cpu_unit_test(test_1cpu_submit_batch),
+			 ztest_unit_test(test_workers_queue),
 			 ztest_unit_test(test_nop));
 	ztest_run_test_suite(work);
 }
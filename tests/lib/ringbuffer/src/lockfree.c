@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <ztest.h>
+#include <ztress.h>
+#include <sys/ring_buffer.h>
+
+#define SPSC_SIZE 16
+#define MPMC_COUNT 4
+
+RING_BUF_SPSC_DECLARE(spsc_buf, SPSC_SIZE);
+RING_BUF_MPMC_DECLARE(mpmc_buf, sizeof(uint32_t), MPMC_COUNT);
+
+/**
+ * @brief Test claim and finish on the single producer, single consumer
+ * ring buffer.
+ *
+ * @ingroup lib_ringbuffer_tests
+ */
+void test_ringbuffer_spsc_claim(void)
+{
+	uint8_t *data;
+	uint32_t len;
+	int err;
+
+	ring_buf_spsc_init(&spsc_buf, SPSC_SIZE, spsc_buf.buf);
+
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, 10);
+	zassert_equal(len, 10, NULL);
+	memset(data, 0xaa, len);
+
+	/* Claimed data is not visible before it is finished */
+	zassert_equal(ring_buf_spsc_size_get(&spsc_buf), 0, NULL);
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_buf, 11), -EINVAL, NULL);
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_buf, 8), 0, NULL);
+	zassert_equal(ring_buf_spsc_size_get(&spsc_buf), 8, NULL);
+
+	/* Unfinished bytes are returned, the next claim stops at the end */
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, SPSC_SIZE);
+	zassert_equal(len, SPSC_SIZE - 8, NULL);
+	zassert_equal(data, &spsc_buf.buf[8], NULL);
+	memset(data, 0xbb, len);
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_buf, len), 0, NULL);
+
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, 1);
+	zassert_equal(len, 0, "Claimed space in a full buffer");
+
+	len = ring_buf_spsc_get_claim(&spsc_buf, &data, 4);
+	zassert_equal(len, 4, NULL);
+	zassert_equal(data[0], 0xaa, NULL);
+	zassert_equal(ring_buf_spsc_get_finish(&spsc_buf, 5), -EINVAL, NULL);
+	zassert_equal(ring_buf_spsc_get_finish(&spsc_buf, 4), 0, NULL);
+	zassert_equal(ring_buf_spsc_space_get(&spsc_buf), 4, NULL);
+
+	/* Space freed at the start is available after wrapping */
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, SPSC_SIZE);
+	zassert_equal(len, 4, NULL);
+	zassert_equal(data, spsc_buf.buf, NULL);
+	err = ring_buf_spsc_put_finish(&spsc_buf, len);
+	zassert_equal(err, 0, NULL);
+
+	zassert_equal(ring_buf_spsc_get(&spsc_buf, NULL, SPSC_SIZE), SPSC_SIZE,
+		      NULL);
+	zassert_equal(ring_buf_spsc_size_get(&spsc_buf), 0, NULL);
+}
+
+/**
+ * @brief Test claim and finish on the multiple producer, multiple consumer
+ * ring.
+ *
+ * @ingroup lib_ringbuffer_tests
+ */
+void test_ringbuffer_mpmc_claim(void)
+{
+	static uint32_t seq[MPMC_COUNT];
+	static uint32_t data[MPMC_COUNT];
+	uint32_t out[MPMC_COUNT];
+	void *put, *put2, *get;
+	uint32_t num;
+
+	ring_buf_mpmc_init(&mpmc_buf, sizeof(uint32_t), MPMC_COUNT, data, seq);
+
+	num = ring_buf_mpmc_put_claim(&mpmc_buf, &put, 2);
+	zassert_equal(num, 2, NULL);
+	num = ring_buf_mpmc_put_claim(&mpmc_buf, &put2, 1);
+	zassert_equal(num, 1, NULL);
+	zassert_equal(put2, &data[2], NULL);
+
+	/* Slots finished out of order are only consumed in order */
+	*(uint32_t *)put2 = 3;
+	zassert_equal(ring_buf_mpmc_put_finish(&mpmc_buf, put2, 1), 0, NULL);
+	zassert_equal(ring_buf_mpmc_get_claim(&mpmc_buf, &get, 1), 0, NULL);
+
+	((uint32_t *)put)[0] = 1;
+	((uint32_t *)put)[1] = 2;
+	zassert_equal(ring_buf_mpmc_put_finish(&mpmc_buf, put, 2), 0, NULL);
+
+	num = ring_buf_mpmc_get_claim(&mpmc_buf, &get, MPMC_COUNT);
+	zassert_equal(num, 3, NULL);
+	zassert_equal(((uint32_t *)get)[0], 1, NULL);
+	zassert_equal(((uint32_t *)get)[2], 3, NULL);
+
+	/* Only one slot left before wrapping, claimed ones are not reused */
+	num = ring_buf_mpmc_put_claim(&mpmc_buf, &put, MPMC_COUNT);
+	zassert_equal(num, 1, NULL);
+	zassert_equal(ring_buf_mpmc_put_finish(&mpmc_buf, put, 1), 0, NULL);
+	zassert_equal(ring_buf_mpmc_put_claim(&mpmc_buf, &put, 1), 0, NULL);
+
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_buf, get, 3), 0, NULL);
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_buf, &out[0], 1), -EINVAL,
+		      NULL);
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_buf, &data[MPMC_COUNT], 0),
+		      -EINVAL, NULL);
+
+	for (num = 0; num < MPMC_COUNT; num++) {
+		out[num] = num + 10;
+	}
+
+	zassert_equal(ring_buf_mpmc_put(&mpmc_buf, out, MPMC_COUNT), 3, NULL);
+	zassert_equal(ring_buf_mpmc_get(&mpmc_buf, out, MPMC_COUNT), 4, NULL);
+	zassert_equal(out[0], 0, NULL);
+	zassert_equal(out[1], 10, NULL);
+	zassert_equal(out[3], 12, NULL);
+	zassert_equal(ring_buf_mpmc_get(&mpmc_buf, out, 1), 0, NULL);
+}
+
+static bool spsc_produce(void *user_data, uint32_t iter_cnt, bool last,
+			 int prio)
+{
+	static uint8_t cnt;
+	static uint32_t wr = 1;
+	uint8_t *data;
+	uint32_t len;
+
+	if (iter_cnt == 0) {
+		cnt = 0;
+	}
+
+	len = ring_buf_spsc_put_claim(&spsc_buf, &data, wr);
+	for (uint32_t i = 0; i < len; i++) {
+		data[i] = cnt++;
+	}
+
+	wr = (wr % 7) + 1;
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_buf, len), 0, NULL);
+
+	return true;
+}
+
+static bool spsc_consume(void *user_data, uint32_t iter_cnt, bool last,
+			 int prio)
+{
+	static uint8_t cnt;
+	static uint32_t rd = 1;
+	uint8_t *data;
+	uint32_t len;
+
+	if (iter_cnt == 0) {
+		cnt = 0;
+	}
+
+	len = ring_buf_spsc_get_claim(&spsc_buf, &data, rd);
+	for (uint32_t i = 0; i < len; i++) {
+		zassert_equal(data[i], cnt, "Got %02x, exp: %02x", data[i], cnt);
+		cnt++;
+	}
+
+	rd = (rd % 5) + 1;
+	zassert_equal(ring_buf_spsc_get_finish(&spsc_buf, len), 0, NULL);
+
+	return true;
+}
+
+/* Producers tag elements with their ID and a running count, so that a
+ * consumer can check that elements of each producer come in order.
+ */
+static uint32_t mpmc_last[2][2];
+
+static bool mpmc_produce(void *user_data, uint32_t iter_cnt, bool last,
+			 int prio)
+{
+	static uint32_t cnt[2];
+	uint32_t id = POINTER_TO_UINT(user_data);
+	void *data;
+	uint32_t num;
+
+	if (iter_cnt == 0) {
+		cnt[id] = 0;
+	}
+
+	num = ring_buf_mpmc_put_claim(&mpmc_buf, &data, 2);
+	for (uint32_t i = 0; i < num; i++) {
+		((uint32_t *)data)[i] = (id << 24) | ++cnt[id];
+	}
+
+	zassert_equal(ring_buf_mpmc_put_finish(&mpmc_buf, data, num), 0, NULL);
+
+	return true;
+}
+
+static bool mpmc_consume(void *user_data, uint32_t iter_cnt, bool last,
+			 int prio)
+{
+	uint32_t cons = POINTER_TO_UINT(user_data) - 2;
+	uint32_t val, id;
+	void *data;
+	uint32_t num;
+
+	if (iter_cnt == 0) {
+		memset(mpmc_last[cons], 0, sizeof(mpmc_last[cons]));
+	}
+
+	num = ring_buf_mpmc_get_claim(&mpmc_buf, &data, 3);
+	for (uint32_t i = 0; i < num; i++) {
+		val = ((uint32_t *)data)[i];
+		id = val >> 24;
+		zassert_true(id < 2, "Bad element %08x", val);
+		zassert_true((val & 0xffffff) > mpmc_last[cons][id],
+			     "Element %08x out of order", val);
+		mpmc_last[cons][id] = val & 0xffffff;
+	}
+
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_buf, data, num), 0, NULL);
+
+	return true;
+}
+
+/* Single producer and single consumer at different priorities, without any
+ * locking.
+ */
+void test_ringbuffer_spsc_stress(void)
+{
+	ring_buf_spsc_init(&spsc_buf, SPSC_SIZE, spsc_buf.buf);
+
+	ztress_set_timeout(K_MSEC(1000));
+	ZTRESS_EXECUTE(ZTRESS_THREAD(spsc_produce, NULL, 0, 0, Z_TIMEOUT_TICKS(20)),
+		       ZTRESS_THREAD(spsc_consume, NULL, 0, 2000, Z_TIMEOUT_TICKS(20)));
+	ZTRESS_EXECUTE(ZTRESS_THREAD(spsc_consume, NULL, 0, 0, Z_TIMEOUT_TICKS(20)),
+		       ZTRESS_THREAD(spsc_produce, NULL, 0, 2000, Z_TIMEOUT_TICKS(20)));
+}
+
+/* Two producers and two consumers preempting each other, without any
+ * locking.
+ */
+void test_ringbuffer_mpmc_stress(void)
+{
+	static uint32_t seq[MPMC_COUNT];
+	static uint32_t data[MPMC_COUNT];
+
+	ring_buf_mpmc_init(&mpmc_buf, sizeof(uint32_t), MPMC_COUNT, data, seq);
+
+	ztress_set_timeout(K_MSEC(1000));
+	ZTRESS_EXECUTE(ZTRESS_THREAD(mpmc_produce, UINT_TO_POINTER(0), 0, 0,
+				     Z_TIMEOUT_TICKS(20)),
+		       ZTRESS_THREAD(mpmc_consume, UINT_TO_POINTER(2), 0, 1000,
+				     Z_TIMEOUT_TICKS(20)),
+		       ZTRESS_THREAD(mpmc_produce, UINT_TO_POINTER(1), 0, 2000,
+				     Z_TIMEOUT_TICKS(20)),
+		       ZTRESS_THREAD(mpmc_consume, UINT_TO_POINTER(3), 0, 3000,
+				     Z_TIMEOUT_TICKS(20)));
+}
@@ -56,6 +56,10 @@ extern void test_ringbuffer_concurrent(void);
 extern void test_ringbuffer_zerocpy_stress(void);
 extern void test_ringbuffer_cpy_stress(void);
 extern void test_ringbuffer_item_stress(void);
+extern void test_ringbuffer_spsc_claim(void);
+extern void test_ringbuffer_mpmc_claim(void);
+extern void test_ringbuffer_spsc_stress(void);
+extern void test_ringbuffer_mpmc_stress(void);
 /**
  * @brief Test APIs of ring buffer
  *
@@ -1057,7 +1061,11 @@ void test_main(void)
 		       ztest_unit_test(test_ringbuffer_concurrent),
 		       ztest_unit_test(test_ringbuffer_zerocpy_stress),
 		       ztest_unit_test(test_ringbuffer_cpy_stress),
-		       ztest_unit_test(test_ringbuffer_item_stress)
+		       ztest_unit_test(test_ringbuffer_item_stress),
+		       ztest_unit_test(test_ringbuffer_spsc_claim),
+		       ztest_unit_test(test_ringbuffer_mpmc_claim),
+		       ztest_unit_test(test_ringbuffer_spsc_stress),
+		       ztest_unit_test(test_ringbuffer_mpmc_stress)
 		);
 	ztest_run_test_suite(test_ringbuffer_api);
 }
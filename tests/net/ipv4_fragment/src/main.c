@@ -0,0 +1,546 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "net_stats.h"
+
+/* Small link MTU so that a modest UDP datagram needs several fragments */
+#define TEST_MTU 256
+
+/* Payload carried by every fragment but the last one */
+#define FRAG_PAYLOAD ((TEST_MTU - NET_IPV4H_LEN) & ~7)
+
+#define DATA_LEN 1000
+#define DATAGRAM_LEN (NET_UDPH_LEN + DATA_LEN)
+#define FRAG_COUNT ((DATAGRAM_LEN + FRAG_PAYLOAD - 1) / FRAG_PAYLOAD)
+
+#define MY_PORT 1234
+#define PEER_PORT 4321
+
+#define WAIT_TIME K_SECONDS(1)
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface;
+static struct k_sem wait_data;
+static struct k_sem wait_recv;
+
+static bool test_failed;
+static bool capture;
+static int frag_count;
+static uint16_t frag_id;
+static uint16_t recv_data_len;
+static struct net_pkt *frags[FRAG_COUNT];
+
+struct net_if_test {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static uint16_t hdr_fragment_flags(struct net_ipv4_hdr *hdr)
+{
+	return (hdr->offset[0] << 8) | hdr->offset[1];
+}
+
+static int verify_fragment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	size_t len = net_pkt_get_len(pkt);
+	uint16_t flags = hdr_fragment_flags(hdr);
+	uint16_t id = (hdr->id[0] << 8) | hdr->id[1];
+	bool last = frag_count == FRAG_COUNT - 1;
+
+	NET_DBG("Fragment %d len %zd flags 0x%04x id 0x%04x",
+		frag_count, len, flags, id);
+
+	if (frag_count >= FRAG_COUNT || len > TEST_MTU ||
+	    ntohs(hdr->len) != len) {
+		return -EINVAL;
+	}
+
+	if (frag_count == 0) {
+		frag_id = id;
+	} else if (id != frag_id) {
+		return -EINVAL;
+	}
+
+	if ((flags & NET_IPV4_FRAGH_OFFSET_MASK) * 8U !=
+	    frag_count * FRAG_PAYLOAD) {
+		return -EINVAL;
+	}
+
+	if (!!(flags & NET_IPV4_MORE_FRAG_MASK) == last) {
+		return -EINVAL;
+	}
+
+	if (!last && len != NET_IPV4H_LEN + FRAG_PAYLOAD) {
+		return -EINVAL;
+	}
+
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV4H_LEN);
+	net_pkt_set_ipv4_opts_len(pkt, 0);
+
+	/* Header checksum computed over a valid header is zero */
+	if (net_calc_chksum_ipv4(pkt) != 0U) {
+		return -EINVAL;
+	}
+
+	frags[frag_count] = net_pkt_clone(pkt, K_NO_WAIT);
+	if (!frags[frag_count]) {
+		return -ENOMEM;
+	}
+
+	frag_count++;
+
+	return 0;
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	if (!capture) {
+		return 0;
+	}
+
+	if (verify_fragment(pkt) < 0) {
+		NET_DBG("Fragment %d cannot be verified", frag_count);
+		test_failed = true;
+		k_sem_give(&wait_data);
+	} else if (frag_count == FRAG_COUNT) {
+		k_sem_give(&wait_data);
+	}
+
+	return 0;
+}
+
+struct net_if_test net_iface_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(net_ipv4_frag_test, "net_ipv4_frag_test",
+		net_iface_dev_init, NULL, &net_iface_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE,
+		TEST_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	uint8_t expected = 0U;
+	uint8_t data;
+
+	recv_data_len = net_pkt_remaining_data(pkt);
+
+	NET_DBG("Data %p received, %u bytes", pkt, recv_data_len);
+
+	while (!net_pkt_read_u8(pkt, &data)) {
+		if (data != expected++) {
+			test_failed = true;
+			break;
+		}
+	}
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_recv);
+
+	return NET_OK;
+}
+
+static void setup_udp_handler(void)
+{
+	static struct net_conn_handle *handle;
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	int ret;
+
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, &my_addr);
+	local_addr.sa_family = AF_INET;
+
+	net_ipaddr_copy(&net_sin(&remote_addr)->sin_addr, &peer_addr);
+	remote_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, &remote_addr, &local_addr,
+			       htons(MY_PORT), htons(PEER_PORT), NULL,
+			       udp_data_received, NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static struct net_pkt *create_datagram(bool dont_fragment)
+{
+	struct net_pkt *pkt;
+	int i, ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, DATAGRAM_LEN, AF_INET,
+					IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create_full(pkt, &my_addr, &peer_addr, 0U, 0U,
+				   dont_fragment ? NET_IPV4_DF : 0U, 0U,
+				   net_if_ipv4_get_ttl(iface));
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(MY_PORT), htons(PEER_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	for (i = 0; i < DATA_LEN; i++) {
+		ret = net_pkt_write_u8(pkt, (uint8_t)i);
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	ret = net_ipv4_finalize(pkt, IPPROTO_UDP);
+	zassert_equal(ret, 0, "Cannot finalize packet");
+
+	return pkt;
+}
+
+/* Turn a captured outgoing fragment into one that is destined to us */
+static void loop_fragment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	struct in_addr addr;
+
+	/* Swapping the addresses changes neither the IPv4 header checksum
+	 * nor the UDP pseudo header checksum.
+	 */
+	net_ipv4_addr_copy_raw((uint8_t *)&addr, hdr->src);
+	net_ipv4_addr_copy_raw(hdr->src, hdr->dst);
+	net_ipv4_addr_copy_raw(hdr->dst, (uint8_t *)&addr);
+
+	net_pkt_cursor_init(pkt);
+}
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+	k_sem_init(&wait_recv, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_up(iface);
+
+	/* Remote and local are swapped so that we can receive the sent
+	 * packet.
+	 */
+	setup_udp_handler();
+}
+
+static void send_and_capture(void)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = create_datagram(false);
+
+	test_failed = false;
+	frag_count = 0;
+	capture = true;
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send (%d)", ret);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting fragments");
+
+	capture = false;
+
+	zassert_false(test_failed, "Fragment verify failed");
+	zassert_equal(frag_count, FRAG_COUNT, "Invalid fragment count %d",
+		      frag_count);
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	send_and_capture();
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	zassert_equal(GET_STAT(iface, ipv4_frag.sent), FRAG_COUNT,
+		      "Invalid sent fragment count");
+#endif
+}
+
+static void test_send_ipv4_dont_fragment(void)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = create_datagram(true);
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, -EIO, "Packet with DF set was sent (%d)", ret);
+
+	net_pkt_unref(pkt);
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	int i, ret;
+
+	zassert_equal(frag_count, FRAG_COUNT, "No captured fragments");
+
+	test_failed = false;
+	recv_data_len = 0U;
+
+	/* Feed the fragments back in reverse order so that they must be
+	 * sorted by the reassembly.
+	 */
+	for (i = FRAG_COUNT - 1; i >= 0; i--) {
+		loop_fragment(frags[i]);
+
+		ret = net_recv_data(iface, frags[i]);
+		zassert_equal(ret, 0, "Cannot receive fragment %d", i);
+
+		frags[i] = NULL;
+	}
+
+	zassert_equal(k_sem_take(&wait_recv, WAIT_TIME), 0,
+		      "Timeout while waiting reassembled packet");
+
+	zassert_false(test_failed, "Reassembled data mismatch");
+	zassert_equal(recv_data_len, DATA_LEN, "Invalid data length %u",
+		      recv_data_len);
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	zassert_equal(GET_STAT(iface, ipv4_frag.recv), FRAG_COUNT,
+		      "Invalid received fragment count");
+	zassert_equal(GET_STAT(iface, ipv4_frag.reassembled), 1,
+		      "Invalid reassembled count");
+#endif
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	struct net_pkt *pkt;
+	int i, ret;
+
+	/* Capture a new set of fragments and only deliver the first one */
+	send_and_capture();
+
+	for (i = 1; i < FRAG_COUNT; i++) {
+		net_pkt_unref(frags[i]);
+		frags[i] = NULL;
+	}
+
+	pkt = frags[0];
+	frags[0] = NULL;
+
+	loop_fragment(pkt);
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive fragment");
+
+	zassert_not_equal(k_sem_take(&wait_recv,
+			  K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT + 1)), 0,
+			  "Incomplete packet was delivered");
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	zassert_equal(GET_STAT(iface, ipv4_frag.timeout), 1,
+		      "Reassembly did not time out");
+	zassert_equal(GET_STAT(iface, ipv4_frag.reassembled), 1,
+		      "Invalid reassembled count");
+#endif
+}
+
+static void recv_fragment(struct net_pkt *pkt, int i)
+{
+	int ret;
+
+	loop_fragment(pkt);
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive fragment %d", i);
+}
+
+static void test_recv_ipv4_fragment_duplicate(void)
+{
+	struct net_pkt *dup;
+	int i;
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	net_stats_t drop = GET_STAT(iface, ipv4_frag.drop);
+	net_stats_t reassembled = GET_STAT(iface, ipv4_frag.reassembled);
+#endif
+
+	send_and_capture();
+
+	dup = net_pkt_clone(frags[1], K_NO_WAIT);
+	zassert_not_null(dup, "Cannot clone fragment");
+
+	test_failed = false;
+	recv_data_len = 0U;
+
+	/* A copy of the second fragment, duplicated by the network, must
+	 * not cancel the reassembly.
+	 */
+	for (i = 0; i < FRAG_COUNT; i++) {
+		recv_fragment(frags[i], i);
+		frags[i] = NULL;
+
+		if (i == 1) {
+			recv_fragment(dup, i);
+		}
+	}
+
+	zassert_equal(k_sem_take(&wait_recv, WAIT_TIME), 0,
+		      "Duplicate fragment cancelled the reassembly");
+
+	zassert_false(test_failed, "Reassembled data mismatch");
+	zassert_equal(recv_data_len, DATA_LEN, "Invalid data length %u",
+		      recv_data_len);
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	zassert_equal(GET_STAT(iface, ipv4_frag.drop), drop + 1,
+		      "Duplicate fragment not dropped");
+	zassert_equal(GET_STAT(iface, ipv4_frag.reassembled), reassembled + 1,
+		      "Invalid reassembled count");
+#endif
+}
+
+static void test_recv_ipv4_fragment_overlap(void)
+{
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	uint16_t flags;
+	int i;
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	net_stats_t drop = GET_STAT(iface, ipv4_frag.drop);
+	net_stats_t reassembled = GET_STAT(iface, ipv4_frag.reassembled);
+#endif
+
+	send_and_capture();
+
+	/* Move the second fragment 8 octets into the first one */
+	pkt = frags[1];
+	frags[1] = NULL;
+
+	hdr = NET_IPV4_HDR(pkt);
+	flags = hdr_fragment_flags(hdr);
+	flags = (flags & ~NET_IPV4_FRAGH_OFFSET_MASK) | 1U;
+	hdr->offset[0] = flags >> 8;
+	hdr->offset[1] = flags & 0xFF;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	/* Out of order, and overlapping the first fragment */
+	recv_fragment(frags[2], 2);
+	recv_fragment(frags[0], 0);
+	recv_fragment(pkt, 1);
+	frags[0] = NULL;
+	frags[2] = NULL;
+
+	/* The rest can only start a new reassembly which times out */
+	for (i = 3; i < FRAG_COUNT; i++) {
+		recv_fragment(frags[i], i);
+		frags[i] = NULL;
+	}
+
+	zassert_not_equal(k_sem_take(&wait_recv,
+			  K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT + 1)), 0,
+			  "Overlapping fragments were reassembled");
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	zassert_true(GET_STAT(iface, ipv4_frag.drop) > drop,
+		     "Overlapping fragments not dropped");
+	zassert_equal(GET_STAT(iface, ipv4_frag.reassembled), reassembled,
+		      "Invalid reassembled count");
+#endif
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_send_ipv4_dont_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout),
+			 ztest_unit_test(test_recv_ipv4_fragment_duplicate),
+			 ztest_unit_test(test_recv_ipv4_fragment_overlap)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
@@ -0,0 +1,530 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, LOG_LEVEL_WRN);
+
+#include <ztest.h>
+#include <stdlib.h>
+#include <net/socket.h>
+#include <net/http_client.h>
+
+#define SERVER_PORT 8080
+#define SERVER_STACK_SIZE 2048
+#define SERVER_PRIO K_PRIO_PREEMPT(8)
+
+#define PIPELINE_DEPTH 4
+#define BENCH_REQUESTS 200
+#define TIMEOUT_MS 1000
+
+static const char * const close_headers[] = {
+	"Connection: close" HTTP_CRLF,
+	NULL
+};
+
+static uint8_t recv_buf[PIPELINE_DEPTH][256];
+static struct http_request requests[PIPELINE_DEPTH];
+
+struct result {
+	char body[32];
+	size_t body_len;
+	uint16_t status;
+	bool complete;
+	bool keep_alive;
+};
+
+static struct result results[PIPELINE_DEPTH];
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(server_ready, 0, 1);
+
+/* Server stand-in state. */
+static atomic_t server_connections;
+static atomic_t server_requests;
+static atomic_t server_bytes;
+static char server_body[64];
+static size_t server_body_len;
+
+/* Decode a chunked request body. Returns the length of the encoded body or
+ * 0 if it has not been fully received yet.
+ */
+static size_t server_dechunk(const char *buf, size_t len)
+{
+	size_t pos = 0;
+	size_t chunk_len;
+
+	server_body_len = 0;
+
+	while (pos < len) {
+		if (memchr(buf + pos, '\n', len - pos) == NULL) {
+			return 0;
+		}
+
+		chunk_len = strtoul(buf + pos, NULL, 16);
+		pos = (const char *)memchr(buf + pos, '\n', len - pos) - buf + 1;
+
+		if (pos + chunk_len + 2 > len) {
+			return 0;
+		}
+
+		if (chunk_len == 0) {
+			return pos + 2;
+		}
+
+		if (server_body_len + chunk_len <= sizeof(server_body)) {
+			memcpy(server_body + server_body_len, buf + pos,
+			       chunk_len);
+			server_body_len += chunk_len;
+		}
+
+		pos += chunk_len + 2;
+	}
+
+	return 0;
+}
+
+/* Handle one request from the start of buf. Returns the number of bytes
+ * consumed, 0 if the request is incomplete or <0 if the connection should
+ * be closed after the response.
+ */
+static int server_handle_request(int sock, char *buf, size_t len)
+{
+	static char rsp[128];
+	char *hdr_end, *url, *url_end;
+	size_t hdr_len, body_len = 0;
+	bool close_conn;
+	int rsp_len;
+
+	buf[len] = '\0';
+
+	hdr_end = strstr(buf, HTTP_CRLF HTTP_CRLF);
+	if (hdr_end == NULL) {
+		return 0;
+	}
+
+	hdr_len = hdr_end - buf + 4;
+
+	if (strstr(buf, "Transfer-Encoding: chunked") != NULL &&
+	    strstr(buf, "Transfer-Encoding: chunked") < hdr_end) {
+		body_len = server_dechunk(buf + hdr_len, len - hdr_len);
+		if (body_len == 0) {
+			return 0;
+		}
+	}
+
+	close_conn = strstr(buf, "Connection: close") != NULL &&
+		     strstr(buf, "Connection: close") < hdr_end;
+
+	/* Echo the URL back as the response body. */
+	url = strchr(buf, ' ') + 1;
+	url_end = strchr(url, ' ');
+
+	rsp_len = snprintk(rsp, sizeof(rsp),
+			   "HTTP/1.1 %s" HTTP_CRLF
+			   "Content-Length: %d" HTTP_CRLF
+			   "%s" HTTP_CRLF "%.*s",
+			   strncmp(url, "/error", 6) == 0 ?
+			   "503 Service Unavailable" : "200 OK",
+			   (int)(url_end - url),
+			   close_conn ? "Connection: close" HTTP_CRLF : "",
+			   (int)(url_end - url), url);
+
+	atomic_inc(&server_requests);
+	atomic_add(&server_bytes, hdr_len + body_len + rsp_len);
+
+	(void)zsock_send(sock, rsp, rsp_len, 0);
+
+	return close_conn ? -1 : hdr_len + body_len;
+}
+
+/* Minimal HTTP/1.1 server, one connection at a time. */
+static void server_main(void *p1, void *p2, void *p3)
+{
+	static char buf[1024];
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+		.sin_addr = INADDR_ANY_INIT,
+	};
+	int listen_sock, sock;
+	size_t len;
+	int ret;
+
+	listen_sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(listen_sock >= 0, "socket failed (%d)", errno);
+
+	ret = zsock_bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "bind failed (%d)", errno);
+
+	ret = zsock_listen(listen_sock, 1);
+	zassert_equal(ret, 0, "listen failed (%d)", errno);
+
+	k_sem_give(&server_ready);
+
+	while (true) {
+		sock = zsock_accept(listen_sock, NULL, NULL);
+		if (sock < 0) {
+			break;
+		}
+
+		atomic_inc(&server_connections);
+		len = 0;
+
+		while (true) {
+			ret = zsock_recv(sock, buf + len, sizeof(buf) - len - 1,
+					 0);
+			if (ret <= 0) {
+				break;
+			}
+
+			len += ret;
+
+			while ((ret = server_handle_request(sock, buf, len)) > 0) {
+				len -= ret;
+				memmove(buf, buf + ret, len);
+			}
+
+			if (ret < 0) {
+				break;
+			}
+		}
+
+		(void)zsock_close(sock);
+	}
+
+	(void)zsock_close(listen_sock);
+}
+
+static int connect_server(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	int sock;
+	int ret;
+
+	zsock_inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(sock >= 0, "socket failed (%d)", errno);
+
+	ret = zsock_connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "connect failed (%d)", errno);
+
+	return sock;
+}
+
+static void response_cb(struct http_response *rsp,
+			enum http_final_call final_data, void *user_data)
+{
+	struct result *res = &results[(rsp->recv_buf - recv_buf[0]) /
+				      sizeof(recv_buf[0])];
+	size_t len;
+
+	if (rsp->body_start != NULL) {
+		len = rsp->data_len - (rsp->body_start - rsp->recv_buf);
+		len = MIN(len, sizeof(res->body) - 1 - res->body_len);
+		memcpy(res->body + res->body_len, rsp->body_start, len);
+		res->body_len += len;
+	}
+
+	if (final_data == HTTP_DATA_FINAL) {
+		res->status = rsp->http_status_code;
+		res->complete = rsp->message_complete;
+		res->keep_alive = rsp->keep_alive;
+	}
+}
+
+static void prepare_request(int idx, enum http_method method,
+			    const char *url)
+{
+	struct http_request *req = &requests[idx];
+
+	memset(req, 0, sizeof(*req));
+	memset(&results[idx], 0, sizeof(results[idx]));
+
+	req->method = method;
+	req->url = url;
+	req->host = "127.0.0.1";
+	req->protocol = "HTTP/1.1";
+	req->response = response_cb;
+	req->recv_buf = recv_buf[idx];
+	req->recv_buf_len = sizeof(recv_buf[idx]);
+}
+
+static void check_error(int idx)
+{
+	zassert_true(results[idx].complete, "Response %d not complete", idx);
+	zassert_equal(results[idx].status, 503, "Unexpected status %d",
+		      results[idx].status);
+	zassert_equal(results[idx].body_len, 0, "Error body reported");
+	zassert_true(results[idx].keep_alive, "Connection should be reusable");
+}
+
+static void check_result(int idx, const char *url)
+{
+	zassert_true(results[idx].complete, "Response %d not complete", idx);
+	zassert_equal(results[idx].status, 200, "Unexpected status %d",
+		      results[idx].status);
+	zassert_equal(results[idx].body_len, strlen(url),
+		      "Unexpected body length %zd", results[idx].body_len);
+	zassert_mem_equal(results[idx].body, url, strlen(url),
+			  "Unexpected body");
+}
+
+static void test_setup(void)
+{
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack),
+			server_main, NULL, NULL, NULL,
+			SERVER_PRIO, 0, K_NO_WAIT);
+	k_sem_take(&server_ready, K_FOREVER);
+}
+
+static void test_keep_alive(void)
+{
+	int sock;
+	int ret;
+
+	atomic_clear(&server_connections);
+	sock = connect_server();
+
+	for (int i = 0; i < 3; i++) {
+		prepare_request(0, HTTP_GET, "/keep-alive");
+
+		ret = http_client_req(sock, &requests[0], TIMEOUT_MS, NULL);
+		zassert_true(ret > 0, "http_client_req failed (%d)", ret);
+
+		check_result(0, "/keep-alive");
+		zassert_true(results[0].keep_alive,
+			     "Connection should be reusable");
+	}
+
+	prepare_request(0, HTTP_GET, "/close");
+	requests[0].header_fields = (const char **)close_headers;
+
+	ret = http_client_req(sock, &requests[0], TIMEOUT_MS, NULL);
+	zassert_true(ret > 0, "http_client_req failed (%d)", ret);
+
+	check_result(0, "/close");
+	zassert_false(results[0].keep_alive,
+		      "Connection should not be reusable");
+
+	zassert_equal(atomic_get(&server_connections), 1,
+		      "Connection was not reused");
+
+	(void)zsock_close(sock);
+}
+
+static const char * const body_chunks[] = {
+	"streamed ", "request ", "body",
+};
+
+static int chunk_cb(struct http_request *req, const uint8_t **chunk,
+		    void *user_data)
+{
+	int *next = user_data;
+
+	if (*next >= ARRAY_SIZE(body_chunks)) {
+		return 0;
+	}
+
+	*chunk = (const uint8_t *)body_chunks[*next];
+
+	return strlen(body_chunks[(*next)++]);
+}
+
+static void test_chunked_payload(void)
+{
+	const char *expected = "streamed request body";
+	int sock = connect_server();
+	int next = 0;
+	int ret;
+
+	prepare_request(0, HTTP_POST, "/upload");
+	requests[0].payload_chunk_cb = chunk_cb;
+
+	ret = http_client_req(sock, &requests[0], TIMEOUT_MS, &next);
+	zassert_true(ret > 0, "http_client_req failed (%d)", ret);
+
+	check_result(0, "/upload");
+	zassert_true(results[0].keep_alive, "Connection should be reusable");
+	zassert_equal(server_body_len, strlen(expected),
+		      "Unexpected body length %zd", server_body_len);
+	zassert_mem_equal(server_body, expected, strlen(expected),
+			  "Unexpected body");
+
+	(void)zsock_close(sock);
+}
+
+static void test_pipeline(void)
+{
+	static const char * const urls[PIPELINE_DEPTH] = {
+		"/one", "/two", "/three", "/four",
+	};
+	struct http_request *reqs[PIPELINE_DEPTH];
+	int sock = connect_server();
+	int ret;
+
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		prepare_request(i, HTTP_GET, urls[i]);
+		reqs[i] = &requests[i];
+	}
+
+	ret = http_client_req_pipeline(sock, reqs, PIPELINE_DEPTH,
+				       TIMEOUT_MS, NULL);
+	zassert_true(ret > 0, "http_client_req_pipeline failed (%d)", ret);
+
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		check_result(i, urls[i]);
+	}
+
+	/* Requests with a body are not pipelined */
+	requests[0].method = HTTP_POST;
+	requests[0].payload = "data";
+
+	ret = http_client_req_pipeline(sock, reqs, PIPELINE_DEPTH,
+				       TIMEOUT_MS, NULL);
+	zassert_equal(ret, -EINVAL, "POST should not be pipelined");
+
+	(void)zsock_close(sock);
+}
+
+/* The body of a server error is not reported but must not be taken for the
+ * start of the next response either.
+ */
+static void test_error_body(void)
+{
+	struct http_request *reqs[2];
+	int sock;
+	int ret;
+
+	atomic_clear(&server_connections);
+	sock = connect_server();
+
+	prepare_request(0, HTTP_GET, "/error");
+
+	ret = http_client_req(sock, &requests[0], TIMEOUT_MS, NULL);
+	zassert_true(ret > 0, "http_client_req failed (%d)", ret);
+	check_error(0);
+
+	prepare_request(0, HTTP_GET, "/after-error");
+
+	ret = http_client_req(sock, &requests[0], TIMEOUT_MS, NULL);
+	zassert_true(ret > 0, "http_client_req failed (%d)", ret);
+	check_result(0, "/after-error");
+
+	for (int i = 0; i < ARRAY_SIZE(reqs); i++) {
+		prepare_request(i, HTTP_GET, i == 0 ? "/error" : "/two");
+		reqs[i] = &requests[i];
+	}
+
+	ret = http_client_req_pipeline(sock, reqs, ARRAY_SIZE(reqs),
+				       TIMEOUT_MS, NULL);
+	zassert_true(ret > 0, "http_client_req_pipeline failed (%d)", ret);
+	check_error(0);
+	check_result(1, "/two");
+
+	zassert_equal(atomic_get(&server_connections), 1,
+		      "Connection was not reused");
+
+	(void)zsock_close(sock);
+}
+
+enum bench_mode {
+	BENCH_NEW_CONNECTION,
+	BENCH_KEEP_ALIVE,
+	BENCH_PIPELINE,
+};
+
+static void bench_requests(enum bench_mode mode, const char *name)
+{
+	struct http_request *reqs[PIPELINE_DEPTH];
+	uint32_t start, elapsed;
+	int sock = -1;
+	int done = 0;
+	int ret;
+
+	atomic_clear(&server_requests);
+	atomic_clear(&server_bytes);
+	atomic_clear(&server_connections);
+
+	start = k_uptime_get_32();
+
+	while (done < BENCH_REQUESTS) {
+		if (sock < 0) {
+			sock = connect_server();
+		}
+
+		if (mode == BENCH_PIPELINE) {
+			for (int i = 0; i < PIPELINE_DEPTH; i++) {
+				prepare_request(i, HTTP_GET, "/bench");
+				reqs[i] = &requests[i];
+			}
+
+			ret = http_client_req_pipeline(sock, reqs,
+						       PIPELINE_DEPTH,
+						       TIMEOUT_MS, NULL);
+			zassert_true(ret > 0, "Pipeline failed (%d)", ret);
+			done += PIPELINE_DEPTH;
+		} else {
+			prepare_request(0, HTTP_GET, "/bench");
+
+			if (mode == BENCH_NEW_CONNECTION) {
+				requests[0].header_fields =
+					(const char **)close_headers;
+			}
+
+			ret = http_client_req(sock, &requests[0], TIMEOUT_MS,
+					      NULL);
+			zassert_true(ret > 0, "Request failed (%d)", ret);
+			done++;
+		}
+
+		if (!results[mode == BENCH_PIPELINE ?
+			     PIPELINE_DEPTH - 1 : 0].keep_alive) {
+			(void)zsock_close(sock);
+			sock = -1;
+		}
+	}
+
+	elapsed = k_uptime_get_32() - start;
+
+	if (sock >= 0) {
+		(void)zsock_close(sock);
+	}
+
+	zassert_equal(atomic_get(&server_requests), done,
+		      "Server saw %d requests, expected %d",
+		      (int)atomic_get(&server_requests), done);
+
+	TC_PRINT("%s: %u req/s, %d bytes/req, %d connections\n", name,
+		 elapsed == 0U ? 0U : (done * 1000U) / elapsed,
+		 (int)atomic_get(&server_bytes) / done,
+		 (int)atomic_get(&server_connections));
+}
+
+static void test_requests_per_second(void)
+{
+	bench_requests(BENCH_NEW_CONNECTION, "connection per request");
+	bench_requests(BENCH_KEEP_ALIVE, "keep-alive");
+	bench_requests(BENCH_PIPELINE, "keep-alive, pipelined");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(http_client,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_keep_alive),
+			 ztest_unit_test(test_chunked_payload),
+			 ztest_unit_test(test_pipeline),
+			 ztest_unit_test(test_error_body),
+			 ztest_unit_test(test_requests_per_second));
+
+	ztest_run_test_suite(http_client);
+}
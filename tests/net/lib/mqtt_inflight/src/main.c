@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, LOG_LEVEL_WRN);
+
+#include <ztest.h>
+#include <net/mqtt.h>
+#include <net/socket.h>
+
+#define BROKER_PORT 1883
+#define BROKER_STACK_SIZE 2048
+#define BROKER_PRIO K_PRIO_PREEMPT(8)
+#define BROKER_MAX_HELD 32
+
+#define WINDOW CONFIG_MQTT_INFLIGHT_WINDOW
+#define RETRANSMIT_TIMEOUT CONFIG_MQTT_INFLIGHT_RETRANSMIT_TIMEOUT
+
+#define BENCH_MESSAGES 500
+#define WAIT_MS 1000
+
+#define PKT_CONNECT  0x10
+#define PKT_PUBLISH  0x30
+#define PKT_PUBREL   0x60
+#define PKT_PINGREQ  0xC0
+#define PKT_DISCONN  0xE0
+
+static uint8_t rx_buffer[256];
+static uint8_t tx_buffer[256];
+static uint8_t payload[64];
+static struct mqtt_client client_ctx;
+static struct sockaddr_in broker_addr;
+static bool connected;
+static uint16_t next_message_id;
+
+K_THREAD_STACK_DEFINE(broker_stack, BROKER_STACK_SIZE);
+static struct k_thread broker_thread;
+static K_SEM_DEFINE(broker_ready, 0, 1);
+
+/* Broker stand-in state. */
+static int broker_sock = -1;
+static bool broker_hold_acks;
+static uint16_t broker_held[BROKER_MAX_HELD];
+static int broker_held_count;
+static atomic_t broker_publish_count;
+static atomic_t broker_dup_count;
+static atomic_t broker_pubrel_count;
+
+static void broker_send_ack(uint8_t type, uint16_t message_id)
+{
+	uint8_t ack[4] = { type, 2, message_id >> 8, message_id & 0xFF };
+
+	(void)zsock_send(broker_sock, ack, sizeof(ack), 0);
+}
+
+static void broker_handle_packet(const uint8_t *pkt, size_t hdr_len)
+{
+	uint8_t qos = (pkt[0] >> 1) & 0x03;
+	uint16_t message_id;
+	uint16_t topic_len;
+	static const uint8_t connack[] = { 0x20, 2, 0, 0 };
+	static const uint8_t pingresp[] = { 0xD0, 0 };
+
+	switch (pkt[0] & 0xF0) {
+	case PKT_CONNECT:
+		(void)zsock_send(broker_sock, connack, sizeof(connack), 0);
+		break;
+
+	case PKT_PUBLISH:
+		atomic_inc(&broker_publish_count);
+		if (pkt[0] & 0x08) {
+			atomic_inc(&broker_dup_count);
+		}
+
+		if (qos == 0) {
+			break;
+		}
+
+		topic_len = (pkt[hdr_len] << 8) | pkt[hdr_len + 1];
+		message_id = (pkt[hdr_len + 2 + topic_len] << 8) |
+			     pkt[hdr_len + 3 + topic_len];
+
+		if (broker_hold_acks) {
+			if (broker_held_count < BROKER_MAX_HELD) {
+				broker_held[broker_held_count++] = message_id;
+			}
+
+			break;
+		}
+
+		broker_send_ack(qos == 1 ? 0x40 : 0x50, message_id);
+		break;
+
+	case PKT_PUBREL:
+		atomic_inc(&broker_pubrel_count);
+		message_id = (pkt[hdr_len] << 8) | pkt[hdr_len + 1];
+		broker_send_ack(0x70, message_id);
+		break;
+
+	case PKT_PINGREQ:
+		(void)zsock_send(broker_sock, pingresp, sizeof(pingresp), 0);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* Minimal MQTT 3.1.1 broker that acknowledges everything it receives. */
+static void broker_main(void *p1, void *p2, void *p3)
+{
+	static uint8_t buf[512];
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(BROKER_PORT),
+		.sin_addr = INADDR_ANY_INIT,
+	};
+	size_t len = 0;
+	int listen_sock;
+	int ret;
+
+	listen_sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(listen_sock >= 0, "socket failed (%d)", errno);
+
+	ret = zsock_bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "bind failed (%d)", errno);
+
+	ret = zsock_listen(listen_sock, 1);
+	zassert_equal(ret, 0, "listen failed (%d)", errno);
+
+	k_sem_give(&broker_ready);
+
+	broker_sock = zsock_accept(listen_sock, NULL, NULL);
+	zassert_true(broker_sock >= 0, "accept failed (%d)", errno);
+
+	while (true) {
+		size_t hdr_len, rem_len, shift;
+
+		ret = zsock_recv(broker_sock, buf + len, sizeof(buf) - len, 0);
+		if (ret <= 0) {
+			break;
+		}
+
+		len += ret;
+
+		while (len >= 2) {
+			rem_len = 0;
+			shift = 0;
+			hdr_len = 1;
+
+			do {
+				rem_len |= (buf[hdr_len] & 0x7F) << shift;
+				shift += 7;
+			} while ((buf[hdr_len++] & 0x80) && hdr_len < len);
+
+			if ((buf[hdr_len - 1] & 0x80) ||
+			    len < hdr_len + rem_len) {
+				break;
+			}
+
+			broker_handle_packet(buf, hdr_len);
+
+			if ((buf[0] & 0xF0) == PKT_DISCONN) {
+				goto out;
+			}
+
+			len -= hdr_len + rem_len;
+			memmove(buf, buf + hdr_len + rem_len, len);
+		}
+	}
+
+out:
+	(void)zsock_close(broker_sock);
+	(void)zsock_close(listen_sock);
+}
+
+static void broker_release_acks(void)
+{
+	broker_hold_acks = false;
+
+	for (int i = 0; i < broker_held_count; i++) {
+		broker_send_ack(0x40, broker_held[i]);
+	}
+
+	broker_held_count = 0;
+}
+
+static void mqtt_evt_handler(struct mqtt_client *const client,
+			     const struct mqtt_evt *evt)
+{
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+
+	case MQTT_EVT_PUBREC: {
+		/* Done by applications written for the untracked API, the
+		 * library must not send a second PUBREL.
+		 */
+		const struct mqtt_pubrel_param rel = {
+			.message_id = evt->param.pubrec.message_id,
+		};
+
+		zassert_equal(mqtt_publish_qos2_release(client, &rel), 0,
+			      "PUBREL release failed");
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+/* Process incoming data for up to timeout ms, or until the window drains
+ * down to the requested number of free entries.
+ */
+static void process_input(int free_entries, int timeout)
+{
+	struct zsock_pollfd fds = {
+		.fd = client_ctx.transport.tcp.sock,
+		.events = ZSOCK_POLLIN,
+	};
+	int64_t end = k_uptime_get() + timeout;
+
+	while (k_uptime_get() < end) {
+		if (free_entries >= 0 &&
+		    mqtt_inflight_window_free(&client_ctx) >= free_entries) {
+			return;
+		}
+
+		if (zsock_poll(&fds, 1, 10) > 0) {
+			zassert_equal(mqtt_input(&client_ctx), 0,
+				      "mqtt_input failed");
+		}
+	}
+}
+
+static int publish(enum mqtt_qos qos)
+{
+	struct mqtt_publish_param param = { 0 };
+
+	if (++next_message_id == 0U) {
+		next_message_id = 1U;
+	}
+
+	param.message.topic.qos = qos;
+	param.message.topic.topic.utf8 = (uint8_t *)"sensors";
+	param.message.topic.topic.size = strlen("sensors");
+	param.message.payload.data = payload;
+	param.message.payload.len = sizeof(payload);
+	param.message_id = next_message_id;
+
+	return mqtt_publish(&client_ctx, &param);
+}
+
+static void test_connect(void)
+{
+	int ret;
+
+	k_thread_create(&broker_thread, broker_stack,
+			K_THREAD_STACK_SIZEOF(broker_stack),
+			broker_main, NULL, NULL, NULL,
+			BROKER_PRIO, 0, K_NO_WAIT);
+	k_sem_take(&broker_ready, K_FOREVER);
+
+	broker_addr.sin_family = AF_INET;
+	broker_addr.sin_port = htons(BROKER_PORT);
+	zsock_inet_pton(AF_INET, "127.0.0.1", &broker_addr.sin_addr);
+
+	mqtt_client_init(&client_ctx);
+
+	client_ctx.broker = &broker_addr;
+	client_ctx.evt_cb = mqtt_evt_handler;
+	client_ctx.client_id.utf8 = (uint8_t *)"zephyr_inflight";
+	client_ctx.client_id.size = strlen("zephyr_inflight");
+	client_ctx.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client_ctx.rx_buf = rx_buffer;
+	client_ctx.rx_buf_size = sizeof(rx_buffer);
+	client_ctx.tx_buf = tx_buffer;
+	client_ctx.tx_buf_size = sizeof(tx_buffer);
+
+	ret = mqtt_connect(&client_ctx);
+	zassert_equal(ret, 0, "mqtt_connect failed (%d)", ret);
+
+	process_input(-1, WAIT_MS);
+	zassert_true(connected, "Not connected");
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not empty");
+}
+
+static void test_window_backpressure(void)
+{
+	int ret;
+
+	broker_hold_acks = true;
+
+	for (int i = 0; i < WINDOW; i++) {
+		ret = publish(MQTT_QOS_1_AT_LEAST_ONCE);
+		zassert_equal(ret, 0, "publish %d failed (%d)", i, ret);
+	}
+
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), 0,
+		      "Window should be full");
+
+	ret = publish(MQTT_QOS_1_AT_LEAST_ONCE);
+	zassert_equal(ret, -EAGAIN, "Full window not reported (%d)", ret);
+
+	/* QoS 0 messages are not subject to the window. */
+	ret = publish(MQTT_QOS_0_AT_MOST_ONCE);
+	zassert_equal(ret, 0, "QoS 0 publish failed (%d)", ret);
+
+	/* Let the broker stand-in receive everything before acking. */
+	k_msleep(50);
+	broker_release_acks();
+
+	process_input(WINDOW, WAIT_MS);
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not drained");
+}
+
+static void test_duplicate_message_id(void)
+{
+	int ret;
+
+	broker_hold_acks = true;
+
+	ret = publish(MQTT_QOS_1_AT_LEAST_ONCE);
+	zassert_equal(ret, 0, "publish failed (%d)", ret);
+
+	next_message_id--;
+	ret = publish(MQTT_QOS_1_AT_LEAST_ONCE);
+	zassert_equal(ret, -EBUSY, "Duplicate id accepted (%d)", ret);
+
+	k_msleep(50);
+	broker_release_acks();
+
+	process_input(WINDOW, WAIT_MS);
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not drained");
+}
+
+static void test_retransmit(void)
+{
+	int ret;
+
+	atomic_set(&broker_dup_count, 0);
+	broker_hold_acks = true;
+
+	ret = publish(MQTT_QOS_1_AT_LEAST_ONCE);
+	zassert_equal(ret, 0, "publish failed (%d)", ret);
+
+	ret = mqtt_keepalive_time_left(&client_ctx);
+	zassert_true(ret <= RETRANSMIT_TIMEOUT,
+		     "Retransmission not reflected in time left (%d)", ret);
+
+	/* Nothing is due yet. */
+	ret = mqtt_live(&client_ctx);
+	zassert_equal(ret, -EAGAIN, "Unexpected retransmission (%d)", ret);
+
+	k_msleep(RETRANSMIT_TIMEOUT + 10);
+
+	ret = mqtt_live(&client_ctx);
+	zassert_equal(ret, 0, "Retransmission failed (%d)", ret);
+
+	k_msleep(50);
+	zassert_equal(atomic_get(&broker_dup_count), 1,
+		      "DUP message not received");
+
+	broker_release_acks();
+
+	process_input(WINDOW, WAIT_MS);
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not drained");
+}
+
+static void test_qos2_flow(void)
+{
+	int ret;
+
+	atomic_set(&broker_pubrel_count, 0);
+
+	for (int i = 0; i < WINDOW; i++) {
+		ret = publish(MQTT_QOS_2_EXACTLY_ONCE);
+		zassert_equal(ret, 0, "publish %d failed (%d)", i, ret);
+	}
+
+	process_input(WINDOW, WAIT_MS);
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not drained");
+
+	k_msleep(50);
+	zassert_equal(atomic_get(&broker_pubrel_count), WINDOW,
+		      "PUBREL not sent once by the library");
+}
+
+static uint32_t bench_publish(enum mqtt_qos qos, int max_inflight)
+{
+	uint32_t start, elapsed;
+	int sent = 0;
+	int ret;
+
+	start = k_uptime_get_32();
+
+	while (sent < BENCH_MESSAGES) {
+		process_input(WINDOW - max_inflight + 1, WAIT_MS);
+
+		ret = publish(qos);
+		zassert_equal(ret, 0, "publish failed (%d)", ret);
+		sent++;
+	}
+
+	process_input(WINDOW, WAIT_MS);
+	zassert_equal(mqtt_inflight_window_free(&client_ctx), WINDOW,
+		      "Window not drained");
+
+	elapsed = k_uptime_get_32() - start;
+
+	return elapsed == 0U ? 0U : (BENCH_MESSAGES * 1000U) / elapsed;
+}
+
+static void test_throughput(void)
+{
+	enum mqtt_qos qos_levels[] = {
+		MQTT_QOS_1_AT_LEAST_ONCE,
+		MQTT_QOS_2_EXACTLY_ONCE,
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(qos_levels); i++) {
+		uint32_t stop_and_wait = bench_publish(qos_levels[i], 1);
+		uint32_t pipelined = bench_publish(qos_levels[i], WINDOW);
+
+		TC_PRINT("QoS %d: stop-and-wait %u msg/s, window %d %u msg/s\n",
+			 qos_levels[i], stop_and_wait, WINDOW, pipelined);
+	}
+}
+
+static void test_disconnect(void)
+{
+	int ret;
+
+	ret = mqtt_disconnect(&client_ctx);
+	zassert_equal(ret, 0, "mqtt_disconnect failed (%d)", ret);
+
+	k_thread_join(&broker_thread, K_MSEC(WAIT_MS));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_inflight,
+			 ztest_unit_test(test_connect),
+			 ztest_unit_test(test_window_backpressure),
+			 ztest_unit_test(test_duplicate_message_id),
+			 ztest_unit_test(test_retransmit),
+			 ztest_unit_test(test_qos2_flow),
+			 ztest_unit_test(test_throughput),
+			 ztest_unit_test(test_disconnect));
+
+	ztest_run_test_suite(mqtt_inflight);
+}
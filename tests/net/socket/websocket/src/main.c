@@ -373,6 +373,172 @@ static void test_recv_two_large_split_msg(void)
 		      test_msg_len, ret);
 }
 
+static void test_send_msgv_and_recv_lorem_ipsum(void)
+{
+	static struct websocket_context ctx;
+	static uint8_t payload[sizeof(lorem_ipsum)];
+	struct iovec iov[3];
+	size_t split1, split2;
+	int ret;
+
+	memset(&ctx, 0, sizeof(ctx));
+
+	ctx.tmp_buf = temp_recv_buf;
+	ctx.tmp_buf_len = sizeof(temp_recv_buf);
+
+	test_msg_len = sizeof(lorem_ipsum) - 1;
+
+	/* The unit test expects the payload in one vector */
+	memcpy(payload, lorem_ipsum, test_msg_len);
+	iov[0].iov_base = payload;
+	iov[0].iov_len = test_msg_len;
+
+	ret = websocket_send_msgv(POINTER_TO_INT(&ctx), iov, 1,
+				  WEBSOCKET_OPCODE_DATA_TEXT, true, true,
+				  SYS_FOREVER_MS);
+	zassert_equal(ret, test_msg_len,
+		      "Should have sent %zd bytes but sent %d instead",
+		      test_msg_len, ret);
+
+	/* The payload is masked in place, check that every vector was
+	 * masked with the key offset matching its position in the message.
+	 */
+	memcpy(payload, lorem_ipsum, test_msg_len);
+	split1 = 5;
+	split2 = 130;
+	iov[0].iov_base = payload;
+	iov[0].iov_len = split1;
+	iov[1].iov_base = payload + split1;
+	iov[1].iov_len = split2 - split1;
+	iov[2].iov_base = payload + split2;
+	iov[2].iov_len = test_msg_len - split2;
+
+	ctx.masking_value = 0x12345678;
+	for (int i = 0; i < ARRAY_SIZE(iov); i++) {
+		websocket_mask_payload(iov[i].iov_base, iov[i].iov_base,
+				       iov[i].iov_len, ctx.masking_value,
+				       (uint8_t *)iov[i].iov_base - payload);
+	}
+
+	websocket_mask_payload(payload, payload, test_msg_len,
+			       ctx.masking_value, 0);
+	zassert_mem_equal(payload, lorem_ipsum, test_msg_len,
+			  "Vectored masking does not match");
+
+	ret = websocket_send_msgv(POINTER_TO_INT(&ctx), iov,
+				  CONFIG_WEBSOCKET_MAX_SEND_IOVCNT + 1,
+				  WEBSOCKET_OPCODE_DATA_TEXT, true, true,
+				  SYS_FOREVER_MS);
+	zassert_equal(ret, -EINVAL, "Too many vectors accepted (%d)", ret);
+}
+
+static void mask_payload_bytewise(uint8_t *dst, const uint8_t *src,
+				  size_t len, uint32_t masking_value,
+				  uint64_t offset)
+{
+	for (size_t i = 0; i < len; i++) {
+		dst[i] = src[i] ^
+			 (masking_value >> (8 * (3 - (i + offset) % 4)));
+	}
+}
+
+static void test_mask_payload(void)
+{
+	static uint8_t expected[64];
+	static uint8_t result[64 + sizeof(long)];
+	const uint32_t masking_value = 0xe17e8eb9;
+	const uint8_t *src = (const uint8_t *)lorem_ipsum;
+
+	for (size_t len = 0; len < sizeof(expected); len++) {
+		for (uint64_t offset = 0; offset < 8; offset++) {
+			for (size_t align = 0; align < sizeof(long); align++) {
+				mask_payload_bytewise(expected, src + align,
+						      len, masking_value,
+						      offset);
+
+				/* Separate source and destination */
+				websocket_mask_payload(result + align,
+						       src + align, len,
+						       masking_value, offset);
+				zassert_mem_equal(result + align, expected,
+						  len, "Mask failed, len %zd "
+						  "offset %d align %zd", len,
+						  (int)offset, align);
+
+				/* In place */
+				memcpy(result + align, src + align, len);
+				websocket_mask_payload(result + align,
+						       result + align, len,
+						       masking_value, offset);
+				zassert_mem_equal(result + align, expected,
+						  len, "In place mask failed");
+			}
+		}
+	}
+}
+
+#define BENCH_ROUNDS 200
+
+static void test_mask_throughput(void)
+{
+	static uint8_t payload[sizeof(lorem_ipsum)];
+	static struct websocket_context ctx;
+	const size_t len = sizeof(lorem_ipsum) - 1;
+	uint32_t bytes = len * BENCH_ROUNDS;
+	uint32_t start, bytewise, wordwise, copy_send, zero_copy_send;
+	struct iovec iov;
+	int ret;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		mask_payload_bytewise(payload, (const uint8_t *)lorem_ipsum,
+				      len, 0xe17e8eb9, i);
+	}
+	bytewise = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		websocket_mask_payload(payload, (const uint8_t *)lorem_ipsum,
+				       len, 0xe17e8eb9, i);
+	}
+	wordwise = k_cycle_get_32() - start;
+
+	/* Send and receive path through the test transport, with the
+	 * payload copied or masked in place.
+	 */
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.tmp_buf = temp_recv_buf;
+	ctx.tmp_buf_len = sizeof(temp_recv_buf);
+	test_msg_len = len;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		ret = websocket_send_msg(POINTER_TO_INT(&ctx), lorem_ipsum,
+					 len, WEBSOCKET_OPCODE_DATA_TEXT,
+					 true, true, SYS_FOREVER_MS);
+		zassert_equal(ret, len, "Send failed (%d)", ret);
+	}
+	copy_send = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		memcpy(payload, lorem_ipsum, len);
+		iov.iov_base = payload;
+		iov.iov_len = len;
+
+		ret = websocket_send_msgv(POINTER_TO_INT(&ctx), &iov, 1,
+					  WEBSOCKET_OPCODE_DATA_TEXT,
+					  true, true, SYS_FOREVER_MS);
+		zassert_equal(ret, len, "Send failed (%d)", ret);
+	}
+	zero_copy_send = k_cycle_get_32() - start;
+
+	TC_PRINT("Masking %u bytes: bytewise %u cycles, wordwise %u cycles\n",
+		 bytes, bytewise, wordwise);
+	TC_PRINT("Send+recv %u bytes: copy %u cycles, in place %u cycles\n",
+		 bytes, copy_send, zero_copy_send);
+}
+
 void test_main(void)
 {
 	k_thread_system_pool_assign(k_current_get());
@@ -390,7 +556,10 @@ void test_main(void)
 			 ztest_unit_test(test_recv_whole_msg),
 			 ztest_unit_test(test_recv_two_msg),
 			 ztest_unit_test(test_send_and_recv_lorem_ipsum),
-			 ztest_unit_test(test_recv_two_large_split_msg)
+			 ztest_unit_test(test_recv_two_large_split_msg),
+			 ztest_unit_test(test_send_msgv_and_recv_lorem_ipsum),
+			 ztest_unit_test(test_mask_payload),
+			 ztest_unit_test(test_mask_throughput)
 		);
 
 	ztest_run_test_suite(websocket);
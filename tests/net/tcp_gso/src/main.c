@@ -0,0 +1,305 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "tcp_internal.h"
+
+/* Small link MTU so that a modest TCP packet needs several segments */
+#define TEST_MTU 256
+
+#define SEG_SIZE (TEST_MTU - NET_IPV4TCPH_LEN)
+
+#define DATA_LEN (3 * SEG_SIZE + 100)
+#define SEG_COUNT ((DATA_LEN + SEG_SIZE - 1) / SEG_SIZE)
+
+#define MY_PORT 1234
+#define PEER_PORT 4321
+
+#define TEST_SEQ 0xfffffff0U
+#define TEST_ACK 0x12345678U
+
+#define WAIT_TIME K_SECONDS(1)
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface;
+static struct k_sem wait_data;
+
+static bool test_failed;
+static int seg_count;
+static size_t seg_data_len;
+static uint8_t seg_flags;
+
+struct net_if_test {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_iface_get_mac(const struct device *dev)
+{
+	struct net_if_test *data = dev->data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	data->ll_addr.addr = data->mac_addr;
+	data->ll_addr.len = 6U;
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int verify_segment(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	size_t len = net_pkt_get_len(pkt);
+	bool last = seg_count == SEG_COUNT - 1;
+	struct net_tcp_hdr *tcp_hdr;
+	size_t data_len;
+	uint8_t flags;
+	uint8_t data;
+	int i;
+
+	NET_DBG("Segment %d len %zd", seg_count, len);
+
+	if (seg_count >= SEG_COUNT || len > TEST_MTU ||
+	    ntohs(hdr->len) != len) {
+		return -EINVAL;
+	}
+
+	data_len = len - NET_IPV4TCPH_LEN;
+	if (data_len != (last ? DATA_LEN - seg_data_len : SEG_SIZE)) {
+		return -EINVAL;
+	}
+
+	/* Checksums computed over valid data are zero */
+	if (net_calc_chksum_ipv4(pkt) != 0U ||
+	    net_calc_chksum_tcp(pkt) != 0U) {
+		return -EINVAL;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, NET_IPV4H_LEN)) {
+		return -EINVAL;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt, &tcp_access);
+	if (!tcp_hdr || net_pkt_set_data(pkt, &tcp_access)) {
+		return -EINVAL;
+	}
+
+	if (sys_get_be32(tcp_hdr->seq) != TEST_SEQ + seg_data_len ||
+	    sys_get_be32(tcp_hdr->ack) != TEST_ACK) {
+		return -EINVAL;
+	}
+
+	/* PSH and FIN are only set in the last segment */
+	flags = last ? seg_flags : seg_flags & ~(PSH | FIN);
+	if (tcp_hdr->flags != flags) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < data_len; i++) {
+		if (net_pkt_read_u8(pkt, &data) ||
+		    data != (uint8_t)(seg_data_len + i)) {
+			return -EINVAL;
+		}
+	}
+
+	seg_data_len += data_len;
+	seg_count++;
+
+	return 0;
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	if (verify_segment(pkt) < 0) {
+		NET_DBG("Segment %d cannot be verified", seg_count);
+		test_failed = true;
+		k_sem_give(&wait_data);
+	} else if (seg_count == SEG_COUNT) {
+		k_sem_give(&wait_data);
+	}
+
+	return 0;
+}
+
+struct net_if_test net_iface_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(net_tcp_gso_test, "net_tcp_gso_test",
+		net_iface_dev_init, NULL, &net_iface_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE,
+		TEST_MTU);
+
+static struct net_pkt *create_tcp_pkt(uint8_t flags)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+	struct net_pkt *pkt;
+	int i, ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, NET_TCPH_LEN + DATA_LEN,
+					AF_INET, IPPROTO_TCP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt, &tcp_access);
+	zassert_not_null(tcp_hdr, "Cannot get TCP header");
+
+	memset(tcp_hdr, 0, NET_TCPH_LEN);
+
+	tcp_hdr->src_port = htons(MY_PORT);
+	tcp_hdr->dst_port = htons(PEER_PORT);
+	sys_put_be32(TEST_SEQ, tcp_hdr->seq);
+	sys_put_be32(TEST_ACK, tcp_hdr->ack);
+	tcp_hdr->offset = (NET_TCPH_LEN / 4U) << 4;
+	tcp_hdr->flags = flags;
+	sys_put_be16(1280U, tcp_hdr->wnd);
+
+	ret = net_pkt_set_data(pkt, &tcp_access);
+	zassert_equal(ret, 0, "Cannot set TCP header");
+
+	for (i = 0; i < DATA_LEN; i++) {
+		ret = net_pkt_write_u8(pkt, (uint8_t)i);
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_set_gso_size(pkt, SEG_SIZE);
+
+	net_pkt_cursor_init(pkt);
+
+	ret = net_ipv4_finalize(pkt, IPPROTO_TCP);
+	zassert_equal(ret, 0, "Cannot finalize packet");
+
+	return pkt;
+}
+
+static void test_setup(void)
+{
+	struct net_if_addr *ifaddr;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "Interface is NULL");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_up(iface);
+}
+
+static void send_and_capture(uint8_t flags)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = create_tcp_pkt(flags);
+
+	test_failed = false;
+	seg_count = 0;
+	seg_data_len = 0;
+	seg_flags = flags;
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send (%d)", ret);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting segments");
+
+	zassert_false(test_failed, "Segment verify failed");
+	zassert_equal(seg_count, SEG_COUNT, "Invalid segment count %d",
+		      seg_count);
+	zassert_equal(seg_data_len, DATA_LEN, "Invalid data length %zu",
+		      seg_data_len);
+}
+
+static void test_send_tcp_gso(void)
+{
+	send_and_capture(PSH | ACK);
+}
+
+static void test_send_tcp_gso_fin(void)
+{
+	send_and_capture(FIN | PSH | ACK);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tcp_gso_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_tcp_gso),
+			 ztest_unit_test(test_send_tcp_gso_fin)
+			 );
+
+	ztest_run_test_suite(net_tcp_gso_test);
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Sector cache of the disk access layer, on top of a RAM disk counting the
+ * accesses which reach it:
+ * * modified sectors are only written on eviction or sync with write-back
+ * * reads return the data written, through the cache and around it
+ * * least recently used sectors are evicted
+ * * sync and detach write the modified sectors back in ascending order
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <init.h>
+#include <storage/disk_access.h>
+
+#define DISK_NAME		"CACHE"
+#define SECTOR_SIZE		512
+#define DISK_SECTORS		32
+#define CACHE_SECTORS		4
+#define MAX_WRITES		8
+
+static uint8_t disk_data[DISK_SECTORS * SECTOR_SIZE];
+static uint32_t disk_reads;
+static uint32_t disk_writes;
+/* first sector of each write which reached the disk */
+static uint32_t disk_write_log[MAX_WRITES];
+
+static uint8_t buf[3 * SECTOR_SIZE];
+static uint8_t expected[3 * SECTOR_SIZE];
+
+DISK_CACHE_DEFINE(test_cache, CACHE_SECTORS, SECTOR_SIZE);
+
+static int test_disk_status(struct disk_info *disk)
+{
+	return DISK_STATUS_OK;
+}
+
+static int test_disk_init(struct disk_info *disk)
+{
+	return 0;
+}
+
+static int test_disk_read(struct disk_info *disk, uint8_t *data_buf,
+			  uint32_t sector, uint32_t count)
+{
+	memcpy(data_buf, &disk_data[sector * SECTOR_SIZE],
+	       count * SECTOR_SIZE);
+	disk_reads++;
+
+	return 0;
+}
+
+static int test_disk_write(struct disk_info *disk, const uint8_t *data_buf,
+			   uint32_t sector, uint32_t count)
+{
+	memcpy(&disk_data[sector * SECTOR_SIZE], data_buf,
+	       count * SECTOR_SIZE);
+	if (disk_writes < MAX_WRITES) {
+		disk_write_log[disk_writes] = sector;
+	}
+	disk_writes++;
+
+	return 0;
+}
+
+static int test_disk_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
+{
+	switch (cmd) {
+	case DISK_IOCTL_CTRL_SYNC:
+		break;
+	case DISK_IOCTL_GET_SECTOR_COUNT:
+		*(uint32_t *)buff = DISK_SECTORS;
+		break;
+	case DISK_IOCTL_GET_SECTOR_SIZE:
+		*(uint32_t *)buff = SECTOR_SIZE;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static const struct disk_operations test_disk_ops = {
+	.init = test_disk_init,
+	.status = test_disk_status,
+	.read = test_disk_read,
+	.write = test_disk_write,
+	.ioctl = test_disk_ioctl,
+};
+
+static struct disk_info test_disk = {
+	.name = DISK_NAME,
+	.ops = &test_disk_ops,
+};
+
+static int test_disk_register(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return disk_access_register(&test_disk);
+}
+
+SYS_INIT(test_disk_register, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+static void fill(uint8_t *data, uint32_t sector, uint32_t count, uint8_t seed)
+{
+	for (uint32_t i = 0; i < count * SECTOR_SIZE; i++) {
+		data[i] = (uint8_t)((sector + i / SECTOR_SIZE) * 31 + i + seed);
+	}
+}
+
+static void write_sector(uint32_t sector, uint8_t seed)
+{
+	fill(buf, sector, 1, seed);
+	zassert_equal(disk_access_write(DISK_NAME, buf, sector, 1), 0,
+		      "Write of sector %u failed", sector);
+}
+
+/* Read sectors through the disk access API and check their content */
+static void check_read(uint32_t sector, uint32_t count, uint8_t seed)
+{
+	fill(expected, sector, count, seed);
+	zassert_equal(disk_access_read(DISK_NAME, buf, sector, count), 0,
+		      "Read of sector %u failed", sector);
+	zassert_mem_equal(buf, expected, count * SECTOR_SIZE,
+			  "Sector %u read mismatch", sector);
+}
+
+/* Check the content of a sector on the disk, behind the cache */
+static void check_disk(uint32_t sector, uint8_t seed)
+{
+	fill(expected, sector, 1, seed);
+	zassert_mem_equal(&disk_data[sector * SECTOR_SIZE], expected,
+			  SECTOR_SIZE, "Sector %u on disk mismatch", sector);
+}
+
+static void cache_setup(void)
+{
+	for (uint32_t i = 0; i < DISK_SECTORS; i++) {
+		fill(&disk_data[i * SECTOR_SIZE], i, 1, 0);
+	}
+
+	zassert_equal(disk_access_init(DISK_NAME), 0, "Disk init failed");
+	zassert_equal(disk_access_cache_attach(DISK_NAME, &test_cache), 0,
+		      "Cache attach failed");
+
+	disk_reads = 0U;
+	disk_writes = 0U;
+}
+
+static void cache_teardown(void)
+{
+	(void)disk_access_cache_detach(DISK_NAME);
+}
+
+static void test_attach(void)
+{
+	zassert_equal(disk_access_cache_attach(DISK_NAME, &test_cache), -EBUSY,
+		      "Cache attached twice");
+	zassert_equal(disk_access_cache_detach(DISK_NAME), 0,
+		      "Cache detach failed");
+	zassert_equal(disk_access_cache_detach(DISK_NAME), -EINVAL,
+		      "Cache detached twice");
+}
+
+static void test_write_back(void)
+{
+	struct disk_cache_stats stats;
+
+	write_sector(1, 1);
+
+	if (IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK)) {
+		zassert_equal(disk_writes, 0, "Sector written through");
+		check_disk(1, 0);
+	} else {
+		zassert_equal(disk_writes, 1, "Sector not written through");
+		check_disk(1, 1);
+	}
+
+	/* read back from the cache, or from the disk when written through */
+	check_read(1, 1, 1);
+	zassert_equal(disk_reads,
+		      IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK) ? 0 : 1,
+		      "Bad read count %u", disk_reads);
+
+	zassert_equal(disk_access_ioctl(DISK_NAME, DISK_IOCTL_CTRL_SYNC, NULL),
+		      0, "Sync failed");
+	zassert_equal(disk_writes, 1, "Sector not written once");
+	check_disk(1, 1);
+
+	zassert_equal(disk_access_cache_stats_get(DISK_NAME, &stats), 0,
+		      "No stats");
+	zassert_equal(stats.hits,
+		      IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK) ? 1 : 0,
+		      "Bad hit count %u", stats.hits);
+	zassert_equal(stats.misses,
+		      IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK) ? 0 : 1,
+		      "Bad miss count %u", stats.misses);
+	zassert_equal(stats.write_backs,
+		      IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK) ? 1 : 0,
+		      "Bad write back count %u", stats.write_backs);
+
+	/* nothing left to write */
+	zassert_equal(disk_access_ioctl(DISK_NAME, DISK_IOCTL_CTRL_SYNC, NULL),
+		      0, "Sync failed");
+	zassert_equal(disk_writes, 1, "Sector written again");
+}
+
+static void test_coherence(void)
+{
+	/* cached sector updated by a write bypassing the cache */
+	check_read(2, 1, 0);
+	fill(buf, 2, 3, 2);
+	zassert_equal(disk_access_write(DISK_NAME, buf, 2, 3), 0,
+		      "Write failed");
+	check_read(2, 1, 2);
+	check_disk(3, 2);
+	zassert_equal(disk_reads, 1, "Cached sector read again");
+
+	/* modified sector returned by a read bypassing the cache */
+	write_sector(6, 3);
+	fill(expected, 5, 3, 0);
+	fill(&expected[SECTOR_SIZE], 6, 1, 3);
+	zassert_equal(disk_access_read(DISK_NAME, buf, 5, 3), 0,
+		      "Read failed");
+	zassert_mem_equal(buf, expected, 3 * SECTOR_SIZE,
+			  "Read around the cache mismatch");
+}
+
+static void test_eviction(void)
+{
+	/* fill the cache, sectors written through are cached once read */
+	for (uint32_t i = 0; i < CACHE_SECTORS; i++) {
+		write_sector(i, 4);
+		check_read(i, 1, 4);
+	}
+
+	/* make sector 0 the most recently used, sector 1 the least */
+	check_read(0, 1, 4);
+
+	disk_reads = 0U;
+	disk_writes = 0U;
+	check_read(10, 1, 0);
+	zassert_equal(disk_reads, 1, "Missing sector not read");
+
+	if (IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK)) {
+		zassert_equal(disk_writes, 1, "Evicted sector not written");
+		zassert_equal(disk_write_log[0], 1, "Bad sector evicted");
+	} else {
+		zassert_equal(disk_writes, 0, "Clean sector written");
+	}
+	check_disk(1, 4);
+
+	/* still cached */
+	check_read(0, 1, 4);
+	zassert_equal(disk_reads, 1, "Cached sector read from disk");
+
+	/* evicted */
+	check_read(1, 1, 4);
+	zassert_equal(disk_reads, 2, "Evicted sector not read from disk");
+}
+
+static void test_sync(void)
+{
+	static const uint32_t sectors[] = { 7, 3, 5 };
+
+	for (int i = 0; i < ARRAY_SIZE(sectors); i++) {
+		write_sector(sectors[i], 5);
+	}
+
+	if (!IS_ENABLED(CONFIG_DISK_CACHE_WRITE_BACK)) {
+		zassert_equal(disk_writes, 3, "Sectors not written through");
+		return;
+	}
+
+	disk_writes = 0U;
+	zassert_equal(disk_access_ioctl(DISK_NAME, DISK_IOCTL_CTRL_SYNC, NULL),
+		      0, "Sync failed");
+	zassert_equal(disk_writes, 3, "Bad write count %u", disk_writes);
+	zassert_equal(disk_write_log[0], 3, "Not written in order");
+	zassert_equal(disk_write_log[1], 5, "Not written in order");
+	zassert_equal(disk_write_log[2], 7, "Not written in order");
+
+	/* the cache is written back when detached */
+	write_sector(9, 6);
+	write_sector(8, 6);
+	disk_writes = 0U;
+	zassert_equal(disk_access_cache_detach(DISK_NAME), 0,
+		      "Cache detach failed");
+	zassert_equal(disk_writes, 2, "Bad write count %u", disk_writes);
+	zassert_equal(disk_write_log[0], 8, "Not written in order");
+	check_disk(8, 6);
+	check_disk(9, 6);
+
+	/* accesses go to the disk once detached */
+	disk_reads = 0U;
+	check_read(9, 1, 6);
+	zassert_equal(disk_reads, 1, "Sector not read from disk");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(disk_cache_test,
+			 ztest_unit_test_setup_teardown(test_attach,
+							cache_setup,
+							cache_teardown),
+			 ztest_unit_test_setup_teardown(test_write_back,
+							cache_setup,
+							cache_teardown),
+			 ztest_unit_test_setup_teardown(test_coherence,
+							cache_setup,
+							cache_teardown),
+			 ztest_unit_test_setup_teardown(test_eviction,
+							cache_setup,
+							cache_teardown),
+			 ztest_unit_test_setup_teardown(test_sync,
+							cache_setup,
+							cache_teardown));
+
+	ztest_run_test_suite(disk_cache_test);
+}
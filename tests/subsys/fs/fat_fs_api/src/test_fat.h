@@ -29,5 +29,6 @@ void test_fat_unmount(void);
 void test_fat_file(void);
 void test_fat_dir(void);
 void test_fat_fs(void);
+void test_fat_free_map(void);
 void test_fat_rename(void);
 void test_fat_mount_rd_only(void);
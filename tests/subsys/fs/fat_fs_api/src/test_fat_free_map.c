@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Free cluster accounting:
+ * * fs_statvfs follows clusters allocated and freed by writes, truncation,
+ *   renames, directories and unlinking
+ * * the count is the same as found by FatFs reading the whole FAT
+ * * the free cluster map matches the FAT, when enabled
+ */
+
+#include "test_fat.h"
+#include <ff.h>
+#include <string.h>
+
+#define MAP_FILE_A	FATFS_MNTP"/mapa.bin"
+#define MAP_FILE_B	FATFS_MNTP"/mapb.bin"
+#define MAP_DIR		FATFS_MNTP"/mapdir"
+
+static uint8_t chunk[512];
+
+static uint32_t free_clusters(uint32_t *csize)
+{
+	struct fs_statvfs stat;
+
+	zassert_equal(fs_statvfs(FATFS_MNTP, &stat), 0, "statvfs failed");
+	if (csize != NULL) {
+		*csize = stat.f_frsize;
+	}
+
+	return stat.f_bfree;
+}
+
+/* Have FatFs count the free clusters again by reading the whole FAT */
+static uint32_t free_clusters_in_fat(void)
+{
+	FATFS *fs;
+	DWORD nclst;
+
+	zassert_equal(f_getfree(&FATFS_MNTP[1], &nclst, &fs), FR_OK,
+		      "f_getfree failed");
+	fs->free_clst = 0xFFFFFFFF;
+	zassert_equal(f_getfree(&FATFS_MNTP[1], &nclst, &fs), FR_OK,
+		      "f_getfree failed");
+
+	return nclst;
+}
+
+#if defined(CONFIG_FS_FATFS_FREE_MAP)
+/* Provided by the FAT file system driver for tests */
+int fatfs_free_map_verify(FATFS *fs);
+#endif
+
+/* Check each cluster of the free cluster map and its count against the FAT */
+static void check_free_map(void)
+{
+#if defined(CONFIG_FS_FATFS_FREE_MAP)
+	FATFS *fs;
+	DWORD nclst;
+
+	zassert_equal(f_getfree(&FATFS_MNTP[1], &nclst, &fs), FR_OK,
+		      "f_getfree failed");
+	zassert_equal(fatfs_free_map_verify(fs), 0,
+		      "free cluster map differs from FAT");
+#endif
+}
+
+static void append_clusters(const char *path, uint32_t csize, int n)
+{
+	struct fs_file_t file;
+
+	fs_file_t_init(&file);
+	zassert_equal(fs_open(&file, path,
+			      FS_O_CREATE | FS_O_WRITE | FS_O_APPEND),
+		      0, "open failed");
+
+	(void)memset(chunk, 0xa5, sizeof(chunk));
+	for (uint32_t off = 0; off < n * csize; off += sizeof(chunk)) {
+		zassert_equal(fs_write(&file, chunk, sizeof(chunk)),
+			      sizeof(chunk), "write failed");
+	}
+
+	zassert_equal(fs_close(&file), 0, "close failed");
+}
+
+static void truncate_file(const char *path, off_t length)
+{
+	struct fs_file_t file;
+
+	fs_file_t_init(&file);
+	zassert_equal(fs_open(&file, path, FS_O_WRITE), 0, "open failed");
+	zassert_equal(fs_truncate(&file, length), 0, "truncate failed");
+	zassert_equal(fs_close(&file), 0, "close failed");
+}
+
+void test_fat_free_map(void)
+{
+	uint32_t free0, csize;
+
+	free0 = free_clusters(&csize);
+	zassert_equal(free_clusters_in_fat(), free0,
+		      "free cluster count differs from FAT");
+	check_free_map();
+
+	append_clusters(MAP_FILE_A, csize, 3);
+	zassert_equal(free_clusters(NULL), free0 - 3, "write not counted");
+	check_free_map();
+
+	append_clusters(MAP_FILE_B, csize, 2);
+	zassert_equal(free_clusters(NULL), free0 - 5, "write not counted");
+	check_free_map();
+
+	truncate_file(MAP_FILE_A, csize);
+	zassert_equal(free_clusters(NULL), free0 - 3, "truncate not counted");
+	check_free_map();
+
+	append_clusters(MAP_FILE_A, csize, 2);
+	zassert_equal(free_clusters(NULL), free0 - 5, "append not counted");
+	check_free_map();
+
+	/* Replaces the file with three clusters */
+	zassert_equal(fs_rename(MAP_FILE_B, MAP_FILE_A), 0, "rename failed");
+	zassert_equal(free_clusters(NULL), free0 - 2, "rename not counted");
+	check_free_map();
+
+	zassert_equal(fs_mkdir(MAP_DIR), 0, "mkdir failed");
+	zassert_equal(free_clusters(NULL), free0 - 3, "mkdir not counted");
+	check_free_map();
+
+	zassert_equal(fs_unlink(MAP_FILE_A), 0, "unlink failed");
+	zassert_equal(fs_unlink(MAP_DIR), 0, "unlink failed");
+	zassert_equal(free_clusters(NULL), free0, "unlink not counted");
+	check_free_map();
+
+	zassert_equal(free_clusters_in_fat(), free0,
+		      "free cluster count differs from FAT");
+}
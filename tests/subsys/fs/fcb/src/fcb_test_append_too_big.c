@@ -18,9 +18,10 @@ void (test_fcb_append_too_big(void))
 
 		/*
 		 * Max element which fits inside sector is
-		 * sector size - (disk header + crc + 1-2 bytes of length).
+		 * sector size - (disk header + crc + 1-2 bytes of length),
+		 * less the sector summary if enabled.
 		 */
-		len = fcb->f_active.fe_sector->fs_size;
+		len = fcb_sector_limit(fcb, fcb->f_active.fe_sector);
 
 		rc = fcb_append(fcb, len, &elem_loc);
 		zassert_true(rc != 0,
@@ -36,7 +37,7 @@ void (test_fcb_append_too_big(void))
 		zassert_true(rc != 0,
 			     "fcb_append call should fail for too big entry");
 
-		len = fcb->f_active.fe_sector->fs_size -
+		len = fcb_sector_limit(fcb, fcb->f_active.fe_sector) -
 			(sizeof(struct fcb_disk_area) + 1 + 2);
 		rc = fcb_append(fcb, len, &elem_loc);
 		zassert_true(rc == 0, "fcb_append call failure");
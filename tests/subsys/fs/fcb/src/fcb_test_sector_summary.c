@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fcb_test.h"
+
+#if defined(CONFIG_FCB_SECTOR_SUMMARY)
+
+#define ENTRY_LEN(i) ((i) % 100)
+
+static void append_entry(struct fcb *fcb, int i)
+{
+	uint8_t test_data[100];
+	struct fcb_entry loc;
+	int len = ENTRY_LEN(i);
+	int rc;
+	int j;
+
+	for (j = 0; j < len; j++) {
+		test_data[j] = fcb_test_append_data(i, j);
+	}
+
+	rc = fcb_append(fcb, len, &loc);
+	zassert_true(rc == 0, "fcb_append call failure");
+	rc = flash_area_write(fcb->fap, FCB_ENTRY_FA_DATA_OFF(loc), test_data,
+			      len);
+	zassert_true(rc == 0, "flash_area_write call failure");
+	rc = fcb_append_finish(fcb, &loc);
+	zassert_true(rc == 0, "fcb_append_finish call failure");
+}
+
+static int summary_walk_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	uint8_t test_data[100];
+	int *var_cnt = (int *)arg;
+	int len = ENTRY_LEN(*var_cnt);
+	int rc;
+	int j;
+
+	zassert_true(entry_ctx->loc.fe_data_len == len,
+		     "entry length read different than expected");
+
+	rc = flash_area_read(entry_ctx->fap,
+			     FCB_ENTRY_FA_DATA_OFF(entry_ctx->loc),
+			     test_data, len);
+	zassert_true(rc == 0, "read call failure");
+
+	for (j = 0; j < len; j++) {
+		zassert_true(test_data[j] == fcb_test_append_data(*var_cnt, j),
+			     "fcb_test_append_data redout misrepresentation");
+	}
+	(*var_cnt)++;
+	return 0;
+}
+
+static void check_entries(struct fcb *fcb, int cnt)
+{
+	struct fcb_entry_ctx entry_ctx;
+	int var_cnt;
+	int rc;
+
+	var_cnt = 0;
+	rc = fcb_walk(fcb, NULL, summary_walk_cb, &var_cnt);
+	zassert_true(rc == 0, "fcb_walk call failure");
+	zassert_true(var_cnt == cnt,
+		     "fcb_walk: elements count read different than expected");
+
+	var_cnt = 0;
+	(void)memset(&entry_ctx, 0, sizeof(entry_ctx));
+	entry_ctx.fap = fcb->fap;
+	while (fcb_getnext(fcb, &entry_ctx.loc) == 0) {
+		summary_walk_cb(&entry_ctx, &var_cnt);
+	}
+	zassert_true(var_cnt == cnt,
+		     "fcb_getnext: elements count read different than expected");
+}
+
+static void remount(struct fcb *fcb)
+{
+	int rc;
+
+	(void)memset(fcb, 0, sizeof(*fcb));
+	fcb->f_erase_value = fcb_test_erase_value;
+	fcb->f_sector_cnt = 4U;
+	fcb->f_sectors = test_fcb_sector;
+
+	rc = fcb_init(TEST_FCB_FLASH_AREA_ID, fcb);
+	zassert_true(rc == 0, "fcb_init call failure");
+}
+
+void test_fcb_sector_summary(void)
+{
+	struct fcb *fcb;
+	struct flash_sector *closed;
+	int cnt;
+
+	fcb = &test_fcb;
+
+	/* Fill the first two sectors, which closes them */
+	for (cnt = 0; fcb->f_active.fe_sector != &test_fcb_sector[2]; cnt++) {
+		append_entry(fcb, cnt);
+	}
+
+	zassert_true(fcb_summary_valid(fcb, &test_fcb_sector[0]),
+		     "closed sector should have a valid summary");
+	zassert_true(fcb_summary_valid(fcb, &test_fcb_sector[1]),
+		     "closed sector should have a valid summary");
+	zassert_false(fcb_summary_valid(fcb, &test_fcb_sector[2]),
+		      "active sector should not have a summary");
+	check_entries(fcb, cnt);
+
+	/* Summaries are checked again after a reset */
+	remount(fcb);
+	zassert_true(fcb->f_active.fe_sector == &test_fcb_sector[2],
+		     "unexpected active sector after reset");
+	check_entries(fcb, cnt);
+	zassert_true(fcb_summary_valid(fcb, &test_fcb_sector[0]),
+		     "closed sector should have a valid summary");
+
+	/* Pretend reset after closing the active sector, but before moving on */
+	closed = fcb->f_active.fe_sector;
+	fcb_sector_close(fcb);
+	remount(fcb);
+	zassert_true(fcb->f_active.fe_sector == closed,
+		     "unexpected active sector after reset");
+	zassert_true(fcb->f_active.fe_elem_off ==
+		     fcb_sector_limit(fcb, closed),
+		     "closed sector should have no room left");
+
+	append_entry(fcb, cnt++);
+	zassert_true(fcb->f_active.fe_sector == &test_fcb_sector[3],
+		     "entry should go to the next sector");
+	zassert_true(fcb_summary_valid(fcb, closed),
+		     "closed sector should have a valid summary");
+	check_entries(fcb, cnt);
+}
+
+#else
+
+void test_fcb_sector_summary(void)
+{
+	ztest_test_skip();
+}
+
+#endif /* CONFIG_FCB_SECTOR_SUMMARY */
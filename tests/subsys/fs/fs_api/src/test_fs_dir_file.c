@@ -684,6 +684,51 @@ void test_file_read(void)
 	TC_PRINT("Data read matches data written\n");
 }
 
+/**
+ * @brief Test fs_readv() and fs_writev() interfaces in file system core
+ *
+ * @ingroup filesystem_api
+ */
+void test_file_readv_writev(void)
+{
+	char read_buff[8];
+	struct fs_iovec iov[] = {
+		{ .base = read_buff, .len = 0 },
+		{ .base = read_buff, .len = sizeof(read_buff) },
+	};
+	ssize_t brw;
+
+	TC_PRINT("\nVectored read and write tests:\n");
+
+	TC_PRINT("Read and write an unopened file\n");
+	fs_file_t_init(&err_filep);
+	brw = fs_readv(&err_filep, iov, ARRAY_SIZE(iov));
+	zassert_equal(brw, -EBADF, "Can't read an unopened file");
+	brw = fs_writev(&err_filep, iov, ARRAY_SIZE(iov));
+	zassert_equal(brw, -EBADF, "Can't write an unopened file");
+
+	TC_PRINT("Filesystem has no read and write interface\n");
+	err_filep.mp = &test_fs_mnt_no_op;
+	brw = fs_readv(&err_filep, iov, ARRAY_SIZE(iov));
+	zassert_equal(brw, -ENOTSUP, "Filesystem has no read interface");
+	brw = fs_writev(&err_filep, iov, ARRAY_SIZE(iov));
+	zassert_equal(brw, -ENOTSUP, "Filesystem has no write interface");
+
+	TC_PRINT("Negative buffer count\n");
+	brw = fs_readv(&filep, iov, -1);
+	zassert_equal(brw, -EINVAL, "Negative buffer count accepted");
+	brw = fs_writev(&filep, iov, -1);
+	zassert_equal(brw, -EINVAL, "Negative buffer count accepted");
+
+	TC_PRINT("Read at end of file\n");
+	brw = fs_readv(&filep, iov, ARRAY_SIZE(iov));
+	zassert_equal(brw, 0, "Read past end of file");
+
+	TC_PRINT("Write nothing\n");
+	brw = fs_writev(&filep, iov, 1);
+	zassert_equal(brw, 0, "Empty write failed");
+}
+
 /**
  * @brief fs_seek tests for expected ENOTSUP
  *
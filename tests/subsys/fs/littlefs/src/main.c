@@ -23,6 +23,10 @@ void test_main(void)
 			 ztest_unit_test(test_lfs_basic),
 			 ztest_unit_test(test_lfs_dirops),
 			 ztest_unit_test(test_lfs_perf),
+			 ztest_unit_test(test_lfs_iov),
+			 ztest_unit_test(test_lfs_async),
+			 ztest_unit_test(test_lfs_async_unmount),
+			 ztest_unit_test(test_lfs_async_unmount_worker),
 			 ztest_unit_test(test_fs_open_flags_lfs),
 			 ztest_unit_test(test_fs_mount_flags)
 			 );
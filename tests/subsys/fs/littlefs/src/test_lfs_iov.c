@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Vectored and asynchronous littlefs I/O:
+ * * writev
+ * * readv
+ * * asynchronous write, sync and read
+ * * unmount with an asynchronous request pending
+ * * unmount from a request run by a worker of the queue
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include "testfs_tests.h"
+#include "testfs_lfs.h"
+
+#define IOV_NAME "iov"
+#define IOV_LEN 300
+
+static uint8_t pattern[IOV_LEN];
+static uint8_t readback[IOV_LEN + 16];
+
+static void fill_pattern(void)
+{
+	for (int i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = (uint8_t)(i * 7 + 3);
+	}
+}
+
+static void open_iov_file(struct fs_mount_t *mp, struct fs_file_t *file)
+{
+	struct testfs_path path;
+
+	zassert_equal(testfs_lfs_wipe_partition(mp), TC_PASS,
+		      "failed to wipe partition");
+	zassert_equal(fs_mount(mp), 0, "mount failed");
+
+	fs_file_t_init(file);
+	zassert_equal(fs_open(file,
+			      testfs_path_init(&path, mp, IOV_NAME,
+					       TESTFS_PATH_END),
+			      FS_O_CREATE | FS_O_RDWR),
+		      0, "open failed");
+}
+
+static void close_iov_file(struct fs_mount_t *mp, struct fs_file_t *file)
+{
+	zassert_equal(fs_close(file), 0, "close failed");
+	zassert_equal(fs_unmount(mp), 0, "unmount failed");
+}
+
+void test_lfs_iov(void)
+{
+	struct fs_mount_t *mp = &testfs_small_mnt;
+	struct fs_file_t file;
+	struct fs_iovec wr_iov[] = {
+		{ .base = &pattern[0], .len = 1 },
+		{ .base = &pattern[1], .len = 0 },
+		{ .base = &pattern[1], .len = 200 },
+		{ .base = &pattern[201], .len = IOV_LEN - 201 },
+	};
+	struct fs_iovec rd_iov[] = {
+		{ .base = &readback[0], .len = 100 },
+		{ .base = &readback[100], .len = sizeof(readback) - 100 },
+	};
+	ssize_t rc;
+
+	fill_pattern();
+	open_iov_file(mp, &file);
+
+	zassert_equal(fs_writev(&file, wr_iov, -1), -EINVAL,
+		      "negative count accepted");
+	zassert_equal(fs_writev(&file, wr_iov, 0), 0,
+		      "empty write failed");
+
+	rc = fs_writev(&file, wr_iov, ARRAY_SIZE(wr_iov));
+	zassert_equal(rc, IOV_LEN, "writev failed: %d", (int)rc);
+
+	zassert_equal(fs_seek(&file, 0, FS_SEEK_SET), 0, "seek failed");
+	(void)memset(readback, 0, sizeof(readback));
+
+	/* Reading past the end of file fills the first buffer only */
+	rc = fs_readv(&file, rd_iov, ARRAY_SIZE(rd_iov));
+	zassert_equal(rc, IOV_LEN, "readv failed: %d", (int)rc);
+	zassert_mem_equal(readback, pattern, IOV_LEN, "readv data differs");
+
+	rc = fs_readv(&file, rd_iov, ARRAY_SIZE(rd_iov));
+	zassert_equal(rc, 0, "readv at end of file: %d", (int)rc);
+
+	close_iov_file(mp, &file);
+
+	zassert_equal(fs_readv(&file, rd_iov, ARRAY_SIZE(rd_iov)), -EBADF,
+		      "readv of closed file");
+}
+
+#if defined(CONFIG_FILE_SYSTEM_ASYNC)
+
+static K_SEM_DEFINE(async_done, 0, 1);
+static ssize_t async_result;
+
+static void async_cb(struct fs_async_req *req, ssize_t result)
+{
+	async_result = result;
+	k_sem_give(&async_done);
+}
+
+static ssize_t async_run(struct fs_async_req *req)
+{
+	zassert_equal(fs_async_submit(req), 0, "submit failed");
+	zassert_equal(k_sem_take(&async_done, K_SECONDS(10)), 0,
+		      "request did not complete");
+	zassert_equal(req->result, async_result, "result differs");
+
+	return async_result;
+}
+
+void test_lfs_async(void)
+{
+	struct fs_mount_t *mp = &testfs_small_mnt;
+	struct fs_file_t file;
+	struct fs_iovec wr_iov[] = {
+		{ .base = &pattern[0], .len = 10 },
+		{ .base = &pattern[10], .len = IOV_LEN - 10 },
+	};
+	struct fs_iovec rd_iov = {
+		.base = readback,
+		.len = sizeof(readback),
+	};
+	struct fs_async_req req = {
+		.zfp = &file,
+		.cb = async_cb,
+	};
+	ssize_t rc;
+
+	fill_pattern();
+	open_iov_file(mp, &file);
+
+	req.op = FS_ASYNC_WRITE;
+	req.iov = wr_iov;
+	req.iovcnt = ARRAY_SIZE(wr_iov);
+	rc = async_run(&req);
+	zassert_equal(rc, IOV_LEN, "async write failed: %d", (int)rc);
+
+	req.op = FS_ASYNC_SYNC;
+	rc = async_run(&req);
+	zassert_equal(rc, 0, "async sync failed: %d", (int)rc);
+
+	zassert_equal(fs_seek(&file, 0, FS_SEEK_SET), 0, "seek failed");
+	(void)memset(readback, 0, sizeof(readback));
+
+	req.op = FS_ASYNC_READ;
+	req.iov = &rd_iov;
+	req.iovcnt = 1;
+	rc = async_run(&req);
+	zassert_equal(rc, IOV_LEN, "async read failed: %d", (int)rc);
+	zassert_mem_equal(readback, pattern, IOV_LEN, "async data differs");
+
+	close_iov_file(mp, &file);
+
+	zassert_equal(fs_async_submit(&req), -EBADF,
+		      "request on closed file accepted");
+}
+
+static struct testfs_path unmount_path;
+static int unmount_stat_rc;
+static int unmount_own_rc;
+
+static void unmount_cb(struct fs_async_req *req, ssize_t result)
+{
+	struct fs_dirent stat;
+
+	/* fs_unmount() does not hold the mount lock while waiting for us */
+	unmount_stat_rc = fs_stat(unmount_path.path, &stat);
+	unmount_own_rc = fs_unmount(&testfs_small_mnt);
+
+	(void)fs_close(req->zfp);
+}
+
+void test_lfs_async_unmount(void)
+{
+	struct fs_mount_t *mp = &testfs_small_mnt;
+	struct fs_file_t file;
+	struct fs_async_req req = {
+		.zfp = &file,
+		.op = FS_ASYNC_SYNC,
+		.cb = unmount_cb,
+	};
+
+	testfs_path_init(&unmount_path, mp, IOV_NAME, TESTFS_PATH_END);
+	unmount_stat_rc = -EINPROGRESS;
+	unmount_own_rc = -EINPROGRESS;
+	open_iov_file(mp, &file);
+
+	zassert_equal(fs_async_submit(&req), 0, "submit failed");
+	zassert_equal(fs_unmount(mp), 0, "unmount failed");
+
+	zassert_equal(req.result, 0, "request did not complete");
+	zassert_equal(unmount_stat_rc, 0, "stat from callback failed: %d",
+		      unmount_stat_rc);
+	zassert_equal(unmount_own_rc, -EDEADLK,
+		      "unmount from callback: %d", unmount_own_rc);
+}
+
+#if defined(CONFIG_WORKQUEUE_WORKERS)
+
+#define UNMOUNT_WQ_STACK_SIZE 2048
+
+static K_THREAD_STACK_DEFINE(unmount_wq_stack, UNMOUNT_WQ_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(unmount_worker_stack, UNMOUNT_WQ_STACK_SIZE);
+static struct k_work_q unmount_wq;
+static struct k_work_q_worker unmount_worker;
+static K_SEM_DEFINE(unmount_blocked, 0, 1);
+static K_SEM_DEFINE(unmount_release, 0, 1);
+
+static void unmount_block(struct k_work *work)
+{
+	k_sem_give(&unmount_blocked);
+	(void)k_sem_take(&unmount_release, K_FOREVER);
+}
+
+void test_lfs_async_unmount_worker(void)
+{
+	struct fs_mount_t *mp = &testfs_small_mnt;
+	struct fs_file_t file;
+	struct k_work_sync sync;
+	struct k_work block;
+	struct fs_async_req req = {
+		.zfp = &file,
+		.op = FS_ASYNC_SYNC,
+		.cb = unmount_cb,
+	};
+
+	k_work_queue_start(&unmount_wq, unmount_wq_stack,
+			   K_THREAD_STACK_SIZEOF(unmount_wq_stack),
+			   K_PRIO_PREEMPT(1), NULL);
+
+	/* Keep the queue thread busy, so that the request is run by the
+	 * worker added afterwards.
+	 */
+	k_work_init(&block, unmount_block);
+	(void)k_work_submit_to_queue(&unmount_wq, &block);
+	zassert_equal(k_sem_take(&unmount_blocked, K_SECONDS(1)), 0,
+		      "queue thread not blocked");
+	zassert_equal(k_work_queue_add_worker(&unmount_wq, &unmount_worker,
+					      unmount_worker_stack,
+					      K_THREAD_STACK_SIZEOF(
+						      unmount_worker_stack),
+					      -1),
+		      0, "worker not added");
+
+	testfs_path_init(&unmount_path, mp, IOV_NAME, TESTFS_PATH_END);
+	unmount_stat_rc = -EINPROGRESS;
+	unmount_own_rc = -EINPROGRESS;
+	mp->async_wq = &unmount_wq;
+	open_iov_file(mp, &file);
+
+	zassert_equal(fs_async_submit(&req), 0, "submit failed");
+	zassert_equal(fs_unmount(mp), 0, "unmount failed");
+	mp->async_wq = NULL;
+
+	zassert_equal(req.result, 0, "request did not complete");
+	zassert_equal(unmount_stat_rc, 0, "stat from callback failed: %d",
+		      unmount_stat_rc);
+	zassert_equal(unmount_own_rc, -EDEADLK,
+		      "unmount from callback: %d", unmount_own_rc);
+
+	k_sem_give(&unmount_release);
+	(void)k_work_flush(&block, &sync);
+}
+
+#else
+
+void test_lfs_async_unmount_worker(void)
+{
+	ztest_test_skip();
+}
+
+#endif /* CONFIG_WORKQUEUE_WORKERS */
+
+#else
+
+void test_lfs_async(void)
+{
+	ztest_test_skip();
+}
+
+void test_lfs_async_unmount(void)
+{
+	ztest_test_skip();
+}
+
+void test_lfs_async_unmount_worker(void)
+{
+	ztest_test_skip();
+}
+
+#endif /* CONFIG_FILE_SYSTEM_ASYNC */
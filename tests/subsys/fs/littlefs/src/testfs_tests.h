@@ -24,6 +24,12 @@ void test_lfs_dirops(void);
 /* Tests in test_lfs_perf */
 void test_lfs_perf(void);
 
+/* Tests in test_lfs_iov */
+void test_lfs_iov(void);
+void test_lfs_async(void);
+void test_lfs_async_unmount(void);
+void test_lfs_async_unmount_worker(void);
+
 /* Test fs_open flags */
 void test_fs_open_flags_lfs(void);
 
@@ -154,6 +154,130 @@ void test_flash_area_check_int_sha256(void)
 	flash_area_close(fa);
 }
 
+/* echo $'0123456789abcdef\nfedcba98765432' > tst.sha */
+static const uint8_t chk_vec[] = {
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+	0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
+	0x0a, 0x66, 0x65, 0x64, 0x63, 0x62, 0x61, 0x39,
+	0x38, 0x37, 0x36, 0x35, 0x34, 0x33, 0x32, 0x0a };
+/* sha256sum tst.sha */
+static const uint8_t chk_sha[] = {
+	0x28, 0xf1, 0x6e, 0xea, 0xc3, 0xea, 0x89, 0x8d,
+	0x80, 0x9e, 0x98, 0xeb, 0x09, 0x49, 0x98, 0x08,
+	0x40, 0x69, 0x43, 0xa6, 0xef, 0xe1, 0xa3, 0xf9,
+	0x3d, 0xdf, 0x15, 0x9e, 0x06, 0xf8, 0xdd, 0xbd };
+/* crc32 tst.sha, little endian */
+static const uint8_t chk_crc[] = { 0x1d, 0x75, 0x69, 0x9e };
+
+static const struct flash_area *write_chk_vec(void)
+{
+	const struct flash_area *fa;
+	int rc;
+
+	rc = flash_area_open(FLASH_AREA_ID(image_1), &fa);
+	zassert_true(rc == 0, "flash_area_open() fail, error %d\n", rc);
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_true(rc == 0, "Flash erase failure, error %d\n", rc);
+	rc = flash_area_write(fa, 0, chk_vec, sizeof(chk_vec));
+	zassert_true(rc == 0, "Flash img write, error %d\n", rc);
+
+	return fa;
+}
+
+void test_flash_area_check_incremental(void)
+{
+	const struct flash_area *fa = write_chk_vec();
+	struct flash_area_check_ctx ctx;
+	uint8_t buffer[5];
+	int rc;
+
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   0, sizeof(chk_vec), NULL, sizeof(buffer));
+	zassert_equal(rc, -EINVAL, "Check init without read buffer\n");
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   fa->fa_size - 1, 2, buffer, sizeof(buffer));
+	zassert_equal(rc, -EINVAL, "Check init out of bounds\n");
+
+	/* Hash the vector in uneven parts, smaller and larger than rbuf */
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   0, sizeof(chk_vec), buffer, sizeof(buffer));
+	zassert_equal(rc, 0, "Check init, error %d\n", rc);
+	rc = flash_area_check_update(&ctx, 3);
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	rc = flash_area_check_update(&ctx, 17);
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	zassert_equal(flash_area_check_remaining(&ctx), sizeof(chk_vec) - 20,
+		      "Wrong remaining length\n");
+	rc = flash_area_check_update(&ctx, sizeof(chk_vec));
+	zassert_equal(rc, -EINVAL, "Check update past the region\n");
+	rc = flash_area_check_update(&ctx, sizeof(chk_vec) - 20);
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	rc = flash_area_check_final(&ctx, chk_sha);
+	zassert_equal(rc, 0, "SHA-256 check, error %d\n", rc);
+
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_CRC32,
+				   0, sizeof(chk_vec), buffer, sizeof(buffer));
+	zassert_equal(rc, 0, "Check init, error %d\n", rc);
+	rc = flash_area_check_update(&ctx, sizeof(chk_vec));
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	rc = flash_area_check_final(&ctx, chk_crc);
+	zassert_equal(rc, 0, "CRC-32 check, error %d\n", rc);
+
+	/* Completing before the whole region was hashed fails */
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_CRC32,
+				   0, sizeof(chk_vec), buffer, sizeof(buffer));
+	zassert_equal(rc, 0, "Check init, error %d\n", rc);
+	rc = flash_area_check_update(&ctx, 1);
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	rc = flash_area_check_final(&ctx, chk_crc);
+	zassert_equal(rc, -EINVAL, "Check of a partly hashed region\n");
+
+	rc = flash_area_check_init(&ctx, fa, FLASH_AREA_CHECK_CRC32,
+				   1, sizeof(chk_vec) - 1, buffer,
+				   sizeof(buffer));
+	zassert_equal(rc, 0, "Check init, error %d\n", rc);
+	rc = flash_area_check_update(&ctx, sizeof(chk_vec) - 1);
+	zassert_equal(rc, 0, "Check update, error %d\n", rc);
+	rc = flash_area_check_final(&ctx, chk_crc);
+	zassert_equal(rc, -EILSEQ, "Check of a wrong region\n");
+
+	flash_area_close(fa);
+}
+
+static K_SEM_DEFINE(chk_done, 0, 1);
+static int chk_result;
+
+static void chk_work_cb(struct flash_area_check_work *work, int result)
+{
+	chk_result = result;
+	k_sem_give(&chk_done);
+}
+
+void test_flash_area_check_work(void)
+{
+	static struct flash_area_check_work work;
+	const struct flash_area *fa = write_chk_vec();
+	uint8_t buffer[4];
+	int rc;
+
+	flash_area_check_work_init(&work);
+
+	rc = flash_area_check_work_submit(&work, NULL, 8, chk_sha, chk_work_cb);
+	zassert_equal(rc, -EINVAL, "Submit of an unstarted check\n");
+
+	rc = flash_area_check_init(&work.ctx, fa, FLASH_AREA_CHECK_SHA256,
+				   0, sizeof(chk_vec), buffer, sizeof(buffer));
+	zassert_equal(rc, 0, "Check init, error %d\n", rc);
+	rc = flash_area_check_work_submit(&work, NULL, 8, chk_sha, chk_work_cb);
+	zassert_equal(rc, 0, "Check submit, error %d\n", rc);
+
+	zassert_equal(k_sem_take(&chk_done, K_SECONDS(1)), 0,
+		      "Check did not complete\n");
+	zassert_equal(chk_result, 0, "SHA-256 check, error %d\n", chk_result);
+
+	flash_area_close(fa);
+}
+
 void test_flash_area_erased_val(void)
 {
 	const struct flash_parameters *param;
@@ -177,7 +301,9 @@ void test_main(void)
 	ztest_test_suite(test_flash_map,
 			 ztest_unit_test(test_flash_area_erased_val),
 			 ztest_unit_test(test_flash_area_get_sectors),
-			 ztest_unit_test(test_flash_area_check_int_sha256)
+			 ztest_unit_test(test_flash_area_check_int_sha256),
+			 ztest_unit_test(test_flash_area_check_incremental),
+			 ztest_unit_test(test_flash_area_check_work)
 			);
 	ztest_run_test_suite(test_flash_map);
 }
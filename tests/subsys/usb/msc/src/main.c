@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Mass storage class data transfers, driven through the bulk endpoint
+ * callbacks of the class with a fake device controller standing in for
+ * the host, on top of the RAM disk:
+ * * READ(10) and WRITE(10) spanning several data buffers
+ * * transfers past the end of the disk
+ * * transfers with a data length not matching the number of blocks
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <sys/byteorder.h>
+#include <storage/disk_access.h>
+#include <drivers/usb/usb_dc.h>
+#include <usb/usb_device.h>
+#include <usb/class/usb_msc.h>
+
+#define DISK_NAME		CONFIG_MASS_STORAGE_DISK_NAME
+#define BLOCK_SIZE		512
+#define MPS			CONFIG_MASS_STORAGE_BULK_EP_MPS
+
+/* More blocks than held by the data buffers, not a multiple of their size */
+#define XFER_LBA		10
+#define XFER_BLOCKS		7
+#define XFER_SIZE		(XFER_BLOCKS * BLOCK_SIZE)
+
+static struct usb_ep_cfg_data *ep_out;
+static struct usb_ep_cfg_data *ep_in;
+
+/* Data of the OUT packet being received by the class */
+static const uint8_t *out_data;
+static uint32_t out_len;
+/* Set as long as the class does not NAK the OUT packets */
+K_SEM_DEFINE(out_ready, 1, 1);
+
+/* Data of all the IN packets sent by the class since the last command */
+static uint8_t in_buf[XFER_SIZE + sizeof(struct CSW)];
+static uint32_t in_len;
+static uint32_t in_last;
+static uint32_t in_last_len;
+static bool in_overflow;
+/* Given when an IN packet has been written */
+K_SEM_DEFINE(in_sem, 0, 1);
+
+static bool in_stalled;
+static bool out_stalled;
+
+static uint32_t tag;
+static uint32_t block_count;
+
+static uint8_t data[XFER_SIZE];
+
+/* Fake device controller */
+
+int usb_dc_attach(void)
+{
+	return 0;
+}
+
+int usb_dc_detach(void)
+{
+	return 0;
+}
+
+int usb_dc_reset(void)
+{
+	return 0;
+}
+
+int usb_dc_set_address(const uint8_t addr)
+{
+	return 0;
+}
+
+void usb_dc_set_status_callback(const usb_dc_status_callback cb)
+{
+}
+
+int usb_dc_ep_check_cap(const struct usb_dc_ep_cfg_data * const cfg)
+{
+	return 0;
+}
+
+int usb_dc_ep_configure(const struct usb_dc_ep_cfg_data * const cfg)
+{
+	return 0;
+}
+
+int usb_dc_ep_set_stall(const uint8_t ep)
+{
+	if (ep_in && ep == ep_in->ep_addr) {
+		in_stalled = true;
+	} else if (ep_out && ep == ep_out->ep_addr) {
+		out_stalled = true;
+	}
+
+	return 0;
+}
+
+int usb_dc_ep_clear_stall(const uint8_t ep)
+{
+	return 0;
+}
+
+int usb_dc_ep_is_stalled(const uint8_t ep, uint8_t *const stalled)
+{
+	*stalled = 0U;
+
+	return 0;
+}
+
+int usb_dc_ep_enable(const uint8_t ep)
+{
+	return 0;
+}
+
+int usb_dc_ep_disable(const uint8_t ep)
+{
+	return 0;
+}
+
+int usb_dc_ep_set_callback(const uint8_t ep, const usb_dc_ep_callback cb)
+{
+	return 0;
+}
+
+int usb_dc_ep_mps(uint8_t ep)
+{
+	return USB_EP_GET_IDX(ep) ? MPS : USB_MAX_CTRL_MPS;
+}
+
+int usb_dc_wakeup_request(void)
+{
+	return 0;
+}
+
+int usb_dc_ep_write(const uint8_t ep, const uint8_t *const buf,
+		    const uint32_t data_len, uint32_t * const ret_bytes)
+{
+	if (ret_bytes) {
+		*ret_bytes = data_len;
+	}
+
+	if (!ep_in || ep != ep_in->ep_addr) {
+		return 0;
+	}
+
+	if (in_len + data_len > sizeof(in_buf)) {
+		in_overflow = true;
+	} else {
+		memcpy(&in_buf[in_len], buf, data_len);
+		in_last = in_len;
+		in_last_len = data_len;
+		in_len += data_len;
+	}
+
+	k_sem_give(&in_sem);
+
+	return 0;
+}
+
+int usb_dc_ep_read_wait(uint8_t ep, uint8_t *buf, uint32_t max_data_len,
+			uint32_t *read_bytes)
+{
+	uint32_t n = 0U;
+
+	if (ep_out && ep == ep_out->ep_addr) {
+		n = MIN(max_data_len, out_len);
+		memcpy(buf, out_data, n);
+		out_data += n;
+		out_len -= n;
+	}
+
+	if (read_bytes) {
+		*read_bytes = n;
+	}
+
+	return 0;
+}
+
+int usb_dc_ep_read_continue(uint8_t ep)
+{
+	if (ep_out && ep == ep_out->ep_addr) {
+		k_sem_give(&out_ready);
+	}
+
+	return 0;
+}
+
+int usb_dc_ep_read(const uint8_t ep, uint8_t *const buf,
+		   const uint32_t max_data_len, uint32_t *const read_bytes)
+{
+	int ret = usb_dc_ep_read_wait(ep, buf, max_data_len, read_bytes);
+
+	if (!ret && buf) {
+		ret = usb_dc_ep_read_continue(ep);
+	}
+
+	return ret;
+}
+
+/* Host side */
+
+/* Send an OUT packet once the class does not NAK them */
+static void host_out(const void *buf, uint32_t len)
+{
+	zassert_equal(k_sem_take(&out_ready, K_SECONDS(1)), 0,
+		      "OUT endpoint not released");
+
+	out_data = buf;
+	out_len = len;
+	ep_out->ep_cb(ep_out->ep_addr, USB_DC_EP_DATA_OUT);
+	zassert_equal(out_len, 0, "OUT packet not read");
+}
+
+static void host_cbw(uint8_t opcode, uint32_t lba, uint16_t blocks,
+		     uint32_t data_len, bool dir_in)
+{
+	struct CBW cbw = {
+		.Signature = CBW_Signature,
+		.Tag = ++tag,
+		.DataLength = data_len,
+		.Flags = dir_in ? 0x80 : 0x00,
+		.CBLength = 10,
+	};
+
+	cbw.CB[0] = opcode;
+	sys_put_be32(lba, &cbw.CB[2]);
+	sys_put_be16(blocks, &cbw.CB[7]);
+
+	in_len = 0U;
+	in_overflow = false;
+	in_stalled = false;
+	out_stalled = false;
+
+	host_out(&cbw, sizeof(cbw));
+}
+
+/* Wait for the next IN packet and report its transfer as complete */
+static void host_in_packet(void)
+{
+	zassert_equal(k_sem_take(&in_sem, K_SECONDS(1)), 0,
+		      "No IN packet after %u bytes", in_len);
+	zassert_false(in_overflow, "Unexpected IN data");
+
+	ep_in->ep_cb(ep_in->ep_addr, USB_DC_EP_DATA_IN);
+}
+
+static void host_in(uint32_t len)
+{
+	while (in_len < len) {
+		host_in_packet();
+		zassert_true(in_last_len <= MPS, "IN packet larger than MPS");
+	}
+}
+
+static void host_out_data(const uint8_t *buf, uint32_t len)
+{
+	for (uint32_t off = 0U; off < len; off += MPS) {
+		host_out(&buf[off], MIN(MPS, len - off));
+	}
+}
+
+static void host_csw(uint8_t status, uint32_t residue)
+{
+	struct CSW csw;
+
+	host_in_packet();
+
+	zassert_equal(in_last_len, sizeof(csw), "CSW expected");
+	memcpy(&csw, &in_buf[in_last], sizeof(csw));
+
+	zassert_equal(csw.Signature, CSW_Signature, "Bad CSW signature");
+	zassert_equal(csw.Tag, tag, "Bad CSW tag");
+	zassert_equal(csw.Status, status, "Bad CSW status %u", csw.Status);
+	zassert_equal(csw.DataResidue, residue, "Bad residue %u",
+		      csw.DataResidue);
+}
+
+static void fill(uint8_t *buf, uint32_t len, uint8_t seed)
+{
+	for (uint32_t i = 0U; i < len; i++) {
+		buf[i] = (uint8_t)(i / BLOCK_SIZE * 7 + i + seed);
+	}
+}
+
+static void read_blocks(uint32_t lba, uint16_t blocks)
+{
+	uint32_t len = blocks * BLOCK_SIZE;
+
+	fill(data, len, (uint8_t)lba);
+	zassert_equal(disk_access_write(DISK_NAME, data, lba, blocks), 0,
+		      "Disk write failed");
+
+	host_cbw(READ10, lba, blocks, len, true);
+	host_in(len);
+	host_csw(CSW_STATUS_CMD_PASSED, 0);
+
+	zassert_equal(in_len, len + sizeof(struct CSW), "Bad IN length");
+	zassert_mem_equal(in_buf, data, len, "Data read mismatch");
+}
+
+static void test_msc_setup(void)
+{
+	STRUCT_SECTION_FOREACH(usb_cfg_data, cfg) {
+		const struct usb_if_descriptor *iface =
+			cfg->interface_descriptor;
+
+		if (iface->bInterfaceClass != USB_BCC_MASS_STORAGE) {
+			continue;
+		}
+
+		for (int i = 0; i < cfg->num_endpoints; i++) {
+			if (USB_EP_DIR_IS_IN(cfg->endpoint[i].ep_addr)) {
+				ep_in = &cfg->endpoint[i];
+			} else {
+				ep_out = &cfg->endpoint[i];
+			}
+		}
+	}
+
+	zassert_not_null(ep_in, "No mass storage IN endpoint");
+	zassert_not_null(ep_out, "No mass storage OUT endpoint");
+
+	zassert_equal(disk_access_ioctl(DISK_NAME, DISK_IOCTL_GET_SECTOR_COUNT,
+					&block_count), 0, "No sector count");
+	zassert_true(block_count > XFER_LBA + XFER_BLOCKS, "Disk too small");
+}
+
+static void test_msc_write10(void)
+{
+	static uint8_t disk[XFER_SIZE];
+
+	fill(data, XFER_SIZE, 0x5a);
+
+	host_cbw(WRITE10, XFER_LBA, XFER_BLOCKS, XFER_SIZE, false);
+	host_out_data(data, XFER_SIZE);
+	host_csw(CSW_STATUS_CMD_PASSED, 0);
+
+	zassert_false(out_stalled, "OUT endpoint stalled");
+	zassert_equal(disk_access_read(DISK_NAME, disk, XFER_LBA, XFER_BLOCKS),
+		      0, "Disk read failed");
+	zassert_mem_equal(disk, data, XFER_SIZE, "Data written mismatch");
+}
+
+static void test_msc_read10(void)
+{
+	read_blocks(XFER_LBA, XFER_BLOCKS);
+	zassert_false(in_stalled, "IN endpoint stalled");
+
+	/* last blocks of the disk */
+	read_blocks(block_count - 3, 3);
+}
+
+static void test_msc_read10_out_of_range(void)
+{
+	host_cbw(READ10, block_count - 2, 4, 4 * BLOCK_SIZE, true);
+	host_csw(CSW_STATUS_CMD_FAILED, 4 * BLOCK_SIZE);
+
+	zassert_true(in_stalled, "IN endpoint not stalled");
+	zassert_equal(in_len, sizeof(struct CSW), "Data sent");
+
+	/* the next command succeeds */
+	read_blocks(XFER_LBA, 1);
+}
+
+static void test_msc_read10_short(void)
+{
+	/* host expects less data than the blocks requested */
+	host_cbw(READ10, XFER_LBA, 2, BLOCK_SIZE, true);
+	host_csw(CSW_STATUS_CMD_FAILED, BLOCK_SIZE);
+
+	zassert_true(in_stalled, "IN endpoint not stalled");
+	zassert_equal(in_len, sizeof(struct CSW), "Data sent");
+
+	read_blocks(XFER_LBA, 2);
+}
+
+static void test_msc_write10_short(void)
+{
+	static uint8_t disk[2 * BLOCK_SIZE];
+
+	fill(data, sizeof(disk), 0x11);
+	zassert_equal(disk_access_write(DISK_NAME, data, XFER_LBA, 2), 0,
+		      "Disk write failed");
+
+	host_cbw(WRITE10, XFER_LBA, 2, BLOCK_SIZE, false);
+	host_csw(CSW_STATUS_CMD_FAILED, BLOCK_SIZE);
+
+	zassert_true(out_stalled, "OUT endpoint not stalled");
+	zassert_equal(disk_access_read(DISK_NAME, disk, XFER_LBA, 2), 0,
+		      "Disk read failed");
+	zassert_mem_equal(disk, data, sizeof(disk), "Disk modified");
+
+	read_blocks(XFER_LBA, 2);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_msc,
+			 ztest_unit_test(test_msc_setup),
+			 ztest_unit_test(test_msc_write10),
+			 ztest_unit_test(test_msc_read10),
+			 ztest_unit_test(test_msc_read10_out_of_range),
+			 ztest_unit_test(test_msc_read10_short),
+			 ztest_unit_test(test_msc_write10_short));
+
+	ztest_run_test_suite(test_msc);
+}